@@ -0,0 +1,126 @@
+/** \addtogroup benchmarks
+  * @{
+  * \addtogroup bench_tropical
+  * @{
+  * \brief Benchmarks the min-plus gemm and csrmm kernels of MinPlus against a min-plus Semiring given by function pointers
+  */
+
+#include <ctf.hpp>
+#include <assert.h>
+
+using namespace CTF;
+
+double fmin_dbl(double a, double b){ return std::min(a,b); }
+double fplus_dbl(double a, double b){ return a+b; }
+
+/**
+ * \brief times niter calls to the local gemm and csrmm kernels of sr, returns seconds per call
+ */
+void time_kernels(CTF_int::algstrct const & sr,
+                  int                       n,
+                  int                       niter,
+                  double const *            A,
+                  double const *            B,
+                  double *                  C,
+                  double const *            vA,
+                  int const *               JA,
+                  int const *               IA,
+                  double &                  t_gemm,
+                  double &                  t_csrmm){
+  double mulid = 0.;
+  double t_st = MPI_Wtime();
+  for (int i=0; i<niter; i++){
+    sr.gemm('N', 'N', n, n, n, (char const*)&mulid, (char const*)A, (char const*)B, (char const*)&mulid, (char*)C);
+  }
+  t_gemm = (MPI_Wtime()-t_st)/niter;
+  t_st = MPI_Wtime();
+  for (int i=0; i<niter; i++){
+    sr.csrmm(n, n, n, (char const*)&mulid, (char const*)vA, JA, IA, IA[n]-1, (char const*)B, (char const*)&mulid, (char*)C, NULL);
+  }
+  t_csrmm = (MPI_Wtime()-t_st)/niter;
+}
+
+void bench_tropical(int    n,
+                    double sp,
+                    int    niter){
+  double inf = std::numeric_limits<double>::infinity();
+  Semiring<double> fptr(inf, &fmin_dbl, MPI_MIN, 0., &fplus_dbl);
+  MinPlus<double> mp;
+
+  printf("Benchmarking min-plus kernels with n=%d, CSR density %lf:\n", n, sp);
+  std::vector<double> A(n*n), B(n*n), C0(n*n), C1(n*n);
+  srand48(7);
+  for (int i=0; i<n*n; i++){
+    A[i] = drand48();
+    B[i] = drand48();
+    C0[i] = inf;
+  }
+  std::vector<double> vA;
+  std::vector<int> JA, IA(1,1);
+  for (int i=0; i<n; i++){
+    for (int j=0; j<n; j++){
+      if (drand48() < sp){
+        vA.push_back(drand48());
+        JA.push_back(j+1);
+      }
+    }
+    IA.push_back(vA.size()+1);
+  }
+  C1 = C0;
+
+  double t_gemm_fptr, t_csrmm_fptr, t_gemm_mp, t_csrmm_mp;
+  time_kernels(fptr, n, niter, A.data(), B.data(), C0.data(), vA.data(), JA.data(), IA.data(), t_gemm_fptr, t_csrmm_fptr);
+  time_kernels(mp, n, niter, A.data(), B.data(), C1.data(), vA.data(), JA.data(), IA.data(), t_gemm_mp, t_csrmm_mp);
+  for (int i=0; i<n*n; i++){
+    assert(C0[i] == C1[i]);
+  }
+
+  double gops = 2.E-9*n*n*n;
+  double sp_gops = 2.E-9*vA.size()*n;
+  printf("gemm function pointers sec/iter: %lf (Gops/s = %lf)\n", t_gemm_fptr, gops/t_gemm_fptr);
+  printf("gemm MinPlus           sec/iter: %lf (Gops/s = %lf), speedup %lf\n", t_gemm_mp, gops/t_gemm_mp, t_gemm_fptr/t_gemm_mp);
+  printf("csrmm function pointers sec/iter: %lf (Gops/s = %lf)\n", t_csrmm_fptr, sp_gops/t_csrmm_fptr);
+  printf("csrmm MinPlus           sec/iter: %lf (Gops/s = %lf), speedup %lf\n", t_csrmm_mp, sp_gops/t_csrmm_mp, t_csrmm_fptr/t_csrmm_mp);
+}
+
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int niter, n;
+  double sp;
+  int const in_num = argc;
+  char ** input_str = argv;
+  MPI_Init(NULL, NULL);
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 400;
+  } else n = 400;
+
+  if (getCmdOption(input_str, input_str+in_num, "-sp")){
+    sp = atof(getCmdOption(input_str, input_str+in_num, "-sp"));
+    if (sp < 0.0 || sp > 1.0) sp = .05;
+  } else sp = .05;
+
+  if (getCmdOption(input_str, input_str+in_num, "-niter")){
+    niter = atoi(getCmdOption(input_str, input_str+in_num, "-niter"));
+    if (niter < 0) niter = 4;
+  } else niter = 4;
+
+  bench_tropical(n, sp, niter);
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
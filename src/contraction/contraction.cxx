@@ -13,6 +13,7 @@
 #include "ctr_2d_general.h"
 #include "spctr_offload.h"
 #include "spctr_2d_general.h"
+#include "ctr_plan_cache.h"
 #include "../symmetry/sym_indices.h"
 #include "../symmetry/symmetrization.h"
 #include "../redistribution/nosym_transp.h"
@@ -45,6 +46,7 @@ namespace CTF_int {
     if (other.is_custom) is_custom = 1;
     else is_custom = 0;
     func      = other.func;
+    is_masked = other.is_masked;
     alpha = other.alpha;
     beta  = other.beta;
   }
@@ -64,6 +66,7 @@ namespace CTF_int {
     if (func_ == NULL) is_custom = 0;
     else is_custom = 1;
     func = func_;
+    is_masked = false;
     alpha = alpha_;
     beta  = beta_;
     
@@ -90,6 +93,7 @@ namespace CTF_int {
     if (func_ == NULL) is_custom = 0;
     else is_custom = 1;
     func = func_;
+    is_masked = false;
     alpha = alpha_;
     beta  = beta_;
     
@@ -160,8 +164,93 @@ namespace CTF_int {
 
 
   double contraction::estimate_time(){
-    assert(0); //FIXME
-    return 0.0;
+    return dry_run().time;
+  }
+
+  /**
+   * \brief creates a tensor with the shape, nonzero count and mapping of X but no data
+   */
+  static tensor * get_mapping_shell(tensor * X){
+    tensor * nX = new tensor(X, 0, 0);
+    nX->nnz_tot = X->nnz_tot;
+    nX->nnz_loc_max = X->nnz_loc_max;
+    nX->nnz_imb = X->nnz_imb;
+    nX->clear_mapping();
+    nX->set_padding();
+    copy_mapping(X->order, X->edge_map, nX->edge_map);
+    nX->is_mapped = 1;
+    nX->topo      = X->topo;
+    nX->set_padding();
+    return nX;
+  }
+
+  CTF::Cost_estimate contraction::dry_run(){
+    CTF::Cost_estimate est;
+    est.time        = 0.0;
+    est.comp_time   = 0.0;
+    est.comm_time   = 0.0;
+    est.redist_time = 0.0;
+    est.mem         = 0;
+    if (A->has_zero_edge_len || B->has_zero_edge_len
+        || C->has_zero_edge_len){
+      return est;
+    }
+    if (B->is_sparse && !A->is_sparse){
+      contraction CBA(B,idx_B,A,idx_A,alpha,C,idx_C,beta,func);
+      return CBA.dry_run();
+    }
+    TAU_FSTART(contraction_dry_run);
+    /* search for the mapping on copies of the tensors that carry no data, so that
+       neither the data nor the mappings of A, B, and C are modified */
+    std::vector<tensor*> shells;
+    shells.push_back(get_mapping_shell(A));
+    shells.push_back(get_mapping_shell(B));
+    shells.push_back(get_mapping_shell(C));
+    contraction * dctr = new contraction(shells[0], idx_A, shells[1], idx_B, alpha, shells[2], idx_C, beta, func);
+    /* execution unfolds symmetries the contraction does not preserve one at a time */
+    while (dctr->unfold_broken_sym(NULL) != -1){
+      contraction * unfold_ctr;
+      dctr->unfold_broken_sym(&unfold_ctr);
+      shells.push_back(unfold_ctr->A);
+      shells.push_back(unfold_ctr->B);
+      shells.push_back(unfold_ctr->C);
+      delete dctr;
+      dctr = unfold_ctr;
+    }
+    est = dctr->est_map_cost();
+    delete dctr;
+    for (int i=0; i<(int)shells.size(); i++){
+      delete shells[i];
+    }
+    TAU_FSTOP(contraction_dry_run);
+    return est;
+  }
+
+  void contraction::get_nnz_frac(double & nnz_frac_A, double & nnz_frac_B, double & nnz_frac_C){
+    nnz_frac_A = 1.0;
+    nnz_frac_B = 1.0;
+    nnz_frac_C = 1.0;
+    if (A->is_sparse) nnz_frac_A = A->calc_nnz_frac();
+    if (B->is_sparse) nnz_frac_B = B->calc_nnz_frac();
+    if (C->is_sparse){
+      int num_tot;
+      int * idx_arr; 
+      inv_idx(A->order, idx_A,
+              B->order, idx_B,
+              C->order, idx_C,
+              &num_tot, &idx_arr);
+      nnz_frac_C = C->calc_nnz_frac();
+      int64_t len_ctr = 1;
+      for (int i=0; i<num_tot; i++){
+        if (idx_arr[3*i+2]==-1){
+          int edge_len = idx_arr[3*i+0] != -1 ? A->lens[idx_arr[3*i+0]] 
+                                              : B->lens[idx_arr[3*i+1]];
+          len_ctr *= edge_len;
+        }
+      }
+      nnz_frac_C = std::min(1.,std::max(nnz_frac_C,nnz_frac_A*nnz_frac_B*len_ctr));
+      cdealloc(idx_arr);
+    }
   }
 
   int contraction::is_equal(contraction const & os){
@@ -596,15 +685,15 @@ namespace CTF_int {
     
       double time_est = 0.0;
       if (tA->is_sparse)
-        time_est += tA->nnz_tot/(tA->size*tA->calc_npe())*tA->calc_nvirt()*est_time_transp(tall_fdim_A, tAiord, tall_flen_A, 1, tA->sr);
+        time_est += tA->calc_nnz_frac()*tA->calc_nvirt()*est_time_transp(tall_fdim_A, tAiord, tall_flen_A, 1, tA->sr);
       else
         time_est += tA->calc_nvirt()*est_time_transp(tall_fdim_A, tAiord, tall_flen_A, 1, tA->sr);
       if (tB->is_sparse)
-        time_est += tB->nnz_tot/(tB->size*tB->calc_npe())*tB->calc_nvirt()*est_time_transp(tall_fdim_B, tBiord, tall_flen_B, 1, tB->sr);
+        time_est += tB->calc_nnz_frac()*tB->calc_nvirt()*est_time_transp(tall_fdim_B, tBiord, tall_flen_B, 1, tB->sr);
       else
         time_est += tB->calc_nvirt()*est_time_transp(tall_fdim_B, tBiord, tall_flen_B, 1, tB->sr);
       if (tC->is_sparse)
-        time_est += 2.*tC->nnz_tot/(tC->size*tC->calc_npe())*tC->calc_nvirt()*est_time_transp(tall_fdim_C, tCiord, tall_flen_C, 1, tC->sr);
+        time_est += 2.*tC->calc_nnz_frac()*tC->calc_nvirt()*est_time_transp(tall_fdim_C, tCiord, tall_flen_C, 1, tC->sr);
       else
         time_est += 2.*tC->calc_nvirt()*est_time_transp(tall_fdim_C, tCiord, tall_flen_C, 1, tC->sr);
       if (is_sparse()){
@@ -746,7 +835,7 @@ namespace CTF_int {
             if (idx_A[i] == idx_C[j]) nrow_idx++;
           }
         }
-        A->spmatricize(iprm.m, iprm.k, nrow_idx, csr_or_coo);
+        A->spmatricize(iprm.m, iprm.k, nrow_idx, csr_or_coo, csr_or_coo);
       }
       nvirt_B = B->calc_nvirt();
       if (!B->is_sparse){
@@ -761,6 +850,7 @@ namespace CTF_int {
             if (idx_B[i] == idx_A[j]) nrow_idx++;
           }
         }
+        // the kernels index all rows of B by the columns of A, so B is kept in CSR rather than DCSR
         B->spmatricize(iprm.k, iprm.n, nrow_idx, csr_or_coo);
       }
 
@@ -2389,12 +2479,6 @@ namespace CTF_int {
     CommData global_comm = wrld->cdt;
     btopo = -1;
     best_time = DBL_MAX;
-    int num_tot;
-    int * idx_arr; 
-    inv_idx(A->order, idx_A,
-            B->order, idx_B,
-            C->order, idx_C,
-            &num_tot, &idx_arr);
     int64_t max_memuse = proc_bytes_available();
     for (j=0; j<6; j++){
       // Attempt to map to all possible permutations of processor topology 
@@ -2473,26 +2557,13 @@ namespace CTF_int {
         }
   #endif
         ctr * sctr;
-        double nnz_frac_A = 1.0;
-        double nnz_frac_B = 1.0;
-        double nnz_frac_C = 1.0;
-        if (A->is_sparse) nnz_frac_A = std::min(1.,((double)A->nnz_tot)/(A->size*A->calc_npe()));
-        if (B->is_sparse) nnz_frac_B = std::min(1.,((double)B->nnz_tot)/(B->size*B->calc_npe()));
-        if (C->is_sparse){
-          nnz_frac_C = std::min(1.,((double)C->nnz_tot)/(C->size*C->calc_npe()));
-          int64_t len_ctr = 1;
-          for (int i=0; i<num_tot; i++){
-            if (idx_arr[3*i+2]==-1){
-              int edge_len = idx_arr[3*i+0] != -1 ? A->lens[idx_arr[3*i+0]] 
-                                                  : B->lens[idx_arr[3*i+1]];
-              len_ctr *= edge_len;
-            }
-          }
-          nnz_frac_C = std::min(1.,std::max(nnz_frac_C,nnz_frac_A*nnz_frac_B*len_ctr));
-        }
+        double nnz_frac_A, nnz_frac_B, nnz_frac_C;
+        get_nnz_frac(nnz_frac_A, nnz_frac_B, nnz_frac_C);
 
+        bool is_inner = false;
   #if FOLD_TSR
         if (can_fold()){
+          is_inner = true;
           est_time = est_time_fold();
           iparam prm = map_fold(false);
           sctr = construct_ctr(1, &prm);
@@ -2513,6 +2584,12 @@ namespace CTF_int {
             est_time = sctr->est_time_rec(sctr->num_lyr);
           }
         }
+        // a masked contraction is only done by mappings that pass the blocks of C to the folded kernel in place
+        if (is_masked && (!is_inner || !((spctr*)sctr)->is_C_in_place())){
+          TAU_FSTOP(est_ctr_map_time);
+          delete sctr;
+          continue;
+        }
   #if DEBUG >= 1
         if (global_comm.rank == 0){
           printf("mapping passed contr est_time = %E sec\n", est_time);
@@ -2604,8 +2681,6 @@ namespace CTF_int {
 
     idx=ttopo;
     time=gbest_time;
-
-    cdealloc(idx_arr);
   }
 
   void contraction::get_best_exh_map(distribution const * dA, distribution const * dB, distribution const * dC, topology * old_topo_A, topology * old_topo_B, topology * old_topo_C, mapping const * old_map_A, mapping const * old_map_B, mapping const * old_map_C, int & idx, double & time, double init_best_time=DBL_MAX){
@@ -2691,10 +2766,10 @@ namespace CTF_int {
         double nnz_frac_A = 1.0;
         double nnz_frac_B = 1.0;
         double nnz_frac_C = 1.0;
-        if (A->is_sparse) nnz_frac_A = std::min(1.,((double)A->nnz_tot)/(A->size*A->calc_npe()));
-        if (B->is_sparse) nnz_frac_B = std::min(1.,((double)B->nnz_tot)/(B->size*B->calc_npe()));
+        if (A->is_sparse) nnz_frac_A = A->calc_nnz_frac();
+        if (B->is_sparse) nnz_frac_B = B->calc_nnz_frac();
         if (C->is_sparse){
-          nnz_frac_C = std::min(1.,((double)C->nnz_tot)/(C->size*C->calc_npe()));
+          nnz_frac_C = C->calc_nnz_frac();
           nnz_frac_C = std::max(nnz_frac_C,nnz_frac_A);
           nnz_frac_C = std::max(nnz_frac_C,nnz_frac_B);
           int64_t len_ctr = 1;
@@ -2710,8 +2785,10 @@ namespace CTF_int {
 
 
         ctr * sctr;
+        bool is_inner = false;
   #if FOLD_TSR
         if (can_fold()){
+          is_inner = true;
           est_time = est_time_fold();
           iparam prm = map_fold(false);
           sctr = construct_ctr(1, &prm);
@@ -2732,6 +2809,12 @@ namespace CTF_int {
             est_time = sctr->est_time_rec(sctr->num_lyr);
           }
         }
+        // a masked contraction is only done by mappings that pass the blocks of C to the folded kernel in place
+        if (is_masked && (!is_inner || !((spctr*)sctr)->is_C_in_place())){
+          TAU_FSTOP(est_ctr_map_time);
+          delete sctr;
+          continue;
+        }
   #if DEBUG >= 4
         printf("mapping passed contr est_time = %E sec\n", est_time);
   #endif 
@@ -2834,7 +2917,7 @@ namespace CTF_int {
   }
 
   int contraction::map(ctr ** ctrf, bool do_remap){
-    int ret, j, need_remap, d;
+    int ret, j;
     int * old_phase_A, * old_phase_B, * old_phase_C;
     topology * old_topo_A, * old_topo_B, * old_topo_C;
     distribution * dA, * dB, * dC;
@@ -2894,10 +2977,134 @@ namespace CTF_int {
       old_phase_C[j]   = C->edge_map[j].calc_phase();
     }
 
-    //bmemuse = UINT64_MAX;
+    /* Reuse the mapping selected previously for an identical contraction, if any */
+    std::vector<int64_t> plan_sig;
+    ctr_plan_cache & plan_cache = get_ctr_plan_cache();
+    bool use_plan_cache = do_remap && !is_masked && ctr_plan_cache::get_signature(A, idx_A, B, idx_B, C, idx_C, plan_sig);
+    if (use_plan_cache){
+      TAU_FSTART(lookup_ctr_plan);
+      ctr_plan const * plan = plan_cache.lookup(wrld, plan_sig);
+      bool is_plan_valid = false;
+      if (plan != NULL && plan->topo_idx < (int)wrld->topovec.size() &&
+          wrld->topovec[plan->topo_idx]->order == plan->topo_order){
+        A->clear_mapping();
+        B->clear_mapping();
+        C->clear_mapping();
+        topology * topo_p = wrld->topovec[plan->topo_idx];
+        A->topo = topo_p;
+        B->topo = topo_p;
+        C->topo = topo_p;
+        A->is_mapped = 1;
+        B->is_mapped = 1;
+        C->is_mapped = 1;
+        copy_mapping(A->order, plan->map_A, A->edge_map);
+        copy_mapping(B->order, plan->map_B, B->edge_map);
+        copy_mapping(C->order, plan->map_C, C->edge_map);
+        A->set_padding();
+        B->set_padding();
+        C->set_padding();
+        is_plan_valid = check_mapping();
+        if (!is_plan_valid){
+          DPRINTF(1,"Cached contraction mapping is invalid, remapping\n");
+          plan_cache.remove(wrld, plan_sig);
+        }
+      }
+      TAU_FSTOP(lookup_ctr_plan);
+      if (is_plan_valid){
+        TAU_FSTOP(init_select_ctr_map);
+        double est_time = plan->est_time;
+        int stat = finish_map(ctrf, dA, dB, dC, old_topo_A, old_topo_B, old_topo_C, old_map_A, old_map_B, old_map_C, est_time);
+        CTF_int::cdealloc(old_phase_A);
+        CTF_int::cdealloc(old_phase_B);
+        CTF_int::cdealloc(old_phase_C);
+        return stat;
+      }
+    }
+  
+    double est_time;
+    ret = map_best(dA, dB, dC, old_topo_A, old_topo_B, old_topo_C, old_map_A, old_map_B, old_map_C, est_time);
+
+    if (ret != SUCCESS && is_masked){
+      // no mapping keeps the blocks of C in place, restore the mappings so the contraction can be done unmasked
+      A->topo = old_topo_A;
+      B->topo = old_topo_B;
+      C->topo = old_topo_C;
+      copy_mapping(A->order, old_map_A, A->edge_map);
+      copy_mapping(B->order, old_map_B, B->edge_map);
+      copy_mapping(C->order, old_map_C, C->edge_map);
+      A->is_mapped = 1;
+      B->is_mapped = 1;
+      C->is_mapped = 1;
+      A->set_padding();
+      B->set_padding();
+      C->set_padding();
+      CTF_int::cdealloc(old_phase_A);
+      CTF_int::cdealloc(old_phase_B);
+      CTF_int::cdealloc(old_phase_C);
+      delete [] old_map_A;
+      delete [] old_map_B;
+      delete [] old_map_C;
+      delete dA;
+      delete dB;
+      delete dC;
+      return NEGATIVE;
+    }
+    if (!do_remap || ret != SUCCESS){
+      A->clear_mapping();
+      B->clear_mapping();
+      C->clear_mapping();
+      A->set_padding();
+      B->set_padding();
+      C->set_padding();
+      CTF_int::cdealloc(old_phase_A);
+      CTF_int::cdealloc(old_phase_B);
+      CTF_int::cdealloc(old_phase_C);
+      delete [] old_map_A;
+      delete [] old_map_B;
+      delete [] old_map_C;
+      delete dA;
+      delete dB;
+      delete dC;
+
+      if (ret != SUCCESS){
+        printf("ERROR: Failed to map contraction!\n");
+        ASSERT(0);
+        //ABORT;
+        return ERROR;
+      }
+      return SUCCESS;
+    }
+    if (use_plan_cache){
+      int topo_idx = -1;
+      for (int i=0; i<(int)wrld->topovec.size(); i++){
+        if (wrld->topovec[i] == A->topo) topo_idx = i;
+      }
+      if (topo_idx != -1)
+        plan_cache.insert(wrld, plan_sig, new ctr_plan(A, B, C, topo_idx, est_time));
+    }
+    
+    CTF_int::cdealloc( old_phase_A );
+    CTF_int::cdealloc( old_phase_B );
+    CTF_int::cdealloc( old_phase_C );
+
+    return finish_map(ctrf, dA, dB, dC, old_topo_A, old_topo_B, old_topo_C, old_map_A, old_map_B, old_map_C, est_time);
+  }
+
+  int contraction::map_best(distribution const * dA,
+                            distribution const * dB,
+                            distribution const * dC,
+                            topology *           old_topo_A,
+                            topology *           old_topo_B,
+                            topology *           old_topo_C,
+                            mapping const *      old_map_A,
+                            mapping const *      old_map_B,
+                            mapping const *      old_map_C,
+                            double &             est_time){
+    int ret;
     int ttopo, ttopo_sel, ttopo_exh;
     double gbest_time_sel, gbest_time_exh;
-  
+    World * wrld = A->wrld;
+
     TAU_FSTART(get_best_sel_map);
     get_best_sel_map(dA, dB, dC, old_topo_A, old_topo_B, old_topo_C, old_map_A, old_map_B, old_map_C, ttopo_sel, gbest_time_sel);
     TAU_FSTOP(get_best_sel_map);
@@ -2922,25 +3129,7 @@ namespace CTF_int {
     B->set_padding();
     C->set_padding();
     
-    if (!do_remap || ttopo == INT_MAX || ttopo == -1){
-      CTF_int::cdealloc(old_phase_A);
-      CTF_int::cdealloc(old_phase_B);
-      CTF_int::cdealloc(old_phase_C);
-      delete [] old_map_A;
-      delete [] old_map_B;
-      delete [] old_map_C;
-      delete dA;
-      delete dB;
-      delete dC;
-
-      if (ttopo == INT_MAX || ttopo == -1){
-        printf("ERROR: Failed to map contraction!\n");
-        ASSERT(0);
-        //ABORT;
-        return ERROR;
-      }
-      return SUCCESS;
-    }
+    if (ttopo == INT_MAX || ttopo == -1) return ERROR;
     topology * topo_g = NULL;
     int j_g;
     if (gbest_time_sel <= gbest_time_exh){
@@ -3003,6 +3192,129 @@ namespace CTF_int {
     A->set_padding();
     B->set_padding();
     C->set_padding();
+    est_time = std::min(gbest_time_sel,gbest_time_exh);
+    return SUCCESS;
+  }
+
+  CTF::Cost_estimate contraction::est_map_cost(){
+    int d;
+    CTF::Cost_estimate est;
+    est.time        = DBL_MAX;
+    est.comp_time   = 0.0;
+    est.comm_time   = 0.0;
+    est.redist_time = 0.0;
+    est.mem         = 0;
+
+    topology * old_topo_A = A->topo;
+    topology * old_topo_B = B->topo;
+    topology * old_topo_C = C->topo;
+    mapping * old_map_A = new mapping[A->order];
+    mapping * old_map_B = new mapping[B->order];
+    mapping * old_map_C = new mapping[C->order];
+    copy_mapping(A->order, A->edge_map, old_map_A);
+    copy_mapping(B->order, B->edge_map, old_map_B);
+    copy_mapping(C->order, C->edge_map, old_map_C);
+    A->set_padding();
+    B->set_padding();
+    C->set_padding();
+    distribution * dA = new distribution(A);
+    distribution * dB = new distribution(B);
+    distribution * dC = new distribution(C);
+
+    double est_time;
+    if (map_best(dA, dB, dC, old_topo_A, old_topo_B, old_topo_C, old_map_A, old_map_B, old_map_C, est_time) == SUCCESS){
+      double nnz_frac_A, nnz_frac_B, nnz_frac_C;
+      get_nnz_frac(nnz_frac_A, nnz_frac_B, nnz_frac_C);
+      ctr * sctr;
+      if (can_fold()){
+        iparam prm = map_fold(false);
+        sctr = construct_ctr(1, &prm);
+        A->remove_fold();
+        B->remove_fold();
+        C->remove_fold();
+      } else
+        sctr = construct_ctr();
+      double ctr_time;
+      if (is_sparse()){
+        spctr * spsctr = (spctr*)sctr;
+        ctr_time      = spsctr->est_time_rec(sctr->num_lyr, nnz_frac_A, nnz_frac_B, nnz_frac_C);
+        est.comm_time = spsctr->est_comm_time_rec(sctr->num_lyr, nnz_frac_A, nnz_frac_B, nnz_frac_C);
+        est.mem       = spsctr->spmem_rec(nnz_frac_A, nnz_frac_B, nnz_frac_C);
+      } else {
+        ctr_time      = sctr->est_time_rec(sctr->num_lyr);
+        est.comm_time = sctr->est_comm_time_rec(sctr->num_lyr);
+        est.mem       = sctr->mem_rec();
+      }
+      est.comp_time = std::max(0.0, ctr_time - est.comm_time);
+      delete sctr;
+
+      /* redistribution of the operands, C is moved there and back */
+      bool need_remap = A->topo != old_topo_A;
+      for (d=0; d<A->order && !need_remap; d++){
+        if (!comp_dim_map(&A->edge_map[d],&old_map_A[d])) need_remap = true;
+      }
+      if (need_remap){
+        est.redist_time += A->est_redist_time(*dA, nnz_frac_A);
+        est.mem = std::max(est.mem, A->get_redist_mem(*dA, nnz_frac_A));
+      }
+      need_remap = B->topo != old_topo_B;
+      for (d=0; d<B->order && !need_remap; d++){
+        if (!comp_dim_map(&B->edge_map[d],&old_map_B[d])) need_remap = true;
+      }
+      if (need_remap){
+        est.redist_time += B->est_redist_time(*dB, nnz_frac_B);
+        est.mem = std::max(est.mem, B->get_redist_mem(*dB, nnz_frac_B));
+      }
+      need_remap = C->topo != old_topo_C;
+      for (d=0; d<C->order && !need_remap; d++){
+        if (!comp_dim_map(&C->edge_map[d],&old_map_C[d])) need_remap = true;
+      }
+      if (need_remap){
+        est.redist_time += 2.*C->est_redist_time(*dC, nnz_frac_C);
+        est.mem = std::max(est.mem, 2*C->get_redist_mem(*dC, nnz_frac_C));
+      }
+      est.time = est.comp_time + est.comm_time + est.redist_time;
+    }
+
+    /* put back the mapping the tensors had */
+    A->clear_mapping();
+    B->clear_mapping();
+    C->clear_mapping();
+    A->topo = old_topo_A;
+    B->topo = old_topo_B;
+    C->topo = old_topo_C;
+    copy_mapping(A->order, old_map_A, A->edge_map);
+    copy_mapping(B->order, old_map_B, B->edge_map);
+    copy_mapping(C->order, old_map_C, C->edge_map);
+    A->is_mapped = 1;
+    B->is_mapped = 1;
+    C->is_mapped = 1;
+    A->set_padding();
+    B->set_padding();
+    C->set_padding();
+
+    delete [] old_map_A;
+    delete [] old_map_B;
+    delete [] old_map_C;
+    delete dA;
+    delete dB;
+    delete dC;
+    return est;
+  }
+
+  int contraction::finish_map(ctr **          ctrf,
+                              distribution *  dA,
+                              distribution *  dB,
+                              distribution *  dC,
+                              topology *      old_topo_A,
+                              topology *      old_topo_B,
+                              topology *      old_topo_C,
+                              mapping *       old_map_A,
+                              mapping *       old_map_B,
+                              mapping *       old_map_C,
+                              double          est_time){
+    int need_remap, d;
+    CommData global_comm = A->wrld->cdt;
     if (can_fold()){
       iparam prm = map_fold(false);
       *ctrf = construct_ctr(1, &prm);
@@ -3021,30 +3333,8 @@ namespace CTF_int {
     #endif
      
 #ifdef VERBOSE
-        double nnz_frac_A = 1.0;
-        double nnz_frac_B = 1.0;
-        double nnz_frac_C = 1.0;
-        int num_tot;
-        int * idx_arr; 
-        inv_idx(A->order, idx_A,
-                B->order, idx_B,
-                C->order, idx_C,
-                &num_tot, &idx_arr);
-        if (A->is_sparse) nnz_frac_A = std::min(1.,((double)A->nnz_tot)/(A->size*A->calc_npe()));
-        if (B->is_sparse) nnz_frac_B = std::min(1.,((double)B->nnz_tot)/(B->size*B->calc_npe()));
-        if (C->is_sparse){
-          nnz_frac_C = std::min(1.,((double)C->nnz_tot)/(C->size*C->calc_npe()));
-          int64_t len_ctr = 1;
-          for (int i=0; i<num_tot; i++){
-            if (idx_arr[3*i+2]==-1){
-              int edge_len = idx_arr[3*i+0] != -1 ? A->lens[idx_arr[3*i+0]] 
-                                                  : B->lens[idx_arr[3*i+1]];
-              len_ctr *= edge_len;
-            }
-          }
-          nnz_frac_C = std::min(1.,std::max(nnz_frac_C,nnz_frac_A*nnz_frac_B*len_ctr));
-        }
-        cdealloc(idx_arr);
+        double nnz_frac_A, nnz_frac_B, nnz_frac_C;
+        get_nnz_frac(nnz_frac_A, nnz_frac_B, nnz_frac_C);
         int64_t memuse = 0;
         if (is_sparse())
           memuse = MAX(((spctr*)*ctrf)->spmem_rec(nnz_frac_A,nnz_frac_B,nnz_frac_C), memuse);
@@ -3053,7 +3343,7 @@ namespace CTF_int {
 
     if (global_comm.rank == 0){
       VPRINTF(1,"Contraction will use %E bytes per processor out of %E available memory and take an estimated of %E sec\n",
-              (double)memuse,(double)proc_bytes_available(),std::min(gbest_time_sel,gbest_time_exh));
+              (double)memuse,(double)proc_bytes_available(),est_time);
 #if DEBUG >= 1
       (*ctrf)->print();
 #endif
@@ -3106,10 +3396,6 @@ namespace CTF_int {
                    
     TAU_FSTOP(redistribute_for_contraction);
     
-    CTF_int::cdealloc( old_phase_A );
-    CTF_int::cdealloc( old_phase_B );
-    CTF_int::cdealloc( old_phase_C );
-    
     delete [] old_map_A;
     delete [] old_map_B;
     delete [] old_map_C;
@@ -4160,6 +4446,10 @@ namespace CTF_int {
   #if REDIST
     //stat = map_tensors(type, fftsr, felm, alpha, beta, &ctrf);
     stat = map(&ctrf);
+    if (stat == NEGATIVE){
+      TAU_FSTOP(contract);
+      return unmasked_contract();
+    }
     if (stat == ERROR) {
       printf("Failed to map tensors to physical grid\n");
       return ERROR;
@@ -4182,6 +4472,10 @@ namespace CTF_int {
   #endif
     } 
     stat = map(&ctrf);
+    if (stat == NEGATIVE){
+      TAU_FSTOP(contract);
+      return unmasked_contract();
+    }
     if (stat == ERROR) {
       printf("Failed to map tensors to physical grid\n");
       return ERROR;
@@ -4215,6 +4509,13 @@ namespace CTF_int {
     bool is_inner = false;
   #if FOLD_TSR
     is_inner = can_fold();
+  #endif
+    if (is_masked && (!is_inner || !((spctr*)ctrf)->is_C_in_place())){
+      delete ctrf;
+      TAU_FSTOP(contract);
+      return unmasked_contract();
+    }
+  #if FOLD_TSR
     if (is_inner){
       iparam prm;
       TAU_FSTART(map_fold);
@@ -4517,6 +4818,7 @@ namespace CTF_int {
     else fptr = NULL;
 
     contraction new_ctr = contraction(tnsr_A, map_A, tnsr_B, map_B, alpha, tnsr_C, map_C, beta, fptr);
+    new_ctr.is_masked = is_masked;
     tnsr_A->unfold();
     tnsr_B->unfold();
     tnsr_C->unfold();
@@ -4685,6 +4987,13 @@ namespace CTF_int {
     return stat;
   }
 
+  int contraction::unmasked_contract(){
+    contraction new_ctr(*this);
+    new_ctr.is_masked = false;
+    new_ctr.execute();
+    return SUCCESS;
+  }
+
   int contraction::home_contract(){
   #ifndef HOME_CONTRACT
     return sym_contract();
@@ -4695,7 +5004,9 @@ namespace CTF_int {
     B->unfold();
     C->unfold();
 
-    if (C->is_sparse && (C->nnz_tot > 0 || C->has_home)){
+    // a masked contraction accumulates into the nonzeros of C itself, which then has no home buffer
+    ASSERT(!is_masked || !C->has_home);
+    if (C->is_sparse && !is_masked && (C->nnz_tot > 0 || C->has_home)){
       if (C->sr->isequal(beta,C->sr->addid())){
         C->set_zero();
       }
@@ -4748,8 +5059,6 @@ namespace CTF_int {
       return SUCCESS;
     }
 
-    CTF_int::contract_mst();
-
     //if (stype->tid_A == stype->tid_B || stype->tid_A == stype->tid_C){
     /*if (stype->tid_A == stype->tid_C){
       clone_tensor(stype->tid_A, 1, &new_tid);
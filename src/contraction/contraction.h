@@ -37,9 +37,11 @@ namespace CTF_int {
       bool is_custom;
       /** \brief function to execute on elements */
       bivar_function const * func;
+      /** \brief whether only the nonzeros already stored in the sparse output are computed, its pattern acting as a mask (see masked_contract()) */
+      bool is_masked;
 
       /** \brief lazy constructor */
-      contraction(){ idx_A = NULL; idx_B = NULL; idx_C=NULL; is_custom=0; alpha=NULL; beta=NULL; };
+      contraction(){ idx_A = NULL; idx_B = NULL; idx_C=NULL; is_custom=0; is_masked=false; alpha=NULL; beta=NULL; };
       
       /** \brief destructor */
       ~contraction();
@@ -110,6 +112,13 @@ namespace CTF_int {
       /** \brief predicts execution time in seconds using performance models */
       double estimate_time();
 
+      /**
+       * \brief searches for the mapping execute() would use and predicts its cost,
+       *        without moving data or changing the mappings of the tensors (collective)
+       * \return predicted times and memory usage, time is DBL_MAX if no mapping fits in memory
+       */
+      CTF::Cost_estimate dry_run();
+
       /**
        * \brief returns 1 if contractions have same tensors and index map
        * \param[in] os contraction object to compare this with
@@ -276,6 +285,74 @@ namespace CTF_int {
        * \return SUCCESS if valid mapping found, ERROR if not enough memory or another issue
        */
       int map(ctr ** ctrf, bool do_remap=1);
+
+      /**
+       * \brief selects the best mapping of the tensors among the topology variants and the
+       *        exhaustive search, and maps the tensors to it without redistributing data
+       * \param[in] dA distribution of A prior to mapping
+       * \param[in] dB distribution of B prior to mapping
+       * \param[in] dC distribution of C prior to mapping
+       * \param[in] old_topo_A topology of A prior to mapping
+       * \param[in] old_topo_B topology of B prior to mapping
+       * \param[in] old_topo_C topology of C prior to mapping
+       * \param[in] old_map_A mapping of A prior to mapping
+       * \param[in] old_map_B mapping of B prior to mapping
+       * \param[in] old_map_C mapping of C prior to mapping
+       * \param[out] est_time estimated execution time of the selected mapping
+       * \return SUCCESS if a valid mapping was found, ERROR otherwise (mappings are then cleared)
+       */
+      int map_best(distribution const * dA,
+                   distribution const * dB,
+                   distribution const * dC,
+                   topology *           old_topo_A,
+                   topology *           old_topo_B,
+                   topology *           old_topo_C,
+                   mapping const *      old_map_A,
+                   mapping const *      old_map_B,
+                   mapping const *      old_map_C,
+                   double &             est_time);
+
+      /**
+       * \brief predicts the cost of the mapping map() would select for this contraction,
+       *        leaves the tensors with their original mapping
+       */
+      CTF::Cost_estimate est_map_cost();
+
+      /**
+       * \brief computes the fraction of nonzeros in each (sparse) operand for the current mapping
+       * \param[out] nnz_frac_A fraction of nonzeros in A (1 if dense)
+       * \param[out] nnz_frac_B fraction of nonzeros in B (1 if dense)
+       * \param[out] nnz_frac_C predicted fraction of nonzeros in C (1 if dense)
+       */
+      void get_nnz_frac(double & nnz_frac_A, double & nnz_frac_B, double & nnz_frac_C);
+
+      /**
+       * \brief constructs the contraction for the mapping selected by map() and redistributes tensors to it,
+       *        deallocates the saved distributions and mappings
+       * \param[out] ctrf contraction class to run
+       * \param[in] dA distribution of A prior to mapping
+       * \param[in] dB distribution of B prior to mapping
+       * \param[in] dC distribution of C prior to mapping
+       * \param[in] old_topo_A topology of A prior to mapping
+       * \param[in] old_topo_B topology of B prior to mapping
+       * \param[in] old_topo_C topology of C prior to mapping
+       * \param[in] old_map_A mapping of A prior to mapping
+       * \param[in] old_map_B mapping of B prior to mapping
+       * \param[in] old_map_C mapping of C prior to mapping
+       * \param[in] est_time estimated execution time of the selected mapping
+       * \return SUCCESS
+       */
+      int finish_map(ctr **         ctrf,
+                     distribution * dA,
+                     distribution * dB,
+                     distribution * dC,
+                     topology *     old_topo_A,
+                     topology *     old_topo_B,
+                     topology *     old_topo_C,
+                     mapping *      old_map_A,
+                     mapping *      old_map_B,
+                     mapping *      old_map_C,
+                     double         est_time);
  
       /**
         * \brief contracts tensors alpha*A*B+beta*C -> C.
@@ -311,6 +388,13 @@ namespace CTF_int {
        */
       int contract();
 
+      /**
+       * \brief contracts tensors alpha*A*B+beta*C -> C as if the contraction were not masked, forming the full product,
+       *        used when no mapping passes the blocks of C to the sequential kernel in place
+       * \return completion status
+       */
+      int unmasked_contract();
+
       /**
        * \brief contracts tensors alpha*A*B+beta*C -> C performs all symmetric permutations
        * \return completion status
@@ -5,8 +5,13 @@
 #include "../mapping/mapping.h"
 #include "../shared/util.h"
 #include "../shared/offload.h"
+#include "../shared/memcontrol.h"
 #include <climits>
 
+namespace CTF {
+  int SUMMA_MAX_LOOKAHEAD = 1;
+}
+
 namespace CTF_int {
 
   int  ctr_2d_gen_build(int                        is_used,
@@ -254,6 +259,10 @@ namespace CTF_int {
     return rec_ctr->est_time_rec(1)*(double)edge_len/MIN(nlyr,edge_len) + est_time_fp(nlyr);
   }
 
+  double ctr_2d_general::est_comm_time_rec(int nlyr) {
+    return rec_ctr->est_comm_time_rec(1)*(double)edge_len/MIN(nlyr,edge_len) + est_time_fp(nlyr);
+  }
+
   int64_t ctr_2d_general::mem_fp() {
     int64_t b_A, b_B, b_C, s_A, s_B, s_C, aux_size;
     find_bsizes(b_A, b_B, b_C, s_A, s_B, s_C, aux_size);
@@ -264,11 +273,81 @@ namespace CTF_int {
     return rec_ctr->mem_rec() + mem_fp();
   }
 
+  int ctr_2d_general::get_lookahead(int64_t nstep, int64_t s_A, int64_t s_B){
+    if (!(move_A || move_B) || nstep <= 1 || CTF::SUMMA_MAX_LOOKAHEAD <= 0) return 0;
+#ifdef OFFLOAD
+    if (alloc_host_buf) return 0;
+#endif
+    int64_t panel_sz = move_A*s_A*sr_A->el_size + move_B*s_B*sr_B->el_size;
+    int depth = (int)std::min((int64_t)CTF::SUMMA_MAX_LOOKAHEAD, nstep-1);
+    // keep half of available memory for the recursive contraction
+    int64_t mem_avail = proc_bytes_available()/2;
+    while (depth > 0 && depth*panel_sz > mem_avail) depth--;
+    /* All processes that share a communicator on which panels are broadcast must
+       post the broadcasts in the same order relative to other collectives, so the
+       depth is agreed upon over the 1D/2D grid spanned by cdt_A and cdt_B */
+    int ncdt = 0;
+    CommData * cdts[3];
+    if (move_A) cdts[ncdt++] = cdt_A;
+    if (move_B) cdts[ncdt++] = cdt_B;
+    if (ncdt == 2) cdts[ncdt++] = cdt_A;
+    for (int i=0; i<ncdt; i++){
+      if (cdts[i]->np > 1)
+        MPI_Allreduce(MPI_IN_PLACE, &depth, 1, MPI_INT, MPI_MIN, cdts[i]->cm);
+    }
+    return depth;
+  }
+
+  void ctr_2d_general::post_panels(int64_t       ib,
+                                   char *        A,
+                                   char *        B,
+                                   char *        buf_A,
+                                   char *        buf_B,
+                                   char *&       op_A,
+                                   char *&       op_B,
+                                   MPI_Request * reqs){
+    int owner_A, owner_B;
+    int64_t b_A, b_B, b_C, s_A, s_B, s_C, aux_size;
+    find_bsizes(b_A, b_B, b_C, s_A, s_B, s_C, aux_size);
+    reqs[0] = MPI_REQUEST_NULL;
+    reqs[1] = MPI_REQUEST_NULL;
+    if (move_A){
+      owner_A   = ib % cdt_A->np;
+      if (cdt_A->rank == owner_A){
+        if (b_A == 1){
+          op_A = A;
+        } else {
+          op_A = buf_A;
+          sr_A->copy(ctr_sub_lda_A, ctr_lda_A, 
+                     A+sr_A->el_size*(ib/cdt_A->np)*ctr_sub_lda_A, ctr_sub_lda_A*b_A, 
+                     op_A, ctr_sub_lda_A);
+        }
+      } else
+        op_A = buf_A;
+      cdt_A->ibcast(op_A, s_A, sr_A->mdtype(), owner_A, reqs);
+    }
+    if (move_B){
+      owner_B   = ib % cdt_B->np;
+      if (cdt_B->rank == owner_B){
+        if (b_B == 1){
+          op_B = B;
+        } else {
+          op_B = buf_B;
+          sr_B->copy(ctr_sub_lda_B, ctr_lda_B,
+                     B+sr_B->el_size*(ib/cdt_B->np)*ctr_sub_lda_B, ctr_sub_lda_B*b_B, 
+                     op_B, ctr_sub_lda_B);
+        }
+      } else 
+        op_B = buf_B;
+      cdt_B->ibcast(op_B, s_B, sr_B->mdtype(), owner_B, reqs+1);
+    }
+  }
+
   void ctr_2d_general::run(char * A, char * B, char * C){
     int owner_A, owner_B, owner_C, ret;
     int64_t ib;
     char * buf_A, * buf_B, * buf_C; 
-    char * op_A, * op_B, * op_C; 
+    char * op_A = NULL, * op_B = NULL, * op_C = NULL;
     int rank_A, rank_B, rank_C;
     int64_t b_A, b_B, b_C, s_A, s_B, s_C, aux_size;
     if (move_A) rank_A = cdt_A->rank;
@@ -327,14 +406,59 @@ namespace CTF_int {
     //ret = CTF_int::mst_alloc_ptr(aux_size, (void**)&buf_aux);
     //ASSERT(ret==0);
 
+    int64_t nstep = 0;
     //for (ib=this->idx_lyr; ib<edge_len; ib+=this->num_lyr){
 #ifdef MICROBENCH
-    for (ib=iidx_lyr; ib<edge_len; ib+=edge_len)
+    for (ib=iidx_lyr; ib<edge_len; ib+=edge_len) nstep++;
 #else
-    for (ib=iidx_lyr; ib<edge_len; ib+=inum_lyr)
+    for (ib=iidx_lyr; ib<edge_len; ib+=inum_lyr) nstep++;
 #endif
+
+    /* With lookahead, the panels of A and B for step is+depth are broadcast into 
+       one of depth+1 buffers while the panels of step is are being contracted */
+    int depth = get_lookahead(nstep, s_A, s_B);
+    char ** pbuf_A = NULL, ** pbuf_B = NULL, ** pop_A = NULL, ** pop_B = NULL;
+    MPI_Request * reqs = NULL;
+    if (depth > 0){
+      CTF_int::alloc_ptr(sizeof(char*)*(depth+1), (void**)&pbuf_A);
+      CTF_int::alloc_ptr(sizeof(char*)*(depth+1), (void**)&pbuf_B);
+      CTF_int::alloc_ptr(sizeof(char*)*(depth+1), (void**)&pop_A);
+      CTF_int::alloc_ptr(sizeof(char*)*(depth+1), (void**)&pop_B);
+      CTF_int::alloc_ptr(sizeof(MPI_Request)*2*(depth+1), (void**)&reqs);
+      pbuf_A[0] = buf_A;
+      pbuf_B[0] = buf_B;
+      for (int i=1; i<=depth; i++){
+        pbuf_A[i] = NULL;
+        pbuf_B[i] = NULL;
+        if (move_A) CTF_int::mst_alloc_ptr(s_A*sr_A->el_size, (void**)&pbuf_A[i]);
+        if (move_B) CTF_int::mst_alloc_ptr(s_B*sr_B->el_size, (void**)&pbuf_B[i]);
+      }
+      for (int64_t is=0; is<depth; is++){
+        post_panels(iidx_lyr+is*inum_lyr, A, B, pbuf_A[is], pbuf_B[is], pop_A[is], pop_B[is], reqs+2*is);
+      }
+    }
+
+    for (int64_t is=0; is<nstep; is++)
     {
-      if (move_A){
+      ib = iidx_lyr+is*inum_lyr;
+      if (depth > 0){
+        if (is+depth < nstep){
+          int jb = (is+depth)%(depth+1);
+          post_panels(ib+depth*inum_lyr, A, B, pbuf_A[jb], pbuf_B[jb], pop_A[jb], pop_B[jb], reqs+2*jb);
+        }
+        int kb = is%(depth+1);
+        TAU_FSTART(ctr_2d_general_wait);
+        MPI_Waitall(2, reqs+2*kb, MPI_STATUSES_IGNORE);
+        TAU_FSTOP(ctr_2d_general_wait);
+        if (move_A){
+          op_A  = pop_A[kb];
+          buf_A = pbuf_A[kb];
+        }
+        if (move_B){
+          op_B  = pop_B[kb];
+          buf_B = pbuf_B[kb];
+        }
+      } else if (move_A){
         owner_A   = ib % cdt_A->np;
         if (rank_A == owner_A){
           if (b_A == 1){
@@ -348,7 +472,8 @@ namespace CTF_int {
         } else
           op_A = buf_A;
         cdt_A->bcast(op_A, s_A, sr_A->mdtype(), owner_A);
-      } else {
+      }
+      if (!move_A){
         if (ctr_sub_lda_A == 0)
           op_A = A;
         else {
@@ -362,7 +487,7 @@ namespace CTF_int {
           }      
         }
       }
-      if (move_B){
+      if (depth == 0 && move_B){
         owner_B   = ib % cdt_B->np;
         if (rank_B == owner_B){
           if (b_B == 1){
@@ -377,7 +502,8 @@ namespace CTF_int {
           op_B = buf_B;
 //        printf("c_B = %ld, s_B = %ld, d_B = %ld, b_B = %ld\n", c_B, s_B,db, b_B);
         cdt_B->bcast(op_B, s_B, sr_B->mdtype(), owner_B);
-      } else {
+      }
+      if (!move_B){
         if (ctr_sub_lda_B == 0)
           op_B = B;
         else {
@@ -443,6 +569,19 @@ namespace CTF_int {
         printf("[%d] P%d C[%d]  = %lf\n",ctr_lda_C,idx_lyr,i, ((double*)C)[i]);
       }*/
     }
+    if (depth > 0){
+      buf_A = pbuf_A[0];
+      buf_B = pbuf_B[0];
+      for (int i=1; i<=depth; i++){
+        if (move_A) CTF_int::cdealloc(pbuf_A[i]);
+        if (move_B) CTF_int::cdealloc(pbuf_B[i]);
+      }
+      CTF_int::cdealloc(pbuf_A);
+      CTF_int::cdealloc(pbuf_B);
+      CTF_int::cdealloc(pop_A);
+      CTF_int::cdealloc(pop_B);
+      CTF_int::cdealloc(reqs);
+    }
     /* FIXME: reuse that */
 #ifdef OFFLOAD
     if (alloc_host_buf){
@@ -102,6 +102,11 @@ namespace CTF_int{
        * \return bytes needed for recursive contraction
        */
       double est_time_rec(int nlyr);
+      /**
+       * \brief returns the part of est_time_rec spent in broadcasts and reductions
+       * \return seconds needed for communication in recursive contraction
+       */
+      double est_comm_time_rec(int nlyr);
       ctr * clone();
 
       /**
@@ -122,6 +127,34 @@ namespace CTF_int{
                        int64_t & s_B,
                        int64_t & s_C,
                        int64_t & aux_size);
+      /**
+       * \brief determines how many panels ahead of the current one to broadcast,
+       *        limited by CTF::SUMMA_MAX_LOOKAHEAD and the available memory
+       * \param[in] nstep number of panels contracted by this process
+       * \param[in] s_A size of panel of A
+       * \param[in] s_B size of panel of B
+       * \return lookahead depth, 0 if broadcasts should be blocking
+       */
+      int get_lookahead(int64_t nstep, int64_t s_A, int64_t s_B);
+      /**
+       * \brief packs panel ib of A and B (if they are moved) and posts their non-blocking broadcasts
+       * \param[in] ib index of panel
+       * \param[in] A local data of A
+       * \param[in] B local data of B
+       * \param[in] buf_A buffer in which to receive panel of A
+       * \param[in] buf_B buffer in which to receive panel of B
+       * \param[out] op_A pointer to panel of A, valid once reqs[0] completes
+       * \param[out] op_B pointer to panel of B, valid once reqs[1] completes
+       * \param[out] reqs requests for broadcasts of A and B
+       */
+      void post_panels(int64_t       ib,
+                       char *        A,
+                       char *        B,
+                       char *        buf_A,
+                       char *        buf_B,
+                       char *&       op_A,
+                       char *&       op_B,
+                       MPI_Request * reqs);
       /**
        * \brief copies ctr object
        */
@@ -162,6 +162,13 @@ namespace CTF_int{
       virtual int64_t mem_rec() { return mem_fp(); };
       virtual double est_time_fp(int nlyr) { return 0; };
       virtual double est_time_rec(int nlyr) { return est_time_fp(nlyr); };
+      /**
+       * \brief returns the part of est_time_rec spent communicating (or moving data to a device),
+       *        zero for kernels that only do local work
+       * \param[in] nlyr amount of replication
+       * \return time in sec
+       */
+      virtual double est_comm_time_rec(int nlyr) { return 0.0; };
       virtual ctr * clone() { return NULL; };
       
       /**
@@ -217,6 +224,7 @@ namespace CTF_int{
        * \return time in sec
        */
       double est_time_rec(int nlyr);
+      double est_comm_time_rec(int nlyr);
       void print();
       ctr * clone();
 
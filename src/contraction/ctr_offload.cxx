@@ -74,6 +74,10 @@ namespace CTF_int {
     return rec_ctr->est_time_rec(nlyr) + est_time_fp(nlyr);
   }
 
+  double ctr_offload::est_comm_time_rec(int nlyr) {
+    return rec_ctr->est_comm_time_rec(nlyr) + est_time_fp(nlyr);
+  }
+
   int64_t ctr_offload::mem_fp(){
     return size_C*sr_C->el_size;
   }
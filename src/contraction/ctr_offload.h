@@ -60,6 +60,12 @@ namespace CTF_int {
        */
       double est_time_rec(int nlyr);
 
+      /**
+       * \brief returns the time spent moving data to and from the device, including calls to rec_ctr
+       * \return seconds needed for data movement in recursive contraction
+       */
+      double est_comm_time_rec(int nlyr);
+
       /**
        * \brief copies ctr object
        */
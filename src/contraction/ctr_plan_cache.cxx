@@ -0,0 +1,218 @@
+/*Copyright (c) 2011, Edgar Solomonik, all rights reserved.*/
+
+#include "ctr_plan_cache.h"
+#include "../tensor/untyped_tensor.h"
+#include "../mapping/mapping.h"
+#include "../shared/util.h"
+
+namespace CTF {
+  int CTR_PLAN_CACHE_SIZE = 1024;
+
+  Plan_cache_stats get_ctr_plan_cache_stats(){
+    CTF_int::ctr_plan_cache & pc = CTF_int::get_ctr_plan_cache();
+    Plan_cache_stats st;
+    st.hits      = pc.nhits;
+    st.misses    = pc.nmisses;
+    st.evictions = pc.nevictions;
+    st.size      = pc.size();
+    return st;
+  }
+
+  void clear_ctr_plan_cache(){
+    CTF_int::get_ctr_plan_cache().clear();
+  }
+}
+
+namespace CTF_int {
+  using namespace CTF;
+
+  ctr_plan_cache & get_ctr_plan_cache(){
+    // leaked on purpose, Worlds destroyed at exit may clear their plans after static objects are gone
+    static ctr_plan_cache * cache = new ctr_plan_cache();
+    return *cache;
+  }
+
+  ctr_plan::ctr_plan(tensor const * A,
+                     tensor const * B,
+                     tensor const * C,
+                     int            topo_idx_,
+                     double         est_time_){
+    topo_idx   = topo_idx_;
+    topo_order = A->topo->order;
+    order_A    = A->order;
+    order_B    = B->order;
+    order_C    = C->order;
+    map_A      = new mapping[order_A];
+    map_B      = new mapping[order_B];
+    map_C      = new mapping[order_C];
+    copy_mapping(order_A, A->edge_map, map_A);
+    copy_mapping(order_B, B->edge_map, map_B);
+    copy_mapping(order_C, C->edge_map, map_C);
+    est_time   = est_time_;
+    last_use   = 0;
+  }
+
+  ctr_plan::~ctr_plan(){
+    delete [] map_A;
+    delete [] map_B;
+    delete [] map_C;
+  }
+
+  /**
+   * \brief appends a (possibly recursive) dimension mapping to a signature
+   */
+  static void append_map_sig(mapping const * map, std::vector<int64_t> & sig){
+    while (map != NULL && map->type != NOT_MAPPED){
+      sig.push_back(map->type);
+      sig.push_back(map->np);
+      // cdt is only meaningful (and only initialized) for physical mappings
+      if (map->type == PHYSICAL_MAP)
+        sig.push_back(map->cdt);
+      if (map->has_child) map = map->child;
+      else map = NULL;
+    }
+    sig.push_back(-1);
+  }
+
+  /**
+   * \brief appends everything about a tensor and its current distribution that affects mapping selection
+   * \return false if the tensor is mapped to a topology not in its World's topovec
+   */
+  static bool append_tsr_sig(tensor const * T, int const * idx, std::vector<int64_t> & sig){
+    sig.push_back(T->order);
+    sig.push_back(T->sr->el_size);
+    sig.push_back(T->is_sparse);
+    if (T->is_sparse){
+      sig.push_back(T->is_csr);
+      // coarsen nonzero count so that sparse tensors whose fill changes slowly still hit
+      int64_t lg_nnz = 0;
+      while (((int64_t)1 << lg_nnz) <= T->nnz_tot) lg_nnz++;
+      sig.push_back(lg_nnz);
+      // likewise for the most loaded process, which the cost model is based on
+      int64_t lg_nnz_max = 0;
+      while (((int64_t)1 << lg_nnz_max) <= T->nnz_loc_max) lg_nnz_max++;
+      sig.push_back(lg_nnz_max);
+    }
+    for (int i=0; i<T->order; i++){
+      sig.push_back(T->lens[i]);
+      sig.push_back(T->sym[i]);
+      sig.push_back(idx[i]);
+    }
+    int topo_idx = -1;
+    if (T->topo != NULL){
+      for (int i=0; i<(int)T->wrld->topovec.size(); i++){
+        if (T->wrld->topovec[i] == T->topo) topo_idx = i;
+      }
+      if (topo_idx == -1) return false;
+    }
+    sig.push_back(topo_idx);
+    if (topo_idx != -1){
+      for (int i=0; i<T->order; i++){
+        append_map_sig(T->edge_map+i, sig);
+      }
+    }
+    return true;
+  }
+
+  bool ctr_plan_cache::get_signature(tensor const *         A,
+                                     int const *            idx_A,
+                                     tensor const *         B,
+                                     int const *            idx_B,
+                                     tensor const *         C,
+                                     int const *            idx_C,
+                                     std::vector<int64_t> & sig){
+    if (CTF::CTR_PLAN_CACHE_SIZE <= 0) return false;
+    sig.clear();
+    // plans are kept per World, the topologies are recorded so that a plan is not used with a different topovec
+    World const * wrld = A->wrld;
+    sig.push_back(wrld->np);
+    sig.push_back(wrld->cdt.node_size);
+    sig.push_back(wrld->topovec.size());
+    if (wrld->phys_topology != NULL){
+      for (int i=0; i<wrld->phys_topology->order; i++){
+        sig.push_back(wrld->phys_topology->lens[i]);
+      }
+    }
+    sig.push_back(-1);
+    if (!append_tsr_sig(A, idx_A, sig)) return false;
+    if (!append_tsr_sig(B, idx_B, sig)) return false;
+    if (!append_tsr_sig(C, idx_C, sig)) return false;
+    return true;
+  }
+
+  ctr_plan_cache::ctr_plan_cache(){
+    nhits      = 0;
+    nmisses    = 0;
+    nevictions = 0;
+  }
+
+  ctr_plan_cache::~ctr_plan_cache(){
+    clear();
+  }
+
+  int64_t ctr_plan_cache::size() const {
+    int64_t n = 0;
+    std::map< World const *, world_plans >::const_iterator it;
+    for (it=worlds.begin(); it!=worlds.end(); it++){
+      n += it->second.plans.size();
+    }
+    return n;
+  }
+
+  ctr_plan const * ctr_plan_cache::lookup(World const * wrld, std::vector<int64_t> const & sig){
+    world_plans & wp = worlds[wrld];
+    wp.ncalls++;
+    std::map< std::vector<int64_t>, ctr_plan* >::iterator it = wp.plans.find(sig);
+    if (it == wp.plans.end()){
+      nmisses++;
+      return NULL;
+    }
+    nhits++;
+    it->second->last_use = wp.ncalls;
+    return it->second;
+  }
+
+  void ctr_plan_cache::insert(World const * wrld, std::vector<int64_t> const & sig, ctr_plan * plan){
+    world_plans & wp = worlds[wrld];
+    std::map< std::vector<int64_t>, ctr_plan* >::iterator it = wp.plans.find(sig);
+    if (it != wp.plans.end()){
+      delete it->second;
+      wp.plans.erase(it);
+    }
+    // eviction depends only on the sequence of lookups on this World, so it is identical on all of its processes
+    while ((int64_t)wp.plans.size() >= CTF::CTR_PLAN_CACHE_SIZE && wp.plans.size() > 0){
+      std::map< std::vector<int64_t>, ctr_plan* >::iterator lru = wp.plans.begin();
+      for (it=wp.plans.begin(); it!=wp.plans.end(); it++){
+        if (it->second->last_use < lru->second->last_use) lru = it;
+      }
+      delete lru->second;
+      wp.plans.erase(lru);
+      nevictions++;
+    }
+    plan->last_use = wp.ncalls;
+    wp.plans[sig] = plan;
+  }
+
+  void ctr_plan_cache::remove(World const * wrld, std::vector<int64_t> const & sig){
+    std::map< World const *, world_plans >::iterator wit = worlds.find(wrld);
+    if (wit == worlds.end()) return;
+    std::map< std::vector<int64_t>, ctr_plan* >::iterator it = wit->second.plans.find(sig);
+    if (it != wit->second.plans.end()){
+      delete it->second;
+      wit->second.plans.erase(it);
+    }
+  }
+
+  void ctr_plan_cache::clear(World const * wrld){
+    std::map< World const *, world_plans >::iterator wit = worlds.begin();
+    while (wit != worlds.end()){
+      if (wrld == NULL || wit->first == wrld){
+        std::map< std::vector<int64_t>, ctr_plan* >::iterator it;
+        for (it=wit->second.plans.begin(); it!=wit->second.plans.end(); it++){
+          delete it->second;
+        }
+        worlds.erase(wit++);
+      } else wit++;
+    }
+  }
+}
@@ -0,0 +1,138 @@
+/*Copyright (c) 2011, Edgar Solomonik, all rights reserved.*/
+
+#ifndef __CTR_PLAN_CACHE_H__
+#define __CTR_PLAN_CACHE_H__
+
+#include "../interface/common.h"
+#include <map>
+
+namespace CTF {
+  class World;
+}
+
+namespace CTF_int {
+  class tensor;
+  class topology;
+  class mapping;
+
+  /**
+   * \brief mapping selected by contraction::map for a given contraction signature
+   */
+  class ctr_plan {
+    public:
+      /** \brief index of the selected topology in World::topovec */
+      int topo_idx;
+      /** \brief order of the selected topology (used to validate topo_idx) */
+      int topo_order;
+      int order_A;
+      int order_B;
+      int order_C;
+      /** \brief selected edge mappings of A, B, and C */
+      mapping * map_A;
+      mapping * map_B;
+      mapping * map_C;
+      /** \brief estimated execution time of the selected mapping */
+      double est_time;
+      /** \brief last cache access, used for LRU eviction */
+      int64_t last_use;
+
+      /**
+       * \brief records the current mapping of A, B, and C
+       * \param[in] A left operand (mapped)
+       * \param[in] B right operand (mapped)
+       * \param[in] C output (mapped)
+       * \param[in] topo_idx index of the topology of A, B, C in World::topovec
+       * \param[in] est_time estimated execution time of the plan
+       */
+      ctr_plan(tensor const * A,
+               tensor const * B,
+               tensor const * C,
+               int            topo_idx,
+               double         est_time);
+
+      ~ctr_plan();
+  };
+
+  /**
+   * \brief cache of contraction mappings keyed by contraction signature
+   *        (index maps, lengths, symmetries, sparsity, and input distributions),
+   *        plans and the CTF::CTR_PLAN_CACHE_SIZE budget are kept separately for each World,
+   *        every process of a World makes the same sequence of lookups and insertions on it,
+   *        so hits, misses, and evictions are consistent across the World even when
+   *        its processes also contract tensors on different subworlds
+   */
+  class ctr_plan_cache {
+    public:
+      /**
+       * \brief computes the signature of a contraction with respect to the current mapping of its operands
+       * \param[in] A left operand
+       * \param[in] idx_A indices of left operand
+       * \param[in] B right operand
+       * \param[in] idx_B indices of right operand
+       * \param[in] C output
+       * \param[in] idx_C indices of output
+       * \param[out] sig signature
+       * \return false if the contraction should not be cached
+       */
+      static bool get_signature(tensor const *          A,
+                                int const *             idx_A,
+                                tensor const *          B,
+                                int const *             idx_B,
+                                tensor const *          C,
+                                int const *             idx_C,
+                                std::vector<int64_t> & sig);
+
+      /**
+       * \brief look up plan, updates hit/miss statistics
+       * \param[in] wrld World the contraction is done on
+       * \param[in] sig signature computed via get_signature
+       * \return plan or NULL if not cached
+       */
+      ctr_plan const * lookup(CTF::World const * wrld, std::vector<int64_t> const & sig);
+
+      /**
+       * \brief inserts plan (taking ownership), evicting the least recently used plan of wrld if it has
+       *        CTF::CTR_PLAN_CACHE_SIZE of them
+       * \param[in] wrld World the contraction is done on
+       * \param[in] sig signature computed via get_signature
+       * \param[in] plan plan to insert
+       */
+      void insert(CTF::World const * wrld, std::vector<int64_t> const & sig, ctr_plan * plan);
+
+      /**
+       * \brief removes plan, e.g. if it was found to be invalid
+       * \param[in] wrld World the contraction is done on
+       * \param[in] sig signature computed via get_signature
+       */
+      void remove(CTF::World const * wrld, std::vector<int64_t> const & sig);
+
+      /**
+       * \brief removes plans, statistics are kept
+       * \param[in] wrld if not NULL, only those of this World
+       */
+      void clear(CTF::World const * wrld=NULL);
+
+      /** \brief number of cached plans */
+      int64_t size() const;
+
+      ctr_plan_cache();
+      ~ctr_plan_cache();
+
+      int64_t nhits;
+      int64_t nmisses;
+      int64_t nevictions;
+    private:
+      /** \brief plans of one World and the count of lookups made on it */
+      struct world_plans {
+        int64_t ncalls;
+        std::map< std::vector<int64_t>, ctr_plan* > plans;
+        world_plans() : ncalls(0) {}
+      };
+      std::map< CTF::World const *, world_plans > worlds;
+  };
+
+  /** \brief returns the contraction plan cache of this process */
+  ctr_plan_cache & get_ctr_plan_cache();
+}
+
+#endif
@@ -88,6 +88,14 @@ namespace CTF_int {
     return nvirt*rec_ctr->est_time_rec(nlyr);
   }
 
+  double ctr_virt::est_comm_time_rec(int nlyr) {
+    int64_t nvirt = 1;
+    for (int dim=0; dim<num_dim; dim++){
+      nvirt *= virt_dim[dim];
+    }
+    return nvirt*rec_ctr->est_comm_time_rec(nlyr);
+  }
+
 
   int64_t ctr_virt::mem_fp(){
     return (order_A+order_B+order_C+(3+VIRT_NTD)*num_dim)*sizeof(int);
@@ -31,6 +31,7 @@ namespace CTF_int {
       int64_t mem_rec();
 
       double est_time_rec(int nlyr);
+      double est_comm_time_rec(int nlyr);
       ctr * clone();
     
       /**
@@ -0,0 +1,190 @@
+#include "masked_ctr.h"
+#include "contraction.h"
+#include "../summation/summation.h"
+#include "../shared/util.h"
+
+namespace CTF_int {
+  /** \brief position of index label c among the n labels idx, or -1 */
+  static int find_idx(int n, char const * idx, char c){
+    for (int i=0; i<n; i++){
+      if (idx[i] == c) return i;
+    }
+    return -1;
+  }
+
+  /** \brief whether all modes of A are nonsymmetric */
+  static bool is_nonsym(tensor const * A){
+    for (int i=0; i<A->order; i++){
+      if (A->sym[i] != NS) return false;
+    }
+    return true;
+  }
+
+  /** \brief new empty sparse tensor shaped like C, without a home buffer (so that it may be contracted into in place) */
+  static tensor * new_sparse_like(tensor const * C){
+    tensor * P = new tensor(C->sr, C->order, C->lens, C->sym, C->wrld, true, "masked_P", 0, true);
+    P->has_home = 0;
+    P->is_home = 0;
+    return P;
+  }
+
+  /**
+   * \brief reads the values of X at the keys of the npair local pairs of the mask and writes them into a new sparse
+   *        tensor with the pattern of X
+   */
+  static tensor * gather_mask(tensor * X, int64_t npair, char const * mask_pairs){
+    algstrct const * sr = X->sr;
+    char * pairs = (char*)alloc(std::max(npair, (int64_t)1)*sr->pair_size());
+    memcpy(pairs, mask_pairs, npair*sr->pair_size());
+    X->read(npair, pairs);
+    tensor * P = new_sparse_like(X);
+    P->write(npair, sr->mulid(), sr->addid(), pairs);
+    cdealloc(pairs);
+    return P;
+  }
+
+  /**
+   * \brief checks that M may mask C and returns the keys of the local nonzeros of M relabeled to the index order of C,
+   *        as pairs with zero values, or NULL (after printing an error) if M is not a valid mask of C
+   * \param[in] C output tensor
+   * \param[in] idx_C indices of C
+   * \param[in] M mask tensor
+   * \param[in] idx_M indices of M
+   * \param[out] nmask number of local nonzeros of M
+   */
+  static char * get_mask_pairs(tensor *     C,
+                               char const * idx_C,
+                               tensor *     M,
+                               char const * idx_M,
+                               int64_t &    nmask){
+    algstrct const * sr = C->sr;
+    int order = C->order;
+    int64_t psz = sr->pair_size();
+
+    // perm[i] is the mode of M indexed by the label of mode i of C
+    int perm[order];
+    bool valid = M->is_sparse && M->order == order && is_nonsym(M) && is_nonsym(C) && sr->addid() != NULL && sr->mulid() != NULL;
+    for (int i=0; valid && i<order; i++){
+      perm[i] = find_idx(order, idx_M, idx_C[i]);
+      valid = perm[i] != -1 && find_idx(i, idx_C, idx_C[i]) == -1 && M->lens[perm[i]] == C->lens[i];
+    }
+    if (!valid){
+      if (C->wrld->rank == 0)
+        printf("CTF ERROR: the mask of a masked contraction must be a sparse nonsymmetric tensor indexed by a permutation of the distinct indices of the nonsymmetric output, with the same lengths\n");
+      IASSERT(0);
+      return NULL;
+    }
+
+    char * M_pairs;
+    M->read_local_nnz(&nmask, &M_pairs);
+    int64_t lda_M[order], lda_C[order];
+    for (int i=0; i<order; i++){
+      lda_M[i] = i == 0 ? 1 : lda_M[i-1]*M->lens[i-1];
+      lda_C[i] = i == 0 ? 1 : lda_C[i-1]*C->lens[i-1];
+    }
+    char * mask_pairs = (char*)alloc(std::max(nmask, (int64_t)1)*psz);
+#ifdef USE_OMP
+    #pragma omp parallel for
+#endif
+    for (int64_t p=0; p<nmask; p++){
+      int64_t k = ConstPairIterator(M->sr, M_pairs+p*M->sr->pair_size()).k();
+      int64_t kC = 0;
+      for (int i=0; i<order; i++){
+        kC += ((k/lda_M[perm[i]])%M->lens[perm[i]])*lda_C[i];
+      }
+      sr->set_pair(mask_pairs+p*psz, kC, sr->addid());
+    }
+    if (M_pairs != NULL) cdealloc(M_pairs);
+    return mask_pairs;
+  }
+
+  void masked_contract(tensor *     A,
+                       char const * idx_A,
+                       tensor *     B,
+                       char const * idx_B,
+                       char const * alpha,
+                       tensor *     C,
+                       char const * idx_C,
+                       char const * beta,
+                       tensor *     M,
+                       char const * idx_M){
+    TAU_FSTART(masked_contract);
+    algstrct const * sr = C->sr;
+    int order = C->order;
+
+    // the pattern of the local nonzeros of M, relabeled to the index order of C and with zero values
+    int64_t nmask;
+    char * mask_pairs = get_mask_pairs(C, idx_C, M, idx_M, nmask);
+    if (mask_pairs == NULL){
+      TAU_FSTOP(masked_contract);
+      return;
+    }
+
+    tensor * P;
+    if (M->nnz_tot == 0){
+      P = new_sparse_like(C);
+    } else if (A->is_sparse && B->is_sparse && is_nonsym(A) && is_nonsym(B) &&
+               A->sr->el_size == sr->el_size && B->sr->el_size == sr->el_size){
+      P = new_sparse_like(C);
+      P->write(nmask, sr->mulid(), sr->addid(), mask_pairs);
+      int64_t nnz_mask = P->nnz_tot;
+      contraction ctr(A, idx_A, B, idx_B, alpha, P, idx_C, sr->mulid());
+      ctr.is_masked = true;
+      ctr.execute();
+      // the contraction could not be restricted to the pattern of P and computed the full product
+      if (P->nnz_tot > nnz_mask){
+        tensor * Q = gather_mask(P, nmask, mask_pairs);
+        delete P;
+        P = Q;
+      }
+    } else {
+      tensor * F = new tensor(sr, order, C->lens, C->sym, C->wrld, true, "masked_F", 0, A->is_sparse && B->is_sparse);
+      contraction ctr(A, idx_A, B, idx_B, alpha, F, idx_C, sr->addid());
+      ctr.execute();
+      P = gather_mask(F, nmask, mask_pairs);
+      delete F;
+    }
+    cdealloc(mask_pairs);
+
+    P->sparsify();
+    summation sum(P, idx_C, sr->mulid(), C, idx_C, beta);
+    sum.execute();
+    delete P;
+    TAU_FSTOP(masked_contract);
+  }
+
+  void masked_sum(tensor *     A,
+                  char const * idx_A,
+                  char const * alpha,
+                  tensor *     C,
+                  char const * idx_C,
+                  char const * beta,
+                  tensor *     M,
+                  char const * idx_M){
+    TAU_FSTART(masked_sum);
+    algstrct const * sr = C->sr;
+    int64_t nmask;
+    char * mask_pairs = get_mask_pairs(C, idx_C, M, idx_M, nmask);
+    if (mask_pairs == NULL){
+      TAU_FSTOP(masked_sum);
+      return;
+    }
+    tensor * P;
+    if (M->nnz_tot == 0){
+      P = new_sparse_like(C);
+    } else {
+      tensor * F = new tensor(sr, C->order, C->lens, C->sym, C->wrld, true, "masked_F", 0, A->is_sparse);
+      summation sum(A, idx_A, alpha, F, idx_C, sr->addid());
+      sum.execute();
+      P = gather_mask(F, nmask, mask_pairs);
+      delete F;
+    }
+    cdealloc(mask_pairs);
+
+    P->sparsify();
+    summation sum(P, idx_C, sr->mulid(), C, idx_C, beta);
+    sum.execute();
+    delete P;
+    TAU_FSTOP(masked_sum);
+  }
+}
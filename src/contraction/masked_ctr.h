@@ -0,0 +1,55 @@
+#ifndef __MASKED_CTR_H__
+#define __MASKED_CTR_H__
+
+#include "../tensor/untyped_tensor.h"
+
+namespace CTF_int {
+  /**
+   * \brief computes C = beta*C + alpha*A*B restricted to the nonzeros of the sparse mask M, i.e. only the entries of the
+   *        product whose indices are stored in M are computed and accumulated into C (the values of M are ignored);
+   *        when A and B are sparse, the mask is carried as the explicit pattern of the output of a contraction that
+   *        accumulates only into the entries it already stores, so the other entries of the product are never formed
+   * \param[in] A left operand tensor
+   * \param[in] idx_A indices of left operand
+   * \param[in] B right operand tensor
+   * \param[in] idx_B indices of right operand
+   * \param[in] alpha scaling factor of the product
+   * \param[in,out] C output tensor
+   * \param[in] idx_C indices of output, must be distinct
+   * \param[in] beta scaling factor of C
+   * \param[in] M sparse nonsymmetric tensor with the same lengths as C (up to the permutation of its indices)
+   * \param[in] idx_M indices of M, a permutation of idx_C
+   */
+  void masked_contract(tensor *     A,
+                       char const * idx_A,
+                       tensor *     B,
+                       char const * idx_B,
+                       char const * alpha,
+                       tensor *     C,
+                       char const * idx_C,
+                       char const * beta,
+                       tensor *     M,
+                       char const * idx_M);
+
+  /**
+   * \brief computes C = beta*C + alpha*A restricted to the nonzeros of the sparse mask M, i.e. the single-operand
+   *        case of masked_contract()
+   * \param[in] A operand tensor
+   * \param[in] idx_A indices of operand
+   * \param[in] alpha scaling factor of A
+   * \param[in,out] C output tensor
+   * \param[in] idx_C indices of output, must be distinct
+   * \param[in] beta scaling factor of C
+   * \param[in] M sparse nonsymmetric tensor with the same lengths as C (up to the permutation of its indices)
+   * \param[in] idx_M indices of M, a permutation of idx_C
+   */
+  void masked_sum(tensor *     A,
+                  char const * idx_A,
+                  char const * alpha,
+                  tensor *     C,
+                  char const * idx_C,
+                  char const * beta,
+                  tensor *     M,
+                  char const * idx_M);
+}
+#endif
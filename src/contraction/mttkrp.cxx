@@ -0,0 +1,184 @@
+#include "mttkrp.h"
+#include "../sparse_formats/csf.h"
+#include "../scaling/scaling.h"
+#include "../shared/util.h"
+
+namespace CTF_int {
+  /** \brief position of index label c among the n labels idx, or -1 */
+  static int find_idx(int n, char const * idx, char c){
+    for (int i=0; i<n; i++){
+      if (idx[i] == c) return i;
+    }
+    return -1;
+  }
+
+  /** \brief whether A is a nonsymmetric tensor on the world and algebraic structure (element size) of M */
+  static bool is_mttkrp_compatible(tensor const * A, tensor const * M){
+    if (A->wrld != M->wrld || A->sr->el_size != M->sr->el_size) return false;
+    for (int i=0; i<A->order; i++){
+      if (A->sym[i] != NS) return false;
+    }
+    return true;
+  }
+
+  bool get_mttkrp_roles(int                 nops,
+                        tensor * const *    ops,
+                        char const * const* idx_ops,
+                        tensor *            M,
+                        char const *        idx_M,
+                        tensor **           T,
+                        tensor **           mats,
+                        int *               r_first,
+                        int *               mode){
+    if (M->is_sparse || M->order != 2 || idx_M[0] == idx_M[1] || !is_mttkrp_compatible(M, M)) return false;
+    if (M->sr->addid() == NULL || M->sr->mulid() == NULL) return false;
+    int iT = -1;
+    for (int i=0; i<nops; i++){
+      if (ops[i] == M || !is_mttkrp_compatible(ops[i], M)) return false;
+      if (ops[i]->is_sparse){
+        if (iT != -1) return false;
+        iT = i;
+      }
+    }
+    if (iT == -1) return false;
+    tensor * t = ops[iT];
+    char const * idx_T = idx_ops[iT];
+    int order = t->order;
+    if (order < 3 || nops != order) return false;
+    for (int j=0; j<order; j++){
+      if (find_idx(j, idx_T, idx_T[j]) != -1) return false;
+      mats[j] = NULL;
+    }
+    int m0 = find_idx(order, idx_T, idx_M[0]);
+    int m1 = find_idx(order, idx_T, idx_M[1]);
+    if ((m0 == -1) == (m1 == -1)) return false;
+    *mode = m0 == -1 ? m1 : m0;
+    r_first[*mode] = m0 == -1;
+    char r = idx_M[m0 == -1 ? 0 : 1];
+    int R = M->lens[m0 == -1 ? 0 : 1];
+    if (M->lens[m0 == -1 ? 1 : 0] != t->lens[*mode]) return false;
+    mats[*mode] = M;
+    for (int i=0; i<nops; i++){
+      if (i == iT) continue;
+      if (ops[i]->order != 2) return false;
+      int ir = find_idx(2, idx_ops[i], r);
+      if (ir == -1) return false;
+      int j = find_idx(order, idx_T, idx_ops[i][1-ir]);
+      if (j == -1 || mats[j] != NULL) return false;
+      if (ops[i]->lens[ir] != R || ops[i]->lens[1-ir] != t->lens[j]) return false;
+      mats[j] = ops[i];
+      r_first[j] = ir == 0;
+    }
+    *T = t;
+    return true;
+  }
+
+  /** \brief global key of entry (i, r) of a matrix with rank index r of length R, first if r_first, and other index of length len */
+  static inline int64_t get_mat_key(int64_t i, int64_t r, int64_t len, int64_t R, int r_first){
+    return r_first ? r + i*R : i + r*len;
+  }
+
+  void mttkrp(tensor *         T,
+              tensor * const * mats,
+              int const *      r_first,
+              int              mode,
+              char const *     alpha,
+              tensor *         M,
+              char const *     beta){
+    TAU_FSTART(mttkrp);
+    algstrct const * sr = M->sr;
+    int order = T->order;
+    int el_size = sr->el_size;
+    int64_t psz = sr->pair_size();
+    int R = M->lens[r_first[mode] ? 0 : 1];
+
+    if (!sr->isequal(beta, sr->mulid())){
+      if (sr->isequal(beta, sr->addid())){
+        M->set_zero();
+      } else {
+        int idx_M[2] = {0, 1};
+        scaling s(M, idx_M, beta);
+        s.execute();
+      }
+    }
+
+    // the output mode is the root of the CSF tree, the other modes follow by increasing length so that the top levels have few fibers
+    int mode_order[order];
+    mode_order[0] = mode;
+    for (int j=0, l=1; j<order; j++){
+      if (j != mode) mode_order[l++] = j;
+    }
+    std::stable_sort(mode_order+1, mode_order+order, [&](int a, int b){ return T->lens[a] < T->lens[b]; });
+
+    int64_t npair;
+    char * pairs;
+    T->read_local_nnz(&npair, &pairs);
+    CSF_Tensor csf(npair, pairs, order, T->lens, mode_order, T->sr);
+    if (pairs != NULL) cdealloc(pairs);
+
+    // relabel the fibers of each level by their position among the distinct indices of the level,
+    // and fetch the rows of the matrix of that mode for these indices (collective over all processes)
+    int64_t * uniq[order];
+    int64_t nuniq[order];
+    char * facs[order];
+    for (int l=0; l<order; l++){
+      int m = mode_order[l];
+      int64_t nf = csf.nfib(l);
+      int64_t * fids = csf.fids(l);
+      uniq[l] = (int64_t*)alloc(sizeof(int64_t)*std::max(nf, (int64_t)1));
+      memcpy(uniq[l], fids, sizeof(int64_t)*nf);
+      std::sort(uniq[l], uniq[l]+nf);
+      nuniq[l] = std::unique(uniq[l], uniq[l]+nf)-uniq[l];
+#ifdef USE_OMP
+      #pragma omp parallel for
+#endif
+      for (int64_t f=0; f<nf; f++){
+        fids[f] = std::lower_bound(uniq[l], uniq[l]+nuniq[l], fids[f])-uniq[l];
+      }
+      facs[l] = NULL;
+      if (l == 0) continue;
+      int64_t len = T->lens[m];
+      int64_t nrd = nuniq[l]*R;
+      char * rd_pairs = (char*)alloc(std::max(nrd, (int64_t)1)*psz);
+      for (int64_t u=0; u<nuniq[l]; u++){
+        for (int r=0; r<R; r++){
+          sr->set_pair(rd_pairs+(u*R+r)*psz, get_mat_key(uniq[l][u], r, len, R, r_first[m]), sr->addid());
+        }
+      }
+      mats[m]->read(nrd, rd_pairs);
+      facs[l] = (char*)alloc(std::max(nrd, (int64_t)1)*el_size);
+      // the pairs are not necessarily returned in the order requested
+      for (int64_t p=0; p<nrd; p++){
+        ConstPairIterator pi(sr, rd_pairs+p*psz);
+        int64_t k = pi.k();
+        int64_t i = r_first[m] ? k/R : k%len;
+        int64_t r = r_first[m] ? k%R : k/len;
+        int64_t u = std::lower_bound(uniq[l], uniq[l]+nuniq[l], i)-uniq[l];
+        memcpy(facs[l]+(u*R+r)*el_size, pi.d(), el_size);
+      }
+      cdealloc(rd_pairs);
+    }
+
+    int64_t nout = nuniq[0]*R;
+    char * out = (char*)alloc(std::max(nout, (int64_t)1)*el_size);
+    sr->set(out, sr->addid(), nout);
+    sr->mttkrp(csf, R, facs, out);
+
+    char * wr_pairs = (char*)alloc(std::max(nout, (int64_t)1)*psz);
+    for (int64_t u=0; u<nuniq[0]; u++){
+      for (int r=0; r<R; r++){
+        sr->set_pair(wr_pairs+(u*R+r)*psz, get_mat_key(uniq[0][u], r, T->lens[mode], R, r_first[mode]), out+(u*R+r)*el_size);
+      }
+    }
+    M->write(nout, alpha, sr->mulid(), wr_pairs);
+
+    cdealloc(wr_pairs);
+    cdealloc(out);
+    for (int l=0; l<order; l++){
+      cdealloc(uniq[l]);
+      if (facs[l] != NULL) cdealloc(facs[l]);
+    }
+    cdealloc(csf.all_data);
+    TAU_FSTOP(mttkrp);
+  }
+}
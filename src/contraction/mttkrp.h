@@ -0,0 +1,52 @@
+#ifndef __MTTKRP_H__
+#define __MTTKRP_H__
+
+#include "../tensor/untyped_tensor.h"
+
+namespace CTF_int {
+  /**
+   * \brief checks whether the contraction of nops operands into M is a matricized tensor times Khatri-Rao product (MTTKRP),
+   *        i.e. M["ir"] = T["ijk..."]*A["jr"]*B["kr"]... with T sparse of order at least 3 and M and all other operands dense
+   *        nonsymmetric matrices (each matrix may hold its indices in either order), and if so gives the roles of the operands
+   * \param[in] nops number of operands
+   * \param[in] ops operands
+   * \param[in] idx_ops index labels of each operand
+   * \param[in] M output tensor
+   * \param[in] idx_M index labels of the output
+   * \param[out] T the sparse operand
+   * \param[out] mats for each mode of T, the matrix indexed by it (M for the mode indexing the output)
+   * \param[out] r_first for each mode of T, whether the rank index is the first index of mats
+   * \param[out] mode mode of T indexing the output
+   * \return whether the contraction is an MTTKRP, if not the outputs are undefined
+   */
+  bool get_mttkrp_roles(int                 nops,
+                        tensor * const *    ops,
+                        char const * const* idx_ops,
+                        tensor *            M,
+                        char const *        idx_M,
+                        tensor **           T,
+                        tensor **           mats,
+                        int *               r_first,
+                        int *               mode);
+
+  /**
+   * \brief computes M = beta*M + alpha*MTTKRP(T), i.e. M[i_mode,r] = beta*M[i_mode,r] + alpha*sum T[i_0,i_1,...]*prod_{j!=mode} mats[j][i_j,r],
+   *        by building a CSF tree of the local nonzeros of T rooted at the output mode, fetching the rows of each matrix
+   *        indexed by the local fibers, and accumulating the local rows of the product into M
+   * \param[in] T sparse tensor
+   * \param[in] mats for each mode j!=mode of T, a dense matrix indexed by mode j of T and by the rank index
+   * \param[in] r_first for each mode of T (including mode, for M), whether the rank index is the first index of the matrix
+   * \param[in] mode mode of T indexing the output
+   * \param[in] alpha scaling factor of the product
+   * \param[in,out] M dense output matrix
+   * \param[in] beta scaling factor of M
+   */
+  void mttkrp(tensor *         T,
+              tensor * const * mats,
+              int const *      r_first,
+              int              mode,
+              char const *     alpha,
+              tensor *         M,
+              char const *     beta);
+}
+#endif
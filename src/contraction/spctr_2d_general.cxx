@@ -4,6 +4,7 @@
 #include "../tensor/untyped_tensor.h"
 #include "../mapping/mapping.h"
 #include "../shared/util.h"
+#include "../shared/memcontrol.h"
 #include <climits>
 
 namespace CTF_int {
@@ -65,6 +66,10 @@ namespace CTF_int {
     return new spctr_2d_general(this);
   }
 
+  bool spctr_2d_general::is_C_in_place() {
+    return !move_C && ctr_sub_lda_C == 0 && rec_ctr->is_C_in_place();
+  }
+
   void spctr_2d_general::find_bsizes(int64_t & b_A,
                                      int64_t & b_B,
                                      int64_t & b_C,
@@ -118,6 +123,10 @@ namespace CTF_int {
     return rec_ctr->est_time_rec(1, nnz_frac_A, nnz_frac_B, nnz_frac_C)*(double)edge_len/MIN(nlyr,edge_len) + est_time_fp(nlyr, nnz_frac_A, nnz_frac_B, nnz_frac_C);
   }
 
+  double spctr_2d_general::est_comm_time_rec(int nlyr, double nnz_frac_A, double nnz_frac_B, double nnz_frac_C) {
+    return rec_ctr->est_comm_time_rec(1, nnz_frac_A, nnz_frac_B, nnz_frac_C)*(double)edge_len/MIN(nlyr,edge_len) + est_time_fp(nlyr, nnz_frac_A, nnz_frac_B, nnz_frac_C);
+  }
+
   int64_t spctr_2d_general::spmem_fp(double nnz_frac_A, double nnz_frac_B, double nnz_frac_C) {
     int64_t b_A, b_B, b_C, s_A, s_B, s_C, aux_size;
     find_bsizes(b_A, b_B, b_C, s_A, s_B, s_C, aux_size);
@@ -135,6 +144,48 @@ namespace CTF_int {
     return rec_ctr->spmem_rec(nnz_frac_A, nnz_frac_B, nnz_frac_C) + spmem_fp(nnz_frac_A, nnz_frac_B, nnz_frac_C);
   }
 
+  int spctr_2d_general::get_lookahead(int64_t         nstep,
+                                      int             nblk_A,
+                                      int64_t const * size_blk_A,
+                                      int             nblk_B,
+                                      int64_t const * size_blk_B){
+    if (!(move_A || move_B) || nstep <= 1 || CTF::SUMMA_MAX_LOOKAHEAD <= 0) return 0;
+    int64_t b_A, b_B, b_C, s_A, s_B, s_C, aux_size;
+    find_bsizes(b_A, b_B, b_C, s_A, s_B, s_C, aux_size);
+    // sizes of sparse panels are not known in advance, so assume the local nonzeros are spread evenly
+    int64_t panel_sz = 0;
+    if (move_A){
+      if (is_sparse_A){
+        int64_t sz_A = 0;
+        for (int i=0; i<nblk_A; i++) sz_A += size_blk_A[i];
+        panel_sz += sz_A/b_A;
+      } else panel_sz += s_A*sr_A->el_size;
+    }
+    if (move_B){
+      if (is_sparse_B){
+        int64_t sz_B = 0;
+        for (int i=0; i<nblk_B; i++) sz_B += size_blk_B[i];
+        panel_sz += sz_B/b_B;
+      } else panel_sz += s_B*sr_B->el_size;
+    }
+    int depth = (int)std::min((int64_t)CTF::SUMMA_MAX_LOOKAHEAD, nstep-1);
+    // keep half of available memory for the recursive contraction
+    int64_t mem_avail = proc_bytes_available()/2;
+    while (depth > 0 && (depth+1)*panel_sz > mem_avail) depth--;
+    /* the nonzero counts and hence the depths differ among processes, which must
+       agree on the sequence of broadcasts posted on cdt_A and cdt_B */
+    int ncdt = 0;
+    CommData * cdts[3];
+    if (move_A) cdts[ncdt++] = cdt_A;
+    if (move_B) cdts[ncdt++] = cdt_B;
+    if (ncdt == 2) cdts[ncdt++] = cdt_A;
+    for (int i=0; i<ncdt; i++){
+      if (cdts[i]->np > 1)
+        MPI_Allreduce(MPI_IN_PLACE, &depth, 1, MPI_INT, MPI_MIN, cdts[i]->cm);
+    }
+    return depth;
+  }
+
   char * bcast_step(int edge_len, char * A, bool is_sparse_A, bool move_A, algstrct const * sr_A, int64_t b_A, int64_t s_A, char * buf_A, CommData * cdt_A, int64_t ctr_sub_lda_A, int64_t ctr_lda_A, int nblk_A, int64_t const * size_blk_A, int & new_nblk_A, int64_t *& new_size_blk_A, int64_t * offsets_A, int ib){
     int ret;
     char * op_A = NULL;
@@ -241,6 +292,65 @@ namespace CTF_int {
   }
 
 
+  void ibcast_sizes_step(char * A, bool is_sparse_A, algstrct const * sr_A, int64_t b_A, char * dbuf_A, CommData * cdt_A, int64_t ctr_sub_lda_A, int64_t ctr_lda_A, int nblk_A, int64_t const * size_blk_A, int & new_nblk_A, int64_t *& new_size_blk_A, int64_t * offsets_A, char *& op_A, char *& spbuf_A, int ib, MPI_Request * req){
+    int ret;
+    int owner_A = ib % cdt_A->np;
+    new_nblk_A     = nblk_A/b_A;
+    new_size_blk_A = (int64_t*)size_blk_A;
+    spbuf_A        = NULL;
+    *req           = MPI_REQUEST_NULL;
+    if (cdt_A->rank == owner_A){
+      if (b_A == 1){
+        op_A = A;
+      } else if (is_sparse_A){
+        int64_t * new_offsets_A;
+        socopy(ctr_sub_lda_A, ctr_lda_A, ctr_sub_lda_A*b_A, ctr_sub_lda_A,
+               size_blk_A+(ib/cdt_A->np)*ctr_sub_lda_A, 
+               new_size_blk_A, new_offsets_A);
+        int64_t bc_size_A = 0;
+        for (int z=0; z<new_nblk_A; z++) bc_size_A += new_size_blk_A[z];
+        ret = CTF_int::mst_alloc_ptr(bc_size_A, (void**)&spbuf_A);
+        ASSERT(ret==0);
+        op_A = spbuf_A;
+        spcopy(ctr_sub_lda_A, ctr_lda_A, ctr_sub_lda_A*b_A, ctr_sub_lda_A,
+               size_blk_A+(ib/cdt_A->np)*ctr_sub_lda_A, 
+               offsets_A+(ib/cdt_A->np)*ctr_sub_lda_A, 
+               A,
+               new_size_blk_A, new_offsets_A, op_A);
+        cdealloc(new_offsets_A);
+      } else {
+        op_A = dbuf_A;
+        sr_A->copy(ctr_sub_lda_A, ctr_lda_A, 
+                   A+sr_A->el_size*(ib/cdt_A->np)*ctr_sub_lda_A, ctr_sub_lda_A*b_A, 
+                   op_A, ctr_sub_lda_A);
+      }
+    } else {
+      if (is_sparse_A)
+        CTF_int::alloc_ptr(sizeof(int64_t)*new_nblk_A, (void**)&new_size_blk_A);
+      else
+        op_A = dbuf_A;
+    }
+    if (is_sparse_A)
+      cdt_A->ibcast(new_size_blk_A, new_nblk_A, MPI_INT64_T, owner_A, req);
+  }
+
+  void ibcast_data_step(bool is_sparse_A, algstrct const * sr_A, int64_t s_A, CommData * cdt_A, int new_nblk_A, int64_t const * new_size_blk_A, char *& op_A, char *& spbuf_A, int ib, MPI_Request * req){
+    int ret;
+    int owner_A = ib % cdt_A->np;
+    if (is_sparse_A){
+      int64_t bc_size_A = 0;
+      for (int z=0; z<new_nblk_A; z++) bc_size_A += new_size_blk_A[z];
+      if (cdt_A->rank != owner_A){
+        ret = CTF_int::mst_alloc_ptr(bc_size_A, (void**)&spbuf_A);
+        ASSERT(ret==0);
+        op_A = spbuf_A;
+      }
+      cdt_A->ibcast(op_A, bc_size_A, MPI_CHAR, owner_A, req);
+    } else {
+      cdt_A->ibcast(op_A, s_A, sr_A->mdtype(), owner_A, req);
+    }
+  }
+
   char * reduce_step_pre(int edge_len, char * C, bool is_sparse_C, bool move_C, algstrct const * sr_C, int64_t b_C, int64_t s_C, char * buf_C, CommData * cdt_C, int64_t ctr_sub_lda_C, int64_t ctr_lda_C, int nblk_C, int64_t const * size_blk_C, int & new_nblk_C, int64_t *& new_size_blk_C, int64_t * offsets_C, int ib, char const *& rec_beta){
     char * op_C;
     new_size_blk_C = (int64_t*)size_blk_C;
@@ -479,9 +589,96 @@ new_nblk_C = nblk_C/edge_len;
 
     new_C = C;
 
-    for (ib=iidx_lyr; ib<edge_len; ib+=inum_lyr){
-      op_A = bcast_step(edge_len, A, is_sparse_A, move_A, sr_A, b_A, s_A, buf_A, cdt_A, ctr_sub_lda_A, ctr_lda_A, nblk_A, size_blk_A, new_nblk_A, new_size_blk_A, offsets_A, ib);
-      op_B = bcast_step(edge_len, B, is_sparse_B, move_B, sr_B, b_B, s_B, buf_B, cdt_B, ctr_sub_lda_B, ctr_lda_B, nblk_B, size_blk_B, new_nblk_B, new_size_blk_B, offsets_B, ib);
+    int64_t nstep = 0;
+    for (ib=iidx_lyr; ib<edge_len; ib+=inum_lyr) nstep++;
+
+    /* With lookahead, the block sizes of step is+depth+1 and the data of step is+depth
+       are broadcast while step is is being contracted. Sparse data can only be received 
+       once its size is known, so the sizes are broadcast one step ahead of the data, 
+       which requires depth+2 slots of buffers */
+    int depth = get_lookahead(nstep, nblk_A, size_blk_A, nblk_B, size_blk_B);
+    int nslot = depth+2;
+    char ** sop_A = NULL, ** sop_B = NULL, ** spbuf_A = NULL, ** spbuf_B = NULL, ** sdbuf_A = NULL, ** sdbuf_B = NULL;
+    int64_t ** ssize_blk_A = NULL, ** ssize_blk_B = NULL;
+    int * snblk_A = NULL, * snblk_B = NULL;
+    MPI_Request * reqs = NULL;
+    if (depth > 0){
+      CTF_int::alloc_ptr(sizeof(char*)*nslot, (void**)&sop_A);
+      CTF_int::alloc_ptr(sizeof(char*)*nslot, (void**)&sop_B);
+      CTF_int::alloc_ptr(sizeof(char*)*nslot, (void**)&spbuf_A);
+      CTF_int::alloc_ptr(sizeof(char*)*nslot, (void**)&spbuf_B);
+      CTF_int::alloc_ptr(sizeof(char*)*nslot, (void**)&sdbuf_A);
+      CTF_int::alloc_ptr(sizeof(char*)*nslot, (void**)&sdbuf_B);
+      CTF_int::alloc_ptr(sizeof(int64_t*)*nslot, (void**)&ssize_blk_A);
+      CTF_int::alloc_ptr(sizeof(int64_t*)*nslot, (void**)&ssize_blk_B);
+      CTF_int::alloc_ptr(sizeof(int)*nslot, (void**)&snblk_A);
+      CTF_int::alloc_ptr(sizeof(int)*nslot, (void**)&snblk_B);
+      // per slot: sizes of A, data of A, sizes of B, data of B
+      CTF_int::alloc_ptr(sizeof(MPI_Request)*4*nslot, (void**)&reqs);
+      for (int i=0; i<nslot; i++){
+        sdbuf_A[i] = buf_A;
+        sdbuf_B[i] = buf_B;
+        if (i>0 && move_A && !is_sparse_A){
+          ret = CTF_int::mst_alloc_ptr(s_A*sr_A->el_size, (void**)&sdbuf_A[i]);
+          ASSERT(ret==0);
+        }
+        if (i>0 && move_B && !is_sparse_B){
+          ret = CTF_int::mst_alloc_ptr(s_B*sr_B->el_size, (void**)&sdbuf_B[i]);
+          ASSERT(ret==0);
+        }
+        for (int j=0; j<4; j++) reqs[4*i+j] = MPI_REQUEST_NULL;
+      }
+    }
+    /* posts the broadcast of the block sizes of step js, packing the data at the owner */
+    auto post_sizes = [&](int64_t js){
+      int jb = js%nslot;
+      int jib = iidx_lyr+js*inum_lyr;
+      if (move_A)
+        ibcast_sizes_step(A, is_sparse_A, sr_A, b_A, sdbuf_A[jb], cdt_A, ctr_sub_lda_A, ctr_lda_A, nblk_A, size_blk_A, snblk_A[jb], ssize_blk_A[jb], offsets_A, sop_A[jb], spbuf_A[jb], jib, reqs+4*jb);
+      if (move_B)
+        ibcast_sizes_step(B, is_sparse_B, sr_B, b_B, sdbuf_B[jb], cdt_B, ctr_sub_lda_B, ctr_lda_B, nblk_B, size_blk_B, snblk_B[jb], ssize_blk_B[jb], offsets_B, sop_B[jb], spbuf_B[jb], jib, reqs+4*jb+2);
+    };
+    /* completes the broadcast of the block sizes of step js and posts the broadcast of its data */
+    auto post_data = [&](int64_t js){
+      int jb = js%nslot;
+      int jib = iidx_lyr+js*inum_lyr;
+      MPI_Wait(reqs+4*jb, MPI_STATUS_IGNORE);
+      MPI_Wait(reqs+4*jb+2, MPI_STATUS_IGNORE);
+      if (move_A)
+        ibcast_data_step(is_sparse_A, sr_A, s_A, cdt_A, snblk_A[jb], ssize_blk_A[jb], sop_A[jb], spbuf_A[jb], jib, reqs+4*jb+1);
+      if (move_B)
+        ibcast_data_step(is_sparse_B, sr_B, s_B, cdt_B, snblk_B[jb], ssize_blk_B[jb], sop_B[jb], spbuf_B[jb], jib, reqs+4*jb+3);
+      if (js+1 < nstep) post_sizes(js+1);
+    };
+    if (depth > 0){
+      post_sizes(0);
+      for (int64_t js=0; js<depth; js++) post_data(js);
+    }
+
+    for (int64_t is=0; is<nstep; is++){
+      ib = iidx_lyr+is*inum_lyr;
+      int kb = is%nslot;
+      if (depth > 0){
+        if (is+depth < nstep) post_data(is+depth);
+        TAU_FSTART(spctr_2d_general_wait);
+        MPI_Wait(reqs+4*kb+1, MPI_STATUS_IGNORE);
+        MPI_Wait(reqs+4*kb+3, MPI_STATUS_IGNORE);
+        TAU_FSTOP(spctr_2d_general_wait);
+        if (move_A){
+          op_A           = sop_A[kb];
+          new_nblk_A     = snblk_A[kb];
+          new_size_blk_A = ssize_blk_A[kb];
+        }
+        if (move_B){
+          op_B           = sop_B[kb];
+          new_nblk_B     = snblk_B[kb];
+          new_size_blk_B = ssize_blk_B[kb];
+        }
+      }
+      if (depth == 0 || !move_A)
+        op_A = bcast_step(edge_len, A, is_sparse_A, move_A, sr_A, b_A, s_A, buf_A, cdt_A, ctr_sub_lda_A, ctr_lda_A, nblk_A, size_blk_A, new_nblk_A, new_size_blk_A, offsets_A, ib);
+      if (depth == 0 || !move_B)
+        op_B = bcast_step(edge_len, B, is_sparse_B, move_B, sr_B, b_B, s_B, buf_B, cdt_B, ctr_sub_lda_B, ctr_lda_B, nblk_B, size_blk_B, new_nblk_B, new_size_blk_B, offsets_B, ib);
       op_C = reduce_step_pre(edge_len, new_C, is_sparse_C, move_C, sr_C, b_C, s_C, buf_C, cdt_C, ctr_sub_lda_C, ctr_lda_C, nblk_C, size_blk_C, new_nblk_C, new_size_blk_C, offsets_C, ib, rec_ctr->beta);
 
 
@@ -495,11 +692,22 @@ new_nblk_C = nblk_C/edge_len;
       /*for (int i=0; i<ctr_sub_lda_C*ctr_lda_C; i++){
         printf("[%d] P%d up_C[%d]  = %lf\n",ctr_lda_C,idx_lyr,i, ((double*)up_C)[i]);
       }*/
-      if (is_sparse_A && move_A && (cdt_A->rank != (ib % cdt_A->np) || b_A != 1)){
-        cdealloc(op_A);
-      }
-      if (is_sparse_B && move_B && (cdt_B->rank != (ib % cdt_B->np)|| b_B != 1)){
-        cdealloc(op_B);
+      if (depth > 0){
+        if (is_sparse_A && move_A && spbuf_A[kb] != NULL){
+          cdealloc(spbuf_A[kb]);
+          spbuf_A[kb] = NULL;
+        }
+        if (is_sparse_B && move_B && spbuf_B[kb] != NULL){
+          cdealloc(spbuf_B[kb]);
+          spbuf_B[kb] = NULL;
+        }
+      } else {
+        if (is_sparse_A && move_A && (cdt_A->rank != (ib % cdt_A->np) || b_A != 1)){
+          cdealloc(op_A);
+        }
+        if (is_sparse_B && move_B && (cdt_B->rank != (ib % cdt_B->np)|| b_B != 1)){
+          cdealloc(op_B);
+        }
       }
       reduce_step_post(edge_len, C, is_sparse_C, move_C, sr_C, b_C, s_C, buf_C, cdt_C, ctr_sub_lda_C, ctr_lda_C, nblk_C, size_blk_C, new_nblk_C, new_size_blk_C, offsets_C, ib, rec_ctr->beta, this->beta, up_C, new_C, n_new_C_grps, i_new_C_grp, new_C_grps);
       
@@ -518,6 +726,23 @@ new_nblk_C = nblk_C/edge_len;
       if (new_size_blk_C != size_blk_C)
         cdealloc(new_size_blk_C);
     }
+    if (depth > 0){
+      for (int i=1; i<nslot; i++){
+        if (move_A && !is_sparse_A) CTF_int::cdealloc(sdbuf_A[i]);
+        if (move_B && !is_sparse_B) CTF_int::cdealloc(sdbuf_B[i]);
+      }
+      CTF_int::cdealloc(sop_A);
+      CTF_int::cdealloc(sop_B);
+      CTF_int::cdealloc(spbuf_A);
+      CTF_int::cdealloc(spbuf_B);
+      CTF_int::cdealloc(sdbuf_A);
+      CTF_int::cdealloc(sdbuf_B);
+      CTF_int::cdealloc(ssize_blk_A);
+      CTF_int::cdealloc(ssize_blk_B);
+      CTF_int::cdealloc(snblk_A);
+      CTF_int::cdealloc(snblk_B);
+      CTF_int::cdealloc(reqs);
+    }
 #if 0 //def OFFLOAD
     if (alloc_host_buf){
       host_pinned_free(buf_A);
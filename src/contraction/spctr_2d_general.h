@@ -111,7 +111,14 @@ namespace CTF_int{
        */
       double est_time_rec(int nlyr, double nnz_frac_A, double nnz_frac_B, double nnz_frac_C);
 
+      /**
+       * \brief returns the part of est_time_rec spent in broadcasts and reductions
+       * \return seconds needed for communication in recursive contraction
+       */
+      double est_comm_time_rec(int nlyr, double nnz_frac_A, double nnz_frac_B, double nnz_frac_C);
+
       spctr * clone();
+      bool is_C_in_place();
 /*      void set_size_blk_A(int new_nblk_A, int64_t const * nnbA){
         spctr::set_size_blk_A(new_nblk_A, nnbA);
         rec_ctr->set_size_blk_A(new_nblk_A, nnbA);
@@ -135,6 +142,21 @@ namespace CTF_int{
                        int64_t & s_B,
                        int64_t & s_C,
                        int64_t & aux_size);
+      /**
+       * \brief determines how many steps ahead of the current one to broadcast,
+       *        limited by CTF::SUMMA_MAX_LOOKAHEAD and the available memory
+       * \param[in] nstep number of steps performed by this process
+       * \param[in] nblk_A number of local blocks of A
+       * \param[in] size_blk_A sizes of local blocks of A (in bytes) if A is sparse
+       * \param[in] nblk_B number of local blocks of B
+       * \param[in] size_blk_B sizes of local blocks of B (in bytes) if B is sparse
+       * \return lookahead depth, 0 if broadcasts should be blocking
+       */
+      int get_lookahead(int64_t         nstep,
+                        int             nblk_A,
+                        int64_t const * size_blk_A,
+                        int             nblk_B,
+                        int64_t const * size_blk_B);
       /**
        * \brief copies spctr object
        */
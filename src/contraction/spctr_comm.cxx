@@ -116,6 +116,10 @@ namespace CTF_int {
     return new spctr_replicate(this);
   }
 
+  bool spctr_replicate::is_C_in_place() {
+    return ncdt_C == 0 && rec_ctr->is_C_in_place();
+  }
+
   void spctr_replicate::print() {
     int i;
     printf("spctr_replicate: \n");
@@ -170,6 +174,10 @@ namespace CTF_int {
     return rec_ctr->est_time_rec(nlyr, nnz_frac_A, nnz_frac_B, nnz_frac_C) + est_time_fp(nlyr, nnz_frac_A, nnz_frac_B, nnz_frac_C);
   }
 
+  double spctr_replicate::est_comm_time_rec(int nlyr, double nnz_frac_A, double nnz_frac_B, double nnz_frac_C) {
+    return rec_ctr->est_comm_time_rec(nlyr, nnz_frac_A, nnz_frac_B, nnz_frac_C) + est_time_fp(nlyr, nnz_frac_A, nnz_frac_B, nnz_frac_C);
+  }
+
   int64_t spctr_replicate::spmem_fp(double nnz_frac_A, double nnz_frac_B, double nnz_frac_C){
     int64_t mem_usage = 0;
     if (is_sparse_A) mem_usage += nnz_frac_A*size_A*sr_A->pair_size();
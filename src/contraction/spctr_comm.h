@@ -48,8 +48,10 @@ namespace CTF_int{
       int64_t spmem_rec(double nnz_frac_A, double nnz_frac_B, double nnz_frac_C);
       double est_time_fp(int nlyr, double nnz_frac_A, double nnz_frac_B, double nnz_frac_C);
       double est_time_rec(int nlyr, double nnz_frac_A, double nnz_frac_B, double nnz_frac_C);
+      double est_comm_time_rec(int nlyr, double nnz_frac_A, double nnz_frac_B, double nnz_frac_C);
       void print();
       spctr * clone();
+      bool is_C_in_place();
 
       spctr_replicate(spctr * other);
       ~spctr_replicate();
@@ -51,6 +51,10 @@ namespace CTF_int {
     return new spctr_offload(this);
   }
 
+  bool spctr_offload::is_C_in_place() {
+    return false;
+  }
+
   void spctr_offload::print() {
     printf("spctr_offload: \n");
     printf("total_iter = %d\n", total_iter);
@@ -77,6 +81,10 @@ namespace CTF_int {
     return rec_ctr->est_time_rec(nlyr, nnz_frac_A, nnz_frac_B, nnz_frac_C) + est_time_fp(nlyr, nnz_frac_A, nnz_frac_B, nnz_frac_C);
   }
 
+  double spctr_offload::est_comm_time_rec(int nlyr, double nnz_frac_A, double nnz_frac_B, double nnz_frac_C){
+    return rec_ctr->est_comm_time_rec(nlyr, nnz_frac_A, nnz_frac_B, nnz_frac_C) + est_time_fp(nlyr, nnz_frac_A, nnz_frac_B, nnz_frac_C);
+  }
+
   int64_t spctr_offload::spmem_fp(double nnz_frac_A, double nnz_frac_B, double nnz_frac_C){
     return 0;
   }
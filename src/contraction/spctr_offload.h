@@ -62,7 +62,14 @@ namespace CTF_int {
        */
       double est_time_rec(int nlyr, double nnz_frac_A, double nnz_frac_B, double nnz_frac_C);
 
+      /**
+       * \brief returns the time spent moving data to and from the device, including calls to rec_ctr
+       * \return seconds needed for data movement in recursive contraction
+       */
+      double est_comm_time_rec(int nlyr, double nnz_frac_A, double nnz_frac_B, double nnz_frac_C);
+
       spctr * clone();
+      bool is_C_in_place();
 
       spctr_offload(spctr * other);
 
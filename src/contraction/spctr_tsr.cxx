@@ -113,6 +113,7 @@ namespace CTF_int {
     }
 
     this->is_custom  = c->is_custom;
+    this->is_masked  = c->is_masked && krnl_type == 4;
     this->alpha      = c->alpha;
     if (is_custom){
       this->func     = c->func;
@@ -181,6 +182,7 @@ namespace CTF_int {
     inner_params = o->inner_params;
     is_custom    = o->is_custom;
     func         = o->func;
+    is_masked    = o->is_masked;
   }
 
   spctr * seq_tsr_spctr::clone() {
@@ -403,6 +405,15 @@ namespace CTF_int {
 
       case 4:
       {
+        if (is_masked){
+          // Do mm using CSR format for A and B, accumulating only into the nonzeros of C
+          ASSERT(sr_C->isequal(beta, sr_C->mulid()));
+          TAU_FSTART(MASKED_CSRMULTCSR);
+          CSR_Matrix::masked_csrmultcsr(A, sr_A, inner_params.m, inner_params.n, inner_params.k,
+                                        alpha, B, sr_B, C, sr_C);
+          TAU_FSTOP(MASKED_CSRMULTCSR);
+          break;
+        }
         // Do mm using CSR format for A and B and C
         TAU_FSTART(CSRMULTCSR);
         CSR_Matrix::csrmultcsr(A, sr_A, inner_params.m, inner_params.n, inner_params.k,
@@ -538,6 +549,10 @@ namespace CTF_int {
     return new spctr_virt(this);
   }
 
+  bool spctr_virt::is_C_in_place() {
+    return rec_ctr->is_C_in_place();
+  }
+
   void spctr_virt::print() {
     int i;
     printf("spctr_virt:\n");
@@ -559,6 +574,14 @@ namespace CTF_int {
     return nblk*rec_ctr->est_time_rec(nlyr, nnz_frac_A, nnz_frac_B, nnz_frac_C);
   }
 
+  double spctr_virt::est_comm_time_rec(int nlyr, double nnz_frac_A, double nnz_frac_B, double nnz_frac_C) {
+    int64_t nblk = 1;
+    for (int dim=0; dim<num_dim; dim++){
+      nblk *= virt_dim[dim];
+    }
+    return nblk*rec_ctr->est_comm_time_rec(nlyr, nnz_frac_A, nnz_frac_B, nnz_frac_C);
+  }
+
 
   #define VIRT_NTD 1
 
@@ -717,7 +740,7 @@ namespace CTF_int {
                              rec_C, 1, new_sp_szs_C+off_C,
                              pass_C);
             if (is_sparse_C){
-              if (do_dealloc) cdealloc(buckets_C[off_C]);
+              if (do_dealloc && buckets_C[off_C] != pass_C) cdealloc(buckets_C[off_C]);
               buckets_C[off_C] = pass_C;
             }
           }
@@ -756,7 +779,7 @@ namespace CTF_int {
       for (int i=0; i<nb_C; i++){
         memcpy(new_C+pfx, buckets_C[i], new_sp_szs_C[i]);
         pfx += new_sp_szs_C[i];
-        if (beta_arr[i] > 0) cdealloc(buckets_C[i]);
+        if (beta_arr[i] > 0 && buckets_C[i] != C + sp_offsets_C[i]) cdealloc(buckets_C[i]);
       }
       //FIXME: how to pass C back generally
       //cdealloc(C);
@@ -798,6 +821,10 @@ namespace CTF_int {
     return new spctr_pin_keys(this);
   }
 
+  bool spctr_pin_keys::is_C_in_place() {
+    return AxBxC != 2 && rec_ctr->is_C_in_place();
+  }
+
   void spctr_pin_keys::print(){
     printf("spctr_pin_keys:\n");
     switch (AxBxC){ 
@@ -895,6 +922,10 @@ namespace CTF_int {
     return est_time_fp(nlyr, nnz_frac_A, nnz_frac_B, nnz_frac_C)+rec_ctr->est_time_rec(nlyr, nnz_frac_A, nnz_frac_B, nnz_frac_C);
   }
 
+  double spctr_pin_keys::est_comm_time_rec(int nlyr, double nnz_frac_A, double nnz_frac_B, double nnz_frac_C) {
+    return rec_ctr->est_comm_time_rec(nlyr, nnz_frac_A, nnz_frac_B, nnz_frac_C);
+  }
+
   void spctr_pin_keys::run(char * A, int nblk_A, int64_t const * size_blk_A,
                            char * B, int nblk_B, int64_t const * size_blk_B,
                            char * C, int nblk_C, int64_t * size_blk_C,
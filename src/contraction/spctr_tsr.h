@@ -38,6 +38,16 @@ namespace CTF_int{
        */
       virtual double est_time_rec(int nlyr, double nnz_frac_A, double nnz_frac_B, double nnz_frac_C){ return 0.0; }
       double est_time_rec(int nlyr){ return est_time_rec(nlyr, 1.0, 1.0, 1.0); }
+      /**
+       * \brief returns the part of est_time_rec spent communicating (or moving data to a device)
+       * \param[in] nlyr amount of replication
+       * \param[in] nnz_frac_A percentage of nonzeros in tensor A
+       * \param[in] nnz_frac_B percentage of nonzeros in tensor B
+       * \param[in] nnz_frac_C percentage of nonzeros in tensor C
+       * \return time in sec
+       */
+      virtual double est_comm_time_rec(int nlyr, double nnz_frac_A, double nnz_frac_B, double nnz_frac_C){ return 0.0; }
+      double est_comm_time_rec(int nlyr){ return est_comm_time_rec(nlyr, 1.0, 1.0, 1.0); }
       /**
        * \brief returns the number of bytes need by each processor in this kernel and its recursive calls
        * \return bytes needed for recursive contraction
@@ -45,6 +55,12 @@ namespace CTF_int{
       virtual int64_t spmem_rec(double nnz_frac_A, double nnz_frac_B, double nnz_frac_C){ return 0; };
 
 
+      /**
+       * \brief whether the sequential kernel is passed the local blocks of C itself, rather than buffers
+       *        that are reduced or merged into C afterwards, so that it may update the nonzeros of C in place
+       */
+      virtual bool is_C_in_place(){ return true; }
+
       void run(char * A, char * B, char * C) { printf("CTF ERROR: PROVIDE SPARSITY ARGS TO RUN\n"); assert(0); };
       virtual void run(char * A, int nblk_A, int64_t const * size_blk_A,
                        char * B, int nblk_B, int64_t const * size_blk_B,
@@ -76,6 +92,8 @@ namespace CTF_int{
       
       int is_custom;
       bivar_function const * func; // custom_params;
+      /** \brief whether the product is accumulated only into the existing nonzeros of C (see contraction::is_masked) */
+      bool is_masked;
       
 
       /**
@@ -142,7 +160,9 @@ namespace CTF_int{
       int64_t spmem_rec(double nnz_frac_A, double nnz_frac_B, double nnz_frac_C);
 
       double est_time_rec(int nlyr, double nnz_frac_A, double nnz_frac_B, double nnz_frac_C);
+      double est_comm_time_rec(int nlyr, double nnz_frac_A, double nnz_frac_B, double nnz_frac_C);
       spctr * clone();
+      bool is_C_in_place();
 
       /**
        * \brief deallocates spctr_virt object
@@ -183,6 +203,8 @@ namespace CTF_int{
 
       double est_time_fp(int nlyr, double nnz_frac_A, double nnz_frac_B, double nnz_frac_C);
       double est_time_rec(int nlyr, double nnz_frac_A, double nnz_frac_B, double nnz_frac_C);
+      double est_comm_time_rec(int nlyr, double nnz_frac_A, double nnz_frac_B, double nnz_frac_C);
+      bool is_C_in_place();
       spctr_pin_keys(spctr * other);
       ~spctr_pin_keys();
       spctr_pin_keys(contraction const * s, int AxBxC);
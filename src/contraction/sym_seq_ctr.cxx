@@ -204,29 +204,12 @@ namespace CTF_int{
         CTF_FLOPS_ADD(imax-imin);
       } else*/ 
       if (alpha == NULL || sr_A->isequal(alpha,sr_A->mulid())){
-        for (int i=imin; i<imax; i++){
-          char tmp[sr_C->el_size];
-          sr_C->mul(A+offsets_A[0][i], 
-                    B+offsets_B[0][i], 
-                    tmp);
-          sr_C->add(tmp, 
-                    C+offsets_C[0][i], 
-                    C+offsets_C[0][i]);
-        }
+        if (imax > imin)
+          sr_C->offsets_ctr(imax-imin, NULL, A, offsets_A[0]+imin, B, offsets_B[0]+imin, C, offsets_C[0]+imin);
         CTF_FLOPS_ADD(2*(imax-imin));
       } else {
-        for (int i=imin; i<imax; i++){
-          char tmp[sr_C->el_size];
-          sr_C->mul(A+offsets_A[0][i], 
-                    B+offsets_B[0][i], 
-                    tmp);
-          sr_C->mul(tmp,
-                    alpha,
-                    tmp);
-          sr_C->add(tmp, 
-                    C+offsets_C[0][i], 
-                    C+offsets_C[0][i]);
-        }
+        if (imax > imin)
+          sr_C->offsets_ctr(imax-imin, alpha, A, offsets_A[0]+imin, B, offsets_B[0]+imin, C, offsets_C[0]+imin);
         CTF_FLOPS_ADD(3*(imax-imin));
       }
     } else {
@@ -213,6 +213,8 @@ namespace CTF_int {
   CommData::CommData(){
     alive = 0;
     created = 0;
+    node_size = 0;
+    inter_node = 0;
   }
 
   CommData::~CommData(){
@@ -226,6 +228,8 @@ namespace CTF_int {
     np      = other.np;
     color   = other.color;
     created = 0;
+    node_size  = other.node_size;
+    inter_node = other.inter_node;
   }
 
   CommData& CommData::operator=(CommData const & other){
@@ -235,6 +239,8 @@ namespace CTF_int {
     np      = other.np;
     color   = other.color;
     created = 0;
+    node_size  = other.node_size;
+    inter_node = other.inter_node;
     return *this;
   }
 
@@ -245,6 +251,8 @@ namespace CTF_int {
     MPI_Comm_size(cm, &np);
     alive = 1;
     created = 0;
+    node_size = 0;
+    inter_node = 0;
   }
 
   CommData::CommData(int rank_, int color_, int np_){
@@ -253,6 +261,8 @@ namespace CTF_int {
     np      = np_;
     alive   = 0;
     created = 0;
+    node_size  = 0;
+    inter_node = 0;
   }
 
   CommData::CommData(int rank_, int color_, CommData parent){
@@ -263,6 +273,8 @@ namespace CTF_int {
     MPI_Comm_size(cm, &np);
     alive   = 1;
     created = 1;
+    node_size  = 0;
+    inter_node = 0;
   }
 
   void CommData::activate(MPI_Comm parent){
@@ -288,13 +300,17 @@ namespace CTF_int {
     }
   }
      
+  double CommData::bw_cost() const {
+    return inter_node ? CTF::INTER_NODE_COMM_COST : 1.;
+  }
+     
   double CommData::estimate_bcast_time(int64_t msg_sz){
-    double ps[] = {1.0, log2((double)np), (double)msg_sz};
+    double ps[] = {1.0, log2((double)np), (double)msg_sz*bw_cost()};
     return bcast_mdl.est_time(ps);
   }
      
   double CommData::estimate_allred_time(int64_t msg_sz, MPI_Op op){
-    double ps[] = {1.0, log2((double)np), (double)msg_sz*log2((double)(np))};
+    double ps[] = {1.0, log2((double)np), (double)msg_sz*log2((double)(np))*bw_cost()};
     if (op >= MPI_MAX && op <= MPI_REPLACE)
       return allred_mdl.est_time(ps);
     else
@@ -302,7 +318,7 @@ namespace CTF_int {
   }
 
   double CommData::estimate_red_time(int64_t msg_sz, MPI_Op op){
-    double ps[] = {1.0, log2((double)np), (double)msg_sz*log2((double)(np))};
+    double ps[] = {1.0, log2((double)np), (double)msg_sz*log2((double)(np))*bw_cost()};
     if (op >= MPI_MAX && op <= MPI_REPLACE)
       return red_mdl.est_time(ps);
     else
@@ -319,12 +335,12 @@ namespace CTF_int {
 
   
   double CommData::estimate_alltoall_time(int64_t chunk_sz) {
-    double ps[] = {1.0, log2((double)np), log2((double)np)*np*chunk_sz};
+    double ps[] = {1.0, log2((double)np), log2((double)np)*np*chunk_sz*bw_cost()};
     return alltoall_mdl.est_time(ps);
   }
   
   double CommData::estimate_alltoallv_time(int64_t tot_sz) {
-    double ps[] = {1.0, log2((double)np), log2((double)np)*tot_sz};
+    double ps[] = {1.0, log2((double)np), log2((double)np)*tot_sz*bw_cost()};
     return alltoallv_mdl.est_time(ps);
   }
 
@@ -341,10 +357,19 @@ namespace CTF_int {
     double exe_time = MPI_Wtime()-st_time;
     int tsize;
     MPI_Type_size(mdtype, &tsize);
-    double tps[] = {exe_time, 1.0, log2(np), ((double)count)*tsize};
+    double tps[] = {exe_time, 1.0, log2(np), ((double)count)*tsize*bw_cost()};
     bcast_mdl.observe(tps);
   }
 
+  void CommData::ibcast(void * buf, int64_t count, MPI_Datatype mdtype, int root, MPI_Request * req){
+#if MPI_VERSION >= 3
+    MPI_Ibcast(buf, count, mdtype, root, cm, req);
+#else
+    bcast(buf, count, mdtype, root);
+    *req = MPI_REQUEST_NULL;
+#endif
+  }
+
   void CommData::allred(void * inbuf, void * outbuf, int64_t count, MPI_Datatype mdtype, MPI_Op op){
 #ifdef TUNE
     MPI_Barrier(cm);
@@ -357,7 +382,7 @@ namespace CTF_int {
     double exe_time = MPI_Wtime()-st_time;
     int tsize;
     MPI_Type_size(mdtype, &tsize);
-    double tps[] = {exe_time, 1.0, log2(np), ((double)count)*tsize*std::max(.5,(double)log2(np))};
+    double tps[] = {exe_time, 1.0, log2(np), ((double)count)*tsize*std::max(.5,(double)log2(np))*bw_cost()};
     if (op >= MPI_MAX && op <= MPI_REPLACE)
       allred_mdl.observe(tps);
     else
@@ -376,7 +401,7 @@ namespace CTF_int {
     double exe_time = MPI_Wtime()-st_time;
     int tsize;
     MPI_Type_size(mdtype, &tsize);
-    double tps[] = {exe_time, 1.0, log2(np), ((double)count)*tsize*std::max(.5,(double)log2(np))};
+    double tps[] = {exe_time, 1.0, log2(np), ((double)count)*tsize*std::max(.5,(double)log2(np))*bw_cost()};
     if (op >= MPI_MAX && op <= MPI_REPLACE)
       red_mdl.observe(tps);
     else
@@ -483,7 +508,7 @@ namespace CTF_int {
 #endif
     double exe_time = MPI_Wtime()-st_time;
     int64_t tot_sz = std::max(send_displs[np-1]+send_counts[np-1], recv_displs[np-1]+recv_counts[np-1])*datum_size;
-    double tps[] = {exe_time, 1.0, log2(np), (double)tot_sz};
+    double tps[] = {exe_time, 1.0, log2(np), (double)tot_sz*bw_cost()};
     alltoallv_mdl.observe(tps);
   }
 
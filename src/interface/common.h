@@ -54,6 +54,193 @@ namespace CTF {
    */
   enum OP { OP_SUM, OP_SUMABS, OP_SUMSQ, OP_MAX, OP_MIN, OP_MAXABS, OP_MINABS};
 
+  /**
+   * \brief maximum number of panels (dense or sparse) SUMMA broadcasts ahead of the panel being contracted,
+   *        the depth used is reduced if there is not enough memory, 0 gives blocking broadcasts
+   */
+  extern int SUMMA_MAX_LOOKAHEAD;
+
+  /**
+   * \brief maximum number of contraction mappings cached for each World on each process, 0 disables the cache
+   */
+  extern int CTR_PLAN_CACHE_SIZE;
+
+  /**
+   * \brief maximum number of redistribution plans (counts, displacements, and bucket offsets) cached on each process,
+   *        0 disables the cache
+   */
+  extern int REDIST_PLAN_CACHE_SIZE;
+
+  /**
+   * \brief contractions of up to this many tensors are ordered optimally by dynamic programming,
+   *        larger ones greedily by the cheapest pairwise contraction
+   */
+  extern int CTR_ORDER_DP_MAX;
+
+  /**
+   * \brief contractions of up to this many tensors (and at most CTR_ORDER_DP_MAX) are ordered by the time
+   *        predicted by contraction::estimate_time() for each pairwise contraction, larger ones by its flop count,
+   *        0 by default since each of these dry runs searches mappings and is collective over the World
+   */
+  extern int CTR_ORDER_EST_MAX;
+
+  /**
+   * \brief smallest number of bytes (2, 4, or 8) used for each index of a local CSR or COO block,
+   *        wider indices are used only for blocks whose dimensions or number of nonzeros require them
+   */
+  extern int SP_MIN_IDX_WIDTH;
+
+  /**
+   * \brief local blocks of sparse contraction operands with fewer than this many nonzeros per row on average
+   *        are stored doubly-compressed (DCSR), keeping row offsets only for nonempty rows, rather than in CSR layout
+   */
+  extern double SP_DCSR_MAX_NNZ_PER_ROW;
+
+  /**
+   * \brief number of consecutive ranks of a World assumed to share a node when building its topologies,
+   *        0 detects nodes via MPI_Comm_split_type, takes effect for Worlds created after it is set
+   */
+  extern int RANKS_PER_NODE;
+
+  /**
+   * \brief factor by which the bandwidth cost of collectives over processes on different nodes
+   *        is scaled relative to collectives within a node
+   */
+  extern double INTER_NODE_COMM_COST;
+
+  /**
+   * \brief bytes of address space reserved for the arena serving temporary buffers (mst_alloc),
+   *        pages are only used once touched, 0 disables the arena, takes effect at the first such allocation
+   */
+  extern int64_t MST_ARENA_SIZE;
+
+  /**
+   * \brief temporary buffers larger than this many bytes bypass the arena and are allocated directly
+   */
+  extern int64_t MST_MAX_BLOCK_SIZE;
+
+  /**
+   * \brief most bytes of freed arena buffers larger than 256 KB whose pages stay committed for reuse,
+   *        the pages of buffers freed beyond it are returned to the operating system
+   */
+  extern int64_t MST_CACHE_SIZE;
+
+  /**
+   * \brief most bytes of intermediate tensors of expressions kept for each World on each process for reuse by later expressions,
+   *        0 disables the pool
+   */
+  extern int64_t INTM_POOL_SIZE;
+
+  /**
+   * \brief most partitions of each World into subworlds (with the copies of tensors moved to them)
+   *        kept by Schedule for later executions, 0 disables the cache
+   */
+  extern int SUBWORLD_CACHE_SIZE;
+
+  /**
+   * \brief usage statistics of a plan cache on this process
+   */
+  struct Plan_cache_stats {
+    /** \brief number of lookups that found a plan */
+    int64_t hits;
+    /** \brief number of lookups that required a new plan */
+    int64_t misses;
+    /** \brief number of plans dropped to stay within the cache size */
+    int64_t evictions;
+    /** \brief number of plans currently cached */
+    int64_t size;
+  };
+
+  /**
+   * \brief predicted cost of a tensor operation on each process, as given by a dry run
+   */
+  struct Cost_estimate {
+    /** \brief total predicted execution time in seconds */
+    double time;
+    /** \brief time spent in local computation */
+    double comp_time;
+    /** \brief time spent communicating within the algorithm (broadcasts, reductions, replication) */
+    double comm_time;
+    /** \brief time spent redistributing operands to and from the chosen mapping */
+    double redist_time;
+    /** \brief peak number of bytes of buffer space used */
+    int64_t mem;
+  };
+
+  /**
+   * \brief usage statistics of the arena serving temporary buffers on this process
+   */
+  struct Mst_stats {
+    /** \brief number of buffers allocated from the arena */
+    int64_t allocs;
+    /** \brief number of buffers returned to the arena */
+    int64_t frees;
+    /** \brief number of buffers allocated directly because they were too large or the arena was full */
+    int64_t fallbacks;
+    /** \brief bytes of arena buffers currently in use (rounded up to their size class) */
+    int64_t bytes_in_use;
+    /** \brief largest value bytes_in_use has reached */
+    int64_t peak_bytes_in_use;
+    /** \brief bytes of the arena handed out to size classes, in use or cached for reuse */
+    int64_t bytes_reserved;
+    /** \brief bytes of bytes_reserved whose pages have not been returned to the operating system,
+     *         counted as used memory when CTF checks whether an operation fits in memory */
+    int64_t bytes_committed;
+    /** \brief bytes of address space reserved for the arena */
+    int64_t arena_size;
+  };
+
+  /**
+   * \brief returns hit/miss statistics of the contraction mapping cache
+   */
+  Plan_cache_stats get_ctr_plan_cache_stats();
+
+  /**
+   * \brief drops all cached contraction mappings (collective over all Worlds in use)
+   */
+  void clear_ctr_plan_cache();
+
+  /**
+   * \brief returns hit/miss statistics of the redistribution plan cache of this process
+   */
+  Plan_cache_stats get_redist_plan_cache_stats();
+
+  /**
+   * \brief drops all cached redistribution plans of this process
+   */
+  void clear_redist_plan_cache();
+
+  /**
+   * \brief returns reuse statistics of the pool of intermediate tensors of this process
+   */
+  Plan_cache_stats get_intm_pool_stats();
+
+  /**
+   * \brief deletes all intermediate tensors pooled on this process
+   */
+  void clear_intm_pool();
+
+  /**
+   * \brief returns reuse statistics of the subworlds kept by Schedule on this process
+   */
+  Plan_cache_stats get_subworld_cache_stats();
+
+  /**
+   * \brief deletes all subworlds kept by Schedule, along with the tensors on them
+   *        (collective over all Worlds they partition)
+   */
+  void clear_subworld_cache();
+
+  /**
+   * \brief returns usage statistics of the arena serving temporary buffers on this process
+   */
+  Mst_stats get_mst_stats();
+
+  /**
+   * \brief returns the pages of large cached arena buffers to the operating system, the buffers stay reusable
+   */
+  void release_mst();
+
   /**
    * @}
    */
@@ -136,6 +323,10 @@ namespace CTF_int {
       int color;
       int alive;
       int created;
+      /** \brief number of consecutive ranks sharing a node, 0 if unknown */
+      int node_size;
+      /** \brief whether the processes of this communicator are on more than one node */
+      int inter_node;
   
       CommData();
       ~CommData();
@@ -175,6 +366,12 @@ namespace CTF_int {
       /* \brief deactivate (MPI_Free) this comm */
       void deactivate();
      
+      /**
+       * \brief factor scaling the bandwidth cost of collectives over this communicator,
+       *        INTER_NODE_COMM_COST if it spans nodes and 1 otherwise
+       */
+      double bw_cost() const;
+     
       /* \brief provide estimate of broadcast execution time */
       double estimate_bcast_time(int64_t msg_sz);
    
@@ -198,6 +395,12 @@ namespace CTF_int {
        */
       void bcast(void * buf, int64_t count, MPI_Datatype mdtype, int root);
 
+      /**
+       * \brief non-blocking broadcast, same interface as MPI_Ibcast, but excluding the comm,
+       *        falls back to a blocking broadcast (and sets req to MPI_REQUEST_NULL) if MPI-3 is unavailable
+       */
+      void ibcast(void * buf, int64_t count, MPI_Datatype mdtype, int root, MPI_Request * req);
+
       /**
        * \brief allreduce, same interface as MPI_Allreduce, but excluding the comm
        */
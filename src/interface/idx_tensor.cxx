@@ -3,6 +3,7 @@
 #include "common.h"
 #include "schedule.h"
 #include "../summation/summation.h"
+#include "../tensor/intm_pool.h"
 
 using namespace CTF_int;
 
@@ -141,6 +142,16 @@ namespace CTF {
     sr->safecopy(scale,other.scale);
   }
 
+  Idx_Tensor::Idx_Tensor(Idx_Tensor && other) : Term(other.sr) {
+    parent  = other.parent;
+    idx_map = other.idx_map;
+    is_intm = other.is_intm;
+    sr->safecopy(scale,other.scale);
+    other.parent  = NULL;
+    other.idx_map = NULL;
+    other.is_intm = 0;
+  }
+
 /*  Idx_Tensor::Idx_Tensor(){
     parent      = NULL;
     idx_map     = NULL;
@@ -158,7 +169,7 @@ namespace CTF {
 
   Idx_Tensor::~Idx_Tensor(){
     if (is_intm) { 
-      delete parent;
+      CTF_int::get_intm_pool().release(parent);
       is_intm = 0;
     }
     if (parent != NULL)  cdealloc(idx_map);
@@ -179,7 +190,7 @@ namespace CTF {
       std::cout << "op= tensor" << std::endl;
       assert(false);
     } else {
-      if (sr->has_mul()){
+      if (sr->has_mul() && sr->addid() != NULL){
         sr->safecopy(scale,sr->addid());
       } else {
         this->parent->set_zero();
@@ -194,7 +205,7 @@ namespace CTF {
       global_schedule->add_operation(
           new TensorOperation(TENSOR_OP_SET, new Idx_Tensor(*this), B.clone()));
     } else {
-      if (sr->has_mul()){
+      if (sr->has_mul() && sr->addid() != NULL){
         sr->safecopy(scale,sr->addid());
       } else {
         this->parent->set_zero();
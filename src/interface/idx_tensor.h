@@ -42,6 +42,14 @@ namespace CTF {
                  int                                           copy=0,
                  std::map<CTF_int::tensor*, CTF_int::tensor*>* remap=NULL);
 
+      /**
+       * \brief move constructor, takes the parent tensor of other along with ownership of it if it is an
+       *        intermediate, so intermediates returned by value are not copied,
+       *        (assignment is not overloaded for rvalues, since it evaluates the expression B into this)
+       * \param[in,out] other tensor to move from, left without a parent
+       */
+      Idx_Tensor(CTF::Idx_Tensor && other);
+
       /**
        * \brief constructor for scalar
        * \param[in] sr ring/semiring
@@ -31,6 +31,32 @@ namespace CTF {
     symm = A.symm;
   }
 
+  template<typename dtype>
+  Matrix<dtype>::Matrix(Matrix<dtype> && A) noexcept
+    : Tensor<dtype>(std::move(A)) {
+    nrow = A.nrow;
+    ncol = A.ncol;
+    symm = A.symm;
+  }
+
+  template<typename dtype>
+  Matrix<dtype> & Matrix<dtype>::operator=(Matrix<dtype> const & A){
+    Tensor<dtype>::operator=(A);
+    nrow = A.nrow;
+    ncol = A.ncol;
+    symm = A.symm;
+    return *this;
+  }
+
+  template<typename dtype>
+  Matrix<dtype> & Matrix<dtype>::operator=(Matrix<dtype> && A){
+    nrow = A.nrow;
+    ncol = A.ncol;
+    symm = A.symm;
+    Tensor<dtype>::operator=(std::move(A));
+    return *this;
+  }
+
   template<typename dtype>
   Matrix<dtype>::Matrix(Tensor<dtype> const & A)
     : Tensor<dtype>(A) {
@@ -27,6 +27,24 @@ namespace CTF {
        */
       Matrix(Matrix<dtype> const & A);
 
+      /** 
+       * \brief move constructor for a matrix
+       * \param[in,out] A matrix to move from without copying its data, left empty
+       */
+      Matrix(Matrix<dtype> && A) noexcept;
+
+      /** 
+       * \brief sets the matrix, copying the data of A
+       * \param[in] A matrix to copy
+       */
+      Matrix<dtype> & operator=(Matrix<dtype> const & A);
+
+      /** 
+       * \brief sets the matrix, taking the data of A without copying it
+       * \param[in,out] A matrix to move from, left empty
+       */
+      Matrix<dtype> & operator=(Matrix<dtype> && A);
+
 
       /** 
        * \brief casts a tensor to a matrix
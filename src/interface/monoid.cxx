@@ -28,11 +28,11 @@ namespace CTF {
   char * CTF::Monoid<double,1>::csr_add(char * cA, char * cB) const {
 #if USE_SP_MKL
     TAU_FSTART(mkl_csr_add)
-    if (fadd != default_add<double>){
-      return CTF_int::algstrct::csr_add(cA, cB);
-    }
     CSR_Matrix A(cA);
     CSR_Matrix B(cB);
+    if (fadd != default_add<double> || A.idx_width() != sizeof(int) || B.idx_width() != sizeof(int)){
+      return CTF_int::algstrct::csr_add(cA, cB);
+    }
     int * ic;
     int m = A.nrow();
     int n = A.ncol();
@@ -1,6 +1,9 @@
 #ifndef __MONOID_H__
 #define __MONOID_H__
 
+#include <type_traits>
+#include "semiring_seq.h"
+
 namespace CTF_int {
   template <typename dtype>
   dtype default_add(dtype a, dtype b){
@@ -53,6 +56,30 @@ namespace CTF_int {
     MPI_Op_create(&default_mxpy<dtype, fxpy>, 1, &newop);
     return newop;
   }
+
+  template <typename dtype, typename f_t>
+  dtype call_default_functor(dtype a, dtype b){
+    return f_t()(a,b);
+  }
+
+  /**
+   * \brief obtains a function pointer equivalent to a binary operator type, which is a
+   *        conversion for captureless lambdas and otherwise calls a default-constructed functor
+   * \param[in] f binary operator
+   */
+  template <typename dtype, typename f_t>
+  typename std::enable_if<std::is_convertible<f_t, dtype (*)(dtype, dtype)>::value, dtype (*)(dtype, dtype)>::type
+  get_binary_fptr(f_t f){
+    return f;
+  }
+
+  template <typename dtype, typename f_t>
+  typename std::enable_if<!std::is_convertible<f_t, dtype (*)(dtype, dtype)>::value, dtype (*)(dtype, dtype)>::type
+  get_binary_fptr(f_t f){
+    static_assert(std::is_default_constructible<f_t>::value,
+                  "CTF ERROR: operators of Monoid_Op and Semiring_Op must be captureless lambdas, function pointers, or default constructible functors");
+    return &call_default_functor<dtype, f_t>;
+  }
 }
 
 namespace CTF {
@@ -133,6 +160,76 @@ namespace CTF {
   };
   template <>
   char * Monoid<double,1>::csr_add(char *, char *) const;
+
+  /**
+   * \brief Monoid with addition given by an operator type rather than a function pointer,
+   *   so that the operator is inlined into the loops over blocks of elements,
+   *   the operator may be a functor, a function pointer, or a captureless lambda (see make_monoid)
+   */
+  template <typename dtype, typename fadd_t, bool is_ord=CTF_int::get_default_is_ord<dtype>()>
+  class Monoid_Op : public Monoid<dtype, is_ord> {
+    public:
+      fadd_t add_op;
+
+      Monoid_Op(Monoid_Op const & other) : Monoid<dtype, is_ord>(other), add_op(other.add_op) { }
+
+      virtual CTF_int::algstrct * clone() const {
+        return new Monoid_Op<dtype, fadd_t, is_ord>(*this);
+      }
+
+      /**
+       * \brief constructor for algstrct equipped with + given by an operator
+       * \param[in] addid_ additive identity
+       * \param[in] fadd_ binary addition operator
+       * \param[in] addmop_ MPI_Op operation for addition
+       */
+      Monoid_Op(dtype  addid_,
+                fadd_t fadd_,
+                MPI_Op addmop_)
+                  : Monoid<dtype, is_ord>(addid_, CTF_int::get_binary_fptr<dtype>(fadd_), addmop_), add_op(fadd_) { }
+
+      void add(char const * a, 
+               char const * b,
+               char *       c) const {
+        ((dtype*)c)[0] = add_op(((dtype*)a)[0],((dtype*)b)[0]);
+      }
+
+      void axpy(int          n,
+                char const * alpha,
+                char const * X,
+                int          incX,
+                char       * Y,
+                int          incY) const {
+        dtype const * dX = (dtype const *)X;
+        dtype * dY = (dtype *)Y;
+        for (int64_t i=0; i<n; i++){
+          dY[i*incY] = add_op(dX[i*incX], dY[i*incY]);
+        }
+      }
+
+      void offsets_sum(int64_t n, char const * A, uint64_t const * offsets_A, char * B, uint64_t const * offsets_B) const {
+        CTF_int::sr_offsets_sum<dtype>(n, A, offsets_A, B, offsets_B, add_op);
+      }
+
+      int64_t pairs_sum(int64_t nA, char const * A, int64_t idx_B, int64_t m, char * B) const {
+        return CTF_int::sr_pairs_sum(nA, A, idx_B, m, (dtype *)B, add_op);
+      }
+
+      void pairs_merge_sum(int64_t nA, char const * A, char const * beta, int64_t nB, char const * B, int64_t & nnew, char *& new_B, int64_t map_pfx) const {
+        CTF_int::sr_pairs_merge_sum(nA, A, (dtype const *)beta, nB, B, nnew, new_B, map_pfx, add_op, CTF_int::algstrct_mul_op<dtype>(this));
+      }
+  };
+
+  /**
+   * \brief creates a Monoid_Op, deducing the type of the addition operator (e.g. of a lambda)
+   * \param[in] addid additive identity
+   * \param[in] fadd binary addition operator
+   * \param[in] addmop MPI_Op operation for addition
+   */
+  template <typename dtype, bool is_ord=CTF_int::get_default_is_ord<dtype>(), typename fadd_t>
+  Monoid_Op<dtype, fadd_t, is_ord> make_monoid(dtype addid, fadd_t fadd, MPI_Op addmop){
+    return Monoid_Op<dtype, fadd_t, is_ord>(addid, fadd, addmop);
+  }
   
   /**
    * @}
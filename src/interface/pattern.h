@@ -0,0 +1,170 @@
+#ifndef __PATTERN_H__
+#define __PATTERN_H__
+
+namespace CTF {
+  /**
+   * \addtogroup algstrct
+   * @{
+   **/
+
+  /**
+   * \brief Boolean semiring whose elements carry no data, for sparse tensors that store only their nonzero pattern
+   *        (e.g. adjacency matrices of unweighted graphs), Matrix<bool> A(n, n, SP, dw, Pattern());
+   *        the stored entries are true (the multiplicative identity) and all others false (the additive identity),
+   *        so pairs hold keys only and storage, redistribution, sorting, and sparse matrix products act on keys alone;
+   *        scalars are true unless NULL (the additive identity), so C["ij"] = A["ik"]*B["kj"] gives the pattern of the
+   *        Boolean product and += its union with C, while tensor values read back are undefined (use the keys),
+   *        and dense tensors over this semiring hold no data
+   */
+  class Pattern : public CTF_int::algstrct {
+    public:
+      Pattern() : CTF_int::algstrct(0) { }
+
+      Pattern(Pattern const & other) : CTF_int::algstrct(other) { }
+
+      CTF_int::algstrct * clone() const {
+        return new Pattern(*this);
+      }
+
+      bool is_ordered() const { return false; }
+
+      MPI_Datatype mdtype() const { return MPI_CHAR; }
+
+      MPI_Op addmop() const { return MPI_LOR; }
+
+      char const * addid() const { return NULL; }
+
+      char const * mulid() const {
+        static char const t = 1;
+        return &t;
+      }
+
+      bool has_mul() const { return true; }
+
+      void add(char const * a, char const * b, char * c) const { }
+
+      void accum(char const * a, char * b) const { }
+
+      void mul(char const * a, char const * b, char * c) const { }
+
+      void safemul(char const * a, char const * b, char *& c) const {
+        if (a == NULL || b == NULL){
+          if (c != NULL) CTF_int::cdealloc(c);
+          c = NULL;
+        } else if (c == NULL){
+          c = (char*)CTF_int::alloc(1);
+        }
+      }
+
+      void min(char const * a, char const * b, char * c) const { }
+
+      void max(char const * a, char const * b, char * c) const { }
+
+      void min(char * c) const { }
+
+      void max(char * c) const { }
+
+      void cast_int(int64_t i, char * c) const { }
+
+      void cast_double(double d, char * c) const { }
+
+      int64_t cast_to_int(char const * c) const { return 1; }
+
+      double cast_to_double(char const * c) const { return 1.; }
+
+      void print(char const * a, FILE * fp=stdout) const {
+        fprintf(fp, "1");
+      }
+
+      void scal(int n, char const * alpha, char * X, int incX) const { }
+
+      void axpy(int n, char const * alpha, char const * X, int incX, char * Y, int incY) const { }
+
+      void coo_to_csr(int64_t nz, int nrow, char * csr_vs, int * csr_ja, int * csr_ia, char const * coo_vs, int const * coo_rs, int const * coo_cs) const {
+        // orders the nonzeros by row, then by column, as CTF_int::seq_coo_to_csr does, with no values to move
+        csr_ia[0] = 1;
+        std::fill(csr_ia+1, csr_ia+nrow+1, 0);
+        for (int64_t i=0; i<nz; i++){
+          csr_ia[coo_rs[i]]++;
+        }
+        for (int i=0; i<nrow; i++){
+          csr_ia[i+1] += csr_ia[i];
+        }
+        for (int64_t i=0; i<nz; i++){
+          csr_ja[i] = i;
+        }
+        std::sort(csr_ja, csr_ja+nz, [&](int u, int v){
+          if (coo_rs[u] != coo_rs[v]) return coo_rs[u] < coo_rs[v];
+          return coo_cs[u] < coo_cs[v];
+        });
+        for (int64_t i=0; i<nz; i++){
+          csr_ja[i] = coo_cs[csr_ja[i]];
+        }
+      }
+
+      void csr_to_coo(int64_t nz, int nrow, char const * csr_vs, int const * csr_ja, int const * csr_ia, char * coo_vs, int * coo_rs, int * coo_cs) const {
+        memcpy(coo_cs, csr_ja, sizeof(int)*nz);
+        for (int i=0; i<nrow; i++){
+          std::fill(coo_rs+csr_ia[i]-1, coo_rs+csr_ia[i+1]-1, i+1);
+        }
+      }
+
+      void csrmultcsr
+                (int          m,
+                 int          n,
+                 int          k,
+                 char const * alpha,
+                 char const * A,
+                 int const *  JA,
+                 int const *  IA,
+                 int64_t      nnz_A,
+                 char const * B,
+                 int const *  JB,
+                 int const *  IB,
+                 int64_t      nnz_B,
+                 char const * beta,
+                 char *&      C_CSR) const {
+        add_pattern(CTF_int::spgemm_pattern(m, n, JA, IA, JB, IB), beta, C_CSR);
+      }
+
+      void csrmultcsr
+                (int                         m,
+                 int                         n,
+                 int                         k,
+                 char const *                alpha,
+                 CTF_int::CSR_Matrix const & A,
+                 CTF_int::CSR_Matrix const & B,
+                 char const *                beta,
+                 char *&                     C_CSR) const {
+        add_pattern(CTF_int::spgemm_pattern(m, n, A, B), beta, C_CSR);
+      }
+
+      void masked_csrmultcsr
+                (int                         m,
+                 int                         n,
+                 int                         k,
+                 char const *                alpha,
+                 CTF_int::CSR_Matrix const & A,
+                 CTF_int::CSR_Matrix const & B,
+                 CTF_int::CSR_Matrix const & C) const {
+        printf("CTF ERROR: a masked product can not drop entries of a pattern, which have no values\n");
+        IASSERT(0);
+        assert(0);
+      }
+
+    private:
+      /** \brief sets C_CSR to the pattern P, or to its union with C_CSR if beta is true */
+      void add_pattern(char * P, char const * beta, char *& C_CSR) const {
+        if (C_CSR == NULL || beta == NULL || CTF_int::CSR_Matrix(C_CSR).nnz() == 0){
+          C_CSR = P;
+        } else {
+          C_CSR = this->csr_add(C_CSR, P);
+          CTF_int::cdealloc(P);
+        }
+      }
+  };
+  /**
+   * @}
+   */
+}
+#endif
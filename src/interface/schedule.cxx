@@ -1,5 +1,6 @@
 #include "common.h"
 #include "schedule.h"
+#include "subworld_cache.h"
 
 using namespace CTF_int;
 
@@ -37,7 +38,6 @@ namespace CTF {
     World * world;
 
     std::vector<TensorOperation*> ops;  // operations to execute
-    std::set<Idx_Tensor*, tensor_name_less > local_tensors; // all local tensors used
     std::map<tensor*, tensor*> remap; // mapping from global tensor -> local tensor
 
     std::set<Idx_Tensor*, tensor_name_less > global_tensors; // all referenced tensors stored as global tensors
@@ -69,7 +69,7 @@ namespace CTF {
 
     int max_starting_task = 0;
     int max_num_tasks = 0;
-    int max_cost = 0;
+    double max_cost = 0;
     // Try to find the longest sequence of tasks that aren't too imbalanced
     for (int starting_task=0; starting_task<(int64_t)ready_tasks.size(); starting_task++) {
       double  sum_cost = 0;
@@ -101,7 +101,7 @@ namespace CTF {
     // Do processor division according to estimated cost
     // Algorithm: divide sum_cost into size blocks, and each processor samples the
     // middle of its block to determine which task it works on
-    int color_sample_point = (max_cost / size) * rank + (max_cost / size / 2);
+    double color_sample_point = (max_cost / size) * rank + (max_cost / size / 2);
     int my_color = 0;
     for (int i=0; i<max_num_tasks; i++) {
       my_color = i;
@@ -112,8 +112,30 @@ namespace CTF {
       }
     }
 
-    MPI_Comm my_comm;
-    MPI_Comm_split(world->comm, my_color, rank, &my_comm);
+    // reuse the subworld of a previous execution with the same partition, if it is cached
+    int * colors = (int*)alloc(sizeof(int)*size);
+    MPI_Allgather(&my_color, 1, MPI_INT, colors, 1, MPI_INT, world->comm);
+    // every partition needs a process, so if sampling left one empty, deal the processes out in turn
+    std::vector<int> part_size(max_num_tasks, 0);
+    for (int i=0; i<size; i++) {
+      part_size[colors[i]]++;
+    }
+    if (std::find(part_size.begin(), part_size.end(), 0) != part_size.end()) {
+      for (int i=0; i<size; i++) {
+        colors[i] = i % max_num_tasks;
+      }
+      my_color = colors[rank];
+    }
+    subworld_cache & sc = get_subworld_cache();
+    std::vector<int64_t> sig;
+    bool is_cached = subworld_cache::get_signature(world, colors, sig);
+    cdealloc(colors);
+    subworld * sub = NULL;
+    if (is_cached) sub = sc.lookup(sig);
+    if (sub == NULL){
+      sub = new subworld(world, my_color);
+      if (is_cached) sc.insert(sig, sub);
+    }
 
     if (rank == 0) {
       std::cout << "Maxparts " << max_colors << ", start " << max_starting_task <<
@@ -129,7 +151,7 @@ namespace CTF {
       comm_ops.push_back(PartitionOps());
       comm_ops[color].color = color;
       if (color == my_color) {
-        comm_ops[color].world = new World(my_comm);
+        comm_ops[color].world = sub->wrld;
       } else {
         comm_ops[color].world = NULL;
       }
@@ -158,15 +180,19 @@ namespace CTF {
     for (comm_op_iter=comm_ops.begin(); comm_op_iter!=comm_ops.end(); comm_op_iter++) {
       typename std::set<Idx_Tensor*, tensor_name_less >::iterator global_tensor_iter;
       for (global_tensor_iter=comm_op_iter->global_tensors.begin(); global_tensor_iter!=comm_op_iter->global_tensors.end(); global_tensor_iter++) {
-        Idx_Tensor* local_clone;
+        tensor * global_tsr = (*global_tensor_iter)->parent;
         if (comm_op_iter->world != NULL) {
-          local_clone = new Idx_Tensor(*(*global_tensor_iter));//, *comm_op_iter->world);
+          // tensors kept on a cached subworld are overwritten rather than created again
+          tensor * local_tsr = sub->get_tensor(global_tsr);
+          comm_op_iter->remap[global_tsr] = local_tsr;
+          global_tsr->add_to_subworld(local_tsr, global_tsr->sr->mulid(), global_tsr->sr->addid());
         } else {
-          local_clone = NULL;
+          comm_op_iter->remap[global_tsr] = NULL;
+          tensor no_tsr;
+          no_tsr.sr = global_tsr->sr->clone();
+          global_tsr->add_to_subworld(&no_tsr, global_tsr->sr->mulid(), global_tsr->sr->addid());
+          delete no_tsr.sr;
         }
-        comm_op_iter->local_tensors.insert(local_clone);
-        comm_op_iter->remap[(*global_tensor_iter)->parent] = local_clone->parent;
-        (*global_tensor_iter)->parent->add_to_subworld(local_clone->parent, (*global_tensor_iter)->sr->mulid(), (*global_tensor_iter)->sr->addid());
       }
       typename std::set<Idx_Tensor*, tensor_name_less >::iterator output_tensor_iter;
       for (output_tensor_iter=comm_op_iter->output_tensors.begin(); output_tensor_iter!=comm_op_iter->output_tensors.end(); output_tensor_iter++) {
@@ -203,18 +229,24 @@ namespace CTF {
     for (comm_op_iter=comm_ops.begin(); comm_op_iter!=comm_ops.end(); comm_op_iter++) {
       typename std::set<Idx_Tensor*, tensor_name_less >::iterator output_tensor_iter;
       for (output_tensor_iter=comm_op_iter->output_tensors.begin(); output_tensor_iter!=comm_op_iter->output_tensors.end(); output_tensor_iter++) {
-        (*output_tensor_iter)->parent->add_from_subworld(comm_op_iter->remap[(*output_tensor_iter)->parent], (*output_tensor_iter)->sr->mulid(), (*output_tensor_iter)->sr->addid());
+        tensor * global_tsr = (*output_tensor_iter)->parent;
+        if (comm_op_iter->world != NULL) {
+          global_tsr->add_from_subworld(comm_op_iter->remap[global_tsr], global_tsr->sr->mulid(), global_tsr->sr->addid());
+        } else {
+          tensor no_tsr;
+          no_tsr.sr = global_tsr->sr->clone();
+          global_tsr->add_from_subworld(&no_tsr, global_tsr->sr->mulid(), global_tsr->sr->addid());
+          delete no_tsr.sr;
+        }
       }
     }
     schedule_timer.comm_up_time = MPI_Wtime() - schedule_timer.comm_up_time;
 
-    // Clean up local tensors & world
-    if ((int64_t)comm_ops.size() > my_color) {
-      typename std::set<Idx_Tensor*, tensor_name_less >::iterator local_tensor_iter;
-      for (local_tensor_iter=comm_ops[my_color].local_tensors.begin(); local_tensor_iter!=comm_ops[my_color].local_tensors.end(); local_tensor_iter++) {
-        delete *local_tensor_iter;
-      }
-      delete comm_ops[my_color].world;
+    // Clean up local tensors & world, unless they are kept for later executions
+    if (!is_cached) {
+      delete sub;
+    } else {
+      sub->drop_unused();
     }
 
     // Update ready tasks
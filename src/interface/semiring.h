@@ -2,7 +2,11 @@
 #define __SEMIRING_H__
 
 #include "functions.h"
+#include "semiring_gemm.h"
+#include "semiring_seq.h"
 #include "../sparse_formats/csr.h"
+#include "../sparse_formats/spgemm.h"
+#include "../sparse_formats/csf.h"
 
 
 namespace CTF_int {
@@ -13,6 +17,42 @@ namespace CTF_int {
     return a*b;
   }
 
+  /**
+   * \brief default addition as a functor, so that it is inlined into templated kernels for arithmetic types,
+   *        other types call the given addition function
+   */
+  template <typename dtype, bool is_arith=std::is_arithmetic<dtype>::value>
+  struct default_add_op {
+    dtype (*fadd)(dtype, dtype);
+    default_add_op(dtype (*fadd_)(dtype, dtype)) : fadd(fadd_) { }
+    dtype operator()(dtype a, dtype b) const { return default_add<dtype>(a,b); }
+  };
+
+  template <typename dtype>
+  struct default_add_op<dtype, false> {
+    dtype (*fadd)(dtype, dtype);
+    default_add_op(dtype (*fadd_)(dtype, dtype)) : fadd(fadd_) { }
+    dtype operator()(dtype a, dtype b) const { return fadd(a,b); }
+  };
+
+  /**
+   * \brief default multiplication as a functor, so that it is inlined into templated kernels for arithmetic types,
+   *        other types call the given multiplication function
+   */
+  template <typename dtype, bool is_arith=std::is_arithmetic<dtype>::value>
+  struct default_mul_op {
+    dtype (*fmul)(dtype, dtype);
+    default_mul_op(dtype (*fmul_)(dtype, dtype)) : fmul(fmul_) { }
+    dtype operator()(dtype a, dtype b) const { return default_mul<dtype>(a,b); }
+  };
+
+  template <typename dtype>
+  struct default_mul_op<dtype, false> {
+    dtype (*fmul)(dtype, dtype);
+    default_mul_op(dtype (*fmul_)(dtype, dtype)) : fmul(fmul_) { }
+    dtype operator()(dtype a, dtype b) const { return fmul(a,b); }
+  };
+
   template <typename dtype>
   void default_axpy(int           n,
                     dtype         alpha,
@@ -76,31 +116,13 @@ namespace CTF_int {
                     dtype const * B,
                     dtype         beta,
                     dtype *       C){
-    int i,j,l;
-    int istride_A, lstride_A, jstride_B, lstride_B;
     //TAU_FSTART(default_gemm);
-    if (tA == 'N' || tA == 'n'){
-      istride_A=1; 
-      lstride_A=m; 
-    } else {
-      istride_A=k; 
-      lstride_A=1; 
-    }
-    if (tB == 'N' || tB == 'n'){
-      jstride_B=k; 
-      lstride_B=1; 
-    } else {
-      jstride_B=1; 
-      lstride_B=n; 
-    }
-    for (j=0; j<n; j++){
-      for (i=0; i<m; i++){
-        C[j*m+i] *= beta;
-        for (l=0; l<k; l++){
-          C[j*m+i] += alpha*A[istride_A*i+lstride_A*l]*B[lstride_B*l+jstride_B*j];
-        }
-      }
+    for (int64_t i=0; i<((int64_t)m)*n; i++){
+      C[i] *= beta;
     }
+    srgemm(tA, tB, m, n, k, &alpha, A, B, C,
+           [](dtype a, dtype b) -> dtype { return a+b; },
+           [](dtype a, dtype b) -> dtype { return a*b; });
     //TAU_FSTOP(default_gemm);
   }
 
@@ -209,6 +231,267 @@ namespace CTF_int {
   void default_coomm< std::complex<double> >
      (int,int,int,std::complex<double>,std::complex<double> const *,int const *,int const *,int,std::complex<double> const *,std::complex<double>,std::complex<double> *);
 
+  /**
+   * \brief X["i"]=alpha*X["i"] for an arbitrary semiring
+   * \param[in] n number of elements
+   * \param[in] alpha scaling factor
+   * \param[in,out] X vector
+   * \param[in] incX stride of X
+   * \param[in] fmul multiplication operator (function pointer or functor)
+   */
+  template <typename dtype, typename fmul_t>
+  void sr_scal(int     n,
+               dtype   alpha,
+               dtype * X,
+               int     incX,
+               fmul_t  fmul){
+    for (int64_t i=0; i<n; i++){
+      X[i*incX] = fmul(alpha, X[i*incX]);
+    }
+  }
+
+  /**
+   * \brief Y["i"]+=alpha*X["i"] for an arbitrary semiring
+   * \param[in] n number of elements
+   * \param[in] alpha scaling factor
+   * \param[in] X vector to add
+   * \param[in] incX stride of X
+   * \param[in,out] Y vector to add to
+   * \param[in] incY stride of Y
+   * \param[in] fadd addition operator (function pointer or functor)
+   * \param[in] fmul multiplication operator (function pointer or functor)
+   */
+  template <typename dtype, typename fadd_t, typename fmul_t>
+  void sr_axpy(int           n,
+               dtype         alpha,
+               dtype const * X,
+               int           incX,
+               dtype *       Y,
+               int           incY,
+               fadd_t        fadd,
+               fmul_t        fmul){
+    for (int64_t i=0; i<n; i++){
+      Y[i*incY] = fadd(fmul(alpha, X[i*incX]), Y[i*incY]);
+    }
+  }
+
+  /**
+   * \brief C["ij"]+=alpha*A["ik"]*B["kj"] for an arbitrary semiring with A in 1-based coordinate format,
+   *        any scaling of C by beta must be done by the caller
+   * \param[in] m number of rows of A and C
+   * \param[in] n number of columns of B and C
+   * \param[in] k number of columns of A and rows of B
+   * \param[in] alpha scaling factor
+   * \param[in] A nonzeros of A
+   * \param[in] rows_A row indices of nonzeros of A
+   * \param[in] cols_A column indices of nonzeros of A
+   * \param[in] nnz_A number of nonzeros of A
+   * \param[in] B dense column-major k-by-n matrix
+   * \param[in,out] C dense column-major m-by-n matrix
+   * \param[in] fadd addition operator (function pointer or functor)
+   * \param[in] fmul multiplication operator (function pointer or functor)
+   */
+  template <typename dtype, typename idx_t, typename fadd_t, typename fmul_t>
+  void sr_coomm(int           m,
+                int           n,
+                int           k,
+                dtype         alpha,
+                dtype const * A,
+                idx_t const * rows_A,
+                idx_t const * cols_A,
+                int64_t       nnz_A,
+                dtype const * B,
+                dtype *       C,
+                fadd_t        fadd,
+                fmul_t        fmul){
+    for (int64_t i=0; i<nnz_A; i++){
+      int row_A = rows_A[i]-1;
+      int col_A = cols_A[i]-1;
+      for (int col_C=0; col_C<n; col_C++){
+        C[((int64_t)col_C)*m+row_A] = fadd(fmul(alpha,fmul(A[i],B[((int64_t)col_C)*k+col_A])), C[((int64_t)col_C)*m+row_A]);
+      }
+    }
+  }
+
+  /**
+   * \brief C["ij"]=beta*C["ij"]+alpha*A["ik"]*B["kj"] for an arbitrary semiring with A in 1-based CSR format
+   * \param[in] m number of rows of A and C
+   * \param[in] n number of columns of B and C
+   * \param[in] k number of columns of A and rows of B
+   * \param[in] alpha scaling factor
+   * \param[in] A nonzeros of A
+   * \param[in] JA column indices of nonzeros of A
+   * \param[in] IA row offsets of A
+   * \param[in] B dense column-major k-by-n matrix
+   * \param[in] beta scaling factor of C
+   * \param[in,out] C dense column-major m-by-n matrix
+   * \param[in] fadd addition operator (function pointer or functor)
+   * \param[in] fmul multiplication operator (function pointer or functor)
+   */
+  template <typename dtype, typename idx_t, typename fadd_t, typename fmul_t>
+  void sr_csrmm(int           m,
+                int           n,
+                int           k,
+                dtype         alpha,
+                dtype const * A,
+                idx_t const * JA,
+                idx_t const * IA,
+                dtype const * B,
+                dtype         beta,
+                dtype *       C,
+                fadd_t        fadd,
+                fmul_t        fmul){
+#ifdef _OPENMP
+    #pragma omp parallel for
+#endif
+    for (int row_A=0; row_A<m; row_A++){
+      for (int col_B=0; col_B<n; col_B++){
+        int64_t i_C = ((int64_t)col_B)*m+row_A;
+        dtype const * B_col = B+((int64_t)col_B)*k;
+        C[i_C] = fmul(beta,C[i_C]);
+        if (IA[row_A] < IA[row_A+1]){
+          int64_t i_A1 = IA[row_A]-1;
+          int col_A1 = JA[i_A1]-1;
+          dtype tmp = fmul(A[i_A1],B_col[col_A1]);
+          for (int64_t i_A=IA[row_A]; i_A<IA[row_A+1]-1; i_A++){
+            int col_A = JA[i_A]-1;
+            tmp = fadd(tmp, fmul(A[i_A],B_col[col_A]));
+          }
+          C[i_C] = fadd(C[i_C], fmul(alpha,tmp));
+        }
+      }
+    }
+  }
+
+  /**
+   * \brief C["ij"]+=alpha*A["ik"]*B["kj"] for an arbitrary semiring with A and B in 1-based CSR format
+   *        and C dense, any scaling of C by beta must be done by the caller
+   * \param[in] m number of rows of A and C
+   * \param[in] n number of columns of B and C
+   * \param[in] k number of columns of A and rows of B
+   * \param[in] alpha scaling factor, NULL if it is the multiplicative identity
+   * \param[in] A nonzeros of A
+   * \param[in] JA column indices of nonzeros of A
+   * \param[in] IA row offsets of A
+   * \param[in] B nonzeros of B
+   * \param[in] JB column indices of nonzeros of B
+   * \param[in] IB row offsets of B
+   * \param[in,out] C dense column-major m-by-n matrix
+   * \param[in] fadd addition operator (function pointer or functor)
+   * \param[in] fmul multiplication operator (function pointer or functor)
+   */
+  template <typename dtype, typename idx_t, typename fadd_t, typename fmul_t>
+  void sr_csrmultd(int           m,
+                   int           n,
+                   int           k,
+                   dtype const * alpha,
+                   dtype const * A,
+                   idx_t const * JA,
+                   idx_t const * IA,
+                   dtype const * B,
+                   idx_t const * JB,
+                   idx_t const * IB,
+                   dtype *       C,
+                   fadd_t        fadd,
+                   fmul_t        fmul){
+#ifdef _OPENMP
+    #pragma omp parallel for
+#endif
+    for (int row_A=0; row_A<m; row_A++){
+      for (int64_t i_A=IA[row_A]-1; i_A<IA[row_A+1]-1; i_A++){
+        int row_B = JA[i_A]-1; //=col_A
+        dtype a = alpha == NULL ? A[i_A] : fmul(alpha[0],A[i_A]);
+        for (int64_t i_B=IB[row_B]-1; i_B<IB[row_B+1]-1; i_B++){
+          int64_t i_C = ((int64_t)(JB[i_B]-1))*m+row_A;
+          C[i_C] = fadd(C[i_C], fmul(a,B[i_B]));
+        }
+      }
+    }
+  }
+
+  /**
+   * \brief sr_coomm with A given as a serialized COO matrix, instantiated for the index width of A
+   */
+  template <typename dtype, typename fadd_t, typename fmul_t>
+  void sr_coomm(int                m,
+                int                n,
+                int                k,
+                dtype              alpha,
+                COO_Matrix const & A,
+                dtype const *      B,
+                dtype *            C,
+                fadd_t             fadd,
+                fmul_t             fmul){
+    dtype const * vA = (dtype const *)A.vals();
+    switch (A.idx_width()){
+      case 2:
+        sr_coomm(m, n, k, alpha, vA, (int16_t const*)A.rows_raw(), (int16_t const*)A.cols_raw(), A.nnz(), B, C, fadd, fmul);
+        break;
+      case 4:
+        sr_coomm(m, n, k, alpha, vA, (int32_t const*)A.rows_raw(), (int32_t const*)A.cols_raw(), A.nnz(), B, C, fadd, fmul);
+        break;
+      default:
+        sr_coomm(m, n, k, alpha, vA, (int64_t const*)A.rows_raw(), (int64_t const*)A.cols_raw(), A.nnz(), B, C, fadd, fmul);
+        break;
+    }
+  }
+
+  /**
+   * \brief sr_csrmm with A given as a serialized CSR matrix, instantiated for the index width of A
+   */
+  template <typename dtype, typename fadd_t, typename fmul_t>
+  void sr_csrmm(int                m,
+                int                n,
+                int                k,
+                dtype              alpha,
+                CSR_Matrix const & A,
+                dtype const *      B,
+                dtype              beta,
+                dtype *            C,
+                fadd_t             fadd,
+                fmul_t             fmul){
+    dtype const * vA = (dtype const *)A.vals();
+    switch (A.idx_width()){
+      case 2:
+        sr_csrmm(m, n, k, alpha, vA, (int16_t const*)A.JA_raw(), (int16_t const*)A.IA_raw(), B, beta, C, fadd, fmul);
+        break;
+      case 4:
+        sr_csrmm(m, n, k, alpha, vA, (int32_t const*)A.JA_raw(), (int32_t const*)A.IA_raw(), B, beta, C, fadd, fmul);
+        break;
+      default:
+        sr_csrmm(m, n, k, alpha, vA, (int64_t const*)A.JA_raw(), (int64_t const*)A.IA_raw(), B, beta, C, fadd, fmul);
+        break;
+    }
+  }
+
+  /**
+   * \brief sr_csrmultd with A and B given as serialized CSR matrices of the same index width, instantiated for that width
+   */
+  template <typename dtype, typename fadd_t, typename fmul_t>
+  void sr_csrmultd(int                m,
+                   int                n,
+                   int                k,
+                   dtype const *      alpha,
+                   CSR_Matrix const & A,
+                   CSR_Matrix const & B,
+                   dtype *            C,
+                   fadd_t             fadd,
+                   fmul_t             fmul){
+    assert(A.idx_width() == B.idx_width());
+    dtype const * vA = (dtype const *)A.vals();
+    dtype const * vB = (dtype const *)B.vals();
+    switch (A.idx_width()){
+      case 2:
+        sr_csrmultd(m, n, k, alpha, vA, (int16_t const*)A.JA_raw(), (int16_t const*)A.IA_raw(), vB, (int16_t const*)B.JA_raw(), (int16_t const*)B.IA_raw(), C, fadd, fmul);
+        break;
+      case 4:
+        sr_csrmultd(m, n, k, alpha, vA, (int32_t const*)A.JA_raw(), (int32_t const*)A.IA_raw(), vB, (int32_t const*)B.JA_raw(), (int32_t const*)B.IA_raw(), C, fadd, fmul);
+        break;
+      default:
+        sr_csrmultd(m, n, k, alpha, vA, (int64_t const*)A.JA_raw(), (int64_t const*)A.IA_raw(), vB, (int64_t const*)B.JA_raw(), (int64_t const*)B.IA_raw(), C, fadd, fmul);
+        break;
+    }
+  }
 
 }
 
@@ -334,13 +617,7 @@ namespace CTF {
                 char       * X,
                 int          incX)  const {
         if (fscal != NULL) fscal(n, ((dtype const *)alpha)[0], (dtype *)X, incX);
-        else {
-          dtype const a = ((dtype*)alpha)[0];
-          dtype * dX    = (dtype*) X;
-          for (int64_t i=0; i<n; i++){
-            dX[i] = fmul(a,dX[i]);
-          }
-        }
+        else CTF_int::sr_scal(n, ((dtype const *)alpha)[0], (dtype *)X, incX, fmul);
       }
 
       /** \brief Y["i"]+=alpha*X["i"]; */
@@ -351,16 +628,7 @@ namespace CTF {
                 char       * Y,
                 int          incY)  const {
         if (faxpy != NULL) faxpy(n, ((dtype const *)alpha)[0], (dtype const *)X, incX, (dtype *)Y, incY);
-        else {
-          assert(incX==1);
-          assert(incY==1);
-          dtype a           = ((dtype*)alpha)[0];
-          dtype const * dX = (dtype*) X;
-          dtype * dY       = (dtype*) Y;
-          for (int64_t i=0; i<n; i++){
-            dY[i] = this->fadd(fmul(a,dX[i]), dY[i]);
-          }
-        }
+        else CTF_int::sr_axpy(n, ((dtype const *)alpha)[0], (dtype const *)X, incX, (dtype *)Y, incY, this->fadd, fmul);
       }
 
       /** \brief beta*C["ij"]=alpha*A^tA["ik"]*B^tB["kj"]; */
@@ -377,51 +645,14 @@ namespace CTF {
         if (fgemm != NULL) fgemm(tA, tB, m, n, k, ((dtype const *)alpha)[0], (dtype const *)A, (dtype const *)B, ((dtype const *)beta)[0], (dtype *)C);
         else {
           //TAU_FSTART(sring_gemm);
-          dtype const * dA = (dtype const *) A;
-          dtype const * dB = (dtype const *) B;
-          dtype * dC       = (dtype*) C;
           if (!this->isequal(beta, this->mulid())){
             scal(m*n, beta, C, 1);
           }  
-          int lda_Cj, lda_Ci, lda_Al, lda_Ai, lda_Bj, lda_Bl;
-          lda_Cj = m;
-          lda_Ci = 1;
-          if (tA == 'N'){
-            lda_Al = m;
-            lda_Ai = 1;
-          } else {
-            assert(tA == 'T');
-            lda_Al = 1;
-            lda_Ai = k;
-          } 
-          if (tB == 'N'){
-            lda_Bj = k;
-            lda_Bl = 1;
-          } else {
-            assert(tB == 'T');
-            lda_Bj = 1;
-            lda_Bl = n;
-          } 
-          if (!this->isequal(alpha, this->mulid())){
-            dtype a          = ((dtype*)alpha)[0];
-            for (int64_t j=0; j<n; j++){
-              for (int64_t i=0; i<m; i++){
-                for (int64_t l=0; l<k; l++){
-                  //dC[j*m+i] = this->fadd(fmul(a,fmul(dA[l*m+i],dB[j*k+l])), dC[j*m+i]);
-                  dC[j*lda_Cj+i*lda_Ci] = this->fadd(fmul(a,fmul(dA[l*lda_Al+i*lda_Ai],dB[j*lda_Bj+l*lda_Bl])), dC[j*lda_Cj+i*lda_Ci]);
-                }
-              }
-            }
-          } else {
-            for (int64_t j=0; j<n; j++){
-              for (int64_t i=0; i<m; i++){
-                for (int64_t l=0; l<k; l++){
-                  //dC[j*m+i] = this->fadd(fmul(a,fmul(dA[l*m+i],dB[j*k+l])), dC[j*m+i]);
-                  dC[j*lda_Cj+i*lda_Ci] = this->fadd(fmul(dA[l*lda_Al+i*lda_Ai],dB[j*lda_Bj+l*lda_Bl]), dC[j*lda_Cj+i*lda_Ci]);
-                }
-              }
-            }
-          }
+          assert(tA == 'N' || tA == 'T');
+          assert(tB == 'N' || tB == 'T');
+          dtype const * a = NULL;
+          if (!this->isequal(alpha, this->mulid())) a = (dtype const *)alpha;
+          CTF_int::srgemm(tA, tB, m, n, k, a, (dtype const *)A, (dtype const *)B, (dtype *)C, this->fadd, fmul);
           //TAU_FSTOP(sring_gemm);
         } 
       }
@@ -452,20 +683,7 @@ namespace CTF {
         }
         if (func == NULL && alpha != NULL && this->isequal(beta,mulid())){
           //TAU_FSTART(func_coomm);
-          dtype const * dA = (dtype const*)A;
-          dtype const * dB = (dtype const*)B;
-          dtype * dC = (dtype*)C;
-          dtype a = ((dtype*)alpha)[0];
-          if (!this->isequal(beta, this->mulid())){
-            scal(m*n, beta, C, 1);
-          }  
-          for (int64_t i=0; i<nnz_A; i++){
-            int row_A = rows_A[i]-1;
-            int col_A = cols_A[i]-1;
-            for (int col_C=0; col_C<n; col_C++){
-              dC[col_C*m+row_A] = this->fadd(fmul(a,fmul(dA[i],dB[col_C*k+col_A])), dC[col_C*m+row_A]);
-            }
-          }
+          CTF_int::sr_coomm(m, n, k, ((dtype const *)alpha)[0], (dtype const *)A, rows_A, cols_A, nnz_A, (dtype const *)B, (dtype *)C, this->fadd, fmul);
           //TAU_FSTOP(func_coomm);
         } else { assert(0); }
       }
@@ -483,27 +701,7 @@ namespace CTF {
                       dtype const * B,
                       dtype         beta,
                       dtype *       C) const {
-#ifdef _OPENMP
-        #pragma omp parallel for
-#endif
-        for (int row_A=0; row_A<m; row_A++){
-#ifdef _OPENMP
-          #pragma omp parallel for
-#endif
-          for (int col_B=0; col_B<n; col_B++){
-            C[col_B*m+row_A] = this->fmul(beta,C[col_B*m+row_A]);
-            if (IA[row_A] < IA[row_A+1]){
-              int i_A1 = IA[row_A]-1;
-              int col_A1 = JA[i_A1]-1;
-              dtype tmp = this->fmul(A[i_A1],B[col_B*k+col_A1]);
-              for (int i_A=IA[row_A]; i_A<IA[row_A+1]-1; i_A++){
-                int col_A = JA[i_A]-1;
-                tmp = this->fadd(tmp, this->fmul(A[i_A],B[col_B*k+col_A]));
-              }
-              C[col_B*m+row_A] = this->fadd(C[col_B*m+row_A], this->fmul(alpha,tmp));
-            }
-          }
-        }
+        CTF_int::sr_csrmm(m, n, k, alpha, A, JA, IA, B, beta, C, this->fadd, this->fmul);
       }
 
 //      void (*fcsrmultd)(int,int,int,dtype const*,int const*,int const*,dtype const*,int const*, int const*,dtype*,int);
@@ -523,7 +721,11 @@ namespace CTF {
                  CTF_int::bivar_function const * func) const {
         assert(!this->has_coo_ker);
         assert(func == NULL);
-        this->default_csrmm(m,n,k,((dtype*)alpha)[0],(dtype*)A,JA,IA,nnz_A,(dtype*)B,((dtype*)beta)[0],(dtype*)C);
+        if (is_def){
+          this->default_csrmm(m,n,k,((dtype*)alpha)[0],(dtype*)A,JA,IA,nnz_A,(dtype*)B,((dtype*)beta)[0],(dtype*)C);
+        } else {
+          CTF_int::sr_csrmm(m,n,k,((dtype*)alpha)[0],(dtype*)A,JA,IA,(dtype*)B,((dtype*)beta)[0],(dtype*)C,this->fadd,fmul);
+        }
       }
 
       void default_csrmultd
@@ -541,27 +743,32 @@ namespace CTF {
                       int           nnz_B,
                       dtype         beta,
                       dtype *       C) const {
-        
+        this->gen_csrmultd(m,n,k,alpha,A,JA,IA,nnz_A,B,JB,IB,nnz_B,beta,C);
+      }
+
+      void gen_csrmultd
+                     (int           m,
+                      int           n,
+                      int           k,
+                      dtype         alpha,
+                      dtype const * A,
+                      int const *   JA,
+                      int const *   IA,
+                      int           nnz_A,
+                      dtype const * B,
+                      int const *   JB,
+                      int const *   IB,
+                      int           nnz_B,
+                      dtype         beta,
+                      dtype *       C) const {
         if (!this->isequal((char const*)&beta, this->mulid())){
           this->scal(m*n, (char const *)&beta, (char*)C, 1);
         }
-#ifdef _OPENMP
-        #pragma omp parallel for
-#endif
-        for (int row_A=0; row_A<m; row_A++){
-          for (int i_A=IA[row_A]-1; i_A<IA[row_A+1]-1; i_A++){
-            int row_B = JA[i_A]-1; //=col_A
-            for (int i_B=IB[row_B]-1; i_B<IB[row_B+1]-1; i_B++){
-              int col_B = JB[i_B]-1;
-              if (!this->isequal((char const*)&alpha, this->mulid()))
-                this->fadd(C[col_B*m+row_A], this->fmul(alpha,this->fmul(A[i_A],B[i_B])));
-              else
-                this->fadd(C[col_B*m+row_A], this->fmul(A[i_A],B[i_B]));
-            }
-          }
-        }
-      
-}
+        dtype const * a = NULL;
+        if (!this->isequal((char const*)&alpha, this->mulid())) a = &alpha;
+        CTF_int::sr_csrmultd(m, n, k, a, A, JA, IA, B, JB, IB, C, this->fadd, this->fmul);
+      }
+
       void gen_csrmultcsr
                       (int          m, 
                       int           n,
@@ -577,89 +784,36 @@ namespace CTF {
                       int           nnz_B,
                       dtype         beta,
                       char *&       C_CSR) const {
-        int * IC = (int*)CTF_int::alloc(sizeof(int)*(m+1));
-        memset(IC, 0, sizeof(int)*(m+1));
-#ifdef _OPENMP
-        #pragma omp parallel
-        {
-#endif
-          int * has_col = (int*)CTF_int::alloc(sizeof(int)*(n+1)); //n is the num of col of B
-          int nnz = 0;
-#ifdef _OPENMP
-          #pragma omp for schedule(dynamic) // TO DO test other strategies
-#endif         
-          for (int i=0; i<m; i++){
-            memset(has_col, 0, sizeof(int)*(n+1)); 
-            nnz = 0;
-            for (int j=0; j<IA[i+1]-IA[i]; j++){
-              int row_B = JA[IA[i]+j-1]-1;
-              for (int kk=0; kk<IB[row_B+1]-IB[row_B]; kk++){
-                int idx_B = IB[row_B]+kk-1;
-                if (has_col[JB[idx_B]] == 0){
-                  nnz++;
-                  has_col[JB[idx_B]] = 1;
-                }
-              }
-              IC[i+1]=nnz;
-            }
-          }
-          CTF_int::cdealloc(has_col);
-#ifdef _OPENMP
-        } // END PARALLEL 
-#endif 
-        int ic_prev = 1;
-        for(int i=0;i < m+1; i++){
-          ic_prev += IC[i];
-          IC[i] = ic_prev;
-        }
-        CTF_int::CSR_Matrix C(IC[m]-1, m, n, sizeof(dtype));
-        dtype * vC = (dtype*)C.vals();
-        this->set((char *)vC, this->addid(), IC[m]+1);
-        int * JC = C.JA();
-        memcpy(C.IA(), IC, sizeof(int)*(m+1));
-        CTF_int::cdealloc(IC);
-        IC = C.IA();
-#ifdef _OPENMP        
-        #pragma omp parallel
-        {
-#endif      
-          int ins = 0;
-          int *dcol = (int *) CTF_int::alloc(n*sizeof(int));
-          dtype *acc_data = (dtype*)CTF_int::alloc(n*sizeof (dtype));
-#ifdef _OPENMP
-          #pragma omp for
-#endif            
-          for (int i=0; i<m; i++){
-            std::fill(acc_data, acc_data+n, this->taddid); 
-            memset(dcol, 0, sizeof(int)*(n));
-            ins = 0;
-            for (int j=0; j<IA[i+1]-IA[i]; j++){
-              int row_b = JA[IA[i]+j-1]-1; // 1-based
-              int idx_a = IA[i]+j-1;
-              for (int ii = 0; ii < IB[row_b+1]-IB[row_b]; ii++){
-                int col_b = IB[row_b]+ii-1;
-                int col_c = JB[col_b]-1; // 1-based
-                dtype val = fmul(A[idx_a], B[col_b]);
-                if (dcol[col_c] == 0){
-                  dcol[col_c] = JB[col_b];
-                }
-                //acc_data[col_c] += val;
-                acc_data[col_c]= this->fadd(acc_data[col_c], val);
-              }
-            }
-            for(int jj = 0; jj < n; jj++){
-              if (dcol[jj] != 0){
-                JC[IC[i]+ins-1] = dcol[jj];
-                vC[IC[i]+ins-1] = acc_data[jj];
-                ++ins;
-              }
-            }
-          }
-          CTF_int::cdealloc(dcol);
-          CTF_int::cdealloc(acc_data);
-#ifdef _OPENMP
-        } //PRAGMA END
-#endif  
+        this->gen_csrmultcsr(m,n,k,alpha,A,JA,IA,nnz_A,B,JB,IB,nnz_B,beta,C_CSR,this->fadd,this->fmul);
+      }
+
+      /**
+       * \brief CSR sparse matrix product for an arbitrary semiring with a dense, hash, or heap accumulator
+       *        per row of C (see CTF_int::spgemm), templated on the operators so that functors are inlined
+       *        into the loop and on the index type of A and B, the index width of C is chosen from its
+       *        number of nonzeros
+       */
+      template <typename idx_t, typename fadd_t, typename fmul_t>
+      void gen_csrmultcsr
+                      (int           m, 
+                      int            n,
+                      int            k, 
+                      dtype          alpha,
+                      dtype const *  A, // A m by k
+                      idx_t const *  JA,
+                      idx_t const *  IA,
+                      int64_t        nnz_A,
+                      dtype const *  B, // B k by n
+                      idx_t const *  JB,
+                      idx_t const *  IB,
+                      int64_t        nnz_B,
+                      dtype          beta,
+                      char *&        C_CSR,
+                      fadd_t         fadd_op,
+                      fmul_t         fmul_op) const {
+        CTF_int::CSR_Matrix C(CTF_int::spgemm<dtype>(m, n, JA, IA, JB, IB,
+                                [&](int64_t ia, int64_t ib){ return fmul_op(A[ia], B[ib]); },
+                                [&](dtype & c, dtype const & v){ c = fadd_op(c, v); }));
         CTF_int::CSR_Matrix C_in(C_CSR);
         if (!this->isequal((char const *)&alpha, this->mulid())){
           this->scal(C.nnz(), (char const *)&alpha, C.vals(), 1);
@@ -676,6 +830,37 @@ namespace CTF {
         }
       }
 
+      /**
+       * \brief gen_csrmultcsr with A and B given as serialized CSR matrices of the same index width
+       */
+      template <typename fadd_t, typename fmul_t>
+      void gen_csrmultcsr
+                      (int                         m, 
+                      int                          n,
+                      int                          k, 
+                      dtype                        alpha,
+                      CTF_int::CSR_Matrix const &  A,
+                      CTF_int::CSR_Matrix const &  B,
+                      dtype                        beta,
+                      char *&                      C_CSR,
+                      fadd_t                       fadd_op,
+                      fmul_t                       fmul_op) const {
+        assert(A.idx_width() == B.idx_width());
+        dtype const * vA = (dtype const *)A.vals();
+        dtype const * vB = (dtype const *)B.vals();
+        switch (A.idx_width()){
+          case 2:
+            this->gen_csrmultcsr(m,n,k,alpha,vA,(int16_t const*)A.JA_raw(),(int16_t const*)A.IA_raw(),A.nnz(),vB,(int16_t const*)B.JA_raw(),(int16_t const*)B.IA_raw(),B.nnz(),beta,C_CSR,fadd_op,fmul_op);
+            break;
+          case 4:
+            this->gen_csrmultcsr(m,n,k,alpha,vA,(int32_t const*)A.JA_raw(),(int32_t const*)A.IA_raw(),A.nnz(),vB,(int32_t const*)B.JA_raw(),(int32_t const*)B.IA_raw(),B.nnz(),beta,C_CSR,fadd_op,fmul_op);
+            break;
+          default:
+            this->gen_csrmultcsr(m,n,k,alpha,vA,(int64_t const*)A.JA_raw(),(int64_t const*)A.IA_raw(),A.nnz(),vB,(int64_t const*)B.JA_raw(),(int64_t const*)B.IA_raw(),B.nnz(),beta,C_CSR,fadd_op,fmul_op);
+            break;
+        }
+      }
+
 
      /* void gen_csrmultcsr_old
                      (int           m,
@@ -785,7 +970,11 @@ namespace CTF {
                  int64_t      nnz_B,
                  char const * beta,
                  char *       C) const {
-        this->default_csrmultd(m,n,k,((dtype const*)alpha)[0],(dtype const*)A,JA,IA,nnz_A,(dtype const*)B,JB,IB,nnz_B,((dtype const*)beta)[0],(dtype*)C);
+        if (is_def){
+          this->default_csrmultd(m,n,k,((dtype const*)alpha)[0],(dtype const*)A,JA,IA,nnz_A,(dtype const*)B,JB,IB,nnz_B,((dtype const*)beta)[0],(dtype*)C);
+        } else {
+          this->gen_csrmultd(m,n,k,((dtype const*)alpha)[0],(dtype const*)A,JA,IA,nnz_A,(dtype const*)B,JB,IB,nnz_B,((dtype const*)beta)[0],(dtype*)C);
+        }
       }
 
 
@@ -812,7 +1001,391 @@ namespace CTF {
         }
       }
 
+      /** \brief coomm on a serialized COO matrix, blocks with 32-bit indices or a custom 32-bit kernel use the coomm above */
+      void coomm(int                         m,
+                 int                         n,
+                 int                         k,
+                 char const *                alpha,
+                 CTF_int::COO_Matrix const & A,
+                 char const *                B,
+                 char const *                beta,
+                 char *                      C) const {
+        if (A.idx_width() == sizeof(int) || (fcoomm != NULL && !is_def)){
+          CTF_int::algstrct::coomm(m, n, k, alpha, A, B, beta, C);
+          return;
+        }
+        if (!this->isequal(beta, this->mulid())){
+          this->scal(m*n, beta, C, 1);
+        }
+        if (is_def)
+          CTF_int::sr_coomm(m, n, k, ((dtype const *)alpha)[0], A, (dtype const *)B, (dtype *)C, CTF_int::default_add_op<dtype>(this->fadd), CTF_int::default_mul_op<dtype>(fmul));
+        else
+          CTF_int::sr_coomm(m, n, k, ((dtype const *)alpha)[0], A, (dtype const *)B, (dtype *)C, this->fadd, fmul);
+      }
+
+      /** \brief csrmm on a serialized CSR matrix, blocks with 32-bit indices use the csrmm above */
+      void csrmm(int                         m,
+                 int                         n,
+                 int                         k,
+                 char const *                alpha,
+                 CTF_int::CSR_Matrix const & A,
+                 char const *                B,
+                 char const *                beta,
+                 char *                      C) const {
+        if (A.idx_width() == sizeof(int)){
+          this->csrmm(m, n, k, alpha, A.vals(), A.JA(), A.IA(), A.nnz(), B, beta, C, NULL);
+        } else if (is_def){
+          CTF_int::sr_csrmm(m, n, k, ((dtype const *)alpha)[0], A, (dtype const *)B, ((dtype const *)beta)[0], (dtype *)C, CTF_int::default_add_op<dtype>(this->fadd), CTF_int::default_mul_op<dtype>(fmul));
+        } else {
+          CTF_int::sr_csrmm(m, n, k, ((dtype const *)alpha)[0], A, (dtype const *)B, ((dtype const *)beta)[0], (dtype *)C, this->fadd, fmul);
+        }
+      }
+
+      /** \brief csrmultd on serialized CSR matrices, blocks with 32-bit indices use the csrmultd above */
+      void csrmultd
+                (int                         m,
+                 int                         n,
+                 int                         k,
+                 char const *                alpha,
+                 CTF_int::CSR_Matrix const & A,
+                 CTF_int::CSR_Matrix const & B,
+                 char const *                beta,
+                 char *                      C) const {
+        if (A.idx_width() == sizeof(int)){
+          this->csrmultd(m, n, k, alpha, A.vals(), A.JA(), A.IA(), A.nnz(), B.vals(), B.JA(), B.IA(), B.nnz(), beta, C);
+          return;
+        }
+        if (!this->isequal(beta, this->mulid())){
+          this->scal(m*n, beta, C, 1);
+        }
+        dtype const * a = NULL;
+        if (!this->isequal(alpha, this->mulid())) a = (dtype const *)alpha;
+        if (is_def)
+          CTF_int::sr_csrmultd(m, n, k, a, A, B, (dtype *)C, CTF_int::default_add_op<dtype>(this->fadd), CTF_int::default_mul_op<dtype>(fmul));
+        else
+          CTF_int::sr_csrmultd(m, n, k, a, A, B, (dtype *)C, this->fadd, fmul);
+      }
+
+      /** \brief csrmultcsr on serialized CSR matrices, blocks with 32-bit indices use the csrmultcsr above */
+      void csrmultcsr
+                (int                         m,
+                 int                         n,
+                 int                         k,
+                 char const *                alpha,
+                 CTF_int::CSR_Matrix const & A,
+                 CTF_int::CSR_Matrix const & B,
+                 char const *                beta,
+                 char *&                     C_CSR) const {
+        if (A.idx_width() == sizeof(int)){
+          this->csrmultcsr(m, n, k, alpha, A.vals(), A.JA(), A.IA(), A.nnz(), B.vals(), B.JA(), B.IA(), B.nnz(), beta, C_CSR);
+        } else if (is_def){
+          this->gen_csrmultcsr(m, n, k, ((dtype const*)alpha)[0], A, B, ((dtype const*)beta)[0], C_CSR, CTF_int::default_add_op<dtype>(this->fadd), CTF_int::default_mul_op<dtype>(fmul));
+        } else {
+          this->gen_csrmultcsr(m, n, k, ((dtype const*)alpha)[0], A, B, ((dtype const*)beta)[0], C_CSR, this->fadd, fmul);
+        }
+      }
+
+      /**
+       * \brief masked_csrmultcsr with typed values, templated on the operators so that functors are inlined into the loop
+       */
+      template <typename fadd_t, typename fmul_t>
+      void gen_masked_csrmultcsr
+                (int                         m,
+                 int                         n,
+                 dtype                       alpha,
+                 CTF_int::CSR_Matrix const & A,
+                 CTF_int::CSR_Matrix const & B,
+                 CTF_int::CSR_Matrix const & C,
+                 fadd_t                      fadd_op,
+                 fmul_t                      fmul_op) const {
+        dtype const * vA = (dtype const *)A.vals();
+        dtype const * vB = (dtype const *)B.vals();
+        dtype * vC = (dtype *)C.vals();
+        if (this->isequal((char const *)&alpha, this->mulid())){
+          CTF_int::masked_spgemm(m, n, A, B, C, [&](int64_t ic, int64_t ia, int64_t ib){ vC[ic] = fadd_op(vC[ic], fmul_op(vA[ia], vB[ib])); });
+        } else {
+          CTF_int::masked_spgemm(m, n, A, B, C, [&](int64_t ic, int64_t ia, int64_t ib){ vC[ic] = fadd_op(vC[ic], fmul_op(alpha, fmul_op(vA[ia], vB[ib]))); });
+        }
+      }
+
+      void masked_csrmultcsr
+                (int                         m,
+                 int                         n,
+                 int                         k,
+                 char const *                alpha,
+                 CTF_int::CSR_Matrix const & A,
+                 CTF_int::CSR_Matrix const & B,
+                 CTF_int::CSR_Matrix const & C) const {
+        if (is_def)
+          this->gen_masked_csrmultcsr(m, n, ((dtype const*)alpha)[0], A, B, C, CTF_int::default_add_op<dtype>(this->fadd), CTF_int::default_mul_op<dtype>(fmul));
+        else
+          this->gen_masked_csrmultcsr(m, n, ((dtype const*)alpha)[0], A, B, C, this->fadd, fmul);
+      }
+
+      /** \brief MTTKRP of a CSF tensor with the typed (inlined for default operators) addition and multiplication */
+      void mttkrp(CTF_int::CSF_Tensor const & T,
+                  int                         R,
+                  char const * const *        facs,
+                  char *                      out) const {
+        if (is_def)
+          CTF_int::csf_mttkrp(T, R, facs, out, CTF_int::typed_mttkrp_ops<dtype, CTF_int::default_add_op<dtype>, CTF_int::default_mul_op<dtype> >(this->taddid, CTF_int::default_add_op<dtype>(this->fadd), CTF_int::default_mul_op<dtype>(fmul)));
+        else
+          CTF_int::csf_mttkrp(T, R, facs, out, CTF_int::typed_mttkrp_ops<dtype, dtype (*)(dtype, dtype), dtype (*)(dtype, dtype)>(this->taddid, this->fadd, fmul));
+      }
+
   };
+
+  /**
+   * \brief Semiring with addition and multiplication given by operator types rather than function pointers,
+   *   so that the operators are inlined into the block kernels (gemm, axpy, scal, and the sparse kernels)
+   *   and into the innermost loops of the sequential tensor kernels (offsets_ctr, offsets_sum, pairs_sum, pairs_merge_sum),
+   *   the operators may be functors, function pointers, or captureless lambdas (see make_semiring)
+   */
+  template <typename dtype, typename fadd_t, typename fmul_t, bool is_ord=CTF_int::get_default_is_ord<dtype>()>
+  class Semiring_Op : public Semiring<dtype, is_ord> {
+    public:
+      fadd_t add_op;
+      fmul_t mul_op;
+
+      Semiring_Op(Semiring_Op const & other) : Semiring<dtype, is_ord>(other), add_op(other.add_op), mul_op(other.mul_op) { }
+
+      virtual CTF_int::algstrct * clone() const {
+        return new Semiring_Op<dtype, fadd_t, fmul_t, is_ord>(*this);
+      }
+
+      /**
+       * \brief constructor for algstrct equipped with * and + given by operators
+       * \param[in] addid_ additive identity
+       * \param[in] fadd_ binary addition operator
+       * \param[in] addmop_ MPI_Op operation for addition
+       * \param[in] mulid_ multiplicative identity
+       * \param[in] fmul_ binary multiplication operator
+       */
+      Semiring_Op(dtype  addid_,
+                  fadd_t fadd_,
+                  MPI_Op addmop_,
+                  dtype  mulid_,
+                  fmul_t fmul_)
+                    : Semiring<dtype, is_ord>(addid_, CTF_int::get_binary_fptr<dtype>(fadd_), addmop_,
+                                              mulid_, CTF_int::get_binary_fptr<dtype>(fmul_)),
+                      add_op(fadd_), mul_op(fmul_) { }
+
+      void add(char const * a, 
+               char const * b,
+               char *       c) const {
+        ((dtype*)c)[0] = add_op(((dtype*)a)[0],((dtype*)b)[0]);
+      }
+
+      void mul(char const * a, 
+               char const * b,
+               char *       c) const {
+        ((dtype*)c)[0] = mul_op(((dtype*)a)[0],((dtype*)b)[0]);
+      }
+
+      void scal(int          n,
+                char const * alpha,
+                char       * X,
+                int          incX)  const {
+        CTF_int::sr_scal(n, ((dtype const *)alpha)[0], (dtype *)X, incX, mul_op);
+      }
+
+      void axpy(int          n,
+                char const * alpha,
+                char const * X,
+                int          incX,
+                char       * Y,
+                int          incY)  const {
+        CTF_int::sr_axpy(n, ((dtype const *)alpha)[0], (dtype const *)X, incX, (dtype *)Y, incY, add_op, mul_op);
+      }
+
+      void offsets_ctr(int64_t n, char const * alpha, char const * A, uint64_t const * offsets_A, char const * B, uint64_t const * offsets_B, char * C, uint64_t const * offsets_C) const {
+        CTF_int::sr_offsets_ctr(n, (dtype const *)alpha, A, offsets_A, B, offsets_B, C, offsets_C, add_op, mul_op);
+      }
+
+      void offsets_sum(int64_t n, char const * A, uint64_t const * offsets_A, char * B, uint64_t const * offsets_B) const {
+        CTF_int::sr_offsets_sum<dtype>(n, A, offsets_A, B, offsets_B, add_op);
+      }
+
+      int64_t pairs_sum(int64_t nA, char const * A, int64_t idx_B, int64_t m, char * B) const {
+        return CTF_int::sr_pairs_sum(nA, A, idx_B, m, (dtype *)B, add_op);
+      }
+
+      void pairs_merge_sum(int64_t nA, char const * A, char const * beta, int64_t nB, char const * B, int64_t & nnew, char *& new_B, int64_t map_pfx) const {
+        CTF_int::sr_pairs_merge_sum(nA, A, (dtype const *)beta, nB, B, nnew, new_B, map_pfx, add_op, mul_op);
+      }
+
+      void gemm(char         tA,
+                char         tB,
+                int          m,
+                int          n,
+                int          k,
+                char const * alpha,
+                char const * A,
+                char const * B,
+                char const * beta,
+                char *       C)  const {
+        if (!this->isequal(beta, this->mulid())){
+          scal(m*n, beta, C, 1);
+        }  
+        dtype const * a = NULL;
+        if (!this->isequal(alpha, this->mulid())) a = (dtype const *)alpha;
+        CTF_int::srgemm(tA, tB, m, n, k, a, (dtype const *)A, (dtype const *)B, (dtype *)C, add_op, mul_op);
+      }
+
+      void coomm(int m, int n, int k, char const * alpha, char const * A, int const * rows_A, int const * cols_A, int64_t nnz_A, char const * B, char const * beta, char * C, CTF_int::bivar_function const * func) const {
+        assert(func == NULL && alpha != NULL);
+        if (!this->isequal(beta, this->mulid())){
+          scal(m*n, beta, C, 1);
+        }  
+        CTF_int::sr_coomm(m, n, k, ((dtype const *)alpha)[0], (dtype const *)A, rows_A, cols_A, nnz_A, (dtype const *)B, (dtype *)C, add_op, mul_op);
+      }
+
+      void csrmm(int          m,
+                 int          n,
+                 int          k,
+                 char const * alpha,
+                 char const * A,
+                 int const *  JA,
+                 int const *  IA,
+                 int64_t      nnz_A,
+                 char const * B,
+                 char const * beta,
+                 char *       C,
+                 CTF_int::bivar_function const * func) const {
+        assert(func == NULL);
+        CTF_int::sr_csrmm(m, n, k, ((dtype const *)alpha)[0], (dtype const *)A, JA, IA, (dtype const *)B, ((dtype const *)beta)[0], (dtype *)C, add_op, mul_op);
+      }
+
+      void csrmultd
+                (int          m,
+                 int          n,
+                 int          k,
+                 char const * alpha,
+                 char const * A,
+                 int const *  JA,
+                 int const *  IA,
+                 int64_t      nnz_A,
+                 char const * B,
+                 int const *  JB,
+                 int const *  IB,
+                 int64_t      nnz_B,
+                 char const * beta,
+                 char *       C) const {
+        if (!this->isequal(beta, this->mulid())){
+          scal(m*n, beta, C, 1);
+        }
+        dtype const * a = NULL;
+        if (!this->isequal(alpha, this->mulid())) a = (dtype const *)alpha;
+        CTF_int::sr_csrmultd(m, n, k, a, (dtype const *)A, JA, IA, (dtype const *)B, JB, IB, (dtype *)C, add_op, mul_op);
+      }
+
+      void csrmultcsr
+                (int          m,
+                 int          n,
+                 int          k,
+                 char const * alpha,
+                 char const * A,
+                 int const *  JA,
+                 int const *  IA,
+                 int64_t      nnz_A,
+                 char const * B,
+                 int const *  JB,
+                 int const *  IB,
+                 int64_t      nnz_B,
+                 char const * beta,
+                 char *&      C_CSR) const {
+        this->gen_csrmultcsr(m,n,k,((dtype const*)alpha)[0],(dtype const*)A,JA,IA,nnz_A,(dtype const*)B,JB,IB,nnz_B,((dtype const*)beta)[0],C_CSR,add_op,mul_op);
+      }
+
+      void coomm(int                         m,
+                 int                         n,
+                 int                         k,
+                 char const *                alpha,
+                 CTF_int::COO_Matrix const & A,
+                 char const *                B,
+                 char const *                beta,
+                 char *                      C) const {
+        if (!this->isequal(beta, this->mulid())){
+          scal(m*n, beta, C, 1);
+        }  
+        CTF_int::sr_coomm(m, n, k, ((dtype const *)alpha)[0], A, (dtype const *)B, (dtype *)C, add_op, mul_op);
+      }
+
+      void csrmm(int                         m,
+                 int                         n,
+                 int                         k,
+                 char const *                alpha,
+                 CTF_int::CSR_Matrix const & A,
+                 char const *                B,
+                 char const *                beta,
+                 char *                      C) const {
+        CTF_int::sr_csrmm(m, n, k, ((dtype const *)alpha)[0], A, (dtype const *)B, ((dtype const *)beta)[0], (dtype *)C, add_op, mul_op);
+      }
+
+      void csrmultd
+                (int                         m,
+                 int                         n,
+                 int                         k,
+                 char const *                alpha,
+                 CTF_int::CSR_Matrix const & A,
+                 CTF_int::CSR_Matrix const & B,
+                 char const *                beta,
+                 char *                      C) const {
+        if (!this->isequal(beta, this->mulid())){
+          scal(m*n, beta, C, 1);
+        }
+        dtype const * a = NULL;
+        if (!this->isequal(alpha, this->mulid())) a = (dtype const *)alpha;
+        CTF_int::sr_csrmultd(m, n, k, a, A, B, (dtype *)C, add_op, mul_op);
+      }
+
+      void csrmultcsr
+                (int                         m,
+                 int                         n,
+                 int                         k,
+                 char const *                alpha,
+                 CTF_int::CSR_Matrix const & A,
+                 CTF_int::CSR_Matrix const & B,
+                 char const *                beta,
+                 char *&                     C_CSR) const {
+        this->gen_csrmultcsr(m,n,k,((dtype const*)alpha)[0],A,B,((dtype const*)beta)[0],C_CSR,add_op,mul_op);
+      }
+
+      void masked_csrmultcsr
+                (int                         m,
+                 int                         n,
+                 int                         k,
+                 char const *                alpha,
+                 CTF_int::CSR_Matrix const & A,
+                 CTF_int::CSR_Matrix const & B,
+                 CTF_int::CSR_Matrix const & C) const {
+        this->gen_masked_csrmultcsr(m,n,((dtype const*)alpha)[0],A,B,C,add_op,mul_op);
+      }
+
+      void mttkrp(CTF_int::CSF_Tensor const & T,
+                  int                         R,
+                  char const * const *        facs,
+                  char *                      out) const {
+        CTF_int::csf_mttkrp(T, R, facs, out, CTF_int::typed_mttkrp_ops<dtype, fadd_t, fmul_t>(this->taddid, add_op, mul_op));
+      }
+  };
+
+  /**
+   * \brief creates a Semiring_Op, deducing the types of the operators (e.g. of lambdas)
+   * \param[in] addid additive identity
+   * \param[in] fadd binary addition operator
+   * \param[in] addmop MPI_Op operation for addition
+   * \param[in] mulid multiplicative identity
+   * \param[in] fmul binary multiplication operator
+   */
+  template <typename dtype, bool is_ord=CTF_int::get_default_is_ord<dtype>(), typename fadd_t, typename fmul_t>
+  Semiring_Op<dtype, fadd_t, fmul_t, is_ord> make_semiring(dtype  addid,
+                                                           fadd_t fadd,
+                                                           MPI_Op addmop,
+                                                           dtype  mulid,
+                                                           fmul_t fmul){
+    return Semiring_Op<dtype, fadd_t, fmul_t, is_ord>(addid, fadd, addmop, mulid, fmul);
+  }
   /**
    * @}
    */
@@ -865,4 +1438,6 @@ namespace CTF {
   void CTF::Semiring<std::complex<double>,0>::offload_gemm(char,char,int,int,int,char const *,char const *,char const *,char const *,char *) const;
 }
 #include "ring.h"
+#include "tropical.h"
+#include "pattern.h"
 #endif
@@ -0,0 +1,253 @@
+#ifndef __SEMIRING_GEMM_H__
+#define __SEMIRING_GEMM_H__
+
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "common.h"
+
+namespace CTF_int {
+
+  /**
+   * \brief blocking parameters of the generic semiring gemm,
+   *        MR x NR is the register tile of C updated by the micro-kernel,
+   *        MC x KC blocks of A and KC x NC blocks of B are packed contiguously
+   */
+  template <typename dtype>
+  struct srgemm_blk {
+    static const int MR = 8;
+    static const int NR = 4;
+    static const int MC = 64;
+    static const int KC = 256;
+    static const int NC = 1024;
+  };
+
+  /**
+   * \brief packs an mc-by-kc block of op(A) into consecutive row panels of MR rows,
+   *        each stored column by column, the last panel may have fewer rows
+   * \param[in] mc number of rows in block
+   * \param[in] kc number of columns in block
+   * \param[in] A first element of block
+   * \param[in] istride distance between rows of op(A)
+   * \param[in] lstride distance between columns of op(A)
+   * \param[in] alpha if not NULL, every element is premultiplied by alpha
+   * \param[in] fmul multiplication operator
+   * \param[out] pA packed block
+   */
+  template <typename dtype, typename fmul_t>
+  void srgemm_pack_A(int           mc,
+                     int           kc,
+                     dtype const * A,
+                     int64_t       istride,
+                     int64_t       lstride,
+                     dtype const * alpha,
+                     fmul_t        fmul,
+                     dtype *       pA){
+    int const MR = srgemm_blk<dtype>::MR;
+    for (int ir=0; ir<mc; ir+=MR){
+      int mr = std::min(MR, mc-ir);
+      for (int l=0; l<kc; l++){
+        dtype const * cA = A + ir*istride + l*lstride;
+        if (alpha == NULL){
+          for (int i=0; i<mr; i++) pA[i] = cA[i*istride];
+        } else {
+          for (int i=0; i<mr; i++) pA[i] = fmul(alpha[0], cA[i*istride]);
+        }
+        pA += mr;
+      }
+    }
+  }
+
+  /**
+   * \brief packs a kc-by-nc block of op(B) into consecutive column panels of NR columns,
+   *        each stored row by row, the last panel may have fewer columns
+   * \param[in] kc number of rows in block
+   * \param[in] nc number of columns in block
+   * \param[in] B first element of block
+   * \param[in] lstride distance between rows of op(B)
+   * \param[in] jstride distance between columns of op(B)
+   * \param[out] pB packed block
+   */
+  template <typename dtype>
+  void srgemm_pack_B(int           kc,
+                     int           nc,
+                     dtype const * B,
+                     int64_t       lstride,
+                     int64_t       jstride,
+                     dtype *       pB){
+    int const NR = srgemm_blk<dtype>::NR;
+    for (int jr=0; jr<nc; jr+=NR){
+      int nr = std::min(NR, nc-jr);
+      dtype * cpB = pB + ((int64_t)jr)*kc;
+      for (int l=0; l<kc; l++){
+        dtype const * cB = B + jr*jstride + l*lstride;
+        for (int j=0; j<nr; j++) cpB[j] = cB[j*jstride];
+        cpB += nr;
+      }
+    }
+  }
+
+  /**
+   * \brief updates an mr-by-nr tile of C with the product of a packed row panel of A and
+   *        a packed column panel of B, keeping the tile in local variables,
+   *        C(i,j) = fadd(fmul(A(i,l),B(l,j)),C(i,j)) in order of increasing l
+   * \param[in] kc length of the panels
+   * \param[in] mr number of rows in the tile (MR for full tiles)
+   * \param[in] nr number of columns in the tile (NR for full tiles)
+   * \param[in] pA packed row panel of A
+   * \param[in] pB packed column panel of B
+   * \param[in,out] C first element of the tile
+   * \param[in] ldc leading dimension of C
+   * \param[in] fadd addition operator
+   * \param[in] fmul multiplication operator
+   */
+  template <typename dtype, typename fadd_t, typename fmul_t>
+  inline void srgemm_micro(int           kc,
+                           int           mr,
+                           int           nr,
+                           dtype const * pA,
+                           dtype const * pB,
+                           dtype *       C,
+                           int64_t       ldc,
+                           fadd_t        fadd,
+                           fmul_t        fmul){
+    int const MR = srgemm_blk<dtype>::MR;
+    int const NR = srgemm_blk<dtype>::NR;
+    dtype acc[NR][MR];
+    if (mr == MR && nr == NR){
+      for (int j=0; j<NR; j++){
+        for (int i=0; i<MR; i++) acc[j][i] = C[j*ldc+i];
+      }
+      for (int l=0; l<kc; l++){
+        for (int j=0; j<NR; j++){
+          dtype b = pB[l*NR+j];
+          for (int i=0; i<MR; i++){
+            acc[j][i] = fadd(fmul(pA[l*MR+i], b), acc[j][i]);
+          }
+        }
+      }
+      for (int j=0; j<NR; j++){
+        for (int i=0; i<MR; i++) C[j*ldc+i] = acc[j][i];
+      }
+    } else {
+      for (int j=0; j<nr; j++){
+        for (int i=0; i<mr; i++) acc[j][i] = C[j*ldc+i];
+      }
+      for (int l=0; l<kc; l++){
+        for (int j=0; j<nr; j++){
+          dtype b = pB[l*nr+j];
+          for (int i=0; i<mr; i++){
+            acc[j][i] = fadd(fmul(pA[l*mr+i], b), acc[j][i]);
+          }
+        }
+      }
+      for (int j=0; j<nr; j++){
+        for (int i=0; i<mr; i++) C[j*ldc+i] = acc[j][i];
+      }
+    }
+  }
+
+  /**
+   * \brief cache-blocked, packed, and threaded gemm for an arbitrary semiring,
+   *        C["ij"] = fadd(alpha*op(A)["ik"]*op(B)["kj"], C["ij"]) with C column-major and m-by-n,
+   *        any scaling of C by beta must be done by the caller,
+   *        the result is identical to the unblocked loop for non-commutative addition,
+   *        since each element of C is updated in order of increasing k
+   * \param[in] tA 'N' if A is m-by-k, 'T' if A is k-by-m and should be transposed
+   * \param[in] tB 'N' if B is k-by-n, 'T' if B is n-by-k and should be transposed
+   * \param[in] m number of rows of C
+   * \param[in] n number of columns of C
+   * \param[in] k contraction length
+   * \param[in] alpha scaling factor applied to A, NULL if it is the multiplicative identity
+   * \param[in] A left operand
+   * \param[in] B right operand
+   * \param[in,out] C output
+   * \param[in] fadd addition operator (function pointer or functor)
+   * \param[in] fmul multiplication operator (function pointer or functor)
+   */
+  template <typename dtype, typename fadd_t, typename fmul_t>
+  void srgemm(char          tA,
+              char          tB,
+              int           m,
+              int           n,
+              int           k,
+              dtype const * alpha,
+              dtype const * A,
+              dtype const * B,
+              dtype *       C,
+              fadd_t        fadd,
+              fmul_t        fmul){
+    int const NR = srgemm_blk<dtype>::NR;
+    int const MC = srgemm_blk<dtype>::MC;
+    int const KC = srgemm_blk<dtype>::KC;
+    int const NC = srgemm_blk<dtype>::NC;
+    if (m <= 0 || n <= 0 || k <= 0) return;
+
+    int64_t istride_A, lstride_A, lstride_B, jstride_B;
+    if (tA == 'N' || tA == 'n'){
+      istride_A = 1;
+      lstride_A = m;
+    } else {
+      istride_A = k;
+      lstride_A = 1;
+    }
+    if (tB == 'N' || tB == 'n'){
+      lstride_B = 1;
+      jstride_B = k;
+    } else {
+      lstride_B = n;
+      jstride_B = 1;
+    }
+
+    int ntd = 1;
+#ifdef _OPENMP
+    if (!omp_in_parallel()) ntd = omp_get_max_threads();
+#endif
+    int mcb = std::min(MC, m);
+    int kcb = std::min(KC, k);
+    int ncb = std::min(NC, n);
+    int nic = (m+MC-1)/MC;
+    dtype * pB = (dtype*)alloc(sizeof(dtype)*((int64_t)kcb)*ncb);
+    dtype * pA = (dtype*)alloc(sizeof(dtype)*((int64_t)mcb)*kcb*ntd);
+
+    for (int jc=0; jc<n; jc+=NC){
+      int nc = std::min(NC, n-jc);
+      // split columns of the B block into groups so that there is enough work for all threads
+      int njg = std::max(1, std::min((nc+NR-1)/NR, (4*ntd+nic-1)/nic));
+      int jg_sz = (((nc+njg-1)/njg+NR-1)/NR)*NR;
+      njg = (nc+jg_sz-1)/jg_sz;
+      for (int pc=0; pc<k; pc+=KC){
+        int kc = std::min(KC, k-pc);
+        srgemm_pack_B(kc, nc, B+jc*jstride_B+pc*lstride_B, lstride_B, jstride_B, pB);
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static) num_threads(ntd)
+#endif
+        for (int t=0; t<nic*njg; t++){
+          int tid = 0;
+#ifdef _OPENMP
+          tid = omp_get_thread_num();
+#endif
+          int ic = (t/njg)*MC;
+          int mc = std::min(MC, m-ic);
+          int jg = (t%njg)*jg_sz;
+          int ng = std::min(jg_sz, nc-jg);
+          dtype * tpA = pA + ((int64_t)tid)*mcb*kcb;
+          srgemm_pack_A(mc, kc, A+ic*istride_A+pc*lstride_A, istride_A, lstride_A, alpha, fmul, tpA);
+          int const MR = srgemm_blk<dtype>::MR;
+          for (int jr=jg; jr<jg+ng; jr+=NR){
+            int nr = std::min(NR, jg+ng-jr);
+            for (int ir=0; ir<mc; ir+=MR){
+              int mr = std::min(MR, mc-ir);
+              srgemm_micro(kc, mr, nr, tpA+((int64_t)ir)*kc, pB+((int64_t)jr)*kc,
+                           C+(ic+ir)+((int64_t)(jc+jr))*m, (int64_t)m, fadd, fmul);
+            }
+          }
+        }
+      }
+    }
+    cdealloc(pA);
+    cdealloc(pB);
+  }
+}
+#endif
@@ -0,0 +1,187 @@
+#ifndef __SEMIRING_SEQ_H__
+#define __SEMIRING_SEQ_H__
+
+#include "../tensor/algstrct.h"
+
+namespace CTF_int {
+
+  /**
+   * \brief multiplication of an algstrct as a functor, for algebraic structures
+   *        that have no multiplication operator type (the operator is then called virtually)
+   */
+  template <typename dtype>
+  struct algstrct_mul_op {
+    algstrct const * sr;
+    algstrct_mul_op(algstrct const * sr_) : sr(sr_) { }
+    dtype operator()(dtype a, dtype b) const {
+      dtype c;
+      sr->mul((char const *)&a, (char const *)&b, (char *)&c);
+      return c;
+    }
+  };
+
+  /**
+   * \brief C[offsets_C[i]]+=alpha*A[offsets_A[i]]*B[offsets_B[i]] for an arbitrary semiring (see algstrct::offsets_ctr)
+   * \param[in] n number of elements
+   * \param[in] alpha scaling factor, NULL if none
+   * \param[in] A, B operands
+   * \param[in] offsets_A, offsets_B byte offsets of the elements of A and B
+   * \param[in,out] C output
+   * \param[in] offsets_C byte offsets of the elements of C
+   * \param[in] fadd addition operator (function pointer or functor)
+   * \param[in] fmul multiplication operator (function pointer or functor)
+   */
+  template <typename dtype, typename fadd_t, typename fmul_t>
+  void sr_offsets_ctr(int64_t          n,
+                      dtype const *    alpha,
+                      char const *     A,
+                      uint64_t const * offsets_A,
+                      char const *     B,
+                      uint64_t const * offsets_B,
+                      char *           C,
+                      uint64_t const * offsets_C,
+                      fadd_t           fadd,
+                      fmul_t           fmul){
+    if (alpha == NULL){
+      for (int64_t i=0; i<n; i++){
+        dtype * c = (dtype*)(C+offsets_C[i]);
+        c[0] = fadd(fmul(((dtype const*)(A+offsets_A[i]))[0], ((dtype const*)(B+offsets_B[i]))[0]), c[0]);
+      }
+    } else {
+      dtype a = alpha[0];
+      for (int64_t i=0; i<n; i++){
+        dtype * c = (dtype*)(C+offsets_C[i]);
+        c[0] = fadd(fmul(fmul(((dtype const*)(A+offsets_A[i]))[0], ((dtype const*)(B+offsets_B[i]))[0]), a), c[0]);
+      }
+    }
+  }
+
+  /**
+   * \brief B[offsets_B[i]]+=A[offsets_A[i]] for an arbitrary monoid (see algstrct::offsets_sum)
+   * \param[in] n number of elements
+   * \param[in] A operand
+   * \param[in] offsets_A byte offsets of the elements of A
+   * \param[in,out] B output
+   * \param[in] offsets_B byte offsets of the elements of B
+   * \param[in] fadd addition operator (function pointer or functor)
+   */
+  template <typename dtype, typename fadd_t>
+  void sr_offsets_sum(int64_t          n,
+                      char const *     A,
+                      uint64_t const * offsets_A,
+                      char *           B,
+                      uint64_t const * offsets_B,
+                      fadd_t           fadd){
+    for (int64_t i=0; i<n; i++){
+      dtype * b = (dtype*)(B+offsets_B[i]);
+      b[0] = fadd(((dtype const*)(A+offsets_A[i]))[0], b[0]);
+    }
+  }
+
+  /**
+   * \brief B[i]+=a for i<m and each leading pair (idx_B+i, a) of A, for an arbitrary monoid (see algstrct::pairs_sum)
+   * \param[in] nA number of pairs in A
+   * \param[in] A pairs sorted by key
+   * \param[in] idx_B key of B[0]
+   * \param[in] m number of elements of B
+   * \param[in,out] B dense output
+   * \param[in] fadd addition operator (function pointer or functor)
+   * \return number of pairs of A accumulated
+   */
+  template <typename dtype, typename fadd_t>
+  int64_t sr_pairs_sum(int64_t      nA,
+                       char const * A,
+                       int64_t      idx_B,
+                       int64_t      m,
+                       dtype *      B,
+                       fadd_t       fadd){
+    int const ps = sizeof(int64_t)+sizeof(dtype);
+    int64_t j = 0;
+    for (int64_t i=0; i<m; i++){
+      while (j < nA && ((int64_t const*)(A+j*ps))[0] == idx_B+i){
+        B[i] = fadd(((dtype const*)(A+j*ps+sizeof(int64_t)))[0], B[i]);
+        j++;
+      }
+    }
+    return j;
+  }
+
+  /**
+   * \brief merges sorted pairs, new_B = A+beta*B, for an arbitrary semiring (see algstrct::pairs_merge_sum)
+   * \param[in] nA number of pairs in A
+   * \param[in] A pairs sorted by key
+   * \param[in] beta scaling factor of B, NULL if none
+   * \param[in] nB number of pairs in B
+   * \param[in] B pairs sorted by key
+   * \param[out] nnew number of pairs in new_B
+   * \param[out] new_B pairs of the result, allocated internally
+   * \param[in] map_pfx how many times each element of A should be replicated
+   * \param[in] fadd addition operator (function pointer or functor)
+   * \param[in] fmul multiplication operator (function pointer or functor)
+   */
+  template <typename dtype, typename fadd_t, typename fmul_t>
+  void sr_pairs_merge_sum(int64_t       nA,
+                          char const *  A,
+                          dtype const * beta,
+                          int64_t       nB,
+                          char const *  B,
+                          int64_t &     nnew,
+                          char *&       new_B,
+                          int64_t       map_pfx,
+                          fadd_t        fadd,
+                          fmul_t        fmul){
+    int const ps = sizeof(int64_t)+sizeof(dtype);
+    auto key = [=](char const * prs, int64_t i) -> int64_t { return ((int64_t const*)(prs+i*ps))[0]; };
+    auto val = [=](char const * prs, int64_t i) -> dtype { return ((dtype const*)(prs+i*ps+sizeof(int64_t)))[0]; };
+    // scaled value of the tth pair of B
+    auto val_B = [&](int64_t t) -> dtype { return beta == NULL ? val(B, t) : fmul(val(B, t), beta[0]); };
+
+    // determine how many unique keys there are in A and B
+    nnew = nB;
+    for (int64_t t=0,ww=0; ww<nA*map_pfx; ww++){
+      while (ww<nA*map_pfx){
+        int64_t w = ww/map_pfx;
+        int64_t mw = ww%map_pfx;
+        if (t<nB && key(B, t) < key(A, w)*map_pfx+mw)
+          t++;
+        else if (t<nB && key(B, t) == key(A, w)*map_pfx+mw){
+          t++;
+          ww++;
+        } else {
+          if (map_pfx != 1 || ww==0 || key(A, ww-1) != key(A, ww))
+            nnew++;
+          ww++;
+        }
+      }
+    }
+    alloc_ptr(ps*nnew, (void**)&new_B);
+    int64_t n=0;
+    for (int64_t t=0,ww=0; n<nnew; n++){
+      int64_t w = ww/map_pfx;
+      int64_t mw = ww%map_pfx;
+      int64_t * k_new = (int64_t*)(new_B+n*ps);
+      dtype * v_new = (dtype*)(new_B+n*ps+sizeof(int64_t));
+      if (t<nB && (w==nA || key(B, t) < key(A, w)*map_pfx+mw)){
+        k_new[0] = key(B, t);
+        v_new[0] = val_B(t);
+        t++;
+      } else {
+        if (t>=nB || key(B, t) > key(A, w)*map_pfx+mw){
+          k_new[0] = key(A, w)*map_pfx+mw;
+          v_new[0] = val(A, w);
+        } else {
+          k_new[0] = key(B, t);
+          v_new[0] = fadd(val(A, w), val_B(t));
+          t++;
+        }
+        ww++;
+        // accumulate any repeated key writes
+        while (map_pfx == 1 && ww<nA && key(A, ww) == key(A, ww-1)){
+          v_new[0] = fadd(v_new[0], val(A, ww));
+          ww++;
+        }
+      }
+    }
+  }
+}
+#endif
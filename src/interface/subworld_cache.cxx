@@ -0,0 +1,169 @@
+/*Copyright (c) 2011, Edgar Solomonik, all rights reserved.*/
+
+#include "subworld_cache.h"
+#include "../shared/util.h"
+
+namespace CTF {
+  int SUBWORLD_CACHE_SIZE = 16;
+
+  Plan_cache_stats get_subworld_cache_stats(){
+    CTF_int::subworld_cache & sc = CTF_int::get_subworld_cache();
+    Plan_cache_stats st;
+    st.hits      = sc.nhits;
+    st.misses    = sc.nmisses;
+    st.evictions = sc.nevictions;
+    st.size      = sc.size();
+    return st;
+  }
+
+  void clear_subworld_cache(){
+    CTF_int::get_subworld_cache().clear();
+  }
+}
+
+namespace CTF_int {
+  using namespace CTF;
+
+  subworld_cache & get_subworld_cache(){
+    // never destroyed, so that Worlds destroyed at exit (e.g. CTF::universe) may still use it
+    static subworld_cache * cache = new subworld_cache();
+    return *cache;
+  }
+
+  subworld::subworld(CTF::World * parent_, int color){
+    TAU_FSTART(subworld);
+    parent = parent_;
+    MPI_Comm_split(parent->comm, color, parent->rank, &cm);
+    wrld = new World(cm);
+    last_use = 0;
+    TAU_FSTOP(subworld);
+  }
+
+  subworld::~subworld(){
+    std::map<tensor const *, tensor *>::iterator it;
+    for (it=tensors.begin(); it!=tensors.end(); it++){
+      delete it->second;
+    }
+    tensors.clear();
+    delete wrld;
+    MPI_Comm_free(&cm);
+  }
+
+  tensor * subworld::get_tensor(tensor const * tsr){
+    used.insert(tsr);
+    std::map<tensor const *, tensor *>::iterator it = tensors.find(tsr);
+    if (it != tensors.end()){
+      tensor * stsr = it->second;
+      // the parent tensor may have been deleted and another one created at the same address
+      bool is_match = stsr->order == tsr->order && stsr->is_sparse == tsr->is_sparse && stsr->sr->el_size == tsr->sr->el_size;
+      for (int i=0; is_match && i<tsr->order; i++){
+        is_match = stsr->lens[i] == tsr->lens[i] && stsr->sym[i] == tsr->sym[i];
+      }
+      if (is_match){
+        delete stsr->sr;
+        stsr->sr = tsr->sr->clone();
+        return stsr;
+      }
+      delete stsr;
+      tensors.erase(it);
+    }
+    tensor * stsr = new tensor(tsr->sr, tsr->order, tsr->lens, tsr->sym, wrld, true, tsr->name, tsr->profile, tsr->is_sparse);
+    tensors[tsr] = stsr;
+    return stsr;
+  }
+
+  void subworld::drop_unused(){
+    std::map<tensor const *, tensor *>::iterator it = tensors.begin();
+    while (it != tensors.end()){
+      if (used.find(it->first) == used.end()){
+        delete it->second;
+        tensors.erase(it++);
+      } else it++;
+    }
+    used.clear();
+  }
+
+  bool subworld_cache::get_signature(CTF::World const *     parent,
+                                     int const *            colors,
+                                     std::vector<int64_t> & sig){
+    if (CTF::SUBWORLD_CACHE_SIZE <= 0) return false;
+    sig.clear();
+    // subworlds are split from the communicator of the parent World and tensors are moved to them through it
+    sig.push_back((int64_t)(intptr_t)parent);
+    sig.push_back(parent->np);
+    for (int i=0; i<parent->np; i++){
+      sig.push_back(colors[i]);
+    }
+    return true;
+  }
+
+  subworld_cache::subworld_cache(){
+    nhits      = 0;
+    nmisses    = 0;
+    nevictions = 0;
+    ncalls     = 0;
+  }
+
+  subworld_cache::~subworld_cache(){
+    // communicators can not be freed once MPI is finalized, by then the process is exiting
+    int is_fin;
+    MPI_Finalized(&is_fin);
+    if (!is_fin) clear();
+  }
+
+  int64_t subworld_cache::size() const {
+    return subworlds.size();
+  }
+
+  subworld * subworld_cache::lookup(std::vector<int64_t> const & sig){
+    ncalls++;
+    std::map< std::vector<int64_t>, subworld* >::iterator it = subworlds.find(sig);
+    if (it == subworlds.end()){
+      nmisses++;
+      return NULL;
+    }
+    nhits++;
+    it->second->last_use = ncalls;
+    return it->second;
+  }
+
+  void subworld_cache::insert(std::vector<int64_t> const & sig, subworld * sub){
+    std::map< std::vector<int64_t>, subworld* >::iterator it = subworlds.find(sig);
+    if (it != subworlds.end()){
+      delete it->second;
+      subworlds.erase(it);
+    }
+    for (;;){
+      int64_t nsub = 0;
+      std::map< std::vector<int64_t>, subworld* >::iterator lru = subworlds.end();
+      for (it=subworlds.begin(); it!=subworlds.end(); it++){
+        if (it->second->parent == sub->parent){
+          nsub++;
+          if (lru == subworlds.end() || it->second->last_use < lru->second->last_use) lru = it;
+        }
+      }
+      if (nsub < CTF::SUBWORLD_CACHE_SIZE || nsub == 0) break;
+      subworld * lru_sub = lru->second;
+      subworlds.erase(lru);
+      delete lru_sub;
+      nevictions++;
+    }
+    sub->last_use = ncalls;
+    subworlds[sig] = sub;
+  }
+
+  void subworld_cache::clear(CTF::World const * parent){
+    // subworlds are removed before they are deleted, since deleting their World clears subworlds partitioning it
+    std::vector<subworld*> subs;
+    std::map< std::vector<int64_t>, subworld* >::iterator it = subworlds.begin();
+    while (it != subworlds.end()){
+      if (parent == NULL || it->second->parent == parent){
+        subs.push_back(it->second);
+        subworlds.erase(it++);
+      } else it++;
+    }
+    for (int i=0; i<(int)subs.size(); i++){
+      delete subs[i];
+    }
+  }
+}
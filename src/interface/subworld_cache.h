@@ -0,0 +1,114 @@
+/*Copyright (c) 2011, Edgar Solomonik, all rights reserved.*/
+
+#ifndef __SUBWORLD_CACHE_H__
+#define __SUBWORLD_CACHE_H__
+
+#include "common.h"
+#include "world.h"
+#include "../tensor/untyped_tensor.h"
+#include <map>
+#include <set>
+
+namespace CTF_int {
+
+  /**
+   * \brief World of one part of a partition of a parent World, along with the copies of parent tensors kept on it
+   */
+  class subworld {
+    public:
+      /** \brief communicator of the part of the partition this process belongs to */
+      MPI_Comm cm;
+      /** \brief World defined on cm */
+      CTF::World * wrld;
+      /** \brief copies of tensors of the parent World defined on wrld */
+      std::map<tensor const *, tensor *> tensors;
+      /** \brief parent tensors whose copies were returned by get_tensor() since the last call to drop_unused() */
+      std::set<tensor const *> used;
+      /** \brief parent World, used to drop subworlds when it is destroyed */
+      CTF::World const * parent;
+      /** \brief last cache access, used for LRU eviction */
+      int64_t last_use;
+
+      /**
+       * \brief splits the parent World (collective over it)
+       * \param[in] parent World to partition
+       * \param[in] color part of the partition this process belongs to
+       */
+      subworld(CTF::World * parent, int color);
+
+      /** \brief deletes the tensors, the World, and the communicator */
+      ~subworld();
+
+      /**
+       * \brief returns the copy of a parent tensor on this subworld, creating it if none is kept
+       *        or if the kept one no longer matches the parent tensor, its data is left as by its previous use
+       * \param[in] tsr tensor defined on the parent World
+       */
+      tensor * get_tensor(tensor const * tsr);
+
+      /**
+       * \brief deletes the copies of parent tensors not requested via get_tensor() since the previous call,
+       *        so that copies of tensors no longer used (or deleted) on the parent World are not kept indefinitely
+       */
+      void drop_unused();
+  };
+
+  /**
+   * \brief cache of subworlds keyed by the parent World and the part of the partition of each of its processes,
+   *        so that schedules executed repeatedly do not split communicators and enumerate topologies
+   *        for every partition, lookups are made by all processes of the parent World with the same signature,
+   *        and eviction only considers subworlds of the same parent, so hits are consistent across processes
+   */
+  class subworld_cache {
+    public:
+      /**
+       * \brief computes the signature of a partition
+       * \param[in] parent World to partition
+       * \param[in] colors part of the partition of each process of parent
+       * \param[out] sig signature
+       * \return false if subworlds should not be cached
+       */
+      static bool get_signature(CTF::World const *     parent,
+                                int const *            colors,
+                                std::vector<int64_t> & sig);
+
+      /**
+       * \brief look up subworld, updates hit/miss statistics
+       * \param[in] sig signature computed via get_signature
+       * \return subworld or NULL if not cached
+       */
+      subworld * lookup(std::vector<int64_t> const & sig);
+
+      /**
+       * \brief inserts subworld (taking ownership), evicting the least recently used subworld
+       *        of the same parent if it has CTF::SUBWORLD_CACHE_SIZE of them (collective over the parent World)
+       * \param[in] sig signature computed via get_signature
+       * \param[in] sub subworld to insert
+       */
+      void insert(std::vector<int64_t> const & sig, subworld * sub);
+
+      /**
+       * \brief deletes cached subworlds, statistics are kept
+       * \param[in] parent if not NULL, only those partitioning this World
+       */
+      void clear(CTF::World const * parent=NULL);
+
+      /** \brief number of cached subworlds */
+      int64_t size() const;
+
+      subworld_cache();
+      ~subworld_cache();
+
+      int64_t nhits;
+      int64_t nmisses;
+      int64_t nevictions;
+    private:
+      int64_t ncalls;
+      std::map< std::vector<int64_t>, subworld* > subworlds;
+  };
+
+  /** \brief returns the subworld cache of this process */
+  subworld_cache & get_subworld_cache();
+}
+
+#endif
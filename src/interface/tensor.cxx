@@ -4,6 +4,7 @@
 #include "world.h"
 #include "idx_tensor.h"
 #include "../tensor/untyped_tensor.h"
+#include "../contraction/masked_ctr.h"
 
 namespace CTF {
 
@@ -20,7 +21,7 @@ namespace CTF {
                         bool                      profile,
                         CTF_int::algstrct const & sr)
     : CTF_int::tensor(&sr, order, len, sym, &world, 1, name, profile) {
-    IASSERT(sizeof(dtype)==this->sr->el_size);
+    IASSERT(sizeof(dtype)==this->sr->el_size || this->sr->el_size == 0);
   }
 
   template<typename dtype>
@@ -32,7 +33,7 @@ namespace CTF {
                         char const *              name,
                         bool                      profile)
     : CTF_int::tensor(&sr, order, len, sym, &world, 1, name, profile) {
-    IASSERT(sizeof(dtype)==this->sr->el_size);
+    IASSERT(sizeof(dtype)==this->sr->el_size || this->sr->el_size == 0);
   }
 
 
@@ -46,7 +47,7 @@ namespace CTF {
                         char const *              name,
                         bool                      profile)
     : CTF_int::tensor(&sr, order, len, sym, &world, 1, name, profile, is_sparse) {
-    IASSERT(sizeof(dtype)==this->sr->el_size);
+    IASSERT(sizeof(dtype)==this->sr->el_size || this->sr->el_size == 0);
   }
 
   template<typename dtype>
@@ -58,7 +59,7 @@ namespace CTF {
                         char const *              name,
                         bool                      profile)
     : CTF_int::tensor(&sr, order, len, NULL, &world, 1, name, profile, is_sparse) {
-    IASSERT(sizeof(dtype)==this->sr->el_size);
+    IASSERT(sizeof(dtype)==this->sr->el_size || this->sr->el_size == 0);
   }
 
 
@@ -70,7 +71,7 @@ namespace CTF {
                         char const *              name,
                         bool                      profile)
     : CTF_int::tensor(&sr, order, len, NULL, &world, 1, name, profile) {
-    IASSERT(sizeof(dtype)==this->sr->el_size);
+    IASSERT(sizeof(dtype)==this->sr->el_size || this->sr->el_size == 0);
   }
 
 
@@ -86,7 +87,7 @@ namespace CTF {
                         bool                      profile,
                         CTF_int::algstrct const & sr_)
     : CTF_int::tensor(&sr_, order, 0, len, sym, &world, idx, prl, blk, name, profile) { 
-    IASSERT(sizeof(dtype)==this->sr->el_size);
+    IASSERT(sizeof(dtype)==this->sr->el_size || this->sr->el_size == 0);
   }
 
   template<typename dtype>
@@ -102,7 +103,7 @@ namespace CTF {
                         bool                      profile,
                         CTF_int::algstrct const & sr_)
     : CTF_int::tensor(&sr_, order, is_sparse_, len, sym, &world, idx, prl, blk, name, profile) { 
-    IASSERT(sizeof(dtype)==this->sr->el_size);
+    IASSERT(sizeof(dtype)==this->sr->el_size || this->sr->el_size == 0);
   }
 
 
@@ -119,6 +120,10 @@ namespace CTF {
   Tensor<dtype>::Tensor(tensor const & A)
     : CTF_int::tensor(&A, true) { }
 
+  template<typename dtype>
+  Tensor<dtype>::Tensor(Tensor<dtype> && A) noexcept
+    : CTF_int::tensor(std::move(A)) { }
+
   template<typename dtype>
   Tensor<dtype>::Tensor(tensor const & A,
                         World &        world_)
@@ -179,7 +184,7 @@ namespace CTF {
     //FIXME raises mem consumption
     char * cpairs; 
     int ret = CTF_int::tensor::read_local(npair, &cpairs);
-    *pairs = Pair<dtype>::cast_char_arr(cpairs, *npair);
+    *pairs = Pair<dtype>::cast_char_arr(cpairs, *npair, sr->el_size);
     assert(ret == CTF_int::SUCCESS);
   }
 
@@ -208,7 +213,7 @@ namespace CTF {
     //FIXME raises mem consumption
     char * cpairs; 
     int ret = CTF_int::tensor::read_local_nnz(npair, &cpairs);
-    *pairs = Pair<dtype>::cast_char_arr(cpairs, *npair);
+    *pairs = Pair<dtype>::cast_char_arr(cpairs, *npair, sr->el_size);
     assert(ret == CTF_int::SUCCESS);
   }
 
@@ -241,7 +246,7 @@ namespace CTF {
   void Tensor<dtype>::read(int64_t       npair,
                            Pair<dtype> * pairs){
     //FIXME raises mem consumption
-    char * cpairs = Pair<dtype>::scast_to_char_arr(pairs, npair);
+    char * cpairs = Pair<dtype>::scast_to_char_arr(pairs, npair, sr->el_size);
     int ret = CTF_int::tensor::read(npair, cpairs);
     if (cpairs != (char*)pairs){
       CTF_int::PairIterator ipairs = CTF_int::PairIterator(sr, cpairs);
@@ -281,7 +286,7 @@ namespace CTF {
                             Pair<dtype> const * pairs) {
 
     //FIXME raises mem consumption
-    char * cpairs = Pair<dtype>::scast_to_char_arr(pairs, npair);
+    char * cpairs = Pair<dtype>::scast_to_char_arr(pairs, npair, sr->el_size);
     int ret = CTF_int::tensor::write(npair, sr->mulid(), sr->addid(), cpairs);
     assert(ret == CTF_int::SUCCESS);
     if (cpairs != (char*)pairs)
@@ -317,7 +322,7 @@ namespace CTF {
                             dtype               alpha,
                             dtype               beta,
                             Pair<dtype> const * pairs) {
-    char * cpairs = Pair<dtype>::scast_to_char_arr(pairs, npair);
+    char * cpairs = Pair<dtype>::scast_to_char_arr(pairs, npair, sr->el_size);
 
     int ret = CTF_int::tensor::write(npair, (char*)&alpha, (char*)&beta, cpairs);
     if (cpairs != (char*)pairs) CTF_int::cdealloc(cpairs);
@@ -350,7 +355,7 @@ namespace CTF {
                            dtype         alpha,
                            dtype         beta,
                            Pair<dtype> * pairs){
-    char * cpairs = Pair<dtype>::scast_to_char_arr(pairs, npair);
+    char * cpairs = Pair<dtype>::scast_to_char_arr(pairs, npair, sr->el_size);
     int ret = CTF_int::tensor::read(npair, (char*)&alpha, (char*)&beta, cpairs);
     if (cpairs != (char*)pairs){
       CTF_int::PairIterator ipairs = CTF_int::PairIterator(sr, cpairs);
@@ -454,6 +459,12 @@ namespace CTF {
     assert(ret == CTF_int::SUCCESS);
   }
 
+  template<typename dtype>
+  void Tensor<dtype>::relabel(int64_t seed, bool inverse){
+    int ret = CTF_int::tensor::relabel(seed, inverse);
+    assert(ret == CTF_int::SUCCESS);
+  }
+
 
   template<typename dtype>
   void Tensor<dtype>::add_to_subworld(
@@ -851,6 +862,23 @@ namespace CTF {
   }
 
 
+  template<typename dtype>
+  void Tensor<dtype>::masked_contract(dtype            alpha,
+                                      CTF_int::tensor& A,
+                                      const char *     idx_A,
+                                      CTF_int::tensor& B,
+                                      const char *     idx_B,
+                                      dtype            beta,
+                                      const char *     idx_C,
+                                      CTF_int::tensor& M,
+                                      const char *     idx_M){
+    assert(A.wrld->cdt.cm == wrld->cdt.cm);
+    assert(B.wrld->cdt.cm == wrld->cdt.cm);
+    assert(M.wrld->cdt.cm == wrld->cdt.cm);
+    CTF_int::masked_contract(&A, idx_A, &B, idx_B, (char const *)&alpha, this, idx_C, (char const *)&beta, &M, idx_M);
+  }
+
+
   template<typename dtype>
   void Tensor<dtype>::sum(dtype            alpha,
                           CTF_int::tensor& A,
@@ -928,6 +956,18 @@ namespace CTF {
       = CTF_int::contraction(&A, idx_A, &B, idx_B, sr->mulid(), this, idx_C, sr->addid());
     return ctr.estimate_time();
   }
+
+  template<typename dtype>
+  Cost_estimate Tensor<dtype>::dry_run(
+                                    CTF_int::tensor& A,
+                                    const char *     idx_A,
+                                    CTF_int::tensor& B,
+                                    const char *     idx_B,
+                                    const char *     idx_C){
+    CTF_int::contraction ctr
+      = CTF_int::contraction(&A, idx_A, &B, idx_B, sr->mulid(), this, idx_C, sr->addid());
+    return ctr.dry_run();
+  }
     
   template<typename dtype>
   double Tensor<dtype>::estimate_time(
@@ -941,8 +981,8 @@ namespace CTF {
   }
 
   template<typename dtype>
-  Tensor<dtype>& Tensor<dtype>::operator=(Tensor<dtype> A){
-
+  Tensor<dtype>& Tensor<dtype>::operator=(Tensor<dtype> const & A){
+    if (this == &A) return *this;
     free_self();
     init(A.sr, A.order, A.lens, A.sym, A.wrld, 0, A.name, A.profile, A.is_sparse);
     copy_tensor_data(&A);
@@ -969,6 +1009,12 @@ namespace CTF {
     assert(ret == CTF_int::SUCCESS);*/
   }
 
+  template<typename dtype>
+  Tensor<dtype>& Tensor<dtype>::operator=(Tensor<dtype> && A){
+    CTF_int::tensor::operator=(std::move(A));
+    return *this;
+  }
+
 
   template<typename dtype>
   Sparse_Tensor<dtype> Tensor<dtype>::operator[](std::vector<int64_t> indices){
@@ -62,16 +62,19 @@ namespace CTF {
        * \brief cast tightly packed character array to array of Pairs, needed to handle alignment
        * \param[in,out] arr char array stored as [k1, d1, k2, d2, ..., kn, dn], deleted if copied
        * \param[in] n number of pairs in array
+       * \param[in] el_size size of each di in arr, 0 if arr holds keys alone (the values of the Pairs are then left undefined)
        * \return array of pairs stored as [Pair(k1, d1), Pair(k2, d2), ..., Pair(kn, dn)]
        */
-      static Pair<dtype> * cast_char_arr(char * arr, int64_t n){
-        if (sizeof(Pair<dtype>) == sizeof(int64_t)+sizeof(dtype)){
+      static Pair<dtype> * cast_char_arr(char * arr, int64_t n, int el_size=sizeof(dtype)){
+        int64_t ps = sizeof(int64_t)+el_size;
+        if (el_size == (int)sizeof(dtype) && sizeof(Pair<dtype>) == (size_t)ps){
           return (Pair<dtype>*)arr;
         } else {
           Pair<dtype> * prs = (Pair<dtype>*)CTF_int::alloc(sizeof(Pair<dtype>)*n);
           for (int64_t i=0; i<n; i++){
-            prs[i].k = ((int64_t*)(arr+i*(sizeof(int64_t)+sizeof(dtype))))[0];
-            prs[i].d = ((dtype*)(arr+sizeof(int64_t)+i*(sizeof(int64_t)+sizeof(dtype))))[0];
+            prs[i].k = ((int64_t*)(arr+i*ps))[0];
+            if (el_size != 0)
+              prs[i].d = ((dtype*)(arr+sizeof(int64_t)+i*ps))[0];
           }
           CTF_int::cdealloc(arr);
           return prs;
@@ -82,36 +85,32 @@ namespace CTF {
        * \brief cast array of Pairs to tightly packed character array, needed to handle alignment
        * \param[in,out] arr array of pairs stored as [Pair(k1, d1), Pair(k2, d2), ..., Pair(kn, dn)], deleted if copied
        * \param[in] n number of pairs in array
+       * \param[in] el_size size of each di in the result, 0 to pack the keys alone
        * \return arr char array stored as [k1, d1, k2, d2, ..., kn, dn]
        */
-      static char * cast_to_char_arr(Pair<dtype> * arr, int64_t n){
-        if (sizeof(Pair<dtype>) == sizeof(int64_t)+sizeof(dtype)){
-          return (char*)arr;
-        } else {
-          char * prs = (char*)CTF_int::alloc((sizeof(dtype)+sizeof(int64_t))*n);
-          for (int64_t i=0; i<n; i++){
-            ((int64_t*)(prs+i*(sizeof(int64_t)+sizeof(dtype))))[0] = arr[i].k;
-            ((dtype*)(prs+sizeof(int64_t)+i*(sizeof(int64_t)+sizeof(dtype))))[0] = arr[i].d;
-          }
-          CTF_int::cdealloc(arr);
-          return prs;
-        }
+      static char * cast_to_char_arr(Pair<dtype> * arr, int64_t n, int el_size=sizeof(dtype)){
+        char * prs = scast_to_char_arr(arr, n, el_size);
+        if (prs != (char*)arr) CTF_int::cdealloc(arr);
+        return prs;
       }
 
       /**
        * \brief(same as above except doesn't delete arr) cast array of Pairs to tightly packed character array, needed to handle alignment
        * \param[in] arr array of pairs stored as [Pair(k1, d1), Pair(k2, d2), ..., Pair(kn, dn)]
        * \param[in] n number of pairs in array
+       * \param[in] el_size size of each di in the result, 0 to pack the keys alone
        * \return arr char array stored as [k1, d1, k2, d2, ..., kn, dn]
        */
-      static char * scast_to_char_arr(Pair<dtype> const * arr, int64_t n){
-        if (sizeof(Pair<dtype>) == sizeof(int64_t)+sizeof(dtype)){
+      static char * scast_to_char_arr(Pair<dtype> const * arr, int64_t n, int el_size=sizeof(dtype)){
+        int64_t ps = sizeof(int64_t)+el_size;
+        if (el_size == (int)sizeof(dtype) && sizeof(Pair<dtype>) == (size_t)ps){
           return (char*)arr;
         } else {
-          char * prs = (char*)CTF_int::alloc((sizeof(dtype)+sizeof(int64_t))*n);
+          char * prs = (char*)CTF_int::alloc(ps*n);
           for (int64_t i=0; i<n; i++){
-            ((int64_t*)(prs+i*(sizeof(int64_t)+sizeof(dtype))))[0] = arr[i].k;
-            ((dtype*)(prs+sizeof(int64_t)+i*(sizeof(int64_t)+sizeof(dtype))))[0] = arr[i].d;
+            ((int64_t*)(prs+i*ps))[0] = arr[i].k;
+            if (el_size != 0)
+              ((dtype*)(prs+sizeof(int64_t)+i*ps))[0] = arr[i].d;
           }
           return prs;
         }
@@ -240,6 +239,12 @@ namespace CTF {
        */
       Tensor(tensor const & A);
 
+      /**
+       * \brief moves a tensor, taking the data, mapping, and home buffer of A without copying them
+       * \param[in,out] A tensor to move from, left empty
+       */
+      Tensor(Tensor<dtype> && A) noexcept;
+
 
       /**
        * \brief copies a tensor (setting data to zero or copying A)
@@ -333,6 +338,7 @@ namespace CTF {
        * The sparse data is defined in coordinate format. The tensor index (i,j,k,l) of a tensor with edge lengths
        * {m,n,p,q} is associated with the global index g via the formula g=i+j*m+k*m*n+l*m*n*p. The row index is first
        * and the column index is second for matrices, which means they are column major. 
+       * Indices absent from a sparse tensor are read as zero.
        * \param[in] npair number of values to fetch
        * \param[in] global_idx index within global tensor of each value to fetch
        * \param[in,out] data a prealloced pointer to the data with the specified indices
@@ -461,6 +467,29 @@ namespace CTF {
                     char const *          idx_C,
                     Bivar_Function<dtype> fseq);
 
+      /**
+       * \brief contracts C[idx_C] = beta*C[idx_C] + alpha*A[idx_A]*B[idx_B], computing the product only at the indices
+       *        of the nonzeros of the sparse tensor M (e.g. C["ij"] = (A["ik"]*B["kj"]).masked(M["ij"]))
+       * \param[in] alpha A*B scaling factor
+       * \param[in] A first operand tensor
+       * \param[in] idx_A indices of A in contraction, e.g. "ik" -> A_{ik}
+       * \param[in] B second operand tensor
+       * \param[in] idx_B indices of B in contraction, e.g. "kj" -> B_{kj}
+       * \param[in] beta C scaling factor
+       * \param[in] idx_C indices of C (this tensor),  e.g. "ij" -> C_{ij}
+       * \param[in] M sparse mask tensor, only the positions of its nonzeros matter
+       * \param[in] idx_M indices of M, a permutation of idx_C
+       */
+      void masked_contract(dtype             alpha,
+                           CTF_int::tensor & A,
+                           char const *      idx_A,
+                           CTF_int::tensor & B,
+                           char const *      idx_B,
+                           dtype             beta,
+                           char const *      idx_C,
+                           CTF_int::tensor & M,
+                           char const *      idx_M);
+
       /**
        * \brief sums B[idx_B] = beta*B[idx_B] + alpha*A[idx_A]
        * \param[in] alpha A scaling factor
@@ -544,13 +573,30 @@ namespace CTF {
        * \param[in] B second operand tensor
        * \param[in] idx_B indices of B in contraction, e.g. "kj" -> B_{kj}
        * \param[in] idx_C indices of C (this tensor),  e.g. "ij" -> C_{ij}
-       * \return time in seconds, at the moment not at all precise
+       * \return time in seconds predicted by the performance models for the mapping
+       *         the contraction would use, including redistribution
        */
       double estimate_time(CTF_int::tensor & A,
                            char const *      idx_A,
                            CTF_int::tensor & B,
                            char const *      idx_B,
                            char const *      idx_C);
+
+      /**
+       * \brief selects the mapping a contraction C[idx_C] = A[idx_A]*B[idx_B] would use and
+       *        predicts its cost, without moving any data or changing mappings (collective)
+       * \param[in] A first operand tensor
+       * \param[in] idx_A indices of A in contraction, e.g. "ik" -> A_{ik}
+       * \param[in] B second operand tensor
+       * \param[in] idx_B indices of B in contraction, e.g. "kj" -> B_{kj}
+       * \param[in] idx_C indices of C (this tensor),  e.g. "ij" -> C_{ij}
+       * \return predicted compute, communication, and redistribution times and peak buffer memory
+       */
+      Cost_estimate dry_run(CTF_int::tensor & A,
+                            char const *      idx_A,
+                            CTF_int::tensor & B,
+                            char const *      idx_B,
+                            char const *      idx_C);
       
       /**
        * \brief estimate the time of a sum B[idx_B] = A[idx_A]
@@ -706,6 +752,16 @@ namespace CTF {
        */ 
       void sparsify(std::function<bool(dtype)> filter);
 
+      /**
+       * \brief relabels the indices of each mode by a pseudo-random permutation, so that dense rows or fibers
+       *        of skewed sparse tensors (e.g. high-degree vertices of power-law graphs) are spread evenly over
+       *        processes; the permutation of a mode depends only on its length and the seed, so operands
+       *        relabeled with the same seed contract as before and results are mapped back with inverse=true
+       * \param[in] seed selects the permutations, must be the same on all processes
+       * \param[in] inverse whether to undo a relabeling done with the same seed
+       */
+      void relabel(int64_t seed=0, bool inverse=false);
+
      /**
        * \brief accumulates this tensor to a tensor object defined on a different world
        * \param[in] tsr a tensor object of the same characteristic as this tensor,
@@ -901,9 +957,15 @@ namespace CTF {
       Tensor<dtype>& operator=(dtype val);
       
       /**
-       * \brief sets the tensor
+       * \brief sets the tensor, copying the data of A
+       */
+      Tensor<dtype>& operator=(Tensor<dtype> const & A);
+
+      /**
+       * \brief sets the tensor, taking the data, mapping, and home buffer of A without copying them
+       * \param[in,out] A tensor to move from, left empty
        */
-      Tensor<dtype>& operator=(const Tensor<dtype> A);
+      Tensor<dtype>& operator=(Tensor<dtype> && A);
      
       /**
        * \brief gives handle to sparse index subset of tensors
@@ -5,10 +5,33 @@
 #include "../tensor/algstrct.h"
 #include "../summation/summation.h"
 #include "../contraction/contraction.h"
+#include "../contraction/mttkrp.h"
+#include "../contraction/masked_ctr.h"
+#include "../tensor/intm_pool.h"
+#include <bitset>
+
+namespace CTF {
+  int CTR_ORDER_DP_MAX = 10;
+  int CTR_ORDER_EST_MAX = 0;
+}
 
 using namespace CTF;
 
 namespace CTF_int {
+  /**
+   * \brief returns a dense zero tensor for an intermediate, taken from the intermediate pool if possible
+   */
+  static tensor * get_intm_tensor(algstrct const * sr,
+                                  int              order,
+                                  int const *      lens,
+                                  int const *      sym,
+                                  World *          wrld){
+    tensor * tsr = get_intm_pool().acquire(sr, order, lens, sym, wrld);
+    if (tsr == NULL)
+      tsr = new tensor(sr, order, lens, sym, wrld, 1);
+    return tsr;
+  }
+
   Idx_Tensor * get_full_intm(Idx_Tensor& A, 
                              Idx_Tensor& B){
     int * len_C, * sym_C;
@@ -86,7 +109,7 @@ namespace CTF_int {
       idx++;
     }
 
-    tensor * tsr_C = new tensor(A.parent->sr, order_C, len_C, sym_C, A.parent->wrld, 1);
+    tensor * tsr_C = get_intm_tensor(A.parent->sr, order_C, len_C, sym_C, A.parent->wrld);
     Idx_Tensor * out = new Idx_Tensor(tsr_C, idx_C);
     out->is_intm = 1;
     cdealloc(sym_C);
@@ -141,7 +164,7 @@ namespace CTF_int {
         order_C++;
       }
     }
-    tensor * tsr_C = new tensor(A.parent->sr, order_C, len_C, sym_C, A.parent->wrld, 1);
+    tensor * tsr_C = get_intm_tensor(A.parent->sr, order_C, len_C, sym_C, A.parent->wrld);
     Idx_Tensor * out = new Idx_Tensor(tsr_C, idx_C);
     out->is_intm = 1;
     cdealloc(sym_C);
@@ -150,6 +173,319 @@ namespace CTF_int {
     return out;
   }
 
+  /**
+   * \brief indices and nonzero density of a tensor considered when ordering contractions
+   */
+  struct ctr_order_node {
+    std::bitset<256> inds;
+    double dens;
+  };
+
+  /**
+   * \brief number of entries in a dense tensor with the given indices
+   */
+  static double inds_size(std::bitset<256> const & inds, int64_t const * lens){
+    double sz = 1.;
+    for (int i=0; i<256; i++){
+      if (inds[i]) sz *= (double)lens[i];
+    }
+    return sz;
+  }
+
+  /**
+   * \brief estimated cost of contracting X and Y into an intermediate with indices out_inds,
+   *        intermediates are dense, so the cost of writing them is accounted for
+   */
+  static double pair_cost(ctr_order_node const &   X,
+                          ctr_order_node const &   Y,
+                          std::bitset<256> const & out_inds,
+                          int64_t const *          lens){
+    return inds_size(X.inds | Y.inds, lens)*X.dens*Y.dens + inds_size(out_inds, lens);
+  }
+
+  /**
+   * \brief creates a tensor without data with the given indices, to stand for an intermediate in a dry run
+   * \param[in] sr algebraic structure of the intermediate
+   * \param[in] inds indices of the intermediate
+   * \param[in] lens length of each index
+   * \param[in] wrld World of the intermediate
+   * \param[out] idx labels of the modes of the intermediate, in increasing order
+   */
+  static tensor * get_intm_shell(algstrct const *         sr,
+                                 std::bitset<256> const & inds,
+                                 int64_t const *          lens,
+                                 World *                  wrld,
+                                 std::vector<char> &      idx){
+    std::vector<int> len_C, sym_C;
+    idx.clear();
+    for (int i=0; i<256; i++){
+      if (inds[i]){
+        idx.push_back((char)i);
+        len_C.push_back((int)lens[i]);
+        sym_C.push_back(NS);
+      }
+    }
+    return new tensor(sr, idx.size(), len_C.data(), sym_C.data(), wrld, false);
+  }
+
+  /**
+   * \brief whether the pairwise contractions of ops may be priced by contraction::estimate_time(),
+   *        intermediates are dense, so a sparse operand may only be contracted with dense ones
+   */
+  static bool can_estimate_pairs(std::vector<Idx_Tensor*> const & ops,
+                                 Idx_Tensor const &               output){
+    if ((int)ops.size() > CTF::CTR_ORDER_EST_MAX || output.parent == NULL) return false;
+    int nsparse = 0;
+    for (int i=0; i<(int)ops.size(); i++){
+      if (ops[i]->parent->wrld != output.parent->wrld || ops[i]->parent->sr->el_size != output.parent->sr->el_size) return false;
+      if (ops[i]->parent->is_sparse) nsparse++;
+    }
+    return nsparse <= 1;
+  }
+
+  static int emit_ctr_order(int                                 S,
+                            int const *                         split,
+                            int &                               nintm,
+                            std::vector< std::pair<int,int> > & order){
+    if ((S & (S-1)) == 0){
+      int i = 0;
+      while (!(S & (1<<i))) i++;
+      return i;
+    }
+    int a = emit_ctr_order(split[S], split, nintm, order);
+    int b = emit_ctr_order(S ^ split[S], split, nintm, order);
+    order.push_back(std::pair<int,int>(a,b));
+    return nintm++;
+  }
+
+  /**
+   * \brief determines in which order to contract ops pairwise into output, by dynamic 
+   *        programming over subsets of ops if there are at most CTF::CTR_ORDER_DP_MAX of them
+   *        and greedily otherwise, depends only on global properties of the tensors, so
+   *        the order is the same on all processes, pairs are priced by their flop count, or if
+   *        there are at most CTF::CTR_ORDER_EST_MAX ops (none by default), by
+   *        contraction::estimate_time() (collective over their World)
+   * \param[in] ops tensors to contract
+   * \param[in] output tensor to write the result into and its indices
+   * \param[out] cost estimated cost of the order
+   * \return pairs of ops/intermediates contracted, ops are numbered 0..ops.size()-1 and
+   *         the intermediate produced by the kth pair is numbered ops.size()+k
+   */
+  static std::vector< std::pair<int,int> > order_contractions(std::vector<Idx_Tensor*> const & ops,
+                                                              Idx_Tensor const &               output,
+                                                              double &                         cost){
+    int n = ops.size();
+    int64_t lens[256];
+    std::bitset<256> out_inds;
+    std::vector<ctr_order_node> nodes(n);
+    for (int i=0; i<256; i++) lens[i] = 1;
+    for (int i=0; i<n; i++){
+      double sz = 1.;
+      for (int j=0; j<ops[i]->parent->order; j++){
+        unsigned char c = ops[i]->idx_map[j];
+        nodes[i].inds[c] = 1;
+        lens[c] = ops[i]->parent->lens[j];
+        sz *= (double)ops[i]->parent->lens[j];
+      }
+      nodes[i].dens = 1.;
+      if (ops[i]->parent->is_sparse && sz > 0.)
+        nodes[i].dens = std::min(1., ((double)ops[i]->parent->nnz_tot)/sz);
+    }
+    if (output.parent != NULL){
+      for (int j=0; j<output.parent->order; j++){
+        out_inds[(unsigned char)output.idx_map[j]] = 1;
+      }
+    }
+    std::vector< std::pair<int,int> > order;
+    cost = 0.;
+    if (n < 2) return order;
+    if (n == 2){
+      order.push_back(std::pair<int,int>(0,1));
+      cost = pair_cost(nodes[0], nodes[1], out_inds, lens);
+      return order;
+    }
+    if (n <= std::min(CTF::CTR_ORDER_DP_MAX, 20)){
+      int nset = 1<<n;
+      int full = nset-1;
+      std::vector< std::bitset<256> > sub_inds(nset);
+      std::vector<ctr_order_node> sub(nset);
+      std::vector<double> best(nset, 0.);
+      std::vector<int> split(nset, 0);
+      // tensors and labels standing for each subset of ops in a dry run, if pairs are priced by one
+      bool is_est = can_estimate_pairs(ops, output);
+      std::vector<tensor*> sub_tsr(nset, NULL);
+      std::vector< std::vector<char> > sub_idx(nset);
+      for (int S=1; S<nset; S++){
+        int low = S & (-S);
+        int i = 0;
+        while (low != (1<<i)) i++;
+        sub_inds[S] = sub_inds[S ^ low] | nodes[i].inds;
+      }
+      for (int S=1; S<nset; S++){
+        int low = S & (-S);
+        if (S == low){
+          int i = 0;
+          while (low != (1<<i)) i++;
+          sub[S] = nodes[i];
+          if (is_est){
+            sub_tsr[S] = ops[i]->parent;
+            sub_idx[S].assign(ops[i]->idx_map, ops[i]->idx_map+ops[i]->parent->order);
+          }
+          continue;
+        }
+        // indices of the intermediate are those needed by the output or by other operands
+        sub[S].inds = sub_inds[S] & (out_inds | sub_inds[full ^ S]);
+        sub[S].dens = 1.;
+        if (is_est){
+          if (S == full){
+            sub_tsr[S] = output.parent;
+            sub_idx[S].assign(output.idx_map, output.idx_map+output.parent->order);
+          } else
+            sub_tsr[S] = get_intm_shell(output.parent->sr, sub[S].inds, lens, output.parent->wrld, sub_idx[S]);
+        }
+        best[S] = -1.;
+        for (int L=(S-1)&S; L>0; L=(L-1)&S){
+          if (!(L & low)) continue;
+          int R = S ^ L;
+          double c = best[L] + best[R];
+          if (is_est){
+            contraction ctr(sub_tsr[L], sub_idx[L].data(), sub_tsr[R], sub_idx[R].data(), output.parent->sr->mulid(),
+                            sub_tsr[S], sub_idx[S].data(), output.parent->sr->addid());
+            c += ctr.estimate_time();
+          } else
+            c += pair_cost(sub[L], sub[R], sub[S].inds, lens);
+          if (best[S] < 0. || c < best[S]){
+            best[S]  = c;
+            split[S] = L;
+          }
+        }
+      }
+      if (is_est){
+        for (int S=1; S<full; S++){
+          if ((S & (S-1)) != 0) delete sub_tsr[S];
+        }
+      }
+      cost = best[full];
+      int nintm = n;
+      emit_ctr_order(full, &(split[0]), nintm, order);
+    } else {
+      std::vector<int> ids;
+      for (int i=0; i<n; i++) ids.push_back(i);
+      while (nodes.size() > 1){
+        int m = nodes.size();
+        int bi = -1, bj = -1;
+        double bc = 0.;
+        ctr_order_node bnode;
+        for (int i=0; i<m; i++){
+          for (int j=i+1; j<m; j++){
+            std::bitset<256> rest_inds = out_inds;
+            for (int k=0; k<m; k++){
+              if (k != i && k != j) rest_inds |= nodes[k].inds;
+            }
+            ctr_order_node nd;
+            nd.inds = (nodes[i].inds | nodes[j].inds) & rest_inds;
+            nd.dens = 1.;
+            double c = pair_cost(nodes[i], nodes[j], nd.inds, lens);
+            if (bi == -1 || c < bc){
+              bi = i;
+              bj = j;
+              bc = c;
+              bnode = nd;
+            }
+          }
+        }
+        order.push_back(std::pair<int,int>(ids[bi], ids[bj]));
+        cost += bc;
+        nodes.erase(nodes.begin()+bj);
+        nodes.erase(nodes.begin()+bi);
+        ids.erase(ids.begin()+bj);
+        ids.erase(ids.begin()+bi);
+        nodes.push_back(bnode);
+        ids.push_back(n+order.size()-1);
+      }
+    }
+    return order;
+  }
+
+  /**
+   * \brief moves a (possibly intermediate) tensor into a new Idx_Tensor, without copying its data
+   */
+  static Idx_Tensor * take_idx_tensor(Idx_Tensor & op){
+    Idx_Tensor * nop = new Idx_Tensor(op.parent, op.idx_map);
+    nop->is_intm = op.is_intm;
+    op.is_intm = 0;
+    nop->sr->safecopy(nop->scale, op.scale);
+    return nop;
+  }
+
+  /**
+   * \brief evaluates (or estimates the cost of) the operands of a contraction term, multiplying
+   *        the scaling factors of all operands into tscale
+   * \param[in] operands terms to evaluate
+   * \param[in] sr algebraic structure of the term
+   * \param[in,out] tscale scaling factor
+   * \param[in,out] cost if not NULL, the operands are not executed and their cost is added
+   * \return tensor operands
+   */
+  static std::vector<Idx_Tensor*> get_ctr_operands(std::vector<Term*> const & operands,
+                                                   algstrct const *           sr,
+                                                   char *&                    tscale,
+                                                   double *                   cost){
+    std::vector<Idx_Tensor*> ops;
+    for (int i=0; i<(int)operands.size(); i++){
+      Idx_Tensor op = cost == NULL ? operands[i]->execute() : operands[i]->estimate_time(*cost);
+      sr->safemul(tscale, op.scale, tscale);
+      if (op.parent != NULL)
+        ops.push_back(take_idx_tensor(op));
+    }
+    return ops;
+  }
+
+  /**
+   * \brief indices to keep in an intermediate, which are those of the output and
+   *        of the tensors remaining to be contracted (non-NULL entries of ops)
+   */
+  static std::vector<char> get_intm_inds(std::vector<Idx_Tensor*> const & ops,
+                                         Idx_Tensor const &               output){
+    std::set<char> uniq_inds;
+    for (int k=0; k<output.parent->order; k++){
+      uniq_inds.insert(output.idx_map[k]);
+    }
+    for (int j=0; j<(int)ops.size(); j++){
+      if (ops[j] != NULL){
+        for (int k=0; k<ops[j]->parent->order; k++){
+          uniq_inds.insert(ops[j]->idx_map[k]);
+        }
+      }
+    }
+    return std::vector<char>(uniq_inds.begin(), uniq_inds.end());
+  }
+
+
+  /**
+   * \brief performs the contraction of ops into output via CTF_int::mttkrp() if it is an MTTKRP
+   *        (a sparse tensor of order at least 3 times a dense matrix along all but one of its modes)
+   * \return whether the contraction was done
+   */
+  static bool execute_mttkrp(std::vector<Idx_Tensor*> const & ops,
+                             Idx_Tensor const &               output,
+                             char const *                     alpha){
+    int nops = ops.size();
+    if (nops < 3) return false;
+    tensor * tops[nops];
+    char const * idx_ops[nops];
+    for (int i=0; i<nops; i++){
+      tops[i] = ops[i]->parent;
+      idx_ops[i] = ops[i]->idx_map;
+    }
+    tensor * T;
+    tensor * mats[nops];
+    int r_first[nops];
+    int mode;
+    if (!get_mttkrp_roles(nops, tops, idx_ops, output.parent, output.idx_map, &T, mats, r_first, &mode)) return false;
+    mttkrp(T, mats, r_first, mode, alpha, output.parent, output.scale);
+    return true;
+  }
 
   //general Term functions, see ../../include/ctf.hpp for doxygen comments
 
@@ -447,6 +783,7 @@ namespace CTF_int {
       delete operands[i];
     }
     operands.clear();
+    if (mask != NULL) delete mask;
   }
 
 
@@ -462,6 +799,7 @@ namespace CTF_int {
 
 
   Contract_Term::Contract_Term(Term * B, Term * A) : Term(A->sr) {
+    mask = NULL;
     operands.push_back(B);
     operands.push_back(A);
   }
@@ -475,6 +813,7 @@ namespace CTF_int {
       Term * t = other.operands[i]->clone(remap);
       operands.push_back(t);
     }
+    mask = other.mask == NULL ? NULL : (Idx_Tensor*)other.mask->clone(remap);
   }
 
 
@@ -490,92 +829,62 @@ namespace CTF_int {
   }
 
 
+  Contract_Term Contract_Term::masked(Idx_Tensor const & M) const {
+    Contract_Term ct(*this);
+    if (ct.mask != NULL) delete ct.mask;
+    ct.mask = (Idx_Tensor*)M.clone();
+    return ct;
+  }
+
+
   void Contract_Term::execute(Idx_Tensor output)const {
-    std::vector< Term* > tmp_ops;
-    for (int i=0; i<(int)operands.size(); i++){
-      tmp_ops.push_back(operands[i]->clone());
-    }
     char * tscale = NULL;
     sr->safecopy(tscale, this->scale);
-    while (tmp_ops.size() > 2){
-      Term * pop_A = tmp_ops.back();
-      tmp_ops.pop_back();
-      Term * pop_B = tmp_ops.back();
-      tmp_ops.pop_back();
-      Idx_Tensor op_A = pop_A->execute();
-      Idx_Tensor op_B = pop_B->execute();
-      if (op_A.parent == NULL) {
-        sr->safemul(op_A.scale, op_B.scale, op_B.scale);
-        tmp_ops.push_back(op_B.clone());
-      } else if (op_B.parent == NULL) {
-        sr->safemul(op_A.scale, op_B.scale, op_A.scale);
-        tmp_ops.push_back(op_A.clone());
+    std::vector< Idx_Tensor* > ops = get_ctr_operands(operands, sr, tscale, NULL);
+    if (ops.size() == 0){
+      assert(0); //FIXME write scalar to whole tensor
+    } else if (ops.size() == 1){
+      if (mask != NULL){
+        masked_sum(ops[0]->parent, ops[0]->idx_map, tscale,
+                   output.parent, output.idx_map, output.scale, mask->parent, mask->idx_map);
       } else {
-        std::set<char> uniq_inds;
-        for (int k=0; k<output.parent->order; k++){
-          uniq_inds.insert(output.idx_map[k]);
-        }
-        std::set<Idx_Tensor*, tensor_name_less > inputs;
-        for (int j=0; j<(int)tmp_ops.size(); j++){
-          tmp_ops[j]->get_inputs(&inputs);
-        }
-        for (std::set<Idx_Tensor*>::iterator j=inputs.begin(); j!=inputs.end(); j++){
-          if ((*j)->parent != NULL){
-            for (int k=0; k<(*j)->parent->order; k++){
-              uniq_inds.insert((*j)->idx_map[k]);
-            }
-          }
-        }
-        std::vector<char> arr(uniq_inds.begin(), uniq_inds.end());
-
-        Idx_Tensor * intm = get_full_intm(op_A, op_B, uniq_inds.size(), &(arr[0]));
-        sr->safemul(tscale, op_A.scale, tscale);
-        sr->safemul(tscale, op_B.scale, tscale);
-        contraction c(op_A.parent, op_A.idx_map,
-                      op_B.parent, op_B.idx_map, tscale,
-                      intm->parent, intm->idx_map, intm->scale);
-        c.execute(); 
-        sr->safecopy(tscale, sr->mulid());
-        tmp_ops.push_back(intm);
-      }
-      delete pop_A;
-      delete pop_B;
-    } 
-    {
-      assert(tmp_ops.size() == 2);
-      Term * pop_B = tmp_ops.back();
-      tmp_ops.pop_back();
-      Term * pop_A = tmp_ops.back();
-      tmp_ops.pop_back();
-      Idx_Tensor op_A = pop_A->execute();
-      Idx_Tensor op_B = pop_B->execute();
-      if (tscale != NULL) cdealloc(tscale);
-      tscale = NULL;
-      sr->safecopy(tscale, this->scale);
-      sr->safemul(tscale, op_A.scale, tscale);
-      sr->safemul(tscale, op_B.scale, tscale);
-
-      if (op_A.parent == NULL && op_B.parent == NULL){
-        assert(0); //FIXME write scalar to whole tensor
-      } else if (op_A.parent == NULL){
-        summation s(op_B.parent, op_B.idx_map, tscale,
-                    output.parent, output.idx_map, output.scale);
-        s.execute();
-      } else if (op_B.parent == NULL){
-        summation s(op_A.parent, op_A.idx_map, tscale,
+        summation s(ops[0]->parent, ops[0]->idx_map, tscale,
                     output.parent, output.idx_map, output.scale);
         s.execute();
-      } else {
-        contraction c(op_A.parent, op_A.idx_map,
-                      op_B.parent, op_B.idx_map, tscale,
-                      output.parent, output.idx_map, output.scale);
-        c.execute();
       }
-      if (tscale != NULL) cdealloc(tscale);
-      tscale = NULL;
-      delete pop_A;
-      delete pop_B;
-    } 
+    } else if (mask != NULL || !execute_mttkrp(ops, output, tscale)){
+      double cost;
+      std::vector< std::pair<int,int> > order = order_contractions(ops, output, cost);
+      for (int k=0; k<(int)order.size(); k++){
+        Idx_Tensor * op_A = ops[order[k].first];
+        Idx_Tensor * op_B = ops[order[k].second];
+        ops[order[k].first]  = NULL;
+        ops[order[k].second] = NULL;
+        if (k == (int)order.size()-1 && mask != NULL){
+          masked_contract(op_A->parent, op_A->idx_map, op_B->parent, op_B->idx_map, tscale,
+                          output.parent, output.idx_map, output.scale, mask->parent, mask->idx_map);
+        } else if (k == (int)order.size()-1){
+          contraction c(op_A->parent, op_A->idx_map,
+                        op_B->parent, op_B->idx_map, tscale,
+                        output.parent, output.idx_map, output.scale);
+          c.execute();
+        } else {
+          std::vector<char> arr = get_intm_inds(ops, output);
+          Idx_Tensor * intm = get_full_intm(*op_A, *op_B, arr.size(), &(arr[0]));
+          contraction c(op_A->parent, op_A->idx_map,
+                        op_B->parent, op_B->idx_map, sr->mulid(),
+                        intm->parent, intm->idx_map, intm->scale);
+          c.execute(); 
+          ops.push_back(intm);
+        }
+        delete op_A;
+        delete op_B;
+      }
+    }
+    for (int i=0; i<(int)ops.size(); i++){
+      if (ops[i] != NULL) delete ops[i];
+    }
+    if (tscale != NULL) cdealloc(tscale);
   }
 
 
@@ -586,6 +895,7 @@ namespace CTF_int {
     }
     char * tscale = NULL;
     sr->safecopy(tscale, this->scale);
+    bool is_masked = false;
     while (tmp_ops.size() > 1){
       Term * pop_A = tmp_ops.back();
       tmp_ops.pop_back();
@@ -599,6 +909,16 @@ namespace CTF_int {
       } else if (op_B.parent == NULL) {
         sr->safemul(op_B.scale, op_A.scale, op_A.scale);
         tmp_ops.push_back(op_A.clone());
+      } else if (mask != NULL && tmp_ops.size() == 0){
+        // the masked product keeps only the indices of the mask
+        Idx_Tensor * intm = get_full_intm(op_A, op_B, mask->parent->order, mask->idx_map);
+        sr->safemul(tscale, op_A.scale, tscale);
+        sr->safemul(tscale, op_B.scale, tscale);
+        masked_contract(op_A.parent, op_A.idx_map, op_B.parent, op_B.idx_map, tscale,
+                        intm->parent, intm->idx_map, intm->scale, mask->parent, mask->idx_map);
+        sr->safecopy(tscale, sr->mulid());
+        tmp_ops.push_back(intm);
+        is_masked = true;
       } else {
         Idx_Tensor * intm = get_full_intm(op_A, op_B);
         sr->safemul(tscale, op_A.scale, tscale);
@@ -620,66 +940,60 @@ namespace CTF_int {
     Idx_Tensor rtsr = tmp_ops[0]->execute();
     delete tmp_ops[0];
     tmp_ops.clear();
+    if (mask != NULL && !is_masked && rtsr.parent != NULL){
+      // the last product involved a scalar (or there was a single tensor operand), so the mask is applied afterwards
+      Idx_Tensor * intm = get_full_intm(rtsr, rtsr, mask->parent->order, mask->idx_map);
+      masked_sum(rtsr.parent, rtsr.idx_map, rtsr.scale,
+                 intm->parent, intm->idx_map, intm->scale, mask->parent, mask->idx_map);
+      Idx_Tensor mtsr(std::move(*intm));
+      delete intm;
+      return mtsr;
+    }
     return rtsr;
   }
 
 
   double Contract_Term::estimate_time(Idx_Tensor output)const {
     double cost = 0.0;
-    std::vector< Term* > tmp_ops;
-    for (int i=0; i<(int)operands.size(); i++){
-      tmp_ops.push_back(operands[i]->clone());
-    }
-    while (tmp_ops.size() > 2){
-      Term * pop_A = tmp_ops.back();
-      tmp_ops.pop_back();
-      Term * pop_B = tmp_ops.back();
-      tmp_ops.pop_back();
-      Idx_Tensor op_A = pop_A->estimate_time(cost);
-      Idx_Tensor op_B = pop_B->estimate_time(cost);
-      if (op_A.parent == NULL) {
-        tmp_ops.push_back(op_B.clone());
-      } else if (op_B.parent == NULL) {
-        tmp_ops.push_back(op_A.clone());
-      } else {
-        Idx_Tensor * intm = get_full_intm(op_A, op_B);
-        contraction c(op_A.parent, op_A.idx_map,
-                      op_B.parent, op_B.idx_map, this->scale, 
-                      intm->parent, intm->idx_map, intm->scale);
-        cost += c.estimate_time();
-        tmp_ops.push_back(intm);
-      }
-      delete pop_A;
-      delete pop_B;
-    } 
-    {
-      assert(tmp_ops.size() == 2);
-      Term * pop_A = tmp_ops.back();
-      tmp_ops.pop_back();
-      Term * pop_B = tmp_ops.back();
-      tmp_ops.pop_back();
-      Idx_Tensor op_A = pop_A->estimate_time(cost);
-      Idx_Tensor op_B = pop_B->estimate_time(cost);
-      
-      if (op_A.parent == NULL && op_B.parent == NULL){
-        assert(0); //FIXME write scalar to whole tensor
-      } else if (op_A.parent == NULL){
-        summation s(op_B.parent, op_B.idx_map, this->scale,
-                    output.parent, output.idx_map, output.scale);
-        cost += s.estimate_time();
-      } else if (op_B.parent == NULL){
-        summation s(op_A.parent, op_A.idx_map, this->scale,
-                    output.parent, output.idx_map, output.scale);
-        cost += s.estimate_time();
-      } else {
-        contraction c(op_A.parent, op_A.idx_map,
-                      op_B.parent, op_B.idx_map, this->scale,
-                      output.parent, output.idx_map, output.scale);
-        cost += c.estimate_time();
+    char * tscale = NULL;
+    sr->safecopy(tscale, this->scale);
+    std::vector< Idx_Tensor* > ops = get_ctr_operands(operands, sr, tscale, &cost);
+    if (ops.size() == 0){
+      assert(0); //FIXME write scalar to whole tensor
+    } else if (ops.size() == 1){
+      summation s(ops[0]->parent, ops[0]->idx_map, tscale,
+                  output.parent, output.idx_map, output.scale);
+      cost += s.estimate_time();
+    } else {
+      double ocost;
+      std::vector< std::pair<int,int> > order = order_contractions(ops, output, ocost);
+      for (int k=0; k<(int)order.size(); k++){
+        Idx_Tensor * op_A = ops[order[k].first];
+        Idx_Tensor * op_B = ops[order[k].second];
+        ops[order[k].first]  = NULL;
+        ops[order[k].second] = NULL;
+        if (k == (int)order.size()-1){
+          contraction c(op_A->parent, op_A->idx_map,
+                        op_B->parent, op_B->idx_map, tscale,
+                        output.parent, output.idx_map, output.scale);
+          cost += c.estimate_time();
+        } else {
+          std::vector<char> arr = get_intm_inds(ops, output);
+          Idx_Tensor * intm = get_full_intm(*op_A, *op_B, arr.size(), &(arr[0]));
+          contraction c(op_A->parent, op_A->idx_map,
+                        op_B->parent, op_B->idx_map, sr->mulid(),
+                        intm->parent, intm->idx_map, intm->scale);
+          cost += c.estimate_time();
+          ops.push_back(intm);
+        }
+        delete op_A;
+        delete op_B;
       }
-      delete pop_A;
-      delete pop_B;
-    } 
+    }
+    for (int i=0; i<(int)ops.size(); i++){
+      if (ops[i] != NULL) delete ops[i];
+    }
+    if (tscale != NULL) cdealloc(tscale);
     return cost;
   }
 
@@ -717,6 +1031,35 @@ namespace CTF_int {
 
 
 
+  std::vector< std::pair<int,int> > Contract_Term::get_contraction_order(Idx_Tensor output,
+                                                                         double *   cost) const {
+    std::vector< Idx_Tensor* > ops;
+    std::vector<int> pos;
+    double ecost = 0.0;
+    for (int i=0; i<(int)operands.size(); i++){
+      Idx_Tensor op = operands[i]->estimate_time(ecost);
+      if (op.parent != NULL){
+        ops.push_back(take_idx_tensor(op));
+        pos.push_back(i);
+      }
+    }
+    double ocost;
+    std::vector< std::pair<int,int> > order = order_contractions(ops, output, ocost);
+    if (cost != NULL) *cost = ocost;
+    // renumber in terms of positions in operands
+    int n = ops.size();
+    for (int k=0; k<(int)order.size(); k++){
+      if (order[k].first < n) order[k].first = pos[order[k].first];
+      else order[k].first += operands.size()-n;
+      if (order[k].second < n) order[k].second = pos[order[k].second];
+      else order[k].second += operands.size()-n;
+    }
+    for (int i=0; i<n; i++){
+      delete ops[i];
+    }
+    return order;
+  }
+
   void Contract_Term::get_inputs(std::set<Idx_Tensor*, tensor_name_less >* inputs_set) const {
     for (int i=0; i<(int)operands.size(); i++){
       operands[i]->get_inputs(inputs_set);
@@ -240,6 +240,8 @@ namespace CTF_int {
   class Contract_Term : public Term {
     public:
       std::vector< Term* > operands;
+      /** \brief if not NULL, only the entries of the product at the nonzeros of this sparse tensor are computed */
+      CTF::Idx_Tensor * mask;
 
  
       /**
@@ -291,13 +293,32 @@ namespace CTF_int {
        * \return output tensor to write results into and its indices
        */
       CTF::Idx_Tensor estimate_time(double  & cost) const;
-      
-      
+
+      /**
+       * \brief chooses the order in which the tensor operands are contracted pairwise when
+       *        the term is written into output, minimizing the estimated number of operations
+       *        (accounting for sparsity of operands) and the size of intermediates
+       * \param[in] output tensor to write results into and its indices
+       * \param[out] cost if not NULL, set to the estimated cost of the chosen order
+       * \return pairs of operands in the order they are contracted, operands are numbered by
+       *         their position in operands and the intermediate produced by the kth pair
+       *         is numbered operands.size()+k, scalar operands are not contracted
+       */
+      std::vector< std::pair<int,int> > get_contraction_order(CTF::Idx_Tensor output,
+                                                              double *        cost=NULL) const;
+
       /**
        * \brief override contraction to grow vector rather than create recursive terms
        * \param[in] A term to multiply by
        */
       Contract_Term operator*(Term const & A) const;
+
+      /**
+       * \brief restricts the term to the nonzeros of a sparse tensor, e.g. C["ij"] = (A["ik"]*B["kj"]).masked(M["ij"])
+       *        computes only the entries C_{ij} such that M_{ij} is stored (see CTF_int::masked_contract)
+       * \param[in] M sparse mask tensor and its indices, which must be those of the output
+       */
+      Contract_Term masked(CTF::Idx_Tensor const & M) const;
  
       /**
        * \brief negates term
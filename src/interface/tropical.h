@@ -0,0 +1,433 @@
+#ifndef __TROPICAL_H__
+#define __TROPICAL_H__
+
+#include <limits>
+#if defined(__AVX__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace CTF_int {
+
+  /**
+   * \brief additive identity of the min-plus (is_max=false) or max-plus (is_max=true) semiring,
+   *        which is infinity for floating point types and the largest (smallest) value otherwise
+   */
+  template <typename dtype, bool is_max>
+  inline dtype tropical_addid(){
+    if (std::numeric_limits<dtype>::has_infinity)
+      return is_max ? -std::numeric_limits<dtype>::infinity() : std::numeric_limits<dtype>::infinity();
+    else
+      return is_max ? std::numeric_limits<dtype>::lowest() : std::numeric_limits<dtype>::max();
+  }
+
+  /**
+   * \brief addition of the min-plus semiring
+   */
+  template <typename dtype>
+  struct tropical_min {
+    dtype operator()(dtype a, dtype b) const { return std::min(a,b); }
+  };
+
+  /**
+   * \brief addition of the max-plus semiring
+   */
+  template <typename dtype>
+  struct tropical_max {
+    dtype operator()(dtype a, dtype b) const { return std::max(a,b); }
+  };
+
+  /**
+   * \brief multiplication of the min-plus (is_max=false) or max-plus (is_max=true) semiring,
+   *        for types without infinity the additive identity is absorbing rather than overflowing
+   */
+  template <typename dtype, bool is_max>
+  struct tropical_plus {
+    dtype operator()(dtype a, dtype b) const {
+      if (std::numeric_limits<dtype>::has_infinity) return a+b;
+      dtype inf = tropical_addid<dtype, is_max>();
+      return (a == inf || b == inf) ? inf : a+b;
+    }
+  };
+
+  /**
+   * \brief acc[j] = min(acc[j], a+b[j]) (max if is_max) for j in [0,n)
+   */
+  template <typename dtype, bool is_max>
+  inline void tropical_axpy(int           n,
+                            dtype         a,
+                            dtype const * b,
+                            dtype *       acc){
+    typename std::conditional<is_max, tropical_max<dtype>, tropical_min<dtype> >::type fadd;
+    tropical_plus<dtype, is_max> fmul;
+    for (int j=0; j<n; j++){
+      acc[j] = fadd(fmul(a, b[j]), acc[j]);
+    }
+  }
+
+#if defined(__AVX512F__) || defined(__AVX__)
+  // min(acc,p) and max(acc,p) return p when either is NaN, matching std::min(p,acc) and std::max(p,acc)
+#ifdef __AVX512F__
+  template <bool is_max>
+  inline __m512d tropical_vop(__m512d acc, __m512d p){
+    return is_max ? _mm512_max_pd(acc, p) : _mm512_min_pd(acc, p);
+  }
+  template <bool is_max>
+  inline __m512 tropical_vop(__m512 acc, __m512 p){
+    return is_max ? _mm512_max_ps(acc, p) : _mm512_min_ps(acc, p);
+  }
+#endif
+  template <bool is_max>
+  inline __m256d tropical_vop(__m256d acc, __m256d p){
+    return is_max ? _mm256_max_pd(acc, p) : _mm256_min_pd(acc, p);
+  }
+  template <bool is_max>
+  inline __m256 tropical_vop(__m256 acc, __m256 p){
+    return is_max ? _mm256_max_ps(acc, p) : _mm256_min_ps(acc, p);
+  }
+
+  template <bool is_max>
+  inline void tropical_axpy_d(int            n,
+                              double         a,
+                              double const * b,
+                              double *       acc){
+    int j=0;
+#ifdef __AVX512F__
+    __m512d va8 = _mm512_set1_pd(a);
+    for (; j+8<=n; j+=8){
+      _mm512_storeu_pd(acc+j, tropical_vop<is_max>(_mm512_loadu_pd(acc+j), _mm512_add_pd(va8, _mm512_loadu_pd(b+j))));
+    }
+#endif
+    __m256d va = _mm256_set1_pd(a);
+    for (; j+4<=n; j+=4){
+      _mm256_storeu_pd(acc+j, tropical_vop<is_max>(_mm256_loadu_pd(acc+j), _mm256_add_pd(va, _mm256_loadu_pd(b+j))));
+    }
+    for (; j<n; j++){
+      double p = a+b[j];
+      acc[j] = is_max ? std::max(p, acc[j]) : std::min(p, acc[j]);
+    }
+  }
+
+  template <bool is_max>
+  inline void tropical_axpy_s(int           n,
+                              float         a,
+                              float const * b,
+                              float *       acc){
+    int j=0;
+#ifdef __AVX512F__
+    __m512 va16 = _mm512_set1_ps(a);
+    for (; j+16<=n; j+=16){
+      _mm512_storeu_ps(acc+j, tropical_vop<is_max>(_mm512_loadu_ps(acc+j), _mm512_add_ps(va16, _mm512_loadu_ps(b+j))));
+    }
+#endif
+    __m256 va = _mm256_set1_ps(a);
+    for (; j+8<=n; j+=8){
+      _mm256_storeu_ps(acc+j, tropical_vop<is_max>(_mm256_loadu_ps(acc+j), _mm256_add_ps(va, _mm256_loadu_ps(b+j))));
+    }
+    for (; j<n; j++){
+      float p = a+b[j];
+      acc[j] = is_max ? std::max(p, acc[j]) : std::min(p, acc[j]);
+    }
+  }
+
+  template <>
+  inline void tropical_axpy<double, false>(int n, double a, double const * b, double * acc){
+    tropical_axpy_d<false>(n, a, b, acc);
+  }
+  template <>
+  inline void tropical_axpy<double, true>(int n, double a, double const * b, double * acc){
+    tropical_axpy_d<true>(n, a, b, acc);
+  }
+  template <>
+  inline void tropical_axpy<float, false>(int n, float a, float const * b, float * acc){
+    tropical_axpy_s<false>(n, a, b, acc);
+  }
+  template <>
+  inline void tropical_axpy<float, true>(int n, float a, float const * b, float * acc){
+    tropical_axpy_s<true>(n, a, b, acc);
+  }
+
+  /**
+   * \brief register tile of srgemm for double precision tropical semirings,
+   *        each of the NR=4 columns of the MR=8 row tile is kept in one 512-bit or two 256-bit registers
+   */
+  template <bool is_max>
+  inline void tropical_micro_d(int            kc,
+                               double const * pA,
+                               double const * pB,
+                               double *       C,
+                               int64_t        ldc){
+    static_assert(srgemm_blk<double>::MR == 8 && srgemm_blk<double>::NR == 4, "tropical micro-kernel assumes an 8-by-4 register tile");
+#ifdef __AVX512F__
+    __m512d c0 = _mm512_loadu_pd(C);
+    __m512d c1 = _mm512_loadu_pd(C+ldc);
+    __m512d c2 = _mm512_loadu_pd(C+2*ldc);
+    __m512d c3 = _mm512_loadu_pd(C+3*ldc);
+    for (int l=0; l<kc; l++){
+      __m512d a = _mm512_loadu_pd(pA+l*8);
+      c0 = tropical_vop<is_max>(c0, _mm512_add_pd(a, _mm512_set1_pd(pB[l*4])));
+      c1 = tropical_vop<is_max>(c1, _mm512_add_pd(a, _mm512_set1_pd(pB[l*4+1])));
+      c2 = tropical_vop<is_max>(c2, _mm512_add_pd(a, _mm512_set1_pd(pB[l*4+2])));
+      c3 = tropical_vop<is_max>(c3, _mm512_add_pd(a, _mm512_set1_pd(pB[l*4+3])));
+    }
+    _mm512_storeu_pd(C, c0);
+    _mm512_storeu_pd(C+ldc, c1);
+    _mm512_storeu_pd(C+2*ldc, c2);
+    _mm512_storeu_pd(C+3*ldc, c3);
+#else
+    __m256d c[4][2];
+    for (int j=0; j<4; j++){
+      c[j][0] = _mm256_loadu_pd(C+j*ldc);
+      c[j][1] = _mm256_loadu_pd(C+j*ldc+4);
+    }
+    for (int l=0; l<kc; l++){
+      __m256d a0 = _mm256_loadu_pd(pA+l*8);
+      __m256d a1 = _mm256_loadu_pd(pA+l*8+4);
+      for (int j=0; j<4; j++){
+        __m256d b = _mm256_broadcast_sd(pB+l*4+j);
+        c[j][0] = tropical_vop<is_max>(c[j][0], _mm256_add_pd(a0, b));
+        c[j][1] = tropical_vop<is_max>(c[j][1], _mm256_add_pd(a1, b));
+      }
+    }
+    for (int j=0; j<4; j++){
+      _mm256_storeu_pd(C+j*ldc, c[j][0]);
+      _mm256_storeu_pd(C+j*ldc+4, c[j][1]);
+    }
+#endif
+  }
+
+  /**
+   * \brief register tile of srgemm for single precision tropical semirings,
+   *        each of the NR=4 columns of the MR=8 row tile is kept in one 256-bit register
+   */
+  template <bool is_max>
+  inline void tropical_micro_s(int           kc,
+                               float const * pA,
+                               float const * pB,
+                               float *       C,
+                               int64_t       ldc){
+    static_assert(srgemm_blk<float>::MR == 8 && srgemm_blk<float>::NR == 4, "tropical micro-kernel assumes an 8-by-4 register tile");
+    __m256 c0 = _mm256_loadu_ps(C);
+    __m256 c1 = _mm256_loadu_ps(C+ldc);
+    __m256 c2 = _mm256_loadu_ps(C+2*ldc);
+    __m256 c3 = _mm256_loadu_ps(C+3*ldc);
+    for (int l=0; l<kc; l++){
+      __m256 a = _mm256_loadu_ps(pA+l*8);
+      c0 = tropical_vop<is_max>(c0, _mm256_add_ps(a, _mm256_broadcast_ss(pB+l*4)));
+      c1 = tropical_vop<is_max>(c1, _mm256_add_ps(a, _mm256_broadcast_ss(pB+l*4+1)));
+      c2 = tropical_vop<is_max>(c2, _mm256_add_ps(a, _mm256_broadcast_ss(pB+l*4+2)));
+      c3 = tropical_vop<is_max>(c3, _mm256_add_ps(a, _mm256_broadcast_ss(pB+l*4+3)));
+    }
+    _mm256_storeu_ps(C, c0);
+    _mm256_storeu_ps(C+ldc, c1);
+    _mm256_storeu_ps(C+2*ldc, c2);
+    _mm256_storeu_ps(C+3*ldc, c3);
+  }
+
+#define TROPICAL_MICRO_DEF(dtype, is_max, fadd_t, kernel) \
+  template <> \
+  inline void srgemm_micro<dtype, fadd_t<dtype>, tropical_plus<dtype, is_max> > \
+                     (int           kc, \
+                      int           mr, \
+                      int           nr, \
+                      dtype const * pA, \
+                      dtype const * pB, \
+                      dtype *       C, \
+                      int64_t       ldc, \
+                      fadd_t<dtype> fadd, \
+                      tropical_plus<dtype, is_max> fmul){ \
+    if (mr == srgemm_blk<dtype>::MR && nr == srgemm_blk<dtype>::NR){ \
+      kernel<is_max>(kc, pA, pB, C, ldc); \
+    } else { \
+      for (int j=0; j<nr; j++){ \
+        for (int l=0; l<kc; l++){ \
+          tropical_axpy<dtype, is_max>(mr, pB[l*nr+j], pA+l*mr, C+j*ldc); \
+        } \
+      } \
+    } \
+  }
+
+  TROPICAL_MICRO_DEF(double, false, tropical_min, tropical_micro_d)
+  TROPICAL_MICRO_DEF(double, true,  tropical_max, tropical_micro_d)
+  TROPICAL_MICRO_DEF(float,  false, tropical_min, tropical_micro_s)
+  TROPICAL_MICRO_DEF(float,  true,  tropical_max, tropical_micro_s)
+#undef TROPICAL_MICRO_DEF
+#endif
+
+  /**
+   * \brief C["ij"]=beta*C["ij"]+alpha*A["ik"]*B["kj"] for a tropical semiring with A in 1-based CSR format,
+   *        B is transposed so that each nonzero of A updates a contiguous row of C with tropical_axpy
+   * \param[in] m number of rows of A and C
+   * \param[in] n number of columns of B and C
+   * \param[in] k number of columns of A and rows of B
+   * \param[in] alpha scaling factor
+   * \param[in] A nonzeros of A
+   * \param[in] JA column indices of nonzeros of A
+   * \param[in] IA row offsets of A
+   * \param[in] B dense column-major k-by-n matrix
+   * \param[in] beta scaling factor of C
+   * \param[in,out] C dense column-major m-by-n matrix
+   */
+  template <typename dtype, bool is_max, typename idx_t>
+  void tropical_csrmm(int           m,
+                      int           n,
+                      int           k,
+                      dtype         alpha,
+                      dtype const * A,
+                      idx_t const * JA,
+                      idx_t const * IA,
+                      dtype const * B,
+                      dtype         beta,
+                      dtype *       C){
+    typename std::conditional<is_max, tropical_max<dtype>, tropical_min<dtype> >::type fadd;
+    tropical_plus<dtype, is_max> fmul;
+    dtype addid = tropical_addid<dtype, is_max>();
+    dtype * tB = (dtype*)alloc(sizeof(dtype)*((int64_t)k)*n);
+#ifdef _OPENMP
+    #pragma omp parallel for
+#endif
+    for (int j=0; j<n; j++){
+      for (int l=0; l<k; l++){
+        tB[((int64_t)l)*n+j] = B[((int64_t)j)*k+l];
+      }
+    }
+#ifdef _OPENMP
+    #pragma omp parallel
+#endif
+    {
+      dtype * acc = (dtype*)alloc(sizeof(dtype)*n);
+#ifdef _OPENMP
+      #pragma omp for schedule(dynamic,16)
+#endif
+      for (int row_A=0; row_A<m; row_A++){
+        if (IA[row_A] < IA[row_A+1]){
+          std::fill(acc, acc+n, addid);
+          for (int64_t i_A=IA[row_A]-1; i_A<IA[row_A+1]-1; i_A++){
+            tropical_axpy<dtype, is_max>(n, A[i_A], tB+((int64_t)(JA[i_A]-1))*n, acc);
+          }
+          for (int j=0; j<n; j++){
+            C[((int64_t)j)*m+row_A] = fadd(fmul(beta, C[((int64_t)j)*m+row_A]), fmul(alpha, acc[j]));
+          }
+        } else {
+          for (int j=0; j<n; j++){
+            C[((int64_t)j)*m+row_A] = fmul(beta, C[((int64_t)j)*m+row_A]);
+          }
+        }
+      }
+      cdealloc(acc);
+    }
+    cdealloc(tB);
+  }
+}
+
+namespace CTF {
+  /**
+   * \addtogroup algstrct
+   * @{
+   */
+
+  /**
+   * \brief tropical semiring with addition min (is_max=false) or max (is_max=true) and multiplication +,
+   *        the library provides vectorized dense and CSR kernels for it when compiled with AVX or AVX-512
+   */
+  template <typename dtype, bool is_max>
+  class Tropical : public Semiring_Op<dtype,
+                                      typename std::conditional<is_max, CTF_int::tropical_max<dtype>, CTF_int::tropical_min<dtype> >::type,
+                                      CTF_int::tropical_plus<dtype, is_max> > {
+    public:
+      typedef typename std::conditional<is_max, CTF_int::tropical_max<dtype>, CTF_int::tropical_min<dtype> >::type fadd_t;
+      typedef CTF_int::tropical_plus<dtype, is_max> fmul_t;
+
+      Tropical(Tropical const & other) : Semiring_Op<dtype, fadd_t, fmul_t>(other) { }
+
+      virtual CTF_int::algstrct * clone() const {
+        return new Tropical<dtype, is_max>(*this);
+      }
+
+      Tropical() : Semiring_Op<dtype, fadd_t, fmul_t>(CTF_int::tropical_addid<dtype, is_max>(), fadd_t(), is_max ? MPI_MAX : MPI_MIN, dtype(0), fmul_t()) {
+        static_assert(!is_max || std::numeric_limits<dtype>::is_signed, "CTF ERROR: max-plus semiring requires a signed type");
+      }
+
+      void csrmm(int          m,
+                 int          n,
+                 int          k,
+                 char const * alpha,
+                 char const * A,
+                 int const *  JA,
+                 int const *  IA,
+                 int64_t      nnz_A,
+                 char const * B,
+                 char const * beta,
+                 char *       C,
+                 CTF_int::bivar_function const * func) const {
+        assert(func == NULL);
+        // transposing B pays off only if there are a few columns to vectorize over
+        if (n < 4 || nnz_A < k)
+          Semiring_Op<dtype, fadd_t, fmul_t>::csrmm(m, n, k, alpha, A, JA, IA, nnz_A, B, beta, C, func);
+        else
+          CTF_int::tropical_csrmm<dtype, is_max>(m, n, k, ((dtype const *)alpha)[0], (dtype const *)A, JA, IA, (dtype const *)B, ((dtype const *)beta)[0], (dtype *)C);
+      }
+
+      void csrmm(int                         m,
+                 int                         n,
+                 int                         k,
+                 char const *                alpha,
+                 CTF_int::CSR_Matrix const & A,
+                 char const *                B,
+                 char const *                beta,
+                 char *                      C) const {
+        if (n < 4 || A.nnz() < k){
+          Semiring_Op<dtype, fadd_t, fmul_t>::csrmm(m, n, k, alpha, A, B, beta, C);
+          return;
+        }
+        dtype a = ((dtype const *)alpha)[0], b = ((dtype const *)beta)[0];
+        dtype const * vA = (dtype const *)A.vals();
+        switch (A.idx_width()){
+          case 2:
+            CTF_int::tropical_csrmm<dtype, is_max>(m, n, k, a, vA, (int16_t const*)A.JA_raw(), (int16_t const*)A.IA_raw(), (dtype const *)B, b, (dtype *)C);
+            break;
+          case 4:
+            CTF_int::tropical_csrmm<dtype, is_max>(m, n, k, a, vA, (int32_t const*)A.JA_raw(), (int32_t const*)A.IA_raw(), (dtype const *)B, b, (dtype *)C);
+            break;
+          default:
+            CTF_int::tropical_csrmm<dtype, is_max>(m, n, k, a, vA, (int64_t const*)A.JA_raw(), (int64_t const*)A.IA_raw(), (dtype const *)B, b, (dtype *)C);
+            break;
+        }
+      }
+  };
+
+  /**
+   * \brief min-plus (tropical) semiring, e.g. for shortest path computations,
+   *        the additive identity is infinity (or the largest value for integer types)
+   */
+  template <typename dtype=double>
+  class MinPlus : public Tropical<dtype, false> {
+    public:
+      MinPlus(MinPlus const & other) : Tropical<dtype, false>(other) { }
+
+      virtual CTF_int::algstrct * clone() const {
+        return new MinPlus<dtype>(*this);
+      }
+
+      MinPlus() : Tropical<dtype, false>() { }
+  };
+
+  /**
+   * \brief max-plus semiring, e.g. for longest path computations,
+   *        the additive identity is -infinity (or the smallest value for integer types)
+   */
+  template <typename dtype=double>
+  class MaxPlus : public Tropical<dtype, true> {
+    public:
+      MaxPlus(MaxPlus const & other) : Tropical<dtype, true>(other) { }
+
+      virtual CTF_int::algstrct * clone() const {
+        return new MaxPlus<dtype>(*this);
+      }
+
+      MaxPlus() : Tropical<dtype, true>() { }
+  };
+  /**
+   * @}
+   */
+}
+#endif
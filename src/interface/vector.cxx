@@ -25,6 +25,12 @@ namespace CTF {
     len = A.len;
   }
 
+  template<typename dtype>
+  Vector<dtype>::Vector(Vector<dtype> && A) noexcept
+    : Tensor<dtype>(std::move(A)) {
+    len = A.len;
+  }
+
   template<typename dtype>
   Vector<dtype>::Vector(Tensor<dtype> const & A)
     : Tensor<dtype>(A) {
@@ -72,8 +78,15 @@ namespace CTF {
 
   template<typename dtype>
   Vector<dtype> & Vector<dtype>::operator=(const Vector<dtype> & A){
-    CTF_int::tensor::free_self();
-    CTF_int::tensor::init(A.sr, A.order, A.lens, A.sym, A.wrld, 1, A.name, A.profile, A.is_sparse);
+    Tensor<dtype>::operator=(A);
+    len = A.len;
+    return *this;
+  }
+
+  template<typename dtype>
+  Vector<dtype> & Vector<dtype>::operator=(Vector<dtype> && A){
+    len = A.len;
+    Tensor<dtype>::operator=(std::move(A));
     return *this;
   }
 
@@ -25,6 +25,12 @@ namespace CTF {
        */
       Vector<dtype>(Vector<dtype> const & A);
 
+      /** 
+       * \brief move constructor for a vector
+       * \param[in,out] A vector to move from without copying its data, left empty
+       */
+      Vector<dtype>(Vector<dtype> && A) noexcept;
+
       /** 
        * \brief casts a tensor to a matrix
        * \param[in] A tensor object of order 1
@@ -82,8 +88,17 @@ namespace CTF {
              CTF_int::algstrct const & sr=Ring<dtype>());
 
 
-
+      /** 
+       * \brief sets the vector, copying the data of A
+       * \param[in] A vector to copy
+       */
       Vector<dtype> & operator=(const Vector<dtype> & A);
+
+      /** 
+       * \brief sets the vector, taking the data of A without copying it
+       * \param[in,out] A vector to move from, left empty
+       */
+      Vector<dtype> & operator=(Vector<dtype> && A);
   /**
    * @}
    */
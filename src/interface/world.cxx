@@ -5,6 +5,9 @@
 #include "../shared/util.h"
 #include "../shared/memcontrol.h"
 #include "../shared/offload.h"
+#include "../tensor/intm_pool.h"
+#include "../contraction/ctr_plan_cache.h"
+#include "subworld_cache.h"
 
 extern "C"
 {
@@ -80,6 +83,12 @@ namespace CTF {
   World::World(char const * emptystring){}
 
   World::~World(){
+    // universe is destroyed at exit, possibly after MPI_Finalize, so what it cached is left to the process
+    if (this != &universe){
+      CTF_int::get_ctr_plan_cache().clear(this);
+      CTF_int::get_intm_pool().clear(this);
+      CTF_int::get_subworld_cache().clear(this);
+    }
     if (!is_copy && this != &universe){
       for (int i=0; i<(int)topovec.size(); i++){
         delete topovec[i];
@@ -112,6 +121,7 @@ namespace CTF {
                   int             argc,
                   const char * const *  argv){
     cdt = CommData(comm);
+    set_node_size(cdt);
     if (mach == TOPOLOGY_GENERIC)
       phys_topology = NULL;
     else
@@ -127,6 +137,7 @@ namespace CTF {
                   const char * const * argv){
 
     cdt = CommData(global_context);
+    set_node_size(cdt);
     phys_topology = new topology(order, dim_len, cdt, 1);
 
     return initialize(argc, argv);
@@ -204,17 +215,15 @@ namespace CTF {
         }
   #endif
       } else {
-#if 0
         int64_t imst_size = 0 ;
         if (mst_size != NULL) 
-          imst_size = strtoull(mst_size,NULL,0);
+          imst_size = strtoll(mst_size,NULL,0);
         if (stack_size != NULL)
-          imst_size = MAX(imst_size,strtoull(stack_size,NULL,0));
+          imst_size = MAX(imst_size,strtoll(stack_size,NULL,0));
         if (rank == 0)
-          printf("Creating stack of size %ld due to CTF_STACK_SIZE enviroment variable\n",
+          VPRINTF(1,"Reserving %ld bytes for temporary buffers due to CTF_MST_SIZE/CTF_STACK_SIZE environment variable\n",
                     imst_size);
         CTF_int::mst_create(imst_size);
-#endif
       }
       mem_size = getenv("CTF_MEMORY_SIZE");
       if (mem_size != NULL){
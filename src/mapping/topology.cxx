@@ -8,6 +8,11 @@
 #include "mpix.h"
 #endif
 
+namespace CTF {
+  int RANKS_PER_NODE = 0;
+  double INTER_NODE_COMM_COST = 4.;
+}
+
 namespace CTF_int {
 /*
   topology::topology(){
@@ -65,6 +70,8 @@ namespace CTF_int {
       dim_comm[i] = CommData(((rank/stride)%lens[i]),
                              (((rank/(stride*lens[i]))*stride)+cut),
                              lens[i]);
+      // ranks along a dimension share a node only if the dimension and all faster ones fit within a node
+      dim_comm[i].inter_node = glb_comm.inter_node && (glb_comm.node_size % (stride*lens[i]) != 0);
 //      SETUP_SUB_COMM_SHELL(cdt, dim_comm[i],
       stride*=lens[i];
       cut = (rank - (rank/stride)*stride);
@@ -91,6 +98,36 @@ namespace CTF_int {
     is_activated = false;
   }
 
+  int get_node_size(CommData const & cdt){
+    if (CTF::RANKS_PER_NODE > 0)
+      return gcd(CTF::RANKS_PER_NODE, cdt.np);
+    int node_size = 1;
+#if MPI_VERSION >= 3
+    TAU_FSTART(get_node_size);
+    MPI_Comm node_cm;
+    int node_np, node_rank;
+    MPI_Comm_split_type(cdt.cm, MPI_COMM_TYPE_SHARED, cdt.rank, MPI_INFO_NULL, &node_cm);
+    MPI_Comm_size(node_cm, &node_np);
+    MPI_Comm_rank(node_cm, &node_rank);
+    // nodes may be used as blocks of the topology only if each holds the same number of consecutive ranks
+    int first = cdt.rank - node_rank;
+    int first_max;
+    MPI_Allreduce(&first, &first_max, 1, MPI_INT, MPI_MAX, node_cm);
+    MPI_Comm_free(&node_cm);
+    int lyt[3] = {first == first_max && first % node_np == 0, node_np, -node_np};
+    MPI_Allreduce(MPI_IN_PLACE, lyt, 3, MPI_INT, MPI_MIN, cdt.cm);
+    if (lyt[0] && lyt[1] == -lyt[2])
+      node_size = node_np;
+    TAU_FSTOP(get_node_size);
+#endif
+    return node_size;
+  }
+
+  void set_node_size(CommData & cdt){
+    cdt.node_size  = get_node_size(cdt);
+    cdt.inter_node = cdt.node_size < cdt.np;
+  }
+
   topology * get_phys_topo(CommData glb_comm,
                            TOPOLOGY mach){
     int np = glb_comm.np;
@@ -106,7 +143,19 @@ namespace CTF_int {
     }
     if (mach == TOPOLOGY_GENERIC){
       int order;
-      factorize(np, &order, &dim_len);
+      if (glb_comm.inter_node && glb_comm.node_size > 1){
+        // factor nodes and the number of nodes separately, so that leading dimensions are within a node
+        int intra_order, inter_order, * intra_len, * inter_len;
+        factorize(glb_comm.node_size, &intra_order, &intra_len);
+        factorize(np/glb_comm.node_size, &inter_order, &inter_len);
+        order = intra_order+inter_order;
+        dim_len = (int*)CTF_int::alloc(order*sizeof(int));
+        memcpy(dim_len, intra_len, intra_order*sizeof(int));
+        memcpy(dim_len+intra_order, inter_len, inter_order*sizeof(int));
+        if (intra_order>0) CTF_int::cdealloc(intra_len);
+        if (inter_order>0) CTF_int::cdealloc(inter_len);
+      } else
+        factorize(np, &order, &dim_len);
       topo = new topology(order, dim_len, glb_comm, 1);
       if (order>0) CTF_int::cdealloc(dim_len);
       return topo;
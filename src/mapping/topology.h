@@ -48,6 +48,22 @@ namespace CTF_int {
       void deactivate();
   };
 
+  /**
+   * \brief computes the number of consecutive ranks of a communicator that share a node,
+   *        CTF::RANKS_PER_NODE if set (reduced to a divisor of the number of processes),
+   *        otherwise detected via MPI_Comm_split_type, or 1 if nodes do not hold equal blocks of consecutive ranks
+   * \param[in] cdt active communicator, call is collective over it
+   * \return number of ranks per node
+   */
+  int get_node_size(CommData const & cdt);
+
+  /**
+   * \brief sets node_size and inter_node of a communicator via get_node_size, so that
+   *        topologies built on it mark which of their dimensions span nodes
+   * \param[in,out] cdt active communicator, call is collective over it
+   */
+  void set_node_size(CommData & cdt);
+
   /**
    * \brief get dimension and torus lengths of specified topology
    *
@@ -2,6 +2,7 @@
 
 #include "dgtog_calc_cnt.h"
 #include "dgtog_redist.h"
+#include "redist_plan_cache.h"
 #include "../shared/util.h"
 #include "dgtog_bucket.h"
 namespace CTF_int {
@@ -331,97 +331,46 @@ void dgtog_reshuffle(int const *          sym,
   TAU_FSTART(dgtog_reshuffle);
   double st_time = MPI_Wtime();
 
-  int * old_virt_lda, * new_virt_lda;
-  alloc_ptr(order*sizeof(int),     (void**)&old_virt_lda);
-  alloc_ptr(order*sizeof(int),     (void**)&new_virt_lda);
-
-  new_virt_lda[0] = 1;
-  old_virt_lda[0] = 1;
-
-  int old_idx_lyr = ord_glb_comm.rank - old_dist.perank[0]*old_dist.pe_lda[0];
-  int new_idx_lyr = ord_glb_comm.rank - new_dist.perank[0]*new_dist.pe_lda[0];
-  int new_nvirt=new_dist.virt_phase[0], old_nvirt=old_dist.virt_phase[0];
-  for (int i=1; i<order; i++) {
-    new_virt_lda[i] = new_nvirt;
-    old_virt_lda[i] = old_nvirt;
-    old_nvirt = old_nvirt*old_dist.virt_phase[i];
-    new_nvirt = new_nvirt*new_dist.virt_phase[i];
-    old_idx_lyr -= old_dist.perank[i]*old_dist.pe_lda[i];
-    new_idx_lyr -= new_dist.perank[i]*new_dist.pe_lda[i];
-  }
-  int64_t old_virt_nelem = old_dist.size/old_nvirt;
-  int64_t new_virt_nelem = new_dist.size/new_nvirt;
-
-  int *old_phys_edge_len; alloc_ptr(sizeof(int)*order, (void**)&old_phys_edge_len);
-  for (int dim = 0;dim < order;dim++) 
-    old_phys_edge_len[dim] = old_dist.pad_edge_len[dim]/old_dist.phys_phase[dim];
-
-  int *new_phys_edge_len; alloc_ptr(sizeof(int)*order, (void**)&new_phys_edge_len);
-  for (int dim = 0;dim < order;dim++)
-    new_phys_edge_len[dim] = new_dist.pad_edge_len[dim]/new_dist.phys_phase[dim];
-
-  int *old_virt_edge_len; alloc_ptr(sizeof(int)*order, (void**)&old_virt_edge_len);
-  for (int dim = 0;dim < order;dim++) 
-    old_virt_edge_len[dim] = old_phys_edge_len[dim]/old_dist.virt_phase[dim];
-
-  int *new_virt_edge_len; alloc_ptr(sizeof(int)*order, (void**)&new_virt_edge_len);
-  for (int dim = 0;dim < order;dim++) 
-    new_virt_edge_len[dim] = new_phys_edge_len[dim]/new_dist.virt_phase[dim];
-
-  int nold_rep = 1;
-  int * old_rep_phase; alloc_ptr(sizeof(int)*order, (void**)&old_rep_phase);
-  for (int i=0; i<order; i++){
-    old_rep_phase[i] = lcm(old_dist.phys_phase[i], new_dist.phys_phase[i])/old_dist.phys_phase[i];
-    nold_rep *= old_rep_phase[i];
+  // counts, displacements, and offsets depend only on the two distributions, so they are reused for repeated redistributions
+  std::vector<int64_t> plan_sig;
+  redist_plan_cache & plan_cache = get_redist_plan_cache();
+  bool use_plan_cache = redist_plan_cache::get_signature(sym, edge_len, old_dist, new_dist, ord_glb_comm, plan_sig);
+  redist_plan * plan = NULL;
+  if (use_plan_cache) plan = plan_cache.lookup(plan_sig);
+  if (plan == NULL){
+    plan = new redist_plan(sym, edge_len, old_dist, new_dist, ord_glb_comm.rank);
+    if (use_plan_cache) plan_cache.insert(plan_sig, plan);
   }
 
-  int nnew_rep = 1;
-  int * new_rep_phase; alloc_ptr(sizeof(int)*order, (void**)&new_rep_phase);
-  for (int i=0; i<order; i++){
-    new_rep_phase[i] = lcm(new_dist.phys_phase[i], old_dist.phys_phase[i])/new_dist.phys_phase[i];
-    nnew_rep *= new_rep_phase[i];
-  }
-  
+  int old_idx_lyr = plan->old_idx_lyr;
+  int new_idx_lyr = plan->new_idx_lyr;
+  int nold_rep = plan->nold_rep;
+  int nnew_rep = plan->nnew_rep;
+  int * old_rep_phase = plan->old_rep_phase;
+  int * new_rep_phase = plan->new_rep_phase;
+  int ** send_pe_offset = plan->send_pe_offset;
+  int ** send_bucket_offset = plan->send_bucket_offset;
+  int64_t ** send_data_offset = plan->send_data_offset;
+  int ** send_ivmax_pre = plan->send_ivmax_pre;
+  int ** recv_pe_offset = plan->recv_pe_offset;
+  int ** recv_bucket_offset = plan->recv_bucket_offset;
+  int64_t ** recv_data_offset = plan->recv_data_offset;
+  int ** recv_ivmax_pre = plan->recv_ivmax_pre;
+  int64_t * recv_displs = plan->recv_displs;
+
+  // bucketing recounts the elements sent and received, so it works on copies of the planned counts
   int64_t * send_counts = (int64_t*)alloc(sizeof(int64_t)*nold_rep);
-  std::fill(send_counts, send_counts+nold_rep, 0);
-  calc_drv_displs(sym, edge_len, old_dist, new_dist, send_counts, old_idx_lyr);
-
+  memcpy(send_counts, plan->send_counts, sizeof(int64_t)*nold_rep);
   int64_t * recv_counts = (int64_t*)alloc(sizeof(int64_t)*nnew_rep);
-  std::fill(recv_counts, recv_counts+nnew_rep, 0);
-  calc_drv_displs(sym, edge_len, new_dist, old_dist, recv_counts, new_idx_lyr);
-  int64_t * recv_displs = (int64_t*)alloc(sizeof(int64_t)*nnew_rep);
+  memcpy(recv_counts, plan->recv_counts, sizeof(int64_t)*nnew_rep);
 
 #ifdef IREDIST
   CTF_Request * recv_reqs = (CTF_Request*)alloc(sizeof(CTF_Request)*nnew_rep);
   CTF_Request * send_reqs = (CTF_Request*)alloc(sizeof(CTF_Request)*nold_rep);
 #endif
 
-  for (int i=0; i<nnew_rep; i++){
-    if (i==0)
-      recv_displs[0] = 0;
-    else
-      recv_displs[i] = recv_displs[i-1] + recv_counts[i-1];
-  }
-
-  int ** recv_bucket_offset; alloc_ptr(sizeof(int*)*order, (void**)&recv_bucket_offset);
-  int ** recv_pe_offset; alloc_ptr(sizeof(int*)*order, (void**)&recv_pe_offset);
-  int ** recv_ivmax_pre; alloc_ptr(sizeof(int*)*order, (void**)&recv_ivmax_pre);
-  int64_t ** recv_data_offset; alloc_ptr(sizeof(int64_t*)*order, (void**)&recv_data_offset);
-  precompute_offsets(new_dist, old_dist, sym, edge_len, new_rep_phase, new_phys_edge_len, new_virt_edge_len, new_dist.virt_phase, new_virt_lda, new_virt_nelem, recv_pe_offset, recv_bucket_offset, recv_data_offset, recv_ivmax_pre);
-
-  int ** send_bucket_offset; alloc_ptr(sizeof(int*)*order, (void**)&send_bucket_offset);
-  int ** send_pe_offset; alloc_ptr(sizeof(int*)*order, (void**)&send_pe_offset);
-  int ** send_ivmax_pre; alloc_ptr(sizeof(int*)*order, (void**)&send_ivmax_pre);
-  int64_t ** send_data_offset; alloc_ptr(sizeof(int64_t*)*order, (void**)&send_data_offset);
-
-  precompute_offsets(old_dist, new_dist, sym, edge_len, old_rep_phase, old_phys_edge_len, old_virt_edge_len, old_dist.virt_phase, old_virt_lda, old_virt_nelem, send_pe_offset, send_bucket_offset, send_data_offset, send_ivmax_pre);
-
 #if !defined(IREDIST) && !defined(PUTREDIST)
-  int64_t * send_displs = (int64_t*)alloc(sizeof(int64_t)*nold_rep);
-  send_displs[0] = 0;
-  for (int i=1; i<nold_rep; i++){
-    send_displs[i] = send_displs[i-1] + send_counts[i-1];
-  }
+  int64_t * send_displs = plan->send_displs;
 #elif defined(PUTREDIST)
   int64_t * all_recv_displs = (int64_t*)alloc(sizeof(int64_t)*ord_glb_comm.np);
   SWITCH_ORD_CALL(CTF_int::calc_cnt_from_rep_cnt, order-1, new_rep_phase, recv_pe_offset, recv_bucket_offset, recv_displs, all_recv_displs, 0, 0, 1);
@@ -539,7 +488,6 @@ void dgtog_reshuffle(int const *          sym,
   //ord_glb_comm.all_to_allv(tsr_data, send_counts, send_displs, sr->el_size,
   //                         recv_buffer, recv_counts, recv_displs);
   TAU_FSTOP(COMM_RESHUFFLE);
-  CTF_int::cdealloc(send_displs);
 #else
   CTF_int::cdealloc(put_displs);
   TAU_FSTART(redist_fence);
@@ -666,38 +614,8 @@ void dgtog_reshuffle(int const *          sym,
   CTF_int::cdealloc(recv_reqs);
   CTF_int::cdealloc(send_reqs);
 #endif
-  for (int i=0; i<order; i++){
-    CTF_int::cdealloc(recv_pe_offset[i]);
-    CTF_int::cdealloc(recv_bucket_offset[i]);
-    CTF_int::cdealloc(recv_data_offset[i]);
-    CTF_int::cdealloc(recv_ivmax_pre[i]);
-  }
-  CTF_int::cdealloc(recv_pe_offset);
-  CTF_int::cdealloc(recv_bucket_offset);
-  CTF_int::cdealloc(recv_data_offset);
-  CTF_int::cdealloc(recv_ivmax_pre);
-
-  for (int i=0; i<order; i++){
-    CTF_int::cdealloc(send_pe_offset[i]);
-    CTF_int::cdealloc(send_bucket_offset[i]);
-    CTF_int::cdealloc(send_data_offset[i]);
-    CTF_int::cdealloc(send_ivmax_pre[i]);
-  }
-  CTF_int::cdealloc(send_pe_offset);
-  CTF_int::cdealloc(send_bucket_offset);
-  CTF_int::cdealloc(send_data_offset);
-  CTF_int::cdealloc(send_ivmax_pre);
-
-  CTF_int::cdealloc(old_virt_lda);
-  CTF_int::cdealloc(new_virt_lda);
   CTF_int::cdealloc(recv_counts);
-  CTF_int::cdealloc(recv_displs);
-  CTF_int::cdealloc(old_phys_edge_len);
-  CTF_int::cdealloc(new_phys_edge_len);
-  CTF_int::cdealloc(old_virt_edge_len);
-  CTF_int::cdealloc(new_virt_edge_len);
-  CTF_int::cdealloc(old_rep_phase);
-  CTF_int::cdealloc(new_rep_phase);
+  if (!use_plan_cache) delete plan;
 #ifdef IREDIST
 #ifdef PUT_NOTIFY
   foMPI_Win_flush_all(win);
@@ -0,0 +1,243 @@
+/*Copyright (c) 2011, Edgar Solomonik, all rights reserved.*/
+
+#include "redist_plan_cache.h"
+#include "dgtog_calc_cnt.h"
+#include "../shared/util.h"
+
+namespace CTF {
+  int REDIST_PLAN_CACHE_SIZE = 256;
+
+  Plan_cache_stats get_redist_plan_cache_stats(){
+    CTF_int::redist_plan_cache & pc = CTF_int::get_redist_plan_cache();
+    Plan_cache_stats st;
+    st.hits      = pc.nhits;
+    st.misses    = pc.nmisses;
+    st.evictions = pc.nevictions;
+    st.size      = pc.size();
+    return st;
+  }
+
+  void clear_redist_plan_cache(){
+    CTF_int::get_redist_plan_cache().clear();
+  }
+}
+
+namespace CTF_int {
+  using namespace CTF;
+
+  redist_plan_cache & get_redist_plan_cache(){
+    static redist_plan_cache cache;
+    return cache;
+  }
+
+  redist_plan::redist_plan(int const *          sym,
+                           int const *          edge_len,
+                           distribution const & old_dist,
+                           distribution const & new_dist,
+                           int                  rank){
+    TAU_FSTART(redist_plan);
+    order = old_dist.order;
+
+    int * old_virt_lda, * new_virt_lda;
+    alloc_ptr(order*sizeof(int),     (void**)&old_virt_lda);
+    alloc_ptr(order*sizeof(int),     (void**)&new_virt_lda);
+
+    new_virt_lda[0] = 1;
+    old_virt_lda[0] = 1;
+
+    old_idx_lyr = rank - old_dist.perank[0]*old_dist.pe_lda[0];
+    new_idx_lyr = rank - new_dist.perank[0]*new_dist.pe_lda[0];
+    int new_nvirt=new_dist.virt_phase[0], old_nvirt=old_dist.virt_phase[0];
+    for (int i=1; i<order; i++) {
+      new_virt_lda[i] = new_nvirt;
+      old_virt_lda[i] = old_nvirt;
+      old_nvirt = old_nvirt*old_dist.virt_phase[i];
+      new_nvirt = new_nvirt*new_dist.virt_phase[i];
+      old_idx_lyr -= old_dist.perank[i]*old_dist.pe_lda[i];
+      new_idx_lyr -= new_dist.perank[i]*new_dist.pe_lda[i];
+    }
+    int64_t old_virt_nelem = old_dist.size/old_nvirt;
+    int64_t new_virt_nelem = new_dist.size/new_nvirt;
+
+    int * old_phys_edge_len; alloc_ptr(sizeof(int)*order, (void**)&old_phys_edge_len);
+    int * new_phys_edge_len; alloc_ptr(sizeof(int)*order, (void**)&new_phys_edge_len);
+    int * old_virt_edge_len; alloc_ptr(sizeof(int)*order, (void**)&old_virt_edge_len);
+    int * new_virt_edge_len; alloc_ptr(sizeof(int)*order, (void**)&new_virt_edge_len);
+    for (int dim = 0;dim < order;dim++){
+      old_phys_edge_len[dim] = old_dist.pad_edge_len[dim]/old_dist.phys_phase[dim];
+      new_phys_edge_len[dim] = new_dist.pad_edge_len[dim]/new_dist.phys_phase[dim];
+      old_virt_edge_len[dim] = old_phys_edge_len[dim]/old_dist.virt_phase[dim];
+      new_virt_edge_len[dim] = new_phys_edge_len[dim]/new_dist.virt_phase[dim];
+    }
+
+    nold_rep = 1;
+    nnew_rep = 1;
+    alloc_ptr(sizeof(int)*order, (void**)&old_rep_phase);
+    alloc_ptr(sizeof(int)*order, (void**)&new_rep_phase);
+    for (int i=0; i<order; i++){
+      old_rep_phase[i] = lcm(old_dist.phys_phase[i], new_dist.phys_phase[i])/old_dist.phys_phase[i];
+      new_rep_phase[i] = lcm(new_dist.phys_phase[i], old_dist.phys_phase[i])/new_dist.phys_phase[i];
+      nold_rep *= old_rep_phase[i];
+      nnew_rep *= new_rep_phase[i];
+    }
+
+    send_counts = (int64_t*)alloc(sizeof(int64_t)*nold_rep);
+    std::fill(send_counts, send_counts+nold_rep, 0);
+    calc_drv_displs(sym, edge_len, old_dist, new_dist, send_counts, old_idx_lyr);
+
+    recv_counts = (int64_t*)alloc(sizeof(int64_t)*nnew_rep);
+    std::fill(recv_counts, recv_counts+nnew_rep, 0);
+    calc_drv_displs(sym, edge_len, new_dist, old_dist, recv_counts, new_idx_lyr);
+
+    send_displs = (int64_t*)alloc(sizeof(int64_t)*nold_rep);
+    send_displs[0] = 0;
+    for (int i=1; i<nold_rep; i++){
+      send_displs[i] = send_displs[i-1] + send_counts[i-1];
+    }
+    recv_displs = (int64_t*)alloc(sizeof(int64_t)*nnew_rep);
+    recv_displs[0] = 0;
+    for (int i=1; i<nnew_rep; i++){
+      recv_displs[i] = recv_displs[i-1] + recv_counts[i-1];
+    }
+
+    alloc_ptr(sizeof(int*)*order, (void**)&recv_bucket_offset);
+    alloc_ptr(sizeof(int*)*order, (void**)&recv_pe_offset);
+    alloc_ptr(sizeof(int*)*order, (void**)&recv_ivmax_pre);
+    alloc_ptr(sizeof(int64_t*)*order, (void**)&recv_data_offset);
+    precompute_offsets(new_dist, old_dist, sym, edge_len, new_rep_phase, new_phys_edge_len, new_virt_edge_len, new_dist.virt_phase, new_virt_lda, new_virt_nelem, recv_pe_offset, recv_bucket_offset, recv_data_offset, recv_ivmax_pre);
+
+    alloc_ptr(sizeof(int*)*order, (void**)&send_bucket_offset);
+    alloc_ptr(sizeof(int*)*order, (void**)&send_pe_offset);
+    alloc_ptr(sizeof(int*)*order, (void**)&send_ivmax_pre);
+    alloc_ptr(sizeof(int64_t*)*order, (void**)&send_data_offset);
+    precompute_offsets(old_dist, new_dist, sym, edge_len, old_rep_phase, old_phys_edge_len, old_virt_edge_len, old_dist.virt_phase, old_virt_lda, old_virt_nelem, send_pe_offset, send_bucket_offset, send_data_offset, send_ivmax_pre);
+
+    cdealloc(old_virt_lda);
+    cdealloc(new_virt_lda);
+    cdealloc(old_phys_edge_len);
+    cdealloc(new_phys_edge_len);
+    cdealloc(old_virt_edge_len);
+    cdealloc(new_virt_edge_len);
+    last_use = 0;
+    TAU_FSTOP(redist_plan);
+  }
+
+  redist_plan::~redist_plan(){
+    for (int i=0; i<order; i++){
+      cdealloc(recv_pe_offset[i]);
+      cdealloc(recv_bucket_offset[i]);
+      cdealloc(recv_data_offset[i]);
+      cdealloc(recv_ivmax_pre[i]);
+      cdealloc(send_pe_offset[i]);
+      cdealloc(send_bucket_offset[i]);
+      cdealloc(send_data_offset[i]);
+      cdealloc(send_ivmax_pre[i]);
+    }
+    cdealloc(recv_pe_offset);
+    cdealloc(recv_bucket_offset);
+    cdealloc(recv_data_offset);
+    cdealloc(recv_ivmax_pre);
+    cdealloc(send_pe_offset);
+    cdealloc(send_bucket_offset);
+    cdealloc(send_data_offset);
+    cdealloc(send_ivmax_pre);
+    cdealloc(send_counts);
+    cdealloc(send_displs);
+    cdealloc(recv_counts);
+    cdealloc(recv_displs);
+    cdealloc(old_rep_phase);
+    cdealloc(new_rep_phase);
+  }
+
+  /**
+   * \brief appends everything about a distribution that determines the local part of a redistribution
+   */
+  static void append_dist_sig(distribution const & dist, std::vector<int64_t> & sig){
+    sig.push_back(dist.is_cyclic);
+    sig.push_back(dist.size);
+    for (int i=0; i<dist.order; i++){
+      sig.push_back(dist.phase[i]);
+      sig.push_back(dist.virt_phase[i]);
+      sig.push_back(dist.phys_phase[i]);
+      sig.push_back(dist.pe_lda[i]);
+      sig.push_back(dist.pad_edge_len[i]);
+      sig.push_back(dist.padding[i]);
+      sig.push_back(dist.perank[i]);
+    }
+  }
+
+  bool redist_plan_cache::get_signature(int const *            sym,
+                                        int const *            edge_len,
+                                        distribution const &   old_dist,
+                                        distribution const &   new_dist,
+                                        CommData const &       cdt,
+                                        std::vector<int64_t> & sig){
+    if (CTF::REDIST_PLAN_CACHE_SIZE <= 0) return false;
+    sig.clear();
+    // plans depend on the communicator only through the number of processes and the rank of this one
+    sig.push_back(cdt.np);
+    sig.push_back(cdt.rank);
+    sig.push_back(old_dist.order);
+    for (int i=0; i<old_dist.order; i++){
+      sig.push_back(sym[i]);
+      sig.push_back(edge_len[i]);
+    }
+    append_dist_sig(old_dist, sig);
+    append_dist_sig(new_dist, sig);
+    return true;
+  }
+
+  redist_plan_cache::redist_plan_cache(){
+    nhits      = 0;
+    nmisses    = 0;
+    nevictions = 0;
+    ncalls     = 0;
+  }
+
+  redist_plan_cache::~redist_plan_cache(){
+    clear();
+  }
+
+  int64_t redist_plan_cache::size() const {
+    return plans.size();
+  }
+
+  redist_plan * redist_plan_cache::lookup(std::vector<int64_t> const & sig){
+    ncalls++;
+    std::map< std::vector<int64_t>, redist_plan* >::iterator it = plans.find(sig);
+    if (it == plans.end()){
+      nmisses++;
+      return NULL;
+    }
+    nhits++;
+    it->second->last_use = ncalls;
+    return it->second;
+  }
+
+  void redist_plan_cache::insert(std::vector<int64_t> const & sig, redist_plan * plan){
+    std::map< std::vector<int64_t>, redist_plan* >::iterator it = plans.find(sig);
+    if (it != plans.end()){
+      delete it->second;
+      plans.erase(it);
+    }
+    while ((int64_t)plans.size() >= CTF::REDIST_PLAN_CACHE_SIZE && plans.size() > 0){
+      std::map< std::vector<int64_t>, redist_plan* >::iterator lru = plans.begin();
+      for (it=plans.begin(); it!=plans.end(); it++){
+        if (it->second->last_use < lru->second->last_use) lru = it;
+      }
+      delete lru->second;
+      plans.erase(lru);
+      nevictions++;
+    }
+    plan->last_use = ncalls;
+    plans[sig] = plan;
+  }
+
+  void redist_plan_cache::clear(){
+    std::map< std::vector<int64_t>, redist_plan* >::iterator it;
+    for (it=plans.begin(); it!=plans.end(); it++){
+      delete it->second;
+    }
+    plans.clear();
+  }
+}
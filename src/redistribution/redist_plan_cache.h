@@ -0,0 +1,120 @@
+/*Copyright (c) 2011, Edgar Solomonik, all rights reserved.*/
+
+#ifndef __REDIST_PLAN_CACHE_H__
+#define __REDIST_PLAN_CACHE_H__
+
+#include "../interface/common.h"
+#include "../mapping/distribution.h"
+#include <map>
+
+namespace CTF_int {
+
+  /**
+   * \brief counts, displacements, and bucket offsets computed by dgtog_reshuffle for moving
+   *        the local data of this process from one distribution to another
+   */
+  class redist_plan {
+    public:
+      int order;
+      /** \brief index of this process within its replication layer of the old/new distribution (0 if it holds data) */
+      int old_idx_lyr;
+      int new_idx_lyr;
+      /** \brief number of processes this process sends to/receives from, and the replication phases giving them */
+      int nold_rep;
+      int nnew_rep;
+      int * old_rep_phase;
+      int * new_rep_phase;
+      /** \brief number of elements sent to/received from each process and offsets into the send/receive buffers */
+      int64_t * send_counts;
+      int64_t * send_displs;
+      int64_t * recv_counts;
+      int64_t * recv_displs;
+      /** \brief per-dimension offsets computed by precompute_offsets for bucketing data to send/unbucketing received data */
+      int ** send_pe_offset;
+      int ** send_bucket_offset;
+      int64_t ** send_data_offset;
+      int ** send_ivmax_pre;
+      int ** recv_pe_offset;
+      int ** recv_bucket_offset;
+      int64_t ** recv_data_offset;
+      int ** recv_ivmax_pre;
+      /** \brief last cache access, used for LRU eviction */
+      int64_t last_use;
+
+      /**
+       * \brief computes the plan for redistributing a tensor
+       * \param[in] sym symmetry relations of tensor
+       * \param[in] edge_len unpadded edge lengths of tensor
+       * \param[in] old_dist starting data distrubtion
+       * \param[in] new_dist target data distrubtion
+       * \param[in] rank index of this process in the communicator of the tensor
+       */
+      redist_plan(int const *          sym,
+                  int const *          edge_len,
+                  distribution const & old_dist,
+                  distribution const & new_dist,
+                  int                  rank);
+
+      ~redist_plan();
+  };
+
+  /**
+   * \brief cache of redistribution plans keyed by the old and new distribution of a tensor
+   *        and the position of this process, plans are local to each process,
+   *        so hits need not be consistent across processes
+   */
+  class redist_plan_cache {
+    public:
+      /**
+       * \brief computes the signature of a redistribution
+       * \param[in] sym symmetry relations of tensor
+       * \param[in] edge_len unpadded edge lengths of tensor
+       * \param[in] old_dist starting data distrubtion
+       * \param[in] new_dist target data distrubtion
+       * \param[in] cdt communicator of the tensor
+       * \param[out] sig signature
+       * \return false if the redistribution should not be cached
+       */
+      static bool get_signature(int const *            sym,
+                                int const *            edge_len,
+                                distribution const &   old_dist,
+                                distribution const &   new_dist,
+                                CommData const &       cdt,
+                                std::vector<int64_t> & sig);
+
+      /**
+       * \brief look up plan, updates hit/miss statistics
+       * \param[in] sig signature computed via get_signature
+       * \return plan or NULL if not cached
+       */
+      redist_plan * lookup(std::vector<int64_t> const & sig);
+
+      /**
+       * \brief inserts plan (taking ownership), evicting least recently used plan if full
+       * \param[in] sig signature computed via get_signature
+       * \param[in] plan plan to insert
+       */
+      void insert(std::vector<int64_t> const & sig, redist_plan * plan);
+
+      /** \brief removes all plans, statistics are kept */
+      void clear();
+
+      /** \brief number of cached plans */
+      int64_t size() const;
+
+      redist_plan_cache();
+      ~redist_plan_cache();
+
+      int64_t nhits;
+      int64_t nmisses;
+      int64_t nevictions;
+    private:
+      int64_t ncalls;
+      std::map< std::vector<int64_t>, redist_plan* > plans;
+  };
+
+  /** \brief returns the redistribution plan cache of this process */
+  redist_plan_cache & get_redist_plan_cache();
+}
+
+#endif
@@ -438,6 +438,9 @@ namespace CTF_int {
                     algstrct const *  sr){
 
     memset(bucket_counts, 0, sizeof(int64_t)*np); 
+    /* bucket of each pair, so that keys are scanned once */
+    int * pair_loc;
+    CTF_int::alloc_ptr(num_pair*sizeof(int), (void**)&pair_loc);
   #ifdef USE_OMP
     int64_t * sub_counts, * sub_offs;
     CTF_int::alloc_ptr(np*sizeof(int64_t)*omp_get_max_threads(), (void**)&sub_counts);
@@ -468,6 +471,7 @@ namespace CTF_int {
         loc += tmp_arr[j];
       }*/
       ASSERT(loc<np);
+      pair_loc[i] = loc;
   #ifdef USE_OMP
       sub_counts[loc+omp_get_thread_num()*np]++;
   #else
@@ -508,14 +512,7 @@ namespace CTF_int {
     #pragma omp parallel for schedule(static,256) 
   #endif
     for (int64_t i=0; i<num_pair; i++){
-      int64_t k = mapped_data[i].k();
-      int64_t loc = 0;
-      for (int j=0; j<order; j++){
-        //FIXME: fine for dense but need extra mod for sparse :(
-        //loc += (k%phys_phase[j])*bucket_lda[j];
-        loc += ((k%edge_len[j])%phys_phase[j])*bucket_lda[j];
-        k = k/edge_len[j];
-      }
+      int64_t loc = pair_loc[i];
   #ifdef USE_OMP
       bucket_data[bucket_off[loc] + sub_offs[loc+omp_get_thread_num()*np]].write(mapped_data[i]);
       sub_offs[loc+omp_get_thread_num()*np]++;
@@ -528,6 +525,7 @@ namespace CTF_int {
     CTF_int::cdealloc(sub_counts);
     CTF_int::cdealloc(sub_offs);
   #endif
+    CTF_int::cdealloc(pair_loc);
     TAU_FSTOP(bucket_by_pe_move);
   }
   
@@ -557,6 +555,9 @@ namespace CTF_int {
     }
 
     memset(virt_counts, 0, sizeof(int64_t)*num_virt); 
+    /* virtual bucket of each pair, so that keys are scanned once */
+    int * pair_loc;
+    CTF_int::alloc_ptr(num_pair*sizeof(int), (void**)&pair_loc);
   #ifdef USE_OMP
     int64_t * sub_counts, * sub_offs;
     CTF_int::alloc_ptr(num_virt*sizeof(int64_t)*omp_get_max_threads(), (void**)&sub_counts);
@@ -564,7 +565,6 @@ namespace CTF_int {
     memset(sub_counts, 0, num_virt*sizeof(int64_t)*omp_get_max_threads());
   #endif
 
-
     /* bucket data */
   #ifdef USE_OMP
     TAU_FSTART(bucket_by_virt_omp_cnt);
@@ -579,8 +579,7 @@ namespace CTF_int {
         loc += (((k%edge_len[j])/phys_phase[j])%virt_phase[j])*virt_lda[j];
         k = k/edge_len[j];
       }
-      
-      //bucket_data[loc*num_pair_virt + virt_counts[loc]] = mapped_data[i];
+      pair_loc[i] = loc;
       sub_counts[loc+omp_get_thread_num()*num_virt]++;
     }
     TAU_FSTOP(bucket_by_virt_omp_cnt);
@@ -605,15 +604,7 @@ namespace CTF_int {
     TAU_FSTART(bucket_by_virt_move);
     #pragma omp parallel for schedule(static)
     for (int64_t i=0; i<num_pair; i++){
-      int64_t k = mapped_data[i].k();
-      int64_t loc = 0;
-      //#pragma unroll
-      for (int j=0; j<order; j++){
-        //FIXME: fine for dense but need extra mod for sparse :(
-        //loc += ((k/phys_phase[j])%virt_phase[j])*virt_lda[j];
-        loc += (((k%edge_len[j])/phys_phase[j])%virt_phase[j])*virt_lda[j];
-        k = k/edge_len[j];
-      }
+      int64_t loc = pair_loc[i];
       bucket_data[virt_prefix[loc] + sub_offs[loc+omp_get_thread_num()*num_virt]].write(mapped_data[i]);
       sub_offs[loc+omp_get_thread_num()*num_virt]++;
     }
@@ -628,6 +619,7 @@ namespace CTF_int {
         loc += (((k%edge_len[j])/phys_phase[j])%virt_phase[j])*virt_lda[j];
         k = k/edge_len[j];
       }
+      pair_loc[i] = loc;
       virt_counts[loc]++;
     }
 
@@ -638,27 +630,27 @@ namespace CTF_int {
     memset(virt_counts, 0, sizeof(int64_t)*num_virt); 
 
     for (int64_t i=0; i<num_pair; i++){
-      int64_t k = mapped_data[i].k();
-      int64_t loc = 0;
-      for (int j=0; j<order; j++){
-        //FIXME: fine for dense but need extra mod for sparse :(
-        //loc += ((k/phys_phase[j])%virt_phase[j])*virt_lda[j];
-        loc += (((k%edge_len[j])/phys_phase[j])%virt_phase[j])*virt_lda[j];
-        k = k/edge_len[j];
-      }
+      int64_t loc = pair_loc[i];
       bucket_data[virt_prefix[loc] + virt_counts[loc]].write(mapped_data[i]);
       virt_counts[loc]++;
     }
   #endif
 
     TAU_FSTART(bucket_by_virt_sort);
+    /* keys are global indices, so their range limits the number of radix sort passes */
+    int64_t max_key = 1;
+    for (int j=0; j<order; j++){
+      max_key *= edge_len[j];
+    }
+    max_key--;
+    /* sort blocks concurrently if there are enough, otherwise each sort is threaded */
   #ifdef USE_OMP
-    #pragma omp parallel for
+    #pragma omp parallel for if (num_virt >= omp_get_max_threads())
   #endif
     for (int64_t i=0; i<num_virt; i++){
       /*std::sort(bucket_data+virt_prefix[i],
           bucket_data+(virt_prefix[i]+virt_counts[i]));*/
-      bucket_data[virt_prefix[i]].sort(virt_counts[i]);
+      bucket_data[virt_prefix[i]].sort(virt_counts[i], max_key);
     }
     TAU_FSTOP(bucket_by_virt_sort);
   #if DEBUG >= 1
@@ -671,6 +663,7 @@ namespace CTF_int {
     CTF_int::cdealloc(sub_counts);
     CTF_int::cdealloc(sub_offs);
   #endif
+    CTF_int::cdealloc(pair_loc);
     CTF_int::cdealloc(virt_prefix);
     CTF_int::cdealloc(virt_lda);
     TAU_FSTOP(bucket_by_virt);
@@ -864,6 +857,21 @@ namespace CTF_int {
     CTF_int::cdealloc(edge_lda);
   }
 
+  /**
+   * \brief copies the keys of n pairs into a new contiguous array, so that they may be binary searched
+   *        without loading the values
+   */
+  static int64_t * get_keys(int64_t n, ConstPairIterator prs){
+    int64_t * keys = (int64_t*)alloc(std::max(n, (int64_t)1)*sizeof(int64_t));
+#ifdef USE_OMP
+    #pragma omp parallel for
+#endif
+    for (int64_t i=0; i<n; i++){
+      keys[i] = prs[i].k();
+    }
+    return keys;
+  }
+
   void wr_pairs_layout(int              order,
                        int              np,
                        int64_t          inwrite,
@@ -1107,8 +1115,14 @@ namespace CTF_int {
     /* Write or read the values corresponding to the keys */
     if (is_sparse){
       if (rw == 'r'){
-        ConstPairIterator prs_tsr(sr, rw_data);
-        sp_read(sr, nnz_loc, prs_tsr, alpha, new_num_pair, buf_data, beta);
+        // the keys are sorted only within each virtual block
+        int64_t tsr_off = 0, read_off = 0;
+        for (int v=0; v<num_virt; v++){
+          ConstPairIterator prs_tsr(sr, rw_data+tsr_off*sr->pair_size());
+          sp_read(sr, old_nnz_blk[v], prs_tsr, alpha, virt_counts[v], buf_data[read_off], beta);
+          tsr_off += old_nnz_blk[v];
+          read_off += virt_counts[v];
+        }
       } else {
         ConstPairIterator prs_tsr(sr, rw_data);
         ConstPairIterator prs_write(sr, buf_data.ptr);
@@ -1144,20 +1158,23 @@ namespace CTF_int {
       /* Sort the key-value pairs we determine*/
       //std::sort(buf_data, buf_data+new_num_pair);
       buf_data.sort(new_num_pair);
-      /* Search for the keys in the order in which we received the keys */
-      for (int64_t i=0; i<new_num_pair; i++){
-        /*el_loc = std::lower_bound(buf_data,
-                                  buf_data+new_num_pair,
-                                  swap_data[i]);*/
-        int64_t el_loc = buf_data.lower_bound(new_num_pair, swap_data[i]);
+      {
+        int64_t * read_keys = get_keys(new_num_pair, buf_data);
+        /* Search for the keys in the order in which we received the keys */
+        for (int64_t i=0; i<new_num_pair; i++){
+          /*el_loc = std::lower_bound(buf_data,
+                                    buf_data+new_num_pair,
+                                    swap_data[i]);*/
+          int64_t el_loc = std::lower_bound(read_keys, read_keys+new_num_pair, swap_data[i].k()) - read_keys;
   #if (DEBUG>=5)
-        ///if (el_loc < buf_data || el_loc >= buf_data+new_num_pair){
-        if (el_loc < 0 || el_loc >= new_num_pair){
-          DEBUG_PRINTF("swap_data[%d].k = %d, not found\n", i, (int)swap_data[i].k());
-          ASSERT(0);
-        }
+          if (el_loc < 0 || el_loc >= new_num_pair){
+            DEBUG_PRINTF("swap_data[%d].k = %d, not found\n", i, (int)swap_data[i].k());
+            ASSERT(0);
+          }
   #endif
-        swap_data[i].write_val(buf_data[el_loc].d());
+          swap_data[i].write_val(buf_data[el_loc].d());
+        }
+        cdealloc(read_keys);
       }
     
       /* Inverse the transpose we did above to get the keys back to requestors */
@@ -1178,6 +1195,7 @@ namespace CTF_int {
       /* Sort the pairs that were sent out, now with correct values */
 //      std::sort(buf_data, buf_data+nwrite);
       buf_data.sort(nwrite);
+      int64_t * written_keys = get_keys(nwrite, buf_data);
       /* Search for the keys in the same order they were requested */
       j=0;
       for (int64_t i=0; i<inwrite; i++){
@@ -1187,7 +1205,7 @@ namespace CTF_int {
           } else {
             //el_loc = std::lower_bound(buf_data, buf_data+nwrite, new_changed_pairs[j]);
             //wr_pairs[i].d = changed_key_scale[j]*el_loc[0].d;
-            int64_t el_loc = buf_data.lower_bound(nwrite, ConstPairIterator(sr, new_changed_pairs+j*sr->pair_size()));
+            int64_t el_loc = std::lower_bound(written_keys, written_keys+nwrite, ConstPairIterator(sr, new_changed_pairs+j*sr->pair_size()).k()) - written_keys;
             if (changed_key_scale[j] == -1){
               char aspr[sr->el_size];
               sr->addinv(buf_data[el_loc].d(), aspr);
@@ -1197,11 +1215,12 @@ namespace CTF_int {
           }
           j++;
         } else {
-          int64_t el_loc = buf_data.lower_bound(nwrite, wr_pairs[i]);
+          int64_t el_loc = std::lower_bound(written_keys, written_keys+nwrite, wr_pairs[i].k()) - written_keys;
 //          el_loc = std::lower_bound(buf_data, buf_data+nwrite, wr_pairs[i]);
           wr_pairs[i].write_val(buf_data[el_loc].d());
         }
       }
+      cdealloc(written_keys);
       CTF_int::cdealloc(depadding);
     }
     if (is_sparse) cdealloc(depad_edge_len);
@@ -1304,25 +1323,22 @@ namespace CTF_int {
                int64_t           nread,
                PairIterator      prs_read,
                char const *      beta){
-    // each for loop iteration does one addition, o and r are also incremented within
     // only incrementing r allows multiple reads of the same val
-    for (int64_t t=0,r=0; t<ntsr && r<nread; r++){
-      while (prs_tsr[t].k() != prs_read[r].k() && t<ntsr && r<nread){
-        if (prs_tsr[t].k() < prs_read[r].k())
-          t++;
-        else
-          r++;
+    for (int64_t t=0,r=0; r<nread; r++){
+      while (t<ntsr && prs_tsr[t].k() < prs_read[r].k())
+        t++;
+      char a[sr->el_size];
+      char b[sr->el_size];
+      char c[sr->el_size];
+      if (beta != NULL){
+        sr->mul(prs_read[r].d(), beta, a);
+      } else if (sr->addid() != NULL){
+        sr->copy(a, sr->addid());
+      } else {
+        prs_read[r].read_val(a);
       }
       // scale and add if match found
-      if (t<ntsr && r<nread){
-        char a[sr->el_size];
-        char b[sr->el_size];
-        char c[sr->el_size];
-        if (beta != NULL){
-          sr->mul(prs_read[r].d(), beta, a);
-        } else {
-          prs_read[r].read_val(a);
-        }
+      if (t<ntsr && prs_tsr[t].k() == prs_read[r].k()){
         if (alpha != NULL){
           sr->mul(prs_tsr[t].d(), alpha, b);
         } else {
@@ -1330,6 +1346,8 @@ namespace CTF_int {
         }
         sr->add(a, b, c);
         prs_read[r].write_val(c);
+      } else {
+        prs_read[r].write_val(a);
       }
     }
   }
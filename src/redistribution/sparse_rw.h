@@ -281,14 +281,15 @@ namespace CTF_int {
 
   /**
    * \brief reads elements of a sparse set defining the tensor, 
-   *    into a sparse read set with potentially repeating keys
+   *    into a sparse read set with potentially repeating keys,
+   *    both sets must be sorted by key, keys not in the tensor are read as zero
    * \param[in] sr algstrct defining data type of array
    * \param[in] ntsr number of elements in sparse tensor
    * \param[in] prs_tsr pairs of the sparse tensor
    * \param[in] alpha scaling factor for data of the sparse tensor
    * \param[in] nread number of elements in the read set
    * \param[in,out] prs_read pairs of the read set
-   * \param[in] beta scaling factor for data of the read set
+   * \param[in] beta scaling factor for data of the read set, if NULL the data is overwritten
    */
   void sp_read(algstrct const *  sr, 
                int64_t           ntsr,
@@ -192,6 +192,10 @@ namespace CTF_int {
     return rec_ctr->est_time_rec(nlyr);
   }
 
+  double strp_ctr::est_comm_time_rec(int nlyr) {
+    return rec_ctr->est_comm_time_rec(nlyr);
+  }
+
 
   void strp_ctr::run(char * A, char * B, char * C){
     char * bA, * bB, * bC;
@@ -151,6 +151,7 @@ namespace CTF_int {
        * \return bytes needed for recursive contraction
        */
       double est_time_rec(int nlyr);
+      double est_comm_time_rec(int nlyr);
   
       /**
        * \brief copies strp_ctr object
@@ -30,6 +30,7 @@
 #include "omp.h"
 #endif
 #include "memcontrol.h"
+#include "mst_arena.h"
 #include <iostream>
 #include <fstream>
 using namespace std;
@@ -88,20 +89,6 @@ void read_off_memory_status(statm_t& result)
   std::list<mem_loc> mem_stacks[MAX_THREADS];
   #endif
 
-  //application memory stack
-  void * mst_buffer = 0;
-  //size of memory stack
-  int64_t mst_buffer_size = 0;
-  //amount of data stored on stack
-  int64_t mst_buffer_used = 0;
-  //the current offset of the top of the stack 
-  int64_t mst_buffer_ptr = 0;
-  //stack of memory locations
-  std::list<mem_loc> mst;
-  //copy buffer for contraction of stack with low memory usage
-  #define CPY_BUFFER_SIZE 1000
-  char * cpy_buffer[CPY_BUFFER_SIZE];
-
   /**
    * \brief sets what fraction of the memory capacity CTF can use
    */
@@ -118,65 +105,10 @@ void read_off_memory_status(statm_t& result)
   }
 
   /**
-   * \brief gets rid of empty space on the stack
-   */
-  std::list<mem_transfer> contract_mst(){
-    std::list<mem_transfer> transfers;
-    int64_t i;
-    if (mst_buffer_ptr > .80*mst_buffer_size && 
-        mst_buffer_used < .40*mst_buffer_size){
-      TAU_FSTART(contract_mst);
-      std::list<mem_loc> old_mst = mst;
-      mst_buffer_ptr = 0;
-      mst_buffer_used = 0;
-
-      mst.clear();
-
-      std::list<mem_loc>::iterator it;
-      for (it=old_mst.begin(); it!=old_mst.end(); it++){
-        mem_transfer t;
-        t.old_ptr = it->ptr;
-        t.new_ptr = mst_alloc(it->len);
-        if (t.old_ptr != t.new_ptr){
-          if ((int64_t)((char*)t.old_ptr - (char*)t.new_ptr) < it->len){
-            for (i=0; i<it->len; i+=CPY_BUFFER_SIZE){
-              memcpy(cpy_buffer, (char*)t.old_ptr+i, MIN(it->len-i, CPY_BUFFER_SIZE));
-              memcpy((char*)t.new_ptr+i, cpy_buffer, MIN(it->len-i, CPY_BUFFER_SIZE));
-            }
-          } else
-            memcpy(t.new_ptr, t.old_ptr, it->len);
-        } else
-          transfers.push_back(t);
-      }
-      printf("Contracted MST\n");
-    // from size " PRId64 " to size " PRId64 "\n", 
-      //DPRINTF(1,"Contracted MST from size " PRId64 " to size " PRId64 "\n", 
-      //            old_mst_buffer_ptr, mst_buffer_ptr);
-      old_mst.clear();
-      TAU_FSTOP(contract_mst);
-    }
-    return transfers;
-  }
-
-  std::list<mem_loc> * get_mst(){
-    return &mst;
-  }
-
-  /**
-   * \brief initializes stack buffer
+   * \brief sets the number of bytes reserved for the arena of temporary buffers, if it has not been created yet
    */
   void mst_create(int64_t size){
-    int pm;
-    void * new_mst_buffer;
-    if (size > mst_buffer_size){
-      pm = posix_memalign((void**)&new_mst_buffer, ALIGN_BYTES, size);
-      ASSERT(pm == 0);
-      if (mst_buffer != NULL){
-        memcpy(new_mst_buffer, mst_buffer, mst_buffer_ptr);
-      } 
-      mst_buffer = new_mst_buffer;
-      mst_buffer_size = size;
-    }
+    CTF::MST_ARENA_SIZE = size;
   }
 
   /**
@@ -216,46 +148,20 @@ void read_off_memory_status(statm_t& result)
                     mem_stacks[i].size());
           }
         }
-        if (mst.size() > 0){
-          printf("Warning: %zu items not deallocated from custom stack, consuming %ld bytes of memory\n",
-                  mst.size(), mst_buffer_ptr);
-        }
       }
     }
   #endif
+    if (instance_counter == 0)
+      mst_arena_release();
   }
 
   /**
-   * \brief frees buffer allocated on stack
-   * \param[in] ptr pointer to buffer on stack
+   * \brief frees buffer allocated from the arena
+   * \param[in] ptr pointer to buffer in the arena
    */
   int mst_free(void * ptr){
-    ASSERT((int64_t)((char*)ptr-(char*)mst_buffer)<mst_buffer_size);
-    
-    std::list<mem_loc>::iterator it;
-    for (it=--mst.end(); it!=mst.begin(); it--){
-      if (it->ptr == ptr){
-        mst_buffer_used = mst_buffer_used - it->len;
-        mst.erase(it);
-        break;
-      }
-    }
-    if (it == mst.begin()){
-      if (it->ptr == ptr){
-        mst_buffer_used = mst_buffer_used - it->len;
-        mst.erase(it);
-      } else {
-        printf("CTF CTF_int::ERROR: Invalid mst free of pointer %p\n", ptr);
-  //      free(ptr);
-        ABORT;
-        return CTF_int::ERROR;
-      }
-    }
-    if (mst.size() > 0)
-      mst_buffer_ptr = (int64_t)((char*)mst.back().ptr - (char*)mst_buffer)+mst.back().len;
-    else
-      mst_buffer_ptr = 0;
-    //printf("freed block, mst_buffer_ptr = " PRId64 "\n", mst_buffer_ptr);
+    ASSERT(mst_arena_owns(ptr));
+    mst_arena_free(ptr);
     return CTF_int::SUCCESS;
   }
 
@@ -265,41 +171,17 @@ void read_off_memory_status(statm_t& result)
    * \param[in,out] ptr pointer to set to new allocation address
    */
   int mst_alloc_ptr(int64_t const len, void ** const ptr){
-    int pm = posix_memalign(ptr, ALIGN_BYTES, len);
-    ASSERT(pm==0);
-#if 0
-    if (mst_buffer_size == 0)
-      return alloc_ptr(len, ptr);
-    else {
-      int64_t plen, off;
-      off = len % MST_ALIGN_BYTES;
-      if (off > 0)
-        plen = len + MST_ALIGN_BYTES - off;
-      else
-        plen = len;
-
-      mem_loc m;
-      //printf("ptr = " PRId64 " plen = %d, size = " PRId64 "\n", mst_buffer_ptr, plen, mst_buffer_size);
-      if (mst_buffer_ptr + plen < mst_buffer_size){
-        *ptr = (void*)((char*)mst_buffer+mst_buffer_ptr);
-        m.ptr = *ptr;
-        m.len = plen;
-        mst.push_back(m);
-        mst_buffer_ptr = mst_buffer_ptr+plen;
-        mst_buffer_used += plen;  
-      } else {
-        DPRINTF(2,"Exceeded mst buffer size (" PRId64 "), current ptr is " PRId64 ", composed of %d items of size " PRId64 "\n",
-                mst_buffer_size, mst_buffer_ptr, (int)mst.size(), mst_buffer_used);
-        alloc_ptr(len, ptr);
-      }
-      return CTF_int::SUCCESS;
+    *ptr = mst_arena_alloc(len);
+    if (*ptr == NULL){
+      mst_arena_fallback();
+      int pm = posix_memalign(ptr, ALIGN_BYTES, len);
+      ASSERT(pm==0);
     }
-#endif
     return CTF_int::SUCCESS;
   }
 
   /**
-   * \brief mst_alloc allocates buffer on the specialized memory stack
+   * \brief mst_alloc allocates a temporary buffer from the arena (see mst_arena_alloc), or directly if it can not
    * \param[in] len number of bytes
    */
   void * mst_alloc(int64_t const len){
@@ -406,12 +288,10 @@ void read_off_memory_status(statm_t& result)
    * \param[in] tid thread id from whose stack pointer needs to be freed
    */
   int cdealloc(void * ptr, int const tid){
+    if (mst_arena_owns(ptr))
+      return mst_free(ptr);
     free(ptr);
 #if 0
-    if ((int64_t)((char*)ptr-(char*)mst_buffer) < mst_buffer_size && 
-        (int64_t)((char*)ptr-(char*)mst_buffer) >= 0){
-      return mst_free(ptr);
-    }
   #ifndef PRODUCTION
     int len, found;
     std::list<mem_loc> * mem_stack;
@@ -476,15 +356,15 @@ void read_off_memory_status(statm_t& result)
    * \param[in,out] ptr pointer to set to address to free
    */
   int cdealloc(void * ptr){ 
+    if (mst_arena_owns(ptr))
+      return mst_free(ptr);
     free(ptr);
     return CTF_int::SUCCESS;
   }
 #if 0
   int cdealloc(void * ptr){
-    if ((int64_t)((char*)ptr-(char*)mst_buffer) < mst_buffer_size && 
-        (int64_t)((char*)ptr-(char*)mst_buffer) >= 0){
+    if (mst_arena_owns(ptr))
       return mst_free(ptr);
-    }
   #ifdef PRODUCTION
     free(ptr);  
     return CTF_int::SUCCESS;
@@ -659,7 +539,8 @@ void read_off_memory_status(statm_t& result)
     
     return mem_avail;
 #else
-    int64_t pused = proc_bytes_used();
+    // temporary buffers come from the arena, which keeps the pages of freed ones for reuse
+    int64_t pused = proc_bytes_used() + mst_arena_bytes_committed();
     int64_t ptotal = proc_bytes_total();
     if (pused > memcap*ptotal){ printf("CTF ERROR: less than %lf percent of local memory remaining, ensuing segfault likely.\n", (100.*(1.-memcap))); }
     return memcap*ptotal-pused;
@@ -0,0 +1,329 @@
+/*Copyright (c) 2011, Edgar Solomonik, all rights reserved.*/
+
+#include "mst_arena.h"
+#include "util.h"
+#include <sys/mman.h>
+#include <unistd.h>
+#include <mutex>
+#include <atomic>
+
+namespace CTF {
+  int64_t MST_ARENA_SIZE = ((int64_t)1)<<36;
+  int64_t MST_MAX_BLOCK_SIZE = ((int64_t)1)<<28;
+  int64_t MST_CACHE_SIZE = ((int64_t)1)<<30;
+
+  Mst_stats get_mst_stats(){
+    return CTF_int::mst_arena_stats();
+  }
+
+  void release_mst(){
+    CTF_int::mst_arena_release();
+  }
+}
+
+namespace CTF_int {
+  // smallest block has 64 bytes, size classes are spaced by a quarter of a power of two
+  #define MST_LG_MIN_BLOCK 6
+  #define MST_LG_MAX_BLOCK 40
+  #define MST_NCLASS ((MST_LG_MAX_BLOCK-MST_LG_MIN_BLOCK)*4+1)
+  // blocks of up to 256 KB are carved from slabs of 2 MB, the size of a huge page
+  #define MST_LG_SLAB 21
+  #define MST_LG_MAX_SMALL 18
+  #define MST_NSMALL ((MST_LG_MAX_SMALL-MST_LG_MIN_BLOCK)*4+1)
+  // size classes are recorded for each 64 KB granule, large blocks are multiples of a granule
+  #define MST_LG_GRANULE 16
+  // most blocks of one small class a thread keeps cached, and most bytes
+  #define MST_THREAD_CACHE 256
+  #define MST_THREAD_CACHE_BYTES (((int64_t)1)<<20)
+
+  /**
+   * \brief free blocks of one size class, linked through their first bytes
+   */
+  struct mst_free_list {
+    void * head;
+    int64_t n;
+  };
+
+  static inline void push(mst_free_list & fl, void * ptr){
+    *(void**)ptr = fl.head;
+    fl.head = ptr;
+    fl.n++;
+  }
+
+  static inline void * pop(mst_free_list & fl){
+    void * ptr = fl.head;
+    fl.head = *(void**)ptr;
+    fl.n--;
+    return ptr;
+  }
+
+  static inline int size_class(int64_t len){
+    if (len <= ((int64_t)1)<<MST_LG_MIN_BLOCK) return 0;
+    int lg = 63-__builtin_clzll((uint64_t)(len-1));
+    return (lg-MST_LG_MIN_BLOCK)*4 + (int)(((len-1)>>(lg-2))&3) + 1;
+  }
+
+  static inline int64_t class_size(int c){
+    if (c == 0) return ((int64_t)1)<<MST_LG_MIN_BLOCK;
+    int lg = (c-1)/4+MST_LG_MIN_BLOCK;
+    return (((int64_t)1)<<lg) + ((c-1)%4+1)*(((int64_t)1)<<(lg-2));
+  }
+
+  static inline int64_t thread_cache_cap(int64_t sz){
+    return std::max((int64_t)4, std::min((int64_t)MST_THREAD_CACHE, MST_THREAD_CACHE_BYTES/sz));
+  }
+
+  // arena_end is written before arena_base is published, neither changes afterwards
+  static std::atomic<char*> arena_base(NULL);
+  static char * arena_end = NULL;
+  static std::atomic<bool> arena_failed(false);
+  // guards everything below as well as the shared free lists
+  static std::mutex arena_lock;
+  // slabs are taken upward from the bottom of the arena, large blocks downward from its top
+  static char * slab_top = NULL;
+  static char * large_bot = NULL;
+  static unsigned char * granule_class = NULL;
+  static mst_free_list shared_free[MST_NCLASS];
+  // free large blocks whose pages (but the first, holding the link) were returned to the operating system
+  static mst_free_list released_free[MST_NCLASS];
+  // bytes of free large blocks on shared_free, and bytes returned to the operating system by blocks on released_free
+  static int64_t cached_bytes = 0;
+  static int64_t released_bytes = 0;
+
+  static std::atomic<int64_t> nallocs(0);
+  static std::atomic<int64_t> nfrees(0);
+  static std::atomic<int64_t> nfallbacks(0);
+  static std::atomic<int64_t> bytes_in_use(0);
+  static std::atomic<int64_t> peak_bytes_in_use(0);
+
+  /**
+   * \brief blocks of small classes cached by one thread
+   */
+  struct mst_thread_cache {
+    mst_free_list lists[MST_NSMALL];
+    /** \brief uncarved remainder of the slab last taken for each class */
+    char * carve_ptr[MST_NSMALL];
+    char * carve_end[MST_NSMALL];
+
+    mst_thread_cache(){
+      memset(lists, 0, sizeof(lists));
+      memset(carve_ptr, 0, sizeof(carve_ptr));
+      memset(carve_end, 0, sizeof(carve_end));
+    }
+
+    ~mst_thread_cache(){
+      std::lock_guard<std::mutex> lk(arena_lock);
+      for (int c=0; c<MST_NSMALL; c++){
+        while (lists[c].n > 0) push(shared_free[c], pop(lists[c]));
+        for (char * p=carve_ptr[c]; p<carve_end[c]; p+=class_size(c)){
+          push(shared_free[c], p);
+        }
+      }
+    }
+  };
+
+  static thread_local mst_thread_cache tcache;
+
+  static bool create_arena(){
+    if (CTF::MST_ARENA_SIZE <= 0 || arena_failed.load()) return false;
+    std::lock_guard<std::mutex> lk(arena_lock);
+    if (arena_base.load() != NULL) return true;
+#if defined(MAP_ANONYMOUS) && defined(MAP_NORESERVE)
+    TAU_FSTART(create_arena);
+    int64_t slab = ((int64_t)1)<<MST_LG_SLAB;
+    int64_t size = ((CTF::MST_ARENA_SIZE+slab-1)>>MST_LG_SLAB)<<MST_LG_SLAB;
+    // reserve an extra slab so that the arena can start at a huge page boundary, pages are committed when touched
+    char * map = (char*)mmap(NULL, size+slab, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+    if (map == (char*)MAP_FAILED){
+      DPRINTF(1,"CTF WARNING: failed to reserve %ld bytes for the arena, allocating temporary buffers directly\n", size);
+      arena_failed = true;
+      TAU_FSTOP(create_arena);
+      return false;
+    }
+    char * base = (char*)((((uintptr_t)map+slab-1)>>MST_LG_SLAB)<<MST_LG_SLAB);
+  #ifdef MADV_HUGEPAGE
+    madvise(base, size, MADV_HUGEPAGE);
+  #endif
+    granule_class = (unsigned char*)calloc(size>>MST_LG_GRANULE, 1);
+    slab_top  = base;
+    large_bot = base+size;
+    arena_end = base+size;
+    arena_base.store(base, std::memory_order_release);
+    TAU_FSTOP(create_arena);
+    return true;
+#else
+    arena_failed = true;
+    return false;
+#endif
+  }
+
+  /**
+   * \brief takes a slab for class c, arena_lock must be held
+   */
+  static char * take_slab(int c){
+    int64_t slab = ((int64_t)1)<<MST_LG_SLAB;
+    if (large_bot - slab_top < slab) return NULL;
+    char * s = slab_top;
+    slab_top += slab;
+    memset(granule_class+((s-arena_base.load())>>MST_LG_GRANULE), c, slab>>MST_LG_GRANULE);
+    return s;
+  }
+
+  static void * small_alloc(int c){
+    mst_thread_cache & tc = tcache;
+    int64_t sz = class_size(c);
+    if (tc.lists[c].n > 0) return pop(tc.lists[c]);
+    if (tc.carve_ptr[c] < tc.carve_end[c]){
+      void * ptr = tc.carve_ptr[c];
+      tc.carve_ptr[c] += sz;
+      return ptr;
+    }
+    std::lock_guard<std::mutex> lk(arena_lock);
+    // take up to half a cache of blocks freed to the shared list, or else a new slab
+    int64_t cap = thread_cache_cap(sz);
+    while (shared_free[c].n > 0 && tc.lists[c].n < cap/2){
+      push(tc.lists[c], pop(shared_free[c]));
+    }
+    if (tc.lists[c].n > 0) return pop(tc.lists[c]);
+    char * s = take_slab(c);
+    if (s == NULL) return NULL;
+    tc.carve_ptr[c] = s+sz;
+    tc.carve_end[c] = s+((((int64_t)1)<<MST_LG_SLAB)/sz)*sz;
+    return s;
+  }
+
+  static void small_free(int c, void * ptr){
+    mst_thread_cache & tc = tcache;
+    push(tc.lists[c], ptr);
+    int64_t cap = thread_cache_cap(class_size(c));
+    if (tc.lists[c].n > cap){
+      std::lock_guard<std::mutex> lk(arena_lock);
+      while (tc.lists[c].n > cap/2){
+        push(shared_free[c], pop(tc.lists[c]));
+      }
+    }
+  }
+
+  /**
+   * \brief bytes of a large block of class c returned to the operating system when it is released
+   */
+  static inline int64_t released_size(int c){
+    return class_size(c)-sysconf(_SC_PAGESIZE);
+  }
+
+  /**
+   * \brief returns the pages of a free large block of class c to the operating system, arena_lock must be held
+   */
+  static void release_block(int c, void * ptr){
+#ifdef MADV_DONTNEED
+    int64_t page = sysconf(_SC_PAGESIZE);
+    madvise((char*)ptr+page, class_size(c)-page, MADV_DONTNEED);
+    released_bytes += released_size(c);
+    push(released_free[c], ptr);
+#else
+    push(shared_free[c], ptr);
+    cached_bytes += class_size(c);
+#endif
+  }
+
+  static void * large_alloc(int c){
+    int64_t sz = class_size(c);
+    std::lock_guard<std::mutex> lk(arena_lock);
+    if (shared_free[c].n > 0){
+      cached_bytes -= sz;
+      return pop(shared_free[c]);
+    }
+    // pages of a released block are committed again as they are touched
+    if (released_free[c].n > 0){
+      released_bytes -= released_size(c);
+      return pop(released_free[c]);
+    }
+    if (large_bot - slab_top < sz) return NULL;
+    large_bot -= sz;
+    granule_class[(large_bot-arena_base.load())>>MST_LG_GRANULE] = c;
+    return large_bot;
+  }
+
+  void * mst_arena_alloc(int64_t len){
+    if (len > CTF::MST_MAX_BLOCK_SIZE || len > (((int64_t)1)<<MST_LG_MAX_BLOCK)) return NULL;
+    if (arena_base.load(std::memory_order_acquire) == NULL && !create_arena()) return NULL;
+    int c = size_class(len);
+    void * ptr = c < MST_NSMALL ? small_alloc(c) : large_alloc(c);
+    if (ptr != NULL){
+      nallocs++;
+      int64_t used = (bytes_in_use += class_size(c));
+      int64_t peak = peak_bytes_in_use.load();
+      while (used > peak && !peak_bytes_in_use.compare_exchange_weak(peak, used)){ }
+    }
+    return ptr;
+  }
+
+  void mst_arena_free(void * ptr){
+    char * base = arena_base.load(std::memory_order_acquire);
+    int c = granule_class[((char*)ptr-base)>>MST_LG_GRANULE];
+    if (c < MST_NSMALL)
+      small_free(c, ptr);
+    else {
+      std::lock_guard<std::mutex> lk(arena_lock);
+      if (cached_bytes + class_size(c) > CTF::MST_CACHE_SIZE)
+        release_block(c, ptr);
+      else {
+        push(shared_free[c], ptr);
+        cached_bytes += class_size(c);
+      }
+    }
+    nfrees++;
+    bytes_in_use -= class_size(c);
+  }
+
+  bool mst_arena_owns(void const * ptr){
+    char * base = arena_base.load(std::memory_order_acquire);
+    return base != NULL && (uintptr_t)ptr >= (uintptr_t)base && (uintptr_t)ptr < (uintptr_t)arena_end;
+  }
+
+  void mst_arena_release(){
+    if (arena_base.load(std::memory_order_acquire) == NULL) return;
+#ifdef MADV_DONTNEED
+    TAU_FSTART(mst_arena_release);
+    std::lock_guard<std::mutex> lk(arena_lock);
+    for (int c=MST_NSMALL; c<MST_NCLASS; c++){
+      while (shared_free[c].n > 0){
+        cached_bytes -= class_size(c);
+        release_block(c, pop(shared_free[c]));
+      }
+    }
+    TAU_FSTOP(mst_arena_release);
+#endif
+  }
+
+  int64_t mst_arena_bytes_committed(){
+    if (arena_base.load(std::memory_order_acquire) == NULL) return 0;
+    std::lock_guard<std::mutex> lk(arena_lock);
+    return (slab_top-arena_base.load())+(arena_end-large_bot)-released_bytes;
+  }
+
+  CTF::Mst_stats mst_arena_stats(){
+    CTF::Mst_stats st;
+    st.allocs            = nallocs;
+    st.frees             = nfrees;
+    st.fallbacks         = nfallbacks;
+    st.bytes_in_use      = bytes_in_use;
+    st.peak_bytes_in_use = peak_bytes_in_use;
+    std::lock_guard<std::mutex> lk(arena_lock);
+    char * base = arena_base.load();
+    if (base == NULL){
+      st.bytes_reserved  = 0;
+      st.bytes_committed = 0;
+      st.arena_size      = 0;
+    } else {
+      st.bytes_reserved  = (slab_top-base)+(arena_end-large_bot);
+      st.bytes_committed = st.bytes_reserved-released_bytes;
+      st.arena_size      = arena_end-base;
+    }
+    return st;
+  }
+
+  void mst_arena_fallback(){
+    nfallbacks++;
+  }
+}
@@ -0,0 +1,52 @@
+/*Copyright (c) 2011, Edgar Solomonik, all rights reserved.*/
+
+#ifndef __MST_ARENA_H__
+#define __MST_ARENA_H__
+
+#include "../interface/common.h"
+
+namespace CTF_int {
+  /**
+   * \brief allocates a temporary buffer from the arena, which reserves CTF::MST_ARENA_SIZE bytes of
+   *        huge-page-aligned address space on first use and recycles blocks through free lists of size classes
+   *        (four per power of two), so allocation and deallocation take constant time,
+   *        blocks of up to 256 KB are carved from 2 MB slabs and cached by each thread, larger ones are shared
+   * \param[in] len number of bytes
+   * \return buffer aligned to ALIGN_BYTES, or NULL if len exceeds CTF::MST_MAX_BLOCK_SIZE,
+   *         the arena is disabled, or it is full
+   */
+  void * mst_arena_alloc(int64_t len);
+
+  /**
+   * \brief returns a buffer to the arena, may be called by any thread
+   * \param[in] ptr buffer for which mst_arena_owns is true
+   */
+  void mst_arena_free(void * ptr);
+
+  /**
+   * \brief whether ptr was allocated by mst_arena_alloc
+   * \param[in] ptr any pointer
+   */
+  bool mst_arena_owns(void const * ptr);
+
+  /**
+   * \brief returns the pages of cached (free) blocks of the shared size classes to the operating system,
+   *        mst_arena_free does so itself for blocks freed once CTF::MST_CACHE_SIZE bytes of them are cached
+   */
+  void mst_arena_release();
+
+  /**
+   * \brief bytes of the arena that may be backed by memory, in use or cached for reuse
+   */
+  int64_t mst_arena_bytes_committed();
+
+  /**
+   * \brief usage statistics of the arena, allocations that bypass it are counted by mst_arena_fallback
+   */
+  CTF::Mst_stats mst_arena_stats();
+
+  /** \brief counts a temporary buffer allocated without the arena */
+  void mst_arena_fallback();
+}
+
+#endif
@@ -306,6 +306,21 @@ namespace CTF_int {
     return fact(n+k-1)/(fact(k)*fact(n-1));
   }
 
+  void file_io_all(MPI_File & file, int64_t off, char * buf, int64_t nbytes, bool is_write, MPI_Comm cm){
+    int64_t max_io = ((int64_t)1)<<30;
+    int64_t nchnk = (nbytes+max_io-1)/max_io;
+    MPI_Allreduce(MPI_IN_PLACE, &nchnk, 1, MPI_INT64_T, MPI_MAX, cm);
+    for (int64_t c=0; c<nchnk; c++){
+      int64_t st = std::min(c*max_io, nbytes);
+      int cnt = (int)std::min(max_io, nbytes-st);
+      MPI_Status stat;
+      if (is_write)
+        MPI_File_write_at_all(file, off+st, buf+st, cnt, MPI_CHAR, &stat);
+      else
+        MPI_File_read_at_all(file, off+st, buf+st, cnt, MPI_CHAR, &stat);
+    }
+  }
+
 
 
 }
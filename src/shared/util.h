@@ -289,7 +289,6 @@ namespace CTF_int {
     void * new_ptr;
   };
 
-  std::list<mem_transfer> contract_mst();
   int untag_mem(void * ptr);
   int free_cond(void * ptr);
   void mem_create();
@@ -464,6 +463,18 @@ namespace CTF_int {
   int64_t choose(int64_t n, int64_t k);  
   void get_choice(int64_t n, int64_t k, int64_t ch, int * chs);
   int64_t chchoose(int64_t n, int64_t k);
+
+  /**
+   * \brief reads or writes nbytes at byte offset off of file with collective MPI I/O, in calls of at most 1 GB,
+   *        making as many calls on each process as on any other, so processes may pass different sizes
+   * \param[in,out] file stream open on all processes of cm
+   * \param[in] off offset in bytes at which this process reads or writes
+   * \param[in,out] buf data to write or buffer to read into
+   * \param[in] nbytes number of bytes this process reads or writes, may be 0
+   * \param[in] is_write whether to write (or read)
+   * \param[in] cm communicator on which file is open
+   */
+  void file_io_all(MPI_File & file, int64_t off, char * buf, int64_t nbytes, bool is_write, MPI_Comm cm);
 }
 #endif
 
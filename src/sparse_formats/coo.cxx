@@ -1,18 +1,32 @@
 #include "coo.h"
 #include "csr.h"
+#include "dcsr.h"
 #include "../shared/util.h"
 #include "../contraction/ctr_comm.h"
 
+namespace CTF {
+  int SP_MIN_IDX_WIDTH = 2;
+}
+
 namespace CTF_int {
-  int64_t get_coo_size(int64_t nnz, int val_size){
-    return nnz*(val_size+sizeof(int)*2)+2*sizeof(int64_t);
+  int get_sp_idx_width(int64_t max_idx){
+    int w = CTF::SP_MIN_IDX_WIDTH <= 2 ? 2 : (CTF::SP_MIN_IDX_WIDTH <= 4 ? 4 : 8);
+    if (w == 2 && max_idx > INT16_MAX) w = 4;
+    if (w == 4 && max_idx > INT32_MAX) w = 8;
+    return w;
+  }
+
+  int64_t get_coo_size(int64_t nnz, int val_size, int idx_width){
+    return nnz*(val_size+idx_width*2)+4*sizeof(int64_t);
   }
 
-  COO_Matrix::COO_Matrix(int64_t nnz, algstrct const * sr){
-    int64_t size = get_coo_size(nnz, sr->el_size);
+  COO_Matrix::COO_Matrix(int64_t nnz, algstrct const * sr, int idx_width){
+    int64_t size = get_coo_size(nnz, sr->el_size, idx_width);
     all_data = (char*)alloc(size);
     ((int64_t*)all_data)[0] = nnz;
     ((int64_t*)all_data)[1] = sr->el_size;
+    ((int64_t*)all_data)[2] = idx_width;
+    ((int64_t*)all_data)[3] = 0;
   }
 
   COO_Matrix::COO_Matrix(char * all_data_){
@@ -22,20 +36,41 @@ namespace CTF_int {
   COO_Matrix::COO_Matrix(CSR_Matrix const & csr, algstrct const * sr){
     int64_t nnz = csr.nnz(); 
     int64_t v_sz = csr.val_size(); 
-    int const * csr_ja = csr.JA();
-    int const * csr_ia = csr.IA();
+    int nrow = csr.nrow();
     char const * csr_vs = csr.vals();
+    int w = std::max(csr.idx_width(), get_sp_idx_width(nrow));
+    // the (compressed) rows of a DCSR matrix are mapped to its nonempty rows, whose indices fit in idx_width()
+    bool is_dcsr = csr.is_dcsr();
+    char const * dcsr_rs = is_dcsr ? DCSR_Matrix(csr.all_data).rows_raw() : NULL;
 
-    int64_t size = get_coo_size(nnz, v_sz);
+    int64_t size = get_coo_size(nnz, v_sz, w);
     all_data = (char*)alloc(size);
     ((int64_t*)all_data)[0] = nnz;
     ((int64_t*)all_data)[1] = v_sz;
+    ((int64_t*)all_data)[2] = w;
+    ((int64_t*)all_data)[3] = 0;
     
     char * vs = vals();
-    int * coo_rs = rows();
-    int * coo_cs = cols();
-  
-    sr->csr_to_coo(nnz, csr.nrow(), csr_vs, csr_ja, csr_ia, vs, coo_rs, coo_cs);
+    if (!is_dcsr && w == sizeof(int) && csr.idx_width() == sizeof(int)){
+      sr->csr_to_coo(nnz, nrow, csr_vs, csr.JA(), csr.IA(), vs, rows(), cols());
+    } else {
+      char const * csr_ja = csr.JA_raw();
+      char const * csr_ia = csr.IA_raw();
+      int csr_w = csr.idx_width();
+      char * coo_rs = rows_raw();
+      char * coo_cs = cols_raw();
+      memcpy(vs, csr_vs, v_sz*nnz);
+#ifdef _OPENMP
+      #pragma omp parallel for
+#endif
+      for (int i=0; i<nrow; i++){
+        int64_t row = is_dcsr ? get_sp_idx(dcsr_rs, csr_w, i) : i+1;
+        for (int64_t j=get_sp_idx(csr_ia, csr_w, i)-1; j<get_sp_idx(csr_ia, csr_w, i+1)-1; j++){
+          set_sp_idx(coo_rs, w, j, row);
+          set_sp_idx(coo_cs, w, j, get_sp_idx(csr_ja, csr_w, j));
+        }
+      }
+    }
   }
 
   int64_t COO_Matrix::nnz() const {
@@ -46,32 +81,78 @@ namespace CTF_int {
     return ((int64_t*)all_data)[1];
   }
 
+  int COO_Matrix::idx_width() const {
+    return ((int64_t*)all_data)[2];
+  }
+
   int64_t COO_Matrix::size() const {
-    return get_coo_size(nnz(),val_size());
+    return get_coo_size(nnz(),val_size(),idx_width());
   }
   
   char * COO_Matrix::vals() const {
-    return all_data + 2*sizeof(int64_t);
+    return all_data + 4*sizeof(int64_t);
   }
 
-  int * COO_Matrix::rows() const {
+  char * COO_Matrix::rows_raw() const {
     int64_t n = this->nnz();
     int v_sz = this->val_size();
 
-    return (int*)(all_data + n*v_sz+2*sizeof(int64_t));
+    return all_data + n*v_sz+4*sizeof(int64_t);
   } 
 
-  int * COO_Matrix::cols() const {
+  char * COO_Matrix::cols_raw() const {
     int64_t n = this->nnz();
-    int v_sz = ((int64_t*)all_data)[1];
+    int v_sz = this->val_size();
 
-    return (int*)(all_data + n*(v_sz+sizeof(int))+2*sizeof(int64_t));
+    return all_data + n*(v_sz+idx_width())+4*sizeof(int64_t);
   } 
 
-  void COO_Matrix::set_data(int64_t nz, int order, int const * lens, int const * rev_ordering, int nrow_idx, char const * tsr_data, algstrct const * sr, int const * phase){
+  int * COO_Matrix::rows() const {
+    ASSERT(idx_width() == sizeof(int));
+    return (int*)rows_raw();
+  } 
+
+  int * COO_Matrix::cols() const {
+    ASSERT(idx_width() == sizeof(int));
+    return (int*)cols_raw();
+  } 
+
+  COO_Matrix COO_Matrix::to_idx_width(int idx_width_) const {
+    int w = idx_width();
+    if (w == idx_width_) return COO_Matrix(all_data);
+    int64_t nz = nnz();
+    int v_sz = val_size();
+    char * new_data = (char*)alloc(get_coo_size(nz, v_sz, idx_width_));
+    COO_Matrix cm(new_data);
+    ((int64_t*)new_data)[0] = nz;
+    ((int64_t*)new_data)[1] = v_sz;
+    ((int64_t*)new_data)[2] = idx_width_;
+    ((int64_t*)new_data)[3] = 0;
+    memcpy(cm.vals(), vals(), nz*v_sz);
+    char const * rs = rows_raw();
+    char const * cs = cols_raw();
+    char * new_rs = cm.rows_raw();
+    char * new_cs = cm.cols_raw();
+    int64_t max_idx = idx_width_ == 2 ? INT16_MAX : (idx_width_ == 4 ? INT32_MAX : INT64_MAX);
+    for (int64_t i=0; i<nz; i++){
+      int64_t r = get_sp_idx(rs, w, i);
+      int64_t c = get_sp_idx(cs, w, i);
+      if (std::max(r,c) > max_idx){
+        printf("CTF ERROR: COO matrix index %ld does not fit in %d bytes\n", std::max(r,c), idx_width_);
+        assert(0);
+      }
+      set_sp_idx(new_rs, idx_width_, i, r);
+      set_sp_idx(new_cs, idx_width_, i, c);
+    }
+    return cm;
+  }
+
+  void COO_Matrix::set_data(int64_t nz, int order, int const * lens, int const * rev_ordering, int nrow_idx, char const * tsr_data, algstrct const * sr, int const * phase, int idx_width){
     TAU_FSTART(convert_to_COO);
     ((int64_t*)all_data)[0] = nz;
     ((int64_t*)all_data)[1] = sr->el_size;
+    ((int64_t*)all_data)[2] = idx_width;
+    ((int64_t*)all_data)[3] = 0;
     int v_sz = sr->el_size;
 
     int * rev_ord_lens = (int*)alloc(sizeof(int)*order);
@@ -104,8 +185,8 @@ namespace CTF_int {
       }
     }
  
-    int * rs = rows();
-    int * cs = cols();
+    char * rs = rows_raw();
+    char * cs = cols_raw();
     char * vs = vals();
 
 #ifdef USE_OMP
@@ -114,18 +195,20 @@ namespace CTF_int {
     for (int64_t i=0; i<nz; i++){
       ConstPairIterator pi(sr, tsr_data);
       int64_t k = pi[i].k();
-      cs[i] = 1;
-      rs[i] = 1;
+      int64_t c = 1;
+      int64_t r = 1;
       for (int j=0; j<order; j++){
         int64_t kpart = (k%lens[j])/phase[j];
         if (ordering[j] < nrow_idx){
-          rs[i] += kpart*lda_row[ordering[j]];
+          r += kpart*lda_row[ordering[j]];
         } else {
-          cs[i] += kpart*lda_col[ordering[j]-nrow_idx];
+          c += kpart*lda_col[ordering[j]-nrow_idx];
         //  printf("%d %ld %d %d %ld\n",j,kpart,ordering[j],nrow_idx,lda_col[ordering[j]-nrow_idx]);
         }
         k=k/lens[j];
       }
+      set_sp_idx(rs, idx_width, i, r);
+      set_sp_idx(cs, idx_width, i, c);
     //  printf("k=%ld col = %d row = %d\n", pi[i].k(), cs[i], rs[i]);
       memcpy(vs+v_sz*i, pi[i].d(), v_sz);
     }
@@ -172,8 +255,9 @@ namespace CTF_int {
       }
     }
  
-    int * rs = rows();
-    int * cs = cols();
+    char const * rs = rows_raw();
+    char const * cs = cols_raw();
+    int w = idx_width();
     char * vs = vals();
 
 #ifdef USE_OMP
@@ -186,9 +270,9 @@ namespace CTF_int {
       for (int j=0; j<order; j++){
         int64_t kpart;
         if (ordering[j] < nrow_idx){
-          kpart = ((rs[i]-1)/lda_row[ordering[j]])%rev_ord_lens[ordering[j]];
+          kpart = ((get_sp_idx(rs, w, i)-1)/lda_row[ordering[j]])%rev_ord_lens[ordering[j]];
         } else {
-          kpart = ((cs[i]-1)/lda_col[ordering[j]-nrow_idx])%rev_ord_lens[ordering[j]];
+          kpart = ((get_sp_idx(cs, w, i)-1)/lda_col[ordering[j]-nrow_idx])%rev_ord_lens[ordering[j]];
         }
         //  printf("%d %ld %d %d %ld\n",j,kpart,ordering[j],nrow_idx,lda_col[ordering[j]-nrow_idx]);
        // if (j>0){ kpart *= lens[j-1]; }
@@ -220,18 +304,16 @@ namespace CTF_int {
 
   void COO_Matrix::coomm(char const * A, algstrct const * sr_A, int m, int n, int k, char const * alpha, char const * B, algstrct const * sr_B, char const * beta, char * C, algstrct const * sr_C, bivar_function const * func){
     COO_Matrix cA((char*)A);
-    int64_t nz = cA.nnz(); 
-    int const * rs = cA.rows();
-    int const * cs = cA.cols();
-    char const * vs = cA.vals();
     if (func != NULL){
       assert(sr_C->isequal(beta, sr_C->mulid()));
       assert(alpha == NULL || sr_C->isequal(alpha, sr_C->mulid()));
-      func->ccoomm(m,n,k,vs,rs,cs,nz,B,C);
+      COO_Matrix iA = cA.to_idx_width(sizeof(int));
+      func->ccoomm(m,n,k,iA.vals(),iA.rows(),iA.cols(),iA.nnz(),B,C);
+      if (iA.all_data != cA.all_data) cdealloc(iA.all_data);
     } else {
       ASSERT(sr_B->el_size == sr_A->el_size);
       ASSERT(sr_C->el_size == sr_A->el_size);
-      sr_A->coomm(m,n,k,alpha,vs,rs,cs,nz,B,beta,C,func);
+      sr_A->coomm(m,n,k,alpha,cA,B,beta,C);
     }
   }
 }
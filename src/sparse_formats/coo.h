@@ -8,7 +8,42 @@ namespace CTF_int {
   class CSR_Matrix;
   class bivar_function;
 
-  int64_t get_coo_size(int64_t nnz, int val_size);
+  /**
+   * \brief number of bytes (2, 4, or 8) used for each index of a local sparse block whose 1-based
+   *        indices (and row offsets) are at most max_idx, at least CTF::SP_MIN_IDX_WIDTH
+   * \param[in] max_idx largest index value that must be representable
+   */
+  int get_sp_idx_width(int64_t max_idx);
+
+  /**
+   * \brief retrieves entry i of an array of indices of width idx_width
+   */
+  inline int64_t get_sp_idx(char const * idx, int idx_width, int64_t i){
+    switch (idx_width){
+      case 2: return ((int16_t const*)idx)[i];
+      case 4: return ((int32_t const*)idx)[i];
+      default: return ((int64_t const*)idx)[i];
+    }
+  }
+
+  /**
+   * \brief sets entry i of an array of indices of width idx_width to v
+   */
+  inline void set_sp_idx(char * idx, int idx_width, int64_t i, int64_t v){
+    switch (idx_width){
+      case 2: ((int16_t*)idx)[i] = (int16_t)v; break;
+      case 4: ((int32_t*)idx)[i] = (int32_t)v; break;
+      default: ((int64_t*)idx)[i] = v; break;
+    }
+  }
+
+  /**
+   * \brief computes the size of a serialized COO matrix
+   * \param[in] nnz number of nonzeros in matrix
+   * \param[in] val_size size of each matrix entry
+   * \param[in] idx_width size of each row and column index
+   */
+  int64_t get_coo_size(int64_t nnz, int val_size, int idx_width);
 
   /** \brief serialized matrix in coordinate format, meaning three arrays of dimension nnz are stored, one of values, and two of row and column indices */
   class COO_Matrix{
@@ -20,8 +55,9 @@ namespace CTF_int {
        * \brief constructor that allocates empty buffer
        * \param[in] nnz number of nonzeros
        * \param[in] sr algebraic structure
+       * \param[in] idx_width size of each row and column index (2, 4, or 8 bytes)
        */
-      COO_Matrix(int64_t nnz, algstrct const * sr);
+      COO_Matrix(int64_t nnz, algstrct const * sr, int idx_width=sizeof(int));
 
       /** 
        * \brief constructor that acccepts data buffer
@@ -51,15 +87,30 @@ namespace CTF_int {
       /** \brief retrieves matrix entry size out of all_data */
       int val_size() const;
 
+      /** \brief retrieves size of each row and column index (2, 4, or 8 bytes) out of all_data */
+      int idx_width() const;
+
       /** \brief retrieves pointer to array of values out of all_data */
       char * vals() const;
 
-      /** \brief retrieves pointer to array row indices of each value */
+      /** \brief retrieves pointer to array row indices of each value, requires idx_width()==sizeof(int) */
       int * rows() const;
 
-      /** \brief retrieves pointer to array of column indices for each value */
+      /** \brief retrieves pointer to array of column indices for each value, requires idx_width()==sizeof(int) */
       int * cols() const;
 
+      /** \brief retrieves pointer to array row indices of each value, with entries of idx_width() bytes */
+      char * rows_raw() const;
+
+      /** \brief retrieves pointer to array of column indices of each value, with entries of idx_width() bytes */
+      char * cols_raw() const;
+
+      /**
+       * \brief returns this matrix if its indices have width idx_width, otherwise a newly allocated copy with that index width
+       * \param[in] idx_width desired size of each row and column index
+       */
+      COO_Matrix to_idx_width(int idx_width) const;
+
       /**
        * \brief folds tensor data into COO format based on prespecification of row and column modes
        * \param[in] nz number of nonzers
@@ -70,8 +121,9 @@ namespace CTF_int {
        * \param[in] tsr_data in key-value pair format
        * \param[in] sr algebraic structure
        * \param[in] phase dimensions of the blocking grid
+       * \param[in] idx_width size of each row and column index, all_data must be of size get_coo_size(nz, sr->el_size, idx_width)
        */
-      void set_data(int64_t nz, int order, int const * lens, int const * ordering, int nrow_idx, char const * tsr_data, algstrct const * sr, int const * phase);
+      void set_data(int64_t nz, int order, int const * lens, int const * ordering, int nrow_idx, char const * tsr_data, algstrct const * sr, int const * phase, int idx_width);
 
       /**
        * \brief unfolds tensor data from COO format based on prespecification of row and column modes
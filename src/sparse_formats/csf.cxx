@@ -0,0 +1,148 @@
+#include "csf.h"
+#include "../shared/util.h"
+
+#define ALIGN 256
+
+namespace CTF_int {
+  /** \brief rounds offset up to a multiple of ALIGN */
+  static int64_t align_offset(int64_t offset){
+    if (offset % ALIGN != 0) offset += ALIGN-(offset%ALIGN);
+    return offset;
+  }
+
+  int64_t get_csf_size(int order, int64_t const * nfib, int val_size){
+    int64_t offset = align_offset((3+2*order)*sizeof(int64_t));
+    offset = align_offset(offset + nfib[order-1]*val_size);
+    for (int l=0; l<order; l++){
+      offset = align_offset(offset + nfib[l]*sizeof(int64_t));
+      if (l < order-1)
+        offset = align_offset(offset + (nfib[l]+1)*sizeof(int64_t));
+    }
+    return offset;
+  }
+
+  CSF_Tensor::CSF_Tensor(int64_t nnz, char const * pairs, int order, int const * lens, int const * mode_order, algstrct const * sr){
+    TAU_FSTART(csf_build);
+    ASSERT(order >= 1);
+    int v_sz = sr->el_size;
+    int64_t psz = sr->pair_size();
+    // strides of each mode in the keys and of each level in the keys reordered by level
+    int64_t lda[order];
+    lda[0] = 1;
+    for (int i=1; i<order; i++){
+      lda[i] = lda[i-1]*lens[i-1];
+    }
+    int64_t lvl_lda[order];
+    lvl_lda[order-1] = 1;
+    for (int l=order-2; l>=0; l--){
+      lvl_lda[l] = lvl_lda[l+1]*lens[mode_order[l+1]];
+    }
+    std::pair<int64_t,int64_t> * lvl_keys = (std::pair<int64_t,int64_t>*)alloc(sizeof(std::pair<int64_t,int64_t>)*nnz);
+#ifdef USE_OMP
+    #pragma omp parallel for
+#endif
+    for (int64_t i=0; i<nnz; i++){
+      int64_t k = ConstPairIterator(sr, pairs+i*psz).k();
+      int64_t lk = 0;
+      for (int l=0; l<order; l++){
+        int m = mode_order[l];
+        lk += ((k/lda[m])%lens[m])*lvl_lda[l];
+      }
+      lvl_keys[i] = std::pair<int64_t,int64_t>(lk, i);
+    }
+    std::sort(lvl_keys, lvl_keys+nnz);
+
+    // a new fiber starts at level l where the indices of levels 0...l differ from those of the previous nonzero
+    int64_t nfib_[order];
+    std::fill(nfib_, nfib_+order, 0);
+    for (int64_t i=0; i<nnz; i++){
+      for (int l=0; l<order; l++){
+        if (i == 0 || lvl_keys[i].first/lvl_lda[l] != lvl_keys[i-1].first/lvl_lda[l]) nfib_[l]++;
+      }
+    }
+    all_data = (char*)alloc(get_csf_size(order, nfib_, v_sz));
+    ((int64_t*)all_data)[0] = order;
+    ((int64_t*)all_data)[1] = nnz;
+    ((int64_t*)all_data)[2] = v_sz;
+    for (int l=0; l<order; l++){
+      ((int64_t*)all_data)[3+l] = mode_order[l];
+      ((int64_t*)all_data)[3+order+l] = nfib_[l];
+    }
+
+    char * vs = vals();
+    int64_t * lfids[order];
+    int64_t * lfptr[order];
+    int64_t cnt[order];
+    for (int l=0; l<order; l++){
+      lfids[l] = fids(l);
+      lfptr[l] = l < order-1 ? fptr(l) : NULL;
+      cnt[l] = 0;
+    }
+    for (int64_t i=0; i<nnz; i++){
+      int64_t lk = lvl_keys[i].first;
+      int l0 = 0;
+      if (i > 0){
+        while (l0 < order-1 && lk/lvl_lda[l0] == lvl_keys[i-1].first/lvl_lda[l0]) l0++;
+      }
+      for (int l=l0; l<order; l++){
+        lfids[l][cnt[l]] = (lk/lvl_lda[l])%lens[mode_order[l]];
+        if (l < order-1) lfptr[l][cnt[l]] = cnt[l+1];
+        cnt[l]++;
+      }
+      memcpy(vs+i*v_sz, ConstPairIterator(sr, pairs+lvl_keys[i].second*psz).d(), v_sz);
+    }
+    for (int l=0; l<order-1; l++){
+      lfptr[l][nfib_[l]] = nfib_[l+1];
+    }
+    cdealloc(lvl_keys);
+    TAU_FSTOP(csf_build);
+  }
+
+  CSF_Tensor::CSF_Tensor(char * all_data_){
+    all_data = all_data_;
+  }
+
+  int CSF_Tensor::order() const {
+    return ((int64_t*)all_data)[0];
+  }
+
+  int64_t CSF_Tensor::nnz() const {
+    return ((int64_t*)all_data)[1];
+  }
+
+  int CSF_Tensor::val_size() const {
+    return ((int64_t*)all_data)[2];
+  }
+
+  int CSF_Tensor::mode(int l) const {
+    return ((int64_t*)all_data)[3+l];
+  }
+
+  int64_t CSF_Tensor::nfib(int l) const {
+    return ((int64_t*)all_data)[3+order()+l];
+  }
+
+  int64_t CSF_Tensor::size() const {
+    return get_csf_size(order(), ((int64_t*)all_data)+3+order(), val_size());
+  }
+
+  char * CSF_Tensor::vals() const {
+    return all_data + align_offset((3+2*order())*sizeof(int64_t));
+  }
+
+  int64_t * CSF_Tensor::fids(int l) const {
+    int ord = order();
+    int64_t offset = align_offset((3+2*ord)*sizeof(int64_t));
+    offset = align_offset(offset + nnz()*val_size());
+    for (int i=0; i<l; i++){
+      offset = align_offset(offset + nfib(i)*sizeof(int64_t));
+      offset = align_offset(offset + (nfib(i)+1)*sizeof(int64_t));
+    }
+    return (int64_t*)(all_data + offset);
+  }
+
+  int64_t * CSF_Tensor::fptr(int l) const {
+    ASSERT(l < order()-1);
+    return (int64_t*)(((char*)fids(l)) + align_offset(nfib(l)*sizeof(int64_t)));
+  }
+}
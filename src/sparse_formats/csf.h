@@ -0,0 +1,205 @@
+#ifndef __CSF_H__
+#define __CSF_H__
+
+#include "../tensor/algstrct.h"
+
+namespace CTF_int {
+
+  /**
+   * \brief computes the size of a serialized CSF tensor
+   * \param[in] order number of modes of the tensor
+   * \param[in] nfib number of fibers at each level (nfib[order-1] is the number of nonzeros)
+   * \param[in] val_size size of each tensor entry
+   */
+  int64_t get_csf_size(int order, int64_t const * nfib, int val_size);
+
+  /**
+   * \brief abstraction for a serialized sparse tensor stored in compressed-sparse-fiber (CSF) layout,
+   *        a tree with one level per mode (in the order given by mode()), whose nodes at level l are the
+   *        fibers of nonzeros sharing their indices along the modes of levels 0...l, so that the leaves are the nonzeros
+   */
+  class CSF_Tensor{
+    public:
+      /** \brief serialized buffer containing all info, index, and values related to tensor */
+      char * all_data;
+
+      /**
+       * \brief constructor builds (and allocates) the CSF tensor of a set of key-value pairs
+       * \param[in] nnz number of pairs, whose keys must be distinct
+       * \param[in] pairs key-value pairs, keys are global indices of a tensor with edge lengths lens
+       * \param[in] order number of modes of the tensor
+       * \param[in] lens edge lengths of the tensor
+       * \param[in] mode_order mode of the tensor stored at each level of the tree, starting with the root
+       * \param[in] sr algebraic structure of the values
+       */
+      CSF_Tensor(int64_t nnz, char const * pairs, int order, int const * lens, int const * mode_order, algstrct const * sr);
+
+      /** \brief constructor given serialized CSF tensor */
+      CSF_Tensor(char * all_data);
+
+      CSF_Tensor(){ all_data=NULL; }
+
+      /** \brief retrieves number of modes out of all_data */
+      int order() const;
+
+      /** \brief retrieves number of nonzeros out of all_data */
+      int64_t nnz() const;
+
+      /** \brief retrieves tensor entry size out of all_data */
+      int val_size() const;
+
+      /** \brief retrieves buffer size out of all_data */
+      int64_t size() const;
+
+      /** \brief retrieves the mode of the tensor stored at level l */
+      int mode(int l) const;
+
+      /** \brief retrieves the number of fibers at level l */
+      int64_t nfib(int l) const;
+
+      /** \brief retrieves the index (along mode(l)) of each fiber at level l, these may be relabeled by the user */
+      int64_t * fids(int l) const;
+
+      /** \brief retrieves the offsets (of size nfib(l)+1) of the children at level l+1 of each fiber at level l<order()-1 */
+      int64_t * fptr(int l) const;
+
+      /** \brief retrieves the values of the nonzeros, ordered as the leaves */
+      char * vals() const;
+  };
+
+  /**
+   * \brief row operations used by the CSF MTTKRP kernel, given by the add() and mul() of an algstrct
+   */
+  struct algstrct_mttkrp_ops {
+    algstrct const * sr;
+    int el_size;
+
+    algstrct_mttkrp_ops(algstrct const * sr_) : sr(sr_), el_size(sr_->el_size) { }
+
+    /** \brief y[r] = 0 */
+    void set_addid(char * y, int R) const {
+      sr->set(y, sr->addid(), R);
+    }
+
+    /** \brief y[r] += a*x[r] */
+    void fma_row(char * y, char const * a, char const * x, int R) const {
+      char tmp[el_size];
+      for (int r=0; r<R; r++){
+        sr->mul(a, x+r*el_size, tmp);
+        sr->add(y+r*el_size, tmp, y+r*el_size);
+      }
+    }
+
+    /** \brief y[r] += a[r]*x[r] */
+    void fma_rows(char * y, char const * a, char const * x, int R) const {
+      char tmp[el_size];
+      for (int r=0; r<R; r++){
+        sr->mul(a+r*el_size, x+r*el_size, tmp);
+        sr->add(y+r*el_size, tmp, y+r*el_size);
+      }
+    }
+  };
+
+  /**
+   * \brief row operations used by the CSF MTTKRP kernel, with elements of type dtype and
+   *        addition and multiplication operators given by (inlined) functors
+   */
+  template <typename dtype, typename fadd_t, typename fmul_t>
+  struct typed_mttkrp_ops {
+    dtype addid;
+    fadd_t fadd;
+    fmul_t fmul;
+    int el_size;
+
+    typed_mttkrp_ops(dtype addid_, fadd_t fadd_, fmul_t fmul_) : addid(addid_), fadd(fadd_), fmul(fmul_), el_size(sizeof(dtype)) { }
+
+    void set_addid(char * y, int R) const {
+      std::fill((dtype*)y, ((dtype*)y)+R, addid);
+    }
+
+    void fma_row(char * y, char const * a, char const * x, int R) const {
+      dtype * ty = (dtype*)y;
+      dtype ta = ((dtype const*)a)[0];
+      dtype const * tx = (dtype const*)x;
+      for (int r=0; r<R; r++){
+        ty[r] = fadd(ty[r], fmul(ta, tx[r]));
+      }
+    }
+
+    void fma_rows(char * y, char const * a, char const * x, int R) const {
+      dtype * ty = (dtype*)y;
+      dtype const * ta = (dtype const*)a;
+      dtype const * tx = (dtype const*)x;
+      for (int r=0; r<R; r++){
+        ty[r] = fadd(ty[r], fmul(ta[r], tx[r]));
+      }
+    }
+  };
+
+  /**
+   * \brief adds into dst the contribution of fiber f at level l>0 of a CSF tensor to its parent's row,
+   *        i.e. the product of the rows of facs along the path from f to the leaves, summed over the leaves,
+   *        partial products are formed once per fiber, rather than once per nonzero
+   * \param[in] order number of levels of the tensor
+   * \param[in] fids fiber indices at each level (CSF_Tensor::fids())
+   * \param[in] fptr child offsets at each level (CSF_Tensor::fptr())
+   * \param[in] vals values of the nonzeros
+   * \param[in] bufs scratch space of order*R elements
+   */
+  template <typename ops_t>
+  void csf_mttkrp_fiber(int order, int64_t const * const * fids, int64_t const * const * fptr, char const * vals, int l, int64_t f, int R, char const * const * facs, char * bufs, char * dst, ops_t const & ops){
+    int el_size = ops.el_size;
+    char const * row = facs[l]+fids[l][f]*R*el_size;
+    if (l == order-1){
+      ops.fma_row(dst, vals+f*el_size, row, R);
+      return;
+    }
+    char * buf = bufs+l*R*el_size;
+    ops.set_addid(buf, R);
+    for (int64_t c=fptr[l][f]; c<fptr[l][f+1]; c++){
+      csf_mttkrp_fiber(order, fids, fptr, vals, l+1, c, R, facs, bufs, buf, ops);
+    }
+    ops.fma_rows(dst, buf, row, R);
+  }
+
+  /**
+   * \brief matricized tensor times Khatri-Rao product (MTTKRP) of a CSF tensor, accumulates into row T.fids(0)[f]
+   *        of out the contribution of each fiber f at the root level
+   * \param[in] T CSF tensor whose fiber indices at each level l>0 are rows of facs[l]
+   * \param[in] R number of columns of each factor matrix
+   * \param[in] facs row-major factor matrices for each level (facs[0] is unused)
+   * \param[in,out] out row-major output matrix, whose rows indexed by T.fids(0) are accumulated to
+   * \param[in] ops row operations (algstrct_mttkrp_ops or typed_mttkrp_ops)
+   */
+  template <typename ops_t>
+  void csf_mttkrp(CSF_Tensor const & T, int R, char const * const * facs, char * out, ops_t const & ops){
+    int el_size = ops.el_size;
+    int order = T.order();
+    int64_t const * fids[order];
+    int64_t const * fptr[order];
+    for (int l=0; l<order; l++){
+      fids[l] = T.fids(l);
+      fptr[l] = l < order-1 ? T.fptr(l) : NULL;
+    }
+    char const * vals = T.vals();
+    int64_t nroot = T.nfib(0);
+#ifdef _OPENMP
+    #pragma omp parallel
+#endif
+    {
+      char * bufs = (char*)alloc(((int64_t)order)*R*el_size);
+#ifdef _OPENMP
+      #pragma omp for schedule(dynamic,16)
+#endif
+      for (int64_t f=0; f<nroot; f++){
+        char * dst = out+fids[0][f]*R*el_size;
+        for (int64_t c=fptr[0][f]; c<fptr[0][f+1]; c++){
+          csf_mttkrp_fiber(order, fids, fptr, vals, 1, c, R, facs, bufs, dst, ops);
+        }
+      }
+      cdealloc(bufs);
+    }
+  }
+}
+
+#endif
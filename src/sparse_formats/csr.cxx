@@ -1,30 +1,46 @@
 #include "csr.h"
+#include "dcsr.h"
 #include "../contraction/ctr_comm.h"
 #include "../shared/util.h"
 
 #define ALIGN 256
 
 namespace CTF_int {
-  int64_t get_csr_size(int64_t nnz, int nrow_, int val_size){
-    int offset = 4*sizeof(int64_t);
+  int64_t get_csr_size(int64_t nnz, int nrow_, int val_size, int idx_width){
+    int64_t offset = 7*sizeof(int64_t);
     if (offset % ALIGN != 0) offset += ALIGN-(offset%ALIGN);
     offset += nnz*val_size;
     if (offset % ALIGN != 0) offset += ALIGN-(offset%ALIGN);
-    offset += (nrow_+1)*sizeof(int);
+    offset += (nrow_+1)*((int64_t)idx_width);
     if (offset % ALIGN != 0) offset += ALIGN-(offset%ALIGN);
-    offset += sizeof(int)*nnz;
+    offset += idx_width*nnz;
     if (offset % ALIGN != 0) offset += ALIGN-(offset%ALIGN);
     return offset;
   }
 
-  CSR_Matrix::CSR_Matrix(int64_t nnz, int nrow_, int ncol, int el_size){
-    ASSERT(ALIGN >= 16);
-    int64_t size = get_csr_size(nnz, nrow_, el_size);
-    all_data = (char*)alloc(size);
+  int get_csr_idx_width(int64_t nnz, int ncol){
+    return get_sp_idx_width(std::max(nnz+1, (int64_t)ncol));
+  }
+
+  /**
+   * \brief writes the header of a serialized CSR matrix,
+   *        the sixth entry is 0 for CSR and 1 for DCSR, in which case the seventh holds the number of rows
+   */
+  static void set_csr_header(char * all_data, int64_t nnz, int el_size, int nrow_, int ncol, int idx_width){
     ((int64_t*)all_data)[0] = nnz;
     ((int64_t*)all_data)[1] = el_size;
     ((int64_t*)all_data)[2] = (int64_t)nrow_;
     ((int64_t*)all_data)[3] = ncol;
+    ((int64_t*)all_data)[4] = idx_width;
+    ((int64_t*)all_data)[5] = 0;
+    ((int64_t*)all_data)[6] = (int64_t)nrow_;
+  }
+
+  CSR_Matrix::CSR_Matrix(int64_t nnz, int nrow_, int ncol, int el_size, int idx_width){
+    ASSERT(ALIGN >= 16);
+    int64_t size = get_csr_size(nnz, nrow_, el_size, idx_width);
+    all_data = (char*)alloc(size);
+    set_csr_header(all_data, nnz, el_size, nrow_, ncol, idx_width);
   }
 
   CSR_Matrix::CSR_Matrix(char * all_data_){
@@ -36,35 +52,57 @@ namespace CTF_int {
     ASSERT(ALIGN >= 16);
     int64_t nz = coom.nnz(); 
     int64_t v_sz = coom.val_size(); 
-    int const * coo_rs = coom.rows();
-    int const * coo_cs = coom.cols();
     char const * vs = coom.vals();
+    int w = get_csr_idx_width(nz, ncol);
 
-    int64_t size = get_csr_size(nz, nrow_, v_sz);
+    int64_t size = get_csr_size(nz, nrow_, v_sz, w);
     if (data == NULL)
       all_data = (char*)alloc(size);
     else
       all_data = data;
-    ((int64_t*)all_data)[0] = nz;
-    ((int64_t*)all_data)[1] = v_sz;
-    ((int64_t*)all_data)[2] = (int64_t)nrow_;
-    ((int64_t*)all_data)[3] = ncol;
+    set_csr_header(all_data, nz, v_sz, nrow_, ncol, w);
 
     char * csr_vs = vals();
-    int * csr_ja = JA();
-    int * csr_ia = IA();
 
-    //memcpy(csr_vs, vs, nz*v_sz);
-    //memset(csr_ja
-
-    sr->coo_to_csr(nz, nrow_, csr_vs, csr_ja, csr_ia, vs, coo_rs, coo_cs);
-/*    for (int i=0; i<nrow_; i++){
-      printf("csr_ja[%d] = %d\n",i,csr_ja[i]);
+    if (w == sizeof(int) && coom.idx_width() == sizeof(int)){
+      sr->coo_to_csr(nz, nrow_, csr_vs, JA(), IA(), vs, coom.rows(), coom.cols());
+      return;
     }
-    for (int i=0; i<nz; i++){
-      printf("csr_ia[%d] = %d\n",i,csr_ia[i]);
-    }*/
-    
+    // order the nonzeros by row, then by column, as done by coo_to_csr for 32-bit indices
+    int coo_w = coom.idx_width();
+    char const * coo_rs = coom.rows_raw();
+    char const * coo_cs = coom.cols_raw();
+    char * csr_ja = JA_raw();
+    char * csr_ia = IA_raw();
+    int64_t * perm = (int64_t*)alloc(sizeof(int64_t)*nz);
+    for (int64_t i=0; i<nz; i++){
+      perm[i] = i;
+    }
+    std::sort(perm, perm+nz, [&](int64_t u, int64_t v){
+      int64_t ru = get_sp_idx(coo_rs, coo_w, u);
+      int64_t rv = get_sp_idx(coo_rs, coo_w, v);
+      if (ru != rv) return ru < rv;
+      int64_t cu = get_sp_idx(coo_cs, coo_w, u);
+      int64_t cv = get_sp_idx(coo_cs, coo_w, v);
+      if (cu != cv) return cu < cv;
+      return u < v;
+    });
+    int64_t irow = 0;
+    set_sp_idx(csr_ia, w, 0, 1);
+    for (int64_t i=0; i<nz; i++){
+      int64_t r = get_sp_idx(coo_rs, coo_w, perm[i]);
+      while (irow < r-1){
+        irow++;
+        set_sp_idx(csr_ia, w, irow, i+1);
+      }
+      set_sp_idx(csr_ja, w, i, get_sp_idx(coo_cs, coo_w, perm[i]));
+      memcpy(csr_vs+i*v_sz, vs+perm[i]*v_sz, v_sz);
+    }
+    while (irow < nrow_){
+      irow++;
+      set_sp_idx(csr_ia, w, irow, nz+1);
+    }
+    cdealloc(perm);
   }
 
   int64_t CSR_Matrix::nnz() const {
@@ -77,7 +115,12 @@ namespace CTF_int {
 
 
   int64_t CSR_Matrix::size() const {
-    return get_csr_size(nnz(),nrow(),val_size());
+    if (is_dcsr()) return DCSR_Matrix(all_data).size();
+    return get_csr_size(nnz(),nrow(),val_size(),idx_width());
+  }
+
+  bool CSR_Matrix::is_dcsr() const {
+    return DCSR_Matrix::is_dcsr(all_data);
   }
   
   int CSR_Matrix::nrow() const {
@@ -87,199 +130,287 @@ namespace CTF_int {
   int CSR_Matrix::ncol() const {
     return ((int64_t*)all_data)[3];
   }
+
+  int CSR_Matrix::idx_width() const {
+    return ((int64_t*)all_data)[4];
+  }
   
   char * CSR_Matrix::vals() const {
-    int offset = 4*sizeof(int64_t);
+    int64_t offset = 7*sizeof(int64_t);
     if (offset % ALIGN != 0) offset += ALIGN-(offset%ALIGN);
     return all_data + offset;
   }
 
-  int * CSR_Matrix::IA() const {
+  char * CSR_Matrix::IA_raw() const {
     int64_t n = this->nnz();
     int v_sz = this->val_size();
 
-    int offset = 4*sizeof(int64_t);
+    int64_t offset = 7*sizeof(int64_t);
     if (offset % ALIGN != 0) offset += ALIGN-(offset%ALIGN);
     offset += n*v_sz;
     if (offset % ALIGN != 0) offset += ALIGN-(offset%ALIGN);
 
-    return (int*)(all_data + offset);
+    return all_data + offset;
   } 
 
-  int * CSR_Matrix::JA() const {
+  char * CSR_Matrix::JA_raw() const {
     int64_t n = this->nnz();
     int64_t nr = this->nrow();
     int v_sz = this->val_size();
 
-    int offset = 4*sizeof(int64_t);
+    int64_t offset = 7*sizeof(int64_t);
     if (offset % ALIGN != 0) offset += ALIGN-(offset%ALIGN);
     offset += n*v_sz;
     if (offset % ALIGN != 0) offset += ALIGN-(offset%ALIGN);
-    offset += (nr+1)*sizeof(int);
+    offset += (nr+1)*idx_width();
     if (offset % ALIGN != 0) offset += ALIGN-(offset%ALIGN);
-    //return (int*)(all_data + n*v_sz+(nr+1)*sizeof(int)+3*sizeof(int64_t));
-    return (int*)(all_data + offset);
+    return all_data + offset;
   } 
 
+  int * CSR_Matrix::IA() const {
+    ASSERT(idx_width() == sizeof(int));
+    return (int*)IA_raw();
+  }
+
+  int * CSR_Matrix::JA() const {
+    ASSERT(idx_width() == sizeof(int));
+    return (int*)JA_raw();
+  }
+
+  CSR_Matrix CSR_Matrix::to_idx_width(int idx_width_) const {
+    int w = idx_width();
+    if (w == idx_width_) return CSR_Matrix(all_data);
+    int64_t nz = nnz();
+    int nr = nrow();
+    int v_sz = val_size();
+    int64_t max_idx = idx_width_ == 2 ? INT16_MAX : (idx_width_ == 4 ? INT32_MAX : INT64_MAX);
+    if (std::max(nz+1, (int64_t)ncol()) > max_idx){
+      printf("CTF ERROR: CSR matrix with %ld nonzeros and %d columns does not fit %d-byte indices\n", nz, ncol(), idx_width_);
+      assert(0);
+    }
+    CSR_Matrix cm(nz, nr, ncol(), v_sz, idx_width_);
+    memcpy(cm.vals(), vals(), nz*v_sz);
+    char const * ia = IA_raw();
+    char const * ja = JA_raw();
+    char * new_ia = cm.IA_raw();
+    char * new_ja = cm.JA_raw();
+    for (int64_t i=0; i<=nr; i++){
+      set_sp_idx(new_ia, idx_width_, i, get_sp_idx(ia, w, i));
+    }
+    for (int64_t i=0; i<nz; i++){
+      set_sp_idx(new_ja, idx_width_, i, get_sp_idx(ja, w, i));
+    }
+    return cm;
+  }
+
   void CSR_Matrix::csrmm(char const * A, algstrct const * sr_A, int m, int n, int k, char const * alpha, char const * B, algstrct const * sr_B, char const * beta, char * C, algstrct const * sr_C, bivar_function const * func, bool do_offload){
+    if (DCSR_Matrix::is_dcsr(A))
+      DCSR_Matrix::csrmm(A, sr_A, m, n, k, alpha, B, sr_B, beta, C, sr_C, func, do_offload);
+    else
+      csrmm(CSR_Matrix((char*)A), sr_A, m, n, k, alpha, B, sr_B, beta, C, sr_C, func, do_offload);
+  }
+
+  void CSR_Matrix::csrmm(CSR_Matrix const & cA, algstrct const * sr_A, int m, int n, int k, char const * alpha, char const * B, algstrct const * sr_B, char const * beta, char * C, algstrct const * sr_C, bivar_function const * func, bool do_offload){
     if (func != NULL && func->has_off_gemm && do_offload){
       assert(sr_C->isequal(beta, sr_C->mulid()));
       assert(alpha == NULL || sr_C->isequal(alpha, sr_C->mulid()));
-      func->coffload_csrmm(m,n,k,A,B,C);
+      func->coffload_csrmm(m,n,k,cA.all_data,B,C);
     } else {
-      CSR_Matrix cA((char*)A);
-      int64_t nz = cA.nnz(); 
-      int const * ja = cA.JA();
-      int const * ia = cA.IA();
-      char const * vs = cA.vals();
       if (func != NULL){
         assert(sr_C->isequal(beta, sr_C->mulid()));
         assert(alpha == NULL || sr_C->isequal(alpha, sr_C->mulid()));
-        func->ccsrmm(m,n,k,vs,ja,ia,nz,B,C,sr_C);
+        // function kernels take 32-bit indices
+        CSR_Matrix iA = cA.to_idx_width(sizeof(int));
+        func->ccsrmm(m,n,k,iA.vals(),iA.JA(),iA.IA(),iA.nnz(),B,C,sr_C);
+        if (iA.all_data != cA.all_data) cdealloc(iA.all_data);
       } else {
         ASSERT(sr_B->el_size == sr_A->el_size);
         ASSERT(sr_C->el_size == sr_A->el_size);
         assert(!do_offload);
-        sr_C->csrmm(m,n,k,alpha,vs,ja,ia,nz,B,beta,C,func);
+        sr_C->csrmm(m,n,k,alpha,cA,B,beta,C);
       }
     }
   }
 
+  /**
+   * \brief gives A and B a common index width, (re)allocating iA and iB if needed
+   * \param[in] cA first matrix
+   * \param[in] cB second matrix
+   * \param[in] idx_width width to use, or 0 for the larger of the two widths
+   * \param[out] iA cA with the common index width
+   * \param[out] iB cB with the common index width
+   */
+  static void match_idx_width(CSR_Matrix const & cA, CSR_Matrix const & cB, int idx_width, CSR_Matrix & iA, CSR_Matrix & iB){
+    if (idx_width == 0) idx_width = std::max(cA.idx_width(), cB.idx_width());
+    iA = cA.to_idx_width(idx_width);
+    iB = cB.to_idx_width(idx_width);
+  }
+
   void CSR_Matrix::csrmultd(char const * A, algstrct const * sr_A, int m, int n, int k, char const * alpha, char const * B, algstrct const * sr_B, char const * beta, char * C, algstrct const * sr_C, bivar_function const * func, bool do_offload){
+    if (DCSR_Matrix::is_dcsr(A) || DCSR_Matrix::is_dcsr(B))
+      DCSR_Matrix::csrmultd(A, sr_A, m, n, k, alpha, B, sr_B, beta, C, sr_C, func, do_offload);
+    else
+      csrmultd(CSR_Matrix((char*)A), sr_A, m, n, k, alpha, CSR_Matrix((char*)B), sr_B, beta, C, sr_C, func, do_offload);
+  }
+
+  void CSR_Matrix::csrmultd(CSR_Matrix const & cA, algstrct const * sr_A, int m, int n, int k, char const * alpha, CSR_Matrix const & cB, algstrct const * sr_B, char const * beta, char * C, algstrct const * sr_C, bivar_function const * func, bool do_offload){
     if (func != NULL && func->has_off_gemm && do_offload){
       assert(0);
       assert(sr_C->isequal(beta, sr_C->mulid()));
       assert(alpha == NULL || sr_C->isequal(alpha, sr_C->mulid()));
     } else {
-      CSR_Matrix cA((char*)A);
-      int64_t nzA = cA.nnz(); 
-      int const * jA = cA.JA();
-      int const * iA = cA.IA();
-      char const * vsA = cA.vals();
-      CSR_Matrix cB((char*)B);
-      int64_t nzB = cB.nnz(); 
-      int const * jB = cB.JA();
-      int const * iB = cB.IA();
-      char const * vsB = cB.vals();
+      CSR_Matrix iA, iB;
+      match_idx_width(cA, cB, func != NULL ? sizeof(int) : 0, iA, iB);
       if (func != NULL){
         assert(sr_C->isequal(beta, sr_C->mulid()));
         assert(alpha == NULL || sr_C->isequal(alpha, sr_C->mulid()));
-        func->ccsrmultd(m,n,k,vsA,jA,iA,nzA,vsB,jB,iB,nzB,C,sr_C);
+        func->ccsrmultd(m,n,k,iA.vals(),iA.JA(),iA.IA(),iA.nnz(),iB.vals(),iB.JA(),iB.IA(),iB.nnz(),C,sr_C);
       } else {
         ASSERT(sr_B->el_size == sr_A->el_size);
         ASSERT(sr_C->el_size == sr_A->el_size);
         assert(!do_offload);
-        sr_C->csrmultd(m,n,k,alpha,vsA,jA,iA,nzA,vsB,jB,iB,nzB,beta,C);
+        sr_C->csrmultd(m,n,k,alpha,iA,iB,beta,C);
       }
+      if (iA.all_data != cA.all_data) cdealloc(iA.all_data);
+      if (iB.all_data != cB.all_data) cdealloc(iB.all_data);
     }
 
   }
 
   void CSR_Matrix::csrmultcsr(char const * A, algstrct const * sr_A, int m, int n, int k, char const * alpha, char const * B, algstrct const * sr_B, char const * beta, char *& C, algstrct const * sr_C, bivar_function const * func, bool do_offload){
+    if (DCSR_Matrix::is_dcsr(A) || DCSR_Matrix::is_dcsr(B))
+      DCSR_Matrix::csrmultcsr(A, sr_A, m, n, k, alpha, B, sr_B, beta, C, sr_C, func, do_offload);
+    else
+      csrmultcsr(CSR_Matrix((char*)A), sr_A, m, n, k, alpha, CSR_Matrix((char*)B), sr_B, beta, C, sr_C, func, do_offload);
+  }
+
+  void CSR_Matrix::csrmultcsr(CSR_Matrix const & cA, algstrct const * sr_A, int m, int n, int k, char const * alpha, CSR_Matrix const & cB, algstrct const * sr_B, char const * beta, char *& C, algstrct const * sr_C, bivar_function const * func, bool do_offload){
     if (func != NULL && func->has_off_gemm && do_offload){
       assert(0);
       assert(sr_C->isequal(beta, sr_C->mulid()));
       assert(alpha == NULL || sr_C->isequal(alpha, sr_C->mulid()));
     } else {
-      CSR_Matrix cA((char*)A);
-      int64_t nzA = cA.nnz(); 
-      int const * jA = cA.JA();
-      int const * iA = cA.IA();
-      char const * vsA = cA.vals();
-      CSR_Matrix cB((char*)B);
-      int64_t nzB = cB.nnz(); 
-      int const * jB = cB.JA();
-      int const * iB = cB.IA();
-      char const * vsB = cB.vals();
+      CSR_Matrix iA, iB;
+      match_idx_width(cA, cB, func != NULL ? sizeof(int) : 0, iA, iB);
       if (func != NULL){
         assert(sr_C->isequal(beta, sr_C->mulid()));
         assert(alpha == NULL || sr_C->isequal(alpha, sr_C->mulid()));
-        func->ccsrmultcsr(m,n,k,vsA,jA,iA,nzA,vsB,jB,iB,nzB,C,sr_C);
+        func->ccsrmultcsr(m,n,k,iA.vals(),iA.JA(),iA.IA(),iA.nnz(),iB.vals(),iB.JA(),iB.IA(),iB.nnz(),C,sr_C);
       } else {
         ASSERT(sr_B->el_size == sr_A->el_size);
         ASSERT(sr_C->el_size == sr_A->el_size);
         assert(!do_offload);
-        sr_C->csrmultcsr(m,n,k,alpha,vsA,jA,iA,nzA,vsB,jB,iB,nzB,beta,C);
+        sr_C->csrmultcsr(m,n,k,alpha,iA,iB,beta,C);
       }
+      if (iA.all_data != cA.all_data) cdealloc(iA.all_data);
+      if (iB.all_data != cB.all_data) cdealloc(iB.all_data);
     }
 
 
   }
 
+  void CSR_Matrix::masked_csrmultcsr(char const * A, algstrct const * sr_A, int m, int n, int k, char const * alpha, char const * B, algstrct const * sr_B, char * C, algstrct const * sr_C){
+    ASSERT(sr_B->el_size == sr_A->el_size);
+    ASSERT(sr_C->el_size == sr_A->el_size);
+    ASSERT(!DCSR_Matrix::is_dcsr(C));
+    // the rows of C are visited in order, so hypersparse operands are expanded to all of their rows
+    CSR_Matrix cA = DCSR_Matrix::is_dcsr(A) ? DCSR_Matrix((char*)A).to_csr() : CSR_Matrix((char*)A);
+    CSR_Matrix cB = DCSR_Matrix::is_dcsr(B) ? DCSR_Matrix((char*)B).to_csr() : CSR_Matrix((char*)B);
+    CSR_Matrix iA, iB;
+    match_idx_width(cA, cB, 0, iA, iB);
+    sr_C->masked_csrmultcsr(m, n, k, alpha, iA, iB, CSR_Matrix(C));
+    if (iA.all_data != cA.all_data) cdealloc(iA.all_data);
+    if (iB.all_data != cB.all_data) cdealloc(iB.all_data);
+    if (cA.all_data != A) cdealloc(cA.all_data);
+    if (cB.all_data != B) cdealloc(cB.all_data);
+  }
+
   void CSR_Matrix::partition(int s, char ** parts_buffer, CSR_Matrix ** parts){
-    int part_nnz[s], part_nrows[s];
+    ASSERT(!is_dcsr());
+    int64_t part_nnz[s];
+    int part_nrows[s];
     int m = nrow();
     int v_sz = val_size();
+    int w = idx_width();
     char * org_vals = vals();
-    int * org_ia = IA();
-    int * org_ja = JA();
+    char const * org_ia = IA_raw();
+    char const * org_ja = JA_raw();
     for (int i=0; i<s; i++){
       part_nnz[i] = 0;
       part_nrows[i] = 0;
     }
     for (int i=0; i<m; i++){
       part_nrows[i%s]++;
-      part_nnz[i%s]+=org_ia[i+1]-org_ia[i];
+      part_nnz[i%s]+=get_sp_idx(org_ia, w, i+1)-get_sp_idx(org_ia, w, i);
     }
     int64_t tot_sz = 0;
     for (int i=0; i<s; i++){
-      tot_sz += get_csr_size(part_nnz[i], part_nrows[i], v_sz);
+      tot_sz += get_csr_size(part_nnz[i], part_nrows[i], v_sz, w);
     }
     alloc_ptr(tot_sz, (void**)parts_buffer);
     char * part_data = *parts_buffer;
     for (int i=0; i<s; i++){
-      ((int64_t*)part_data)[0] = part_nnz[i];
-      ((int64_t*)part_data)[1] = v_sz;
-      ((int64_t*)part_data)[2] = part_nrows[i];
-      ((int64_t*)part_data)[3] = ncol();
+      set_csr_header(part_data, part_nnz[i], v_sz, part_nrows[i], ncol(), w);
       parts[i] = new CSR_Matrix(part_data);
       char * pvals = parts[i]->vals();
-      int * pja = parts[i]->JA();
-      int * pia = parts[i]->IA();
-      pia[0] = 1;
+      char * pja = parts[i]->JA_raw();
+      char * pia = parts[i]->IA_raw();
+      int64_t pnz = 0;
+      set_sp_idx(pia, w, 0, 1);
       for (int j=i, k=0; j<m; j+=s, k++){
-        memcpy(pvals+(pia[k]-1)*v_sz, org_vals+(org_ia[j]-1)*v_sz, (org_ia[j+1]-org_ia[j])*v_sz);
-        memcpy(pja+(pia[k]-1), org_ja+(org_ia[j]-1), (org_ia[j+1]-org_ia[j])*sizeof(int));
-        pia[k+1] = pia[k]+org_ia[j+1]-org_ia[j];
+        int64_t org_st = get_sp_idx(org_ia, w, j)-1;
+        int64_t row_nnz = get_sp_idx(org_ia, w, j+1)-1-org_st;
+        memcpy(pvals+pnz*v_sz, org_vals+org_st*v_sz, row_nnz*v_sz);
+        memcpy(pja+pnz*w, org_ja+org_st*w, row_nnz*w);
+        pnz += row_nnz;
+        set_sp_idx(pia, w, k+1, pnz+1);
       }
-      part_data += get_csr_size(part_nnz[i], part_nrows[i], v_sz);
+      part_data += get_csr_size(part_nnz[i], part_nrows[i], v_sz, w);
     }
   }
       
   CSR_Matrix::CSR_Matrix(char * const * smnds, int s){
     CSR_Matrix * csrs[s];
     int64_t tot_nnz=0, tot_nrow=0;
+    int part_w = 0;
     for (int i=0; i<s; i++){
       csrs[i] = new CSR_Matrix(smnds[i]);
       tot_nnz += csrs[i]->nnz();
       tot_nrow += csrs[i]->nrow();
+      part_w = std::max(part_w, csrs[i]->idx_width());
     }
     int64_t v_sz = csrs[0]->val_size();
     int64_t tot_ncol = csrs[0]->ncol();
-    all_data = (char*)alloc(get_csr_size(tot_nnz, tot_nrow, v_sz));
-    ((int64_t*)all_data)[0] = tot_nnz;
-    ((int64_t*)all_data)[1] = v_sz;
-    ((int64_t*)all_data)[2] = tot_nrow;
-    ((int64_t*)all_data)[3] = tot_ncol;
+    int w = std::max(part_w, get_csr_idx_width(tot_nnz, tot_ncol));
+    all_data = (char*)alloc(get_csr_size(tot_nnz, tot_nrow, v_sz, w));
+    set_csr_header(all_data, tot_nnz, v_sz, tot_nrow, tot_ncol, w);
     
     char * csr_vs = vals();
-    int * csr_ja = JA();
-    int * csr_ia = IA();
+    char * csr_ja = JA_raw();
+    char * csr_ia = IA_raw();
 
-    csr_ia[0] = 1;
+    int64_t nz = 0;
+    set_sp_idx(csr_ia, w, 0, 1);
 
     for (int i=0; i<tot_nrow; i++){
       int ipart = i%s;
-      int const * pja = csrs[ipart]->JA();
-      int const * pia = csrs[ipart]->IA();
-      int i_nnz = pia[i/s+1]-pia[i/s];
-      memcpy(csr_vs+(csr_ia[i]-1)*v_sz,
-             csrs[ipart]->vals()+(pia[i/s]-1)*v_sz,
+      int pw = csrs[ipart]->idx_width();
+      char const * pja = csrs[ipart]->JA_raw();
+      char const * pia = csrs[ipart]->IA_raw();
+      int64_t p_st = get_sp_idx(pia, pw, i/s)-1;
+      int64_t i_nnz = get_sp_idx(pia, pw, i/s+1)-1-p_st;
+      memcpy(csr_vs+nz*v_sz,
+             csrs[ipart]->vals()+p_st*v_sz,
              i_nnz*v_sz);
-      memcpy(csr_ja+(csr_ia[i]-1),
-             pja+(pia[i/s]-1),
-             i_nnz*sizeof(int));
-      csr_ia[i+1] = csr_ia[i]+i_nnz;
+      if (pw == w){
+        memcpy(csr_ja+nz*w, pja+p_st*w, i_nnz*w);
+      } else {
+        for (int64_t j=0; j<i_nnz; j++){
+          set_sp_idx(csr_ja, w, nz+j, get_sp_idx(pja, pw, p_st+j));
+        }
+      }
+      nz += i_nnz;
+      set_sp_idx(csr_ia, w, i+1, nz+1);
     }
     for (int i=0; i<s; i++){
       delete csrs[i];
@@ -288,15 +419,16 @@ namespace CTF_int {
 
   void CSR_Matrix::print(algstrct const * sr){
     char * csr_vs = vals();
-    int * csr_ja = JA();
-    int * csr_ia = IA();
+    char const * csr_ja = JA_raw();
+    char const * csr_ia = IA_raw();
+    int w = idx_width();
     int irow= 0;
     int v_sz = val_size();
     int64_t nz = nnz();
     printf("CSR Matrix has %ld nonzeros %d rows %d cols\n", nz, nrow(), ncol());
     for (int64_t i=0; i<nz; i++){
-      while (i>=csr_ia[irow+1]-1) irow++;
-      printf("[%d,%d] ",irow,csr_ja[i]);
+      while (i>=get_sp_idx(csr_ia, w, irow+1)-1) irow++;
+      printf("[%d,%ld] ",irow,get_sp_idx(csr_ja, w, i));
       sr->print(csr_vs+v_sz*i);
       printf("\n");
     }
@@ -327,74 +459,74 @@ namespace CTF_int {
     int el_size = A.val_size();
 
     char const * vA = A.vals();
-    int const * JA = A.JA();
-    int const * IA = A.IA();
+    char const * JA = A.JA_raw();
+    char const * IA = A.IA_raw();
+    int wA = A.idx_width();
     int nrow = A.nrow();
     char const * vB = B.vals();
-    int const * JB = B.JA();
-    int const * IB = B.IA();
+    char const * JB = B.JA_raw();
+    char const * IB = B.IA_raw();
+    int wB = B.idx_width();
     ASSERT(nrow == B.nrow());
     int ncol = std::max(A.ncol(),B.ncol());
-    int * IC = (int*)alloc(sizeof(int)*(nrow+1));
+    int64_t * IC = (int64_t*)alloc(sizeof(int64_t)*(nrow+1));
     int * has_col = (int*)alloc(sizeof(int)*ncol);
     IC[0] = 1;
     for (int i=0; i<nrow; i++){
       memset(has_col, 0, sizeof(int)*ncol);
       IC[i+1] = IC[i];
-      for (int j=0; j<IA[i+1]-IA[i]; j++){
-        has_col[JA[IA[i]+j-1]-1] = 1;
+      for (int64_t j=get_sp_idx(IA, wA, i)-1; j<get_sp_idx(IA, wA, i+1)-1; j++){
+        has_col[get_sp_idx(JA, wA, j)-1] = 1;
       }
-      for (int j=0; j<IB[i+1]-IB[i]; j++){
-        has_col[JB[IB[i]+j-1]-1] = 1;
+      for (int64_t j=get_sp_idx(IB, wB, i)-1; j<get_sp_idx(IB, wB, i+1)-1; j++){
+        has_col[get_sp_idx(JB, wB, j)-1] = 1;
       }
       for (int j=0; j<ncol; j++){
         IC[i+1] += has_col[j];
       }
     }
-    CSR_Matrix C(IC[nrow]-1, nrow, ncol, el_size);
+    int wC = get_csr_idx_width(IC[nrow]-1, ncol);
+    CSR_Matrix C(IC[nrow]-1, nrow, ncol, el_size, wC);
     char * vC = C.vals();
-    int * JC = C.JA();
-    memcpy(C.IA(), IC, sizeof(int)*(nrow+1));
-    cdealloc(IC);
-    IC = C.IA();
+    char * JC = C.JA_raw();
+    char * IC_C = C.IA_raw();
+    for (int i=0; i<=nrow; i++){
+      set_sp_idx(IC_C, wC, i, IC[i]);
+    }
     int64_t * rev_col = (int64_t*)alloc(sizeof(int64_t)*ncol);
     for (int i=0; i<nrow; i++){
       memset(has_col, 0, sizeof(int)*ncol);
-      for (int j=0; j<IA[i+1]-IA[i]; j++){
-        has_col[JA[IA[i]+j-1]-1] = 1;
+      for (int64_t j=get_sp_idx(IA, wA, i)-1; j<get_sp_idx(IA, wA, i+1)-1; j++){
+        has_col[get_sp_idx(JA, wA, j)-1] = 1;
       }
-      for (int j=0; j<IB[i+1]-IB[i]; j++){
-        has_col[JB[IB[i]+j-1]-1] = 1;
+      for (int64_t j=get_sp_idx(IB, wB, i)-1; j<get_sp_idx(IB, wB, i+1)-1; j++){
+        has_col[get_sp_idx(JB, wB, j)-1] = 1;
       }
-      int vs = 0;
+      int64_t vs = 0;
       for (int j=0; j<ncol; j++){
         if (has_col[j]){
-          JC[IC[i]+vs-1] = j+1;
-          //FIXME:: overflow?
+          set_sp_idx(JC, wC, IC[i]+vs-1, j+1);
           rev_col[j] = (IC[i]+vs-1)*el_size;
           vs++;
         }
       }
       memset(has_col, 0, sizeof(int)*ncol);
-      for (int j=0; j<IA[i+1]-IA[i]; j++){
-        int idx_A = IA[i]+j-1;
-        memcpy(vC+rev_col[JA[idx_A]-1],vA+idx_A*el_size,el_size);
-        has_col[JA[idx_A]-1] = 1;
+      for (int64_t idx_A=get_sp_idx(IA, wA, i)-1; idx_A<get_sp_idx(IA, wA, i+1)-1; idx_A++){
+        int64_t col_A = get_sp_idx(JA, wA, idx_A)-1;
+        memcpy(vC+rev_col[col_A],vA+idx_A*el_size,el_size);
+        has_col[col_A] = 1;
       }
-      for (int j=0; j<IB[i+1]-IB[i]; j++){
-        int idx_B = IB[i]+j-1;
-        if (has_col[JB[idx_B]-1])
-          adder->accum(vB+idx_B*el_size,vC+rev_col[JB[idx_B]-1]);
+      for (int64_t idx_B=get_sp_idx(IB, wB, i)-1; idx_B<get_sp_idx(IB, wB, i+1)-1; idx_B++){
+        int64_t col_B = get_sp_idx(JB, wB, idx_B)-1;
+        if (has_col[col_B])
+          adder->accum(vB+idx_B*el_size,vC+rev_col[col_B]);
         else
-          memcpy(vC+rev_col[JB[idx_B]-1],vB+idx_B*el_size,el_size);
+          memcpy(vC+rev_col[col_B],vB+idx_B*el_size,el_size);
       }
     }
+    cdealloc(IC);
     cdealloc(has_col);
     cdealloc(rev_col);
- /*   printf("nnz C is %ld\n", C.nnz());
-    printf("%d %d %d\n",C.IA()[0],C.IA()[1],C.IA()[2]);
-    printf("%d %d\n",C.JA()[0],C.JA()[1]);
-    printf("%lf %lf\n",((double*)C.vals())[0],((double*)C.vals())[1]);*/
     TAU_FSTOP(csr_add);
     
     return C.all_data;
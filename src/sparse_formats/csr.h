@@ -13,11 +13,20 @@ namespace CTF_int {
    * \param[in] nnz number of nonzeros in matrix
    * \param[in] nrow number of rows in matrix
    * \param[in] val_size size of each matrix entry
+   * \param[in] idx_width size of each row offset and column index
    */
-  int64_t get_csr_size(int64_t nnz, int nrow, int val_size);
+  int64_t get_csr_size(int64_t nnz, int nrow, int val_size, int idx_width);
 
   /**
-   * \brief abstraction for a serialized sparse matrix stored in column-sparse-row (CSR) layout
+   * \brief number of bytes used for the row offsets and column indices of a CSR matrix
+   * \param[in] nnz number of nonzeros in matrix
+   * \param[in] ncol number of columns in matrix
+   */
+  int get_csr_idx_width(int64_t nnz, int ncol);
+
+  /**
+   * \brief abstraction for a serialized sparse matrix stored in column-sparse-row (CSR) layout,
+   *        the row offsets and column indices are 1-based and have a width of 2, 4, or 8 bytes
    */
   class CSR_Matrix{
     public:
@@ -25,7 +34,7 @@ namespace CTF_int {
       char * all_data;
       
       /** \brief constructor allocates all_data */
-      CSR_Matrix(int64_t nnz, int nrow, int ncol, int el_size);
+      CSR_Matrix(int64_t nnz, int nrow, int ncol, int el_size, int idx_width=sizeof(int));
 
       /** \brief constructor given serialized CSR matrix */
       CSR_Matrix(char * all_data);
@@ -34,16 +43,19 @@ namespace CTF_int {
       
       CSR_Matrix(CSR_Matrix const & other){ all_data=other.all_data; }
       
-      /** \brief constructor given coordinate format (COO) matrix */
+      /** \brief constructor given coordinate format (COO) matrix, the index width is chosen by get_csr_idx_width() */
       CSR_Matrix(COO_Matrix const & coom, int nrow, int ncol, algstrct const * sr, char * data=NULL);
 
       /** \brief retrieves number of nonzeros out of all_data */
       int64_t nnz() const;
 
-      /** \brief retrieves buffer size out of all_data */
+      /** \brief retrieves buffer size out of all_data (also for a DCSR matrix) */
       int64_t size() const;
 
-      /** \brief retrieves number of rows out of all_data */
+      /** \brief whether all_data holds a doubly-compressed (DCSR_Matrix) rather than a CSR matrix */
+      bool is_dcsr() const;
+
+      /** \brief retrieves number of rows out of all_data, for a DCSR matrix this is the number of nonempty rows */
       int nrow() const;
       
       /** \brief retrieves number of columns out of all_data */
@@ -52,17 +64,32 @@ namespace CTF_int {
       /** \brief retrieves matrix entry size out of all_data */
       int val_size() const;
 
+      /** \brief retrieves size of each row offset and column index (2, 4, or 8 bytes) out of all_data */
+      int idx_width() const;
+
       /** \brief retrieves array of values out of all_data */
       char * vals() const;
 
-      /** \brief retrieves prefix sum of number of nonzeros for each row (of size nrow()+1) out of all_data */
+      /** \brief retrieves prefix sum of number of nonzeros for each row (of size nrow()+1) out of all_data, requires idx_width()==sizeof(int) */
       int * IA() const;
 
-      /** \brief retrieves column indices of each value in vals stored in sorted form by row */
+      /** \brief retrieves column indices of each value in vals stored in sorted form by row, requires idx_width()==sizeof(int) */
       int * JA() const;
 
+      /** \brief retrieves row offsets as in IA(), with entries of idx_width() bytes */
+      char * IA_raw() const;
+
+      /** \brief retrieves column indices as in JA(), with entries of idx_width() bytes */
+      char * JA_raw() const;
+
+      /**
+       * \brief returns this matrix if its indices have width idx_width, otherwise a newly allocated copy with that index width
+       * \param[in] idx_width desired size of each row offset and column index
+       */
+      CSR_Matrix to_idx_width(int idx_width) const;
+
       /**
-       * \brief splits CSR matrix into s submatrices (returned) corresponding to subsets of rows, all parts allocated in one contiguous buffer (passed back in parts_buffer)
+       * \brief splits CSR (not DCSR) matrix into s submatrices (returned) corresponding to subsets of rows, all parts allocated in one contiguous buffer (passed back in parts_buffer)
        */
       void partition(int s, char ** parts_buffer, CSR_Matrix ** parts);
       
@@ -78,20 +105,41 @@ namespace CTF_int {
       void print(algstrct const * sr);
 
       /**
-       * \brief computes C = beta*C + func(alpha*A*B) where A is a CSR_Matrix, while B and C are dense
+       * \brief computes C = beta*C + func(alpha*A*B) where A is a CSR_Matrix (or DCSR_Matrix), while B and C are dense
        */
       static void csrmm(char const * A, algstrct const * sr_A, int m, int n, int k, char const * alpha, char const * B, algstrct const * sr_B, char const * beta, char * C, algstrct const * sr_C, bivar_function const * func, bool do_offload);
+
+      /**
+       * \brief csrmm() for an m-row CSR matrix A, treating a DCSR buffer as its compressed matrix
+       */
+      static void csrmm(CSR_Matrix const & A, algstrct const * sr_A, int m, int n, int k, char const * alpha, char const * B, algstrct const * sr_B, char const * beta, char * C, algstrct const * sr_C, bivar_function const * func, bool do_offload);
       
       /**
-       * \brief computes C = beta*C + func(alpha*A*B) where A and B are CSR_Matrices, while C is dense
+       * \brief computes C = beta*C + func(alpha*A*B) where A and B are CSR_Matrices (or DCSR_Matrices), while C is dense
        */
       static void csrmultd(char const * A, algstrct const * sr_A, int m, int n, int k, char const * alpha, char const * B, algstrct const * sr_B, char const * beta, char * C, algstrct const * sr_C, bivar_function const * func, bool do_offload);
 
       /**
-       * \brief computes C = beta*C + func(alpha*A*B) where A, B, and C are CSR_Matrices, while C is dense
+       * \brief csrmultd() for an m-row CSR matrix A and k-row CSR matrix B, treating DCSR buffers as their compressed matrices
+       */
+      static void csrmultd(CSR_Matrix const & A, algstrct const * sr_A, int m, int n, int k, char const * alpha, CSR_Matrix const & B, algstrct const * sr_B, char const * beta, char * C, algstrct const * sr_C, bivar_function const * func, bool do_offload);
+
+      /**
+       * \brief computes C = beta*C + func(alpha*A*B) where A and B are CSR_Matrices (or DCSR_Matrices), while C is a CSR_Matrix
        */
       static void csrmultcsr(char const * A, algstrct const * sr_A, int m, int n, int k, char const * alpha, char const * B, algstrct const * sr_B, char const * beta, char *& C, algstrct const * sr_C, bivar_function const * func, bool do_offload);
 
+      /**
+       * \brief csrmultcsr() for an m-row CSR matrix A and k-row CSR matrix B, treating DCSR buffers as their compressed matrices
+       */
+      static void csrmultcsr(CSR_Matrix const & A, algstrct const * sr_A, int m, int n, int k, char const * alpha, CSR_Matrix const & B, algstrct const * sr_B, char const * beta, char *& C, algstrct const * sr_C, bivar_function const * func, bool do_offload);
+
+      /**
+       * \brief computes C += alpha*A*B on the nonzeros of C only (the pattern of C is a mask and is kept), where A and B
+       *        are CSR_Matrices (or DCSR_Matrices) and C is a CSR_Matrix, updated in place
+       */
+      static void masked_csrmultcsr(char const * A, algstrct const * sr_A, int m, int n, int k, char const * alpha, char const * B, algstrct const * sr_B, char * C, algstrct const * sr_C);
+
       static void compute_has_col(
 
                       int const * JA,
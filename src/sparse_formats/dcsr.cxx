@@ -0,0 +1,265 @@
+#include "dcsr.h"
+#include "../contraction/ctr_comm.h"
+#include "../shared/util.h"
+
+#define ALIGN 256
+
+namespace CTF {
+  double SP_DCSR_MAX_NNZ_PER_ROW = .5;
+}
+
+namespace CTF_int {
+  int64_t get_dcsr_size(int64_t nnz, int64_t nnzr, int val_size, int idx_width){
+    int64_t offset = get_csr_size(nnz, nnzr, val_size, idx_width);
+    offset += nnzr*idx_width;
+    if (offset % ALIGN != 0) offset += ALIGN-(offset%ALIGN);
+    return offset;
+  }
+
+  bool use_dcsr(int64_t nnz, int nrow){
+    return nnz < CTF::SP_DCSR_MAX_NNZ_PER_ROW*nrow;
+  }
+
+  /** \brief writes the header of a serialized DCSR matrix, the first five entries are those of its compressed CSR matrix */
+  static void set_dcsr_header(char * all_data, int64_t nnz, int64_t nnzr, int el_size, int nrow_, int ncol, int idx_width){
+    ((int64_t*)all_data)[0] = nnz;
+    ((int64_t*)all_data)[1] = el_size;
+    ((int64_t*)all_data)[2] = nnzr;
+    ((int64_t*)all_data)[3] = ncol;
+    ((int64_t*)all_data)[4] = idx_width;
+    ((int64_t*)all_data)[5] = 1;
+    ((int64_t*)all_data)[6] = (int64_t)nrow_;
+  }
+
+  DCSR_Matrix::DCSR_Matrix(int64_t nnz, int64_t nnzr, int nrow_, int ncol, int el_size, int idx_width){
+    all_data = (char*)alloc(get_dcsr_size(nnz, nnzr, el_size, idx_width));
+    set_dcsr_header(all_data, nnz, nnzr, el_size, nrow_, ncol, idx_width);
+  }
+
+  DCSR_Matrix::DCSR_Matrix(char * all_data_){
+    all_data = all_data_;
+  }
+
+  DCSR_Matrix::DCSR_Matrix(COO_Matrix const & coom, int nrow_, int ncol){
+    int64_t nz = coom.nnz();
+    int v_sz = coom.val_size();
+    char const * vs = coom.vals();
+    int coo_w = coom.idx_width();
+    char const * coo_rs = coom.rows_raw();
+    char const * coo_cs = coom.cols_raw();
+
+    // order the nonzeros by row, then by column, as done for CSR
+    int64_t * perm = (int64_t*)alloc(sizeof(int64_t)*nz);
+    for (int64_t i=0; i<nz; i++){
+      perm[i] = i;
+    }
+    std::sort(perm, perm+nz, [&](int64_t u, int64_t v){
+      int64_t ru = get_sp_idx(coo_rs, coo_w, u);
+      int64_t rv = get_sp_idx(coo_rs, coo_w, v);
+      if (ru != rv) return ru < rv;
+      int64_t cu = get_sp_idx(coo_cs, coo_w, u);
+      int64_t cv = get_sp_idx(coo_cs, coo_w, v);
+      if (cu != cv) return cu < cv;
+      return u < v;
+    });
+    int64_t nr = 0;
+    for (int64_t i=0; i<nz; i++){
+      if (i == 0 || get_sp_idx(coo_rs, coo_w, perm[i]) != get_sp_idx(coo_rs, coo_w, perm[i-1])) nr++;
+    }
+    int w = get_sp_idx_width(std::max(std::max(nz+1, (int64_t)ncol), (int64_t)nrow_));
+    all_data = (char*)alloc(get_dcsr_size(nz, nr, v_sz, w));
+    set_dcsr_header(all_data, nz, nr, v_sz, nrow_, ncol, w);
+
+    CSR_Matrix cm = compressed();
+    char * dcsr_vs = cm.vals();
+    char * dcsr_ia = cm.IA_raw();
+    char * dcsr_ja = cm.JA_raw();
+    char * dcsr_rs = rows_raw();
+    int64_t ir = -1;
+    for (int64_t i=0; i<nz; i++){
+      int64_t r = get_sp_idx(coo_rs, coo_w, perm[i]);
+      if (ir == -1 || get_sp_idx(dcsr_rs, w, ir) != r){
+        ir++;
+        set_sp_idx(dcsr_rs, w, ir, r);
+        set_sp_idx(dcsr_ia, w, ir, i+1);
+      }
+      set_sp_idx(dcsr_ja, w, i, get_sp_idx(coo_cs, coo_w, perm[i]));
+      memcpy(dcsr_vs+i*v_sz, vs+perm[i]*v_sz, v_sz);
+    }
+    set_sp_idx(dcsr_ia, w, nr, nz+1);
+    cdealloc(perm);
+  }
+
+  bool DCSR_Matrix::is_dcsr(char const * all_data_){
+    return ((int64_t const*)all_data_)[5] == 1;
+  }
+
+  int64_t DCSR_Matrix::nnz() const {
+    return ((int64_t*)all_data)[0];
+  }
+
+  int DCSR_Matrix::val_size() const {
+    return ((int64_t*)all_data)[1];
+  }
+
+  int64_t DCSR_Matrix::nnzr() const {
+    return ((int64_t*)all_data)[2];
+  }
+
+  int DCSR_Matrix::ncol() const {
+    return ((int64_t*)all_data)[3];
+  }
+
+  int DCSR_Matrix::idx_width() const {
+    return ((int64_t*)all_data)[4];
+  }
+
+  int DCSR_Matrix::nrow() const {
+    return ((int64_t*)all_data)[6];
+  }
+
+  int64_t DCSR_Matrix::size() const {
+    return get_dcsr_size(nnz(), nnzr(), val_size(), idx_width());
+  }
+
+  char * DCSR_Matrix::vals() const {
+    return compressed().vals();
+  }
+
+  char * DCSR_Matrix::rows_raw() const {
+    return all_data + get_csr_size(nnz(), nnzr(), val_size(), idx_width());
+  }
+
+  CSR_Matrix DCSR_Matrix::compressed() const {
+    return CSR_Matrix(all_data);
+  }
+
+  CSR_Matrix DCSR_Matrix::to_csr() const {
+    return expand_rows(compressed(), rows_raw(), idx_width(), nrow());
+  }
+
+  CSR_Matrix DCSR_Matrix::expand_rows(CSR_Matrix const & cm, char const * rows, int rows_width, int nrow_){
+    int64_t nz = cm.nnz();
+    int64_t nr = cm.nrow();
+    int v_sz = cm.val_size();
+    int w = cm.idx_width();
+    CSR_Matrix out(nz, nrow_, cm.ncol(), v_sz, w);
+    memcpy(out.vals(), cm.vals(), nz*v_sz);
+    memcpy(out.JA_raw(), cm.JA_raw(), nz*w);
+    char const * cia = cm.IA_raw();
+    char * ia = out.IA_raw();
+    int64_t r = 0;
+    for (int64_t i=0; i<nrow_; i++){
+      set_sp_idx(ia, w, i, get_sp_idx(cia, w, r));
+      if (r < nr && get_sp_idx(rows, rows_width, r) == i+1) r++;
+    }
+    set_sp_idx(ia, w, nrow_, nz+1);
+    return out;
+  }
+
+  /**
+   * \brief sets C = beta*C for a dense buffer of n elements, unless beta is the multiplicative identity
+   */
+  static void scale_dense(char const * beta, char * C, int64_t n, algstrct const * sr_C){
+    if (beta == NULL || sr_C->isequal(beta, sr_C->mulid())) return;
+    if (sr_C->isequal(beta, sr_C->addid()))
+      sr_C->set(C, sr_C->addid(), n);
+    else
+      sr_C->scal(n, beta, C, 1);
+  }
+
+  /**
+   * \brief copies the given rows of a dense column-major m-by-n matrix C into a newly allocated nr-by-n matrix
+   */
+  static char * gather_rows(char const * C, int m, int n, char const * rows, int w, int64_t nr, int el_size){
+    char * Cc = (char*)alloc(nr*n*el_size);
+#ifdef USE_OMP
+    #pragma omp parallel for
+#endif
+    for (int j=0; j<n; j++){
+      for (int64_t r=0; r<nr; r++){
+        memcpy(Cc+(j*nr+r)*el_size, C+(j*(int64_t)m+get_sp_idx(rows, w, r)-1)*el_size, el_size);
+      }
+    }
+    return Cc;
+  }
+
+  /**
+   * \brief copies the nr-by-n matrix Cc back into the given rows of the dense column-major m-by-n matrix C and deallocates Cc
+   */
+  static void scatter_rows(char * Cc, int m, int n, char const * rows, int w, int64_t nr, int el_size, char * C){
+#ifdef USE_OMP
+    #pragma omp parallel for
+#endif
+    for (int j=0; j<n; j++){
+      for (int64_t r=0; r<nr; r++){
+        memcpy(C+(j*(int64_t)m+get_sp_idx(rows, w, r)-1)*el_size, Cc+(j*nr+r)*el_size, el_size);
+      }
+    }
+    cdealloc(Cc);
+  }
+
+  void DCSR_Matrix::csrmm(char const * A, algstrct const * sr_A, int m, int n, int k, char const * alpha, char const * B, algstrct const * sr_B, char const * beta, char * C, algstrct const * sr_C, bivar_function const * func, bool do_offload){
+    TAU_FSTART(dcsrmm);
+    DCSR_Matrix dA((char*)A);
+    int64_t nr = dA.nnzr();
+    int w = dA.idx_width();
+    char const * rows = dA.rows_raw();
+    // rows of C with no nonzeros in A are only scaled by beta
+    scale_dense(beta, C, ((int64_t)m)*n, sr_C);
+    if (nr > 0){
+      char * Cc = gather_rows(C, m, n, rows, w, nr, sr_C->el_size);
+      CSR_Matrix::csrmm(dA.compressed(), sr_A, nr, n, k, alpha, B, sr_B, sr_C->mulid(), Cc, sr_C, func, do_offload);
+      scatter_rows(Cc, m, n, rows, w, nr, sr_C->el_size, C);
+    }
+    TAU_FSTOP(dcsrmm);
+  }
+
+  void DCSR_Matrix::csrmultd(char const * A, algstrct const * sr_A, int m, int n, int k, char const * alpha, char const * B, algstrct const * sr_B, char const * beta, char * C, algstrct const * sr_C, bivar_function const * func, bool do_offload){
+    TAU_FSTART(dcsrmultd);
+    // rows of B are indexed by the column indices of A, so B is used with all k rows
+    CSR_Matrix cB = is_dcsr(B) ? DCSR_Matrix((char*)B).to_csr() : CSR_Matrix((char*)B);
+    if (!is_dcsr(A)){
+      CSR_Matrix::csrmultd(CSR_Matrix((char*)A), sr_A, m, n, k, alpha, cB, sr_B, beta, C, sr_C, func, do_offload);
+    } else {
+      DCSR_Matrix dA((char*)A);
+      int64_t nr = dA.nnzr();
+      int w = dA.idx_width();
+      char const * rows = dA.rows_raw();
+      scale_dense(beta, C, ((int64_t)m)*n, sr_C);
+      if (nr > 0){
+        char * Cc = gather_rows(C, m, n, rows, w, nr, sr_C->el_size);
+        CSR_Matrix::csrmultd(dA.compressed(), sr_A, nr, n, k, alpha, cB, sr_B, sr_C->mulid(), Cc, sr_C, func, do_offload);
+        scatter_rows(Cc, m, n, rows, w, nr, sr_C->el_size, C);
+      }
+    }
+    if (cB.all_data != B) cdealloc(cB.all_data);
+    TAU_FSTOP(dcsrmultd);
+  }
+
+  void DCSR_Matrix::csrmultcsr(char const * A, algstrct const * sr_A, int m, int n, int k, char const * alpha, char const * B, algstrct const * sr_B, char const * beta, char *& C, algstrct const * sr_C, bivar_function const * func, bool do_offload){
+    TAU_FSTART(dcsrmultcsr);
+    CSR_Matrix cB = is_dcsr(B) ? DCSR_Matrix((char*)B).to_csr() : CSR_Matrix((char*)B);
+    if (!is_dcsr(A)){
+      CSR_Matrix::csrmultcsr(CSR_Matrix((char*)A), sr_A, m, n, k, alpha, cB, sr_B, beta, C, sr_C, func, do_offload);
+    } else {
+      DCSR_Matrix dA((char*)A);
+      // multiply the nonempty rows of A into a compressed product, then give it the rows of C
+      char * Cc = NULL;
+      CSR_Matrix::csrmultcsr(dA.compressed(), sr_A, dA.nnzr(), n, k, alpha, cB, sr_B, sr_C->mulid(), Cc, sr_C, func, do_offload);
+      CSR_Matrix X = expand_rows(CSR_Matrix(Cc), dA.rows_raw(), dA.idx_width(), m);
+      cdealloc(Cc);
+      CSR_Matrix C_in(C);
+      if (C == NULL || C_in.nnz() == 0 || sr_C->isequal(beta, sr_C->addid())){
+        C = X.all_data;
+      } else {
+        if (!sr_C->isequal(beta, sr_C->mulid()))
+          sr_C->scal(C_in.nnz(), beta, C_in.vals(), 1);
+        C = sr_C->csr_add(C, X.all_data);
+        cdealloc(X.all_data);
+      }
+    }
+    if (cB.all_data != B) cdealloc(cB.all_data);
+    TAU_FSTOP(dcsrmultcsr);
+  }
+}
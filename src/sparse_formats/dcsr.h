@@ -0,0 +1,107 @@
+#ifndef __DCSR_H__
+#define __DCSR_H__
+
+#include "csr.h"
+
+namespace CTF_int {
+
+  /**
+   * \brief computes the size of a serialized DCSR matrix
+   * \param[in] nnz number of nonzeros in matrix
+   * \param[in] nnzr number of nonempty rows in matrix
+   * \param[in] val_size size of each matrix entry
+   * \param[in] idx_width size of each row offset, column index, and row index
+   */
+  int64_t get_dcsr_size(int64_t nnz, int64_t nnzr, int val_size, int idx_width);
+
+  /**
+   * \brief whether a block of nnz nonzeros with nrow rows should be stored in DCSR rather than CSR layout,
+   *        i.e. whether nnz < CTF::SP_DCSR_MAX_NNZ_PER_ROW*nrow
+   */
+  bool use_dcsr(int64_t nnz, int nrow);
+
+  /**
+   * \brief abstraction for a serialized hypersparse matrix stored in doubly-compressed-sparse-row (DCSR) layout,
+   *        which keeps row offsets only for the nnzr() nonempty rows, along with a list of their (1-based) row indices.
+   *        The buffer begins with a CSR_Matrix of nnzr() rows (the compressed matrix) and carries a flag in its header,
+   *        so the CSR_Matrix kernels recognize DCSR operands and work on their compressed rows.
+   */
+  class DCSR_Matrix{
+    public:
+      /** \brief serialized buffer containing all info, index, and values related to matrix */
+      char * all_data;
+
+      /** \brief constructor allocates all_data */
+      DCSR_Matrix(int64_t nnz, int64_t nnzr, int nrow, int ncol, int el_size, int idx_width);
+
+      /** \brief constructor given serialized DCSR matrix */
+      DCSR_Matrix(char * all_data);
+
+      DCSR_Matrix(){ all_data=NULL; }
+
+      /** \brief constructor given coordinate format (COO) matrix, allocates all_data */
+      DCSR_Matrix(COO_Matrix const & coom, int nrow, int ncol);
+
+      /** \brief whether the serialized sparse matrix all_data (in CSR or DCSR layout) is a DCSR matrix */
+      static bool is_dcsr(char const * all_data);
+
+      /** \brief retrieves number of nonzeros out of all_data */
+      int64_t nnz() const;
+
+      /** \brief retrieves buffer size out of all_data */
+      int64_t size() const;
+
+      /** \brief retrieves number of rows (including empty ones) out of all_data */
+      int nrow() const;
+
+      /** \brief retrieves number of nonempty rows out of all_data */
+      int64_t nnzr() const;
+
+      /** \brief retrieves number of columns out of all_data */
+      int ncol() const;
+
+      /** \brief retrieves matrix entry size out of all_data */
+      int val_size() const;
+
+      /** \brief retrieves size of each row offset, column index, and row index out of all_data */
+      int idx_width() const;
+
+      /** \brief retrieves array of values out of all_data */
+      char * vals() const;
+
+      /** \brief retrieves sorted 1-based indices of the nnzr() nonempty rows, with entries of idx_width() bytes */
+      char * rows_raw() const;
+
+      /** \brief returns the compressed nnzr()-by-ncol() CSR matrix, which shares all_data */
+      CSR_Matrix compressed() const;
+
+      /** \brief returns a newly allocated CSR matrix with all nrow() rows */
+      CSR_Matrix to_csr() const;
+
+      /**
+       * \brief expands the rows of a CSR matrix into a newly allocated CSR matrix with more rows
+       * \param[in] cm matrix whose row i becomes row rows[i]-1 of the output
+       * \param[in] rows sorted 1-based row indices of width rows_width
+       * \param[in] rows_width size of each entry of rows
+       * \param[in] nrow number of rows of the output
+       */
+      static CSR_Matrix expand_rows(CSR_Matrix const & cm, char const * rows, int rows_width, int nrow);
+
+      /**
+       * \brief computes C = beta*C + func(alpha*A*B) where A is a DCSR_Matrix, while B and C are dense
+       */
+      static void csrmm(char const * A, algstrct const * sr_A, int m, int n, int k, char const * alpha, char const * B, algstrct const * sr_B, char const * beta, char * C, algstrct const * sr_C, bivar_function const * func, bool do_offload);
+
+      /**
+       * \brief computes C = beta*C + func(alpha*A*B) where A and B are CSR or DCSR matrices with at least one DCSR, while C is dense
+       */
+      static void csrmultd(char const * A, algstrct const * sr_A, int m, int n, int k, char const * alpha, char const * B, algstrct const * sr_B, char const * beta, char * C, algstrct const * sr_C, bivar_function const * func, bool do_offload);
+
+      /**
+       * \brief computes C = beta*C + func(alpha*A*B) where A and B are CSR or DCSR matrices with at least one DCSR, while C is a CSR matrix
+       */
+      static void csrmultcsr(char const * A, algstrct const * sr_A, int m, int n, int k, char const * alpha, char const * B, algstrct const * sr_B, char const * beta, char *& C, algstrct const * sr_C, bivar_function const * func, bool do_offload);
+  };
+}
+
+#endif
@@ -0,0 +1,495 @@
+#ifndef __SPGEMM_H__
+#define __SPGEMM_H__
+
+#include "csr.h"
+
+namespace CTF_int {
+  /** \brief rows whose product has at least n/SPGEMM_DENSE_RATIO flops use a dense accumulator of length n */
+  #define SPGEMM_DENSE_RATIO 4
+  /** \brief rows of A with at most this many nonzeros that do not use a dense accumulator merge rows of B with a heap */
+  #define SPGEMM_HEAP_MAX_NNZ 8
+
+  enum SPGEMM_ACC { SPGEMM_ACC_NONE, SPGEMM_ACC_COPY, SPGEMM_ACC_DENSE, SPGEMM_ACC_HASH, SPGEMM_ACC_HEAP };
+
+  /**
+   * \brief chooses the accumulator for a row of C=A*B
+   * \param[in] n number of columns of C
+   * \param[in] nnz_row_A number of nonzeros in the row of A
+   * \param[in] flops upper bound on the number of nonzeros in the row of C (products formed)
+   */
+  inline SPGEMM_ACC get_spgemm_acc(int64_t n, int64_t nnz_row_A, int64_t flops){
+    if (flops == 0) return SPGEMM_ACC_NONE;
+    if (nnz_row_A == 1) return SPGEMM_ACC_COPY;
+    if (flops*SPGEMM_DENSE_RATIO >= n) return SPGEMM_ACC_DENSE;
+    if (nnz_row_A <= SPGEMM_HEAP_MAX_NNZ) return SPGEMM_ACC_HEAP;
+    return SPGEMM_ACC_HASH;
+  }
+
+  /**
+   * \brief per-thread accumulators of the row-wise sparse matrix product, buffers are allocated
+   *        when first needed and sized by the rows that use them, so no O(n) work is done per row
+   */
+  template <typename dtype_C>
+  class SpGEMM_Workspace {
+    public:
+      int64_t n;
+      // dense accumulator, reset through the list of touched columns
+      char *    dense_flag;
+      dtype_C * dense_vals;
+      int64_t * touched;
+      int64_t   touched_sz;
+      // open addressing hash table keyed by column
+      int64_t * hash_keys;
+      dtype_C * hash_vals;
+      int64_t   hash_sz;
+      // heap of cursors into rows of B
+      int64_t * heap;
+      int64_t   heap_sz;
+
+      SpGEMM_Workspace(int64_t n_){
+        n = n_;
+        dense_flag = NULL;
+        dense_vals = NULL;
+        touched = NULL;
+        touched_sz = 0;
+        hash_keys = NULL;
+        hash_vals = NULL;
+        hash_sz = 0;
+        heap = NULL;
+        heap_sz = 0;
+      }
+
+      ~SpGEMM_Workspace(){
+        if (dense_flag != NULL) cdealloc(dense_flag);
+        if (dense_vals != NULL) cdealloc(dense_vals);
+        if (touched != NULL) cdealloc(touched);
+        if (hash_keys != NULL) cdealloc(hash_keys);
+        if (hash_vals != NULL) cdealloc(hash_vals);
+        if (heap != NULL) cdealloc(heap);
+      }
+
+      void reserve_dense(){
+        if (dense_flag == NULL){
+          dense_flag = (char*)alloc(n);
+          memset(dense_flag, 0, n);
+          dense_vals = (dtype_C*)alloc(sizeof(dtype_C)*n);
+        }
+      }
+
+      void reserve_touched(int64_t sz){
+        if (touched_sz < sz){
+          if (touched != NULL) cdealloc(touched);
+          touched_sz = std::max(sz, 2*touched_sz);
+          touched = (int64_t*)alloc(sizeof(int64_t)*touched_sz);
+        }
+      }
+
+      /** \brief clears and returns mask of a hash table with at least 2*flops slots */
+      int64_t reserve_hash(int64_t flops){
+        int64_t sz = 16;
+        while (sz < 2*flops) sz *= 2;
+        if (hash_sz < sz){
+          if (hash_keys != NULL){
+            cdealloc(hash_keys);
+            cdealloc(hash_vals);
+          }
+          hash_sz = sz;
+          hash_keys = (int64_t*)alloc(sizeof(int64_t)*hash_sz);
+          hash_vals = (dtype_C*)alloc(sizeof(dtype_C)*hash_sz);
+        }
+        std::fill(hash_keys, hash_keys+sz, (int64_t)-1);
+        return sz-1;
+      }
+
+      void reserve_heap(int64_t sz){
+        if (heap_sz < sz){
+          if (heap != NULL) cdealloc(heap);
+          heap_sz = std::max(sz, 2*heap_sz);
+          heap = (int64_t*)alloc(sizeof(int64_t)*4*heap_sz);
+        }
+      }
+  };
+
+  /**
+   * \brief computes a row of C=A*B (1-based CSR indices) with the accumulator acc, if cols_C is NULL
+   *        only the number of distinct columns is computed (symbolic pass), otherwise the sorted
+   *        columns are written to cols_C and, unless vals_C is NULL (pattern-only C), the values to vals_C
+   * \param[in] i row of A and C
+   * \param[in] n number of columns of C
+   * \param[in] acc accumulator to use (given by get_spgemm_acc)
+   * \param[in] flops number of products in the row
+   * \param[in] JA column indices of A
+   * \param[in] IA row offsets of A
+   * \param[in] JB column indices of B
+   * \param[in] IB row offsets of B
+   * \param[in] fprod fprod(idx_A,idx_B) returns the product of the given nonzeros of A and B
+   * \param[in] facc facc(c,v) accumulates v into c
+   * \param[in,out] ws workspace of this thread
+   * \param[in] width width of column indices of C
+   * \param[out] cols_C column indices of the row of C
+   * \param[out] vals_C values of the row of C, or NULL if C has no values
+   * \return number of nonzeros in the row of C
+   */
+  template <typename dtype_C, typename idx_t, typename fprod_t, typename facc_t>
+  int64_t spgemm_row(int64_t                     i,
+                     int64_t                     n,
+                     SPGEMM_ACC                  acc,
+                     int64_t                     flops,
+                     idx_t const *               JA,
+                     idx_t const *               IA,
+                     idx_t const *               JB,
+                     idx_t const *               IB,
+                     fprod_t &                   fprod,
+                     facc_t &                    facc,
+                     SpGEMM_Workspace<dtype_C> & ws,
+                     int                         width,
+                     char *                      cols_C,
+                     dtype_C *                   vals_C){
+    bool is_num = cols_C != NULL;
+    bool has_vals = vals_C != NULL;
+    int64_t nnz = 0;
+    switch (acc){
+      case SPGEMM_ACC_NONE:
+        return 0;
+      case SPGEMM_ACC_COPY: {
+        int64_t ia = IA[i]-1;
+        int64_t rb = JA[ia]-1;
+        nnz = IB[rb+1]-IB[rb];
+        if (is_num){
+          for (int64_t l=0; l<nnz; l++){
+            int64_t ib = IB[rb]-1+l;
+            set_sp_idx(cols_C, width, l, JB[ib]);
+            if (has_vals) vals_C[l] = fprod(ia, ib);
+          }
+        }
+        return nnz;
+      }
+      case SPGEMM_ACC_DENSE: {
+        ws.reserve_dense();
+        ws.reserve_touched(std::min(flops, n));
+        for (int64_t ia=IA[i]-1; ia<IA[i+1]-1; ia++){
+          int64_t rb = JA[ia]-1;
+          for (int64_t ib=IB[rb]-1; ib<IB[rb+1]-1; ib++){
+            int64_t c = JB[ib]-1;
+            if (!ws.dense_flag[c]){
+              ws.dense_flag[c] = 1;
+              ws.touched[nnz++] = c;
+              if (has_vals) ws.dense_vals[c] = fprod(ia, ib);
+            } else if (has_vals){
+              facc(ws.dense_vals[c], fprod(ia, ib));
+            }
+          }
+        }
+        if (is_num){
+          if (nnz*SPGEMM_DENSE_RATIO*4 < n){
+            std::sort(ws.touched, ws.touched+nnz);
+            for (int64_t l=0; l<nnz; l++){
+              int64_t c = ws.touched[l];
+              set_sp_idx(cols_C, width, l, c+1);
+              if (has_vals) vals_C[l] = ws.dense_vals[c];
+              ws.dense_flag[c] = 0;
+            }
+          } else {
+            int64_t l = 0;
+            for (int64_t c=0; c<n; c++){
+              if (ws.dense_flag[c]){
+                set_sp_idx(cols_C, width, l, c+1);
+                if (has_vals) vals_C[l] = ws.dense_vals[c];
+                ws.dense_flag[c] = 0;
+                l++;
+              }
+            }
+          }
+        } else {
+          for (int64_t l=0; l<nnz; l++){
+            ws.dense_flag[ws.touched[l]] = 0;
+          }
+        }
+        return nnz;
+      }
+      case SPGEMM_ACC_HASH: {
+        int64_t mask = ws.reserve_hash(flops);
+        for (int64_t ia=IA[i]-1; ia<IA[i+1]-1; ia++){
+          int64_t rb = JA[ia]-1;
+          for (int64_t ib=IB[rb]-1; ib<IB[rb+1]-1; ib++){
+            int64_t c = JB[ib]-1;
+            int64_t h = (c*(int64_t)2654435761) & mask;
+            while (ws.hash_keys[h] != -1 && ws.hash_keys[h] != c) h = (h+1) & mask;
+            if (ws.hash_keys[h] == -1){
+              ws.hash_keys[h] = c;
+              nnz++;
+              if (has_vals) ws.hash_vals[h] = fprod(ia, ib);
+            } else if (has_vals){
+              facc(ws.hash_vals[h], fprod(ia, ib));
+            }
+          }
+        }
+        if (is_num){
+          // gather occupied slots and sort them by column
+          ws.reserve_touched(nnz);
+          int64_t * slots = ws.touched;
+          int64_t l = 0;
+          for (int64_t h=0; h<=mask; h++){
+            if (ws.hash_keys[h] != -1) slots[l++] = h;
+          }
+          int64_t const * hkeys = ws.hash_keys;
+          std::sort(slots, slots+nnz, [hkeys](int64_t a, int64_t b){ return hkeys[a] < hkeys[b]; });
+          for (l=0; l<nnz; l++){
+            set_sp_idx(cols_C, width, l, ws.hash_keys[slots[l]]+1);
+            if (has_vals) vals_C[l] = ws.hash_vals[slots[l]];
+          }
+        }
+        return nnz;
+      }
+      case SPGEMM_ACC_HEAP: {
+        // each heap entry is (column, position in B, end of row in B, position in A)
+        ws.reserve_heap(IA[i+1]-IA[i]);
+        int64_t (*hp)[4] = (int64_t(*)[4])ws.heap;
+        int64_t nh = 0;
+        auto greater_col = [](int64_t const * a, int64_t const * b){ return a[0] > b[0]; };
+        for (int64_t ia=IA[i]-1; ia<IA[i+1]-1; ia++){
+          int64_t rb = JA[ia]-1;
+          if (IB[rb+1] > IB[rb]){
+            hp[nh][0] = JB[IB[rb]-1];
+            hp[nh][1] = IB[rb]-1;
+            hp[nh][2] = IB[rb+1]-1;
+            hp[nh][3] = ia;
+            nh++;
+          }
+        }
+        // binary min-heap on column, sifted by hand on the row-of-four layout
+        auto sift_down = [&](int64_t p){
+          for (;;){
+            int64_t s = p, lc = 2*p+1, rc = 2*p+2;
+            if (lc < nh && greater_col(hp[s], hp[lc])) s = lc;
+            if (rc < nh && greater_col(hp[s], hp[rc])) s = rc;
+            if (s == p) break;
+            for (int q=0; q<4; q++) std::swap(hp[p][q], hp[s][q]);
+            p = s;
+          }
+        };
+        for (int64_t p=nh/2-1; p>=0; p--) sift_down(p);
+        int64_t last_col = -1;
+        while (nh > 0){
+          int64_t c = hp[0][0];
+          int64_t ib = hp[0][1];
+          int64_t ia = hp[0][3];
+          if (c != last_col){
+            if (is_num) set_sp_idx(cols_C, width, nnz, c);
+            if (has_vals) vals_C[nnz] = fprod(ia, ib);
+            nnz++;
+            last_col = c;
+          } else if (has_vals){
+            facc(vals_C[nnz-1], fprod(ia, ib));
+          }
+          hp[0][1]++;
+          if (hp[0][1] < hp[0][2]){
+            hp[0][0] = JB[hp[0][1]];
+          } else {
+            nh--;
+            for (int q=0; q<4; q++) hp[0][q] = hp[nh][q];
+          }
+          sift_down(0);
+        }
+        return nnz;
+      }
+    }
+    return nnz;
+  }
+
+  /**
+   * \brief row-wise sparse matrix product C=A*B of 1-based CSR matrices, each row of C is formed by a dense,
+   *        hash, or heap accumulator chosen from an upper bound on its number of nonzeros (the number of
+   *        products), a symbolic pass sizes C exactly before the numeric pass fills it
+   * \param[in] m number of rows of A and C
+   * \param[in] n number of columns of B and C
+   * \param[in] JA column indices of A
+   * \param[in] IA row offsets of A
+   * \param[in] JB column indices of B
+   * \param[in] IB row offsets of B
+   * \param[in] fprod fprod(idx_A,idx_B) returns the product of the given nonzeros of A and B
+   * \param[in] facc facc(c,v) accumulates v into c
+   * \param[in] is_pattern if true, C gets no values (only its nonzero pattern is computed) and fprod and facc are not called
+   * \return serialized CSR_Matrix C, with index width given by its number of nonzeros
+   */
+  template <typename dtype_C, typename idx_t, typename fprod_t, typename facc_t>
+  char * spgemm(int64_t       m,
+                int64_t       n,
+                idx_t const * JA,
+                idx_t const * IA,
+                idx_t const * JB,
+                idx_t const * IB,
+                fprod_t       fprod,
+                facc_t        facc,
+                bool          is_pattern=false){
+    int64_t * IC = (int64_t*)alloc(sizeof(int64_t)*(m+1));
+    int64_t * row_flops = (int64_t*)alloc(sizeof(int64_t)*(m+1));
+    char * row_acc = (char*)alloc(sizeof(char)*(m+1));
+    IC[0] = 0;
+#ifdef _OPENMP
+    #pragma omp parallel
+#endif
+    {
+      SpGEMM_Workspace<dtype_C> ws(n);
+#ifdef _OPENMP
+      #pragma omp for schedule(dynamic,64)
+#endif
+      for (int64_t i=0; i<m; i++){
+        int64_t flops = 0;
+        for (int64_t ia=IA[i]-1; ia<IA[i+1]-1; ia++){
+          int64_t rb = JA[ia]-1;
+          flops += IB[rb+1]-IB[rb];
+        }
+        row_flops[i] = flops;
+        SPGEMM_ACC acc = get_spgemm_acc(n, IA[i+1]-IA[i], flops);
+        row_acc[i] = (char)acc;
+        IC[i+1] = spgemm_row<dtype_C>(i, n, acc, flops, JA, IA, JB, IB, fprod, facc, ws, 0, NULL, (dtype_C*)NULL);
+      }
+    }
+    for (int64_t i=0; i<m; i++){
+      IC[i+1] += IC[i];
+    }
+    int64_t nnz_C = IC[m];
+    int width = get_csr_idx_width(nnz_C, n);
+    CSR_Matrix C(nnz_C, m, n, is_pattern ? 0 : sizeof(dtype_C), width);
+    dtype_C * vC = is_pattern ? NULL : (dtype_C*)C.vals();
+    char * JC = C.JA_raw();
+    for (int64_t i=0; i<=m; i++){
+      set_sp_idx(C.IA_raw(), width, i, IC[i]+1);
+    }
+#ifdef _OPENMP
+    #pragma omp parallel
+#endif
+    {
+      SpGEMM_Workspace<dtype_C> ws(n);
+#ifdef _OPENMP
+      #pragma omp for schedule(dynamic,64)
+#endif
+      for (int64_t i=0; i<m; i++){
+        spgemm_row<dtype_C>(i, n, (SPGEMM_ACC)row_acc[i], row_flops[i], JA, IA, JB, IB, fprod, facc, ws, width, JC+IC[i]*width, is_pattern ? NULL : vC+IC[i]);
+      }
+    }
+    cdealloc(row_acc);
+    cdealloc(row_flops);
+    cdealloc(IC);
+    return C.all_data;
+  }
+
+  /**
+   * \brief nonzero pattern of the product C=A*B of 1-based CSR matrices (see spgemm()), no values are read or formed
+   * \return serialized CSR_Matrix C with no values
+   */
+  template <typename idx_t>
+  char * spgemm_pattern(int64_t       m,
+                        int64_t       n,
+                        idx_t const * JA,
+                        idx_t const * IA,
+                        idx_t const * JB,
+                        idx_t const * IB){
+    return spgemm<char>(m, n, JA, IA, JB, IB, [](int64_t ia, int64_t ib){ return (char)0; }, [](char & c, char const & v){}, true);
+  }
+
+  /**
+   * \brief spgemm_pattern() for serialized CSR matrices A and B with indices of the same width
+   */
+  inline char * spgemm_pattern(int64_t            m,
+                               int64_t            n,
+                               CSR_Matrix const & A,
+                               CSR_Matrix const & B){
+    assert(A.idx_width() == B.idx_width());
+    switch (A.idx_width()){
+      case 2:
+        return spgemm_pattern(m, n, (int16_t const*)A.JA_raw(), (int16_t const*)A.IA_raw(), (int16_t const*)B.JA_raw(), (int16_t const*)B.IA_raw());
+      case 4:
+        return spgemm_pattern(m, n, (int32_t const*)A.JA_raw(), (int32_t const*)A.IA_raw(), (int32_t const*)B.JA_raw(), (int32_t const*)B.IA_raw());
+      default:
+        return spgemm_pattern(m, n, (int64_t const*)A.JA_raw(), (int64_t const*)A.IA_raw(), (int64_t const*)B.JA_raw(), (int64_t const*)B.IA_raw());
+    }
+  }
+
+  /**
+   * \brief masked sparse matrix product of 1-based CSR matrices, accumulates the products A[i,k]*B[k,j] into the
+   *        nonzeros (i,j) already present in C, products that do not fall on a nonzero of C are not formed and
+   *        rows of C without nonzeros are skipped, so the pattern of C (the mask) is unchanged
+   * \param[in] m number of rows of A and C
+   * \param[in] n number of columns of B and C
+   * \param[in] JA column indices of A
+   * \param[in] IA row offsets of A
+   * \param[in] JB column indices of B
+   * \param[in] IB row offsets of B
+   * \param[in] C m-by-n CSR matrix whose nonzeros are accumulated to
+   * \param[in] fupd fupd(idx_C,idx_A,idx_B) accumulates the product of the given nonzeros of A and B into the given nonzero of C
+   */
+  template <typename idx_t, typename fupd_t>
+  void masked_spgemm(int64_t            m,
+                     int64_t            n,
+                     idx_t const *      JA,
+                     idx_t const *      IA,
+                     idx_t const *      JB,
+                     idx_t const *      IB,
+                     CSR_Matrix const & C,
+                     fupd_t             fupd){
+    int w = C.idx_width();
+    char const * IC = C.IA_raw();
+    char const * JC = C.JA_raw();
+#ifdef _OPENMP
+    #pragma omp parallel
+#endif
+    {
+      // position of each column in the current row of C, -1 for columns outside of the mask
+      int64_t * pos = NULL;
+#ifdef _OPENMP
+      #pragma omp for schedule(dynamic,64)
+#endif
+      for (int64_t i=0; i<m; i++){
+        int64_t st_C = get_sp_idx(IC, w, i)-1;
+        int64_t end_C = get_sp_idx(IC, w, i+1)-1;
+        if (st_C == end_C || IA[i] == IA[i+1]) continue;
+        if (pos == NULL){
+          pos = (int64_t*)alloc(sizeof(int64_t)*n);
+          std::fill(pos, pos+n, (int64_t)-1);
+        }
+        for (int64_t ic=st_C; ic<end_C; ic++){
+          pos[get_sp_idx(JC, w, ic)-1] = ic;
+        }
+        for (int64_t ia=IA[i]-1; ia<IA[i+1]-1; ia++){
+          int64_t rb = JA[ia]-1;
+          for (int64_t ib=IB[rb]-1; ib<IB[rb+1]-1; ib++){
+            int64_t ic = pos[JB[ib]-1];
+            if (ic >= 0) fupd(ic, ia, ib);
+          }
+        }
+        for (int64_t ic=st_C; ic<end_C; ic++){
+          pos[get_sp_idx(JC, w, ic)-1] = -1;
+        }
+      }
+      if (pos != NULL) cdealloc(pos);
+    }
+  }
+
+  /**
+   * \brief masked_spgemm() for serialized CSR matrices A and B with indices of the same width
+   */
+  template <typename fupd_t>
+  void masked_spgemm(int64_t            m,
+                     int64_t            n,
+                     CSR_Matrix const & A,
+                     CSR_Matrix const & B,
+                     CSR_Matrix const & C,
+                     fupd_t             fupd){
+    assert(A.idx_width() == B.idx_width());
+    switch (A.idx_width()){
+      case 2:
+        masked_spgemm(m, n, (int16_t const*)A.JA_raw(), (int16_t const*)A.IA_raw(), (int16_t const*)B.JA_raw(), (int16_t const*)B.IA_raw(), C, fupd);
+        break;
+      case 4:
+        masked_spgemm(m, n, (int32_t const*)A.JA_raw(), (int32_t const*)A.IA_raw(), (int32_t const*)B.JA_raw(), (int32_t const*)B.IA_raw(), C, fupd);
+        break;
+      default:
+        masked_spgemm(m, n, (int64_t const*)A.JA_raw(), (int64_t const*)A.IA_raw(), (int64_t const*)B.JA_raw(), (int64_t const*)B.IA_raw(), C, fupd);
+        break;
+    }
+  }
+}
+
+#endif
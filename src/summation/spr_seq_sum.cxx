@@ -47,18 +47,23 @@ namespace CTF_int{
     int imax = edge_len_B[0];
     if (sym_B[0] != NS) imax = (idx_B/lda_B[0+1])%edge_len_B[0+1];
 
+    bool is_alpha = !(alpha == NULL || sr_A->isequal(alpha, sr_A->mulid()));
+    if (func == NULL && !is_alpha){
+      int64_t nacc = sr_B->pairs_sum(size_A, A.ptr, idx_B, imax, B);
+      A.ptr += nacc*sr_A->pair_size();
+      size_A -= nacc;
+      B += imax*sr_B->el_size;
+      return;
+    }
+
     for (int i=0; i<imax; i++){
       while (size_A > 0 && idx_B == A.k()){
         if (func == NULL){
-          if (sr_A->isequal(alpha, sr_A->mulid()) || alpha == NULL){
-            sr_B->add(A.d(), B, B);
-          } else {
-            char tmp[sr_A->el_size];
-            sr_A->mul(A.d(), alpha, tmp);
-            sr_B->add(tmp, B, B);
-          }
+          char tmp[sr_A->el_size];
+          sr_A->mul(A.d(), alpha, tmp);
+          sr_B->add(tmp, B, B);
         } else {
-          if (sr_A->isequal(alpha, sr_A->mulid()) || alpha == NULL){
+          if (!is_alpha){
             func->acc_f(A.d(), B, sr_B);
           } else {
             char tmp[sr_A->el_size];
@@ -162,24 +167,6 @@ namespace CTF_int{
     assert(0);
   }
 
-  /**
-   * \brief As pairs in a sparse A set to the 
-   *         sparse set of elements defining the tensor,
-   *         resulting in a set of size between nB and nB+nA
-   * \param[in] sr_A algstrct defining data type of array
-   * \param[in] nA number of elements in sparse tensor
-   * \param[in] prs_A pairs of the sparse tensor
-   * \param[in] beta scaling factor for data of the sparse tensor
-   * \param[in] sr_B algstrct defining data type of array
-   * \param[in] nB number of elements in the A set
-   * \param[in] prs_B pairs of the A set
-   * \param[in] alpha scaling factor for data of the A set
-   * \param[out] nnew number of elements in resulting set
-   * \param[out] pprs_new char array containing the pairs of the resulting set
-   * \param[in] func NULL or pointer to a function to apply elementwise
-   * \param[in] map_pfx how many times each element of A should be replicated
-   */
-
   void spspsum(algstrct const *        sr_A,
                int64_t                 nA,
                ConstPairIterator       prs_A,
@@ -193,7 +180,6 @@ namespace CTF_int{
                univar_function const * func,
                int64_t                 map_pfx){
 
-    TAU_FSTART(spA_spB_seq_sum);
     // determine how many unique keys there are in prs_tsr and prs_Write
     nnew = nB;
     bool is_acc = (func != NULL && func->is_accumulator());
@@ -320,7 +306,6 @@ namespace CTF_int{
       }*/
     }
     ASSERT(n==nnew);
-    TAU_FSTOP(spA_spB_seq_sum);
   }
 
 
@@ -341,9 +326,15 @@ namespace CTF_int{
         printf("scaling B by 0\n");
         sr_B->scal(size_B, beta, B, 1);
       }*/
-      spspsum(sr_A, size_A, ConstPairIterator(sr_A, A), beta,
-              sr_B, size_B, ConstPairIterator(sr_B, B),alpha,
-              new_size_B, new_B, func, map_pfx);
+      TAU_FSTART(spA_spB_seq_sum);
+      if (func == NULL && (alpha == NULL || sr_A->isequal(alpha, sr_A->mulid()))){
+        sr_B->pairs_merge_sum(size_A, A, beta, size_B, B, new_size_B, new_B, map_pfx);
+      } else {
+        spspsum(sr_A, size_A, ConstPairIterator(sr_A, A), beta,
+                sr_B, size_B, ConstPairIterator(sr_B, B),alpha,
+                new_size_B, new_B, func, map_pfx);
+      }
+      TAU_FSTOP(spA_spB_seq_sum);
   }
 
 }
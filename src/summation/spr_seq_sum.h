@@ -65,6 +65,36 @@ namespace CTF_int {
                        algstrct const *        sr_B,
                        univar_function const * func);
 
+  /**
+   * \brief As pairs in a sparse A set to the 
+   *         sparse set of elements defining the tensor,
+   *         resulting in a set of size between nB and nB+nA
+   * \param[in] sr_A algstrct defining data type of array
+   * \param[in] nA number of elements in sparse tensor
+   * \param[in] prs_A pairs of the sparse tensor
+   * \param[in] beta scaling factor for data of the sparse tensor
+   * \param[in] sr_B algstrct defining data type of array
+   * \param[in] nB number of elements in the A set
+   * \param[in] prs_B pairs of the A set
+   * \param[in] alpha scaling factor for data of the A set
+   * \param[out] nnew number of elements in resulting set
+   * \param[out] pprs_new char array containing the pairs of the resulting set
+   * \param[in] func NULL or pointer to a function to apply elementwise
+   * \param[in] map_pfx how many times each element of A should be replicated
+   */
+  void spspsum(algstrct const *        sr_A,
+               int64_t                 nA,
+               ConstPairIterator       prs_A,
+               char const *            beta,
+               algstrct const *        sr_B,
+               int64_t                 nB,
+               ConstPairIterator       prs_B,
+               char const *            alpha,
+               int64_t &               nnew,
+               char *&                 pprs_new,
+               univar_function const * func,
+               int64_t                 map_pfx);
+
   /**
    * \brief performs summation between two sparse tensors
    *   assumes A and B contain key value pairs sorted by key,
@@ -123,8 +123,27 @@ namespace CTF_int {
   }
   
   double summation::estimate_time(){
-    assert(0); //FIXME
-    return 0.0;
+    if (A->has_zero_edge_len || B->has_zero_edge_len) return 0.0;
+    double nnz_frac_A = 1.0;
+    double nnz_frac_B = 1.0;
+    if (A->is_sparse) nnz_frac_A = A->calc_nnz_frac();
+    if (B->is_sparse) nnz_frac_B = B->calc_nnz_frac();
+    /* one operand is redistributed unless both are already aligned */
+    bool is_aligned = A->topo == B->topo && A->order == B->order;
+    for (int i=0; i<A->order && is_aligned; i++){
+      if (idx_A[i] != idx_B[i] || !comp_dim_map(&A->edge_map[i], &B->edge_map[i]))
+        is_aligned = false;
+    }
+    double est_time = 0.0;
+    if (!is_aligned){
+      distribution dA(A);
+      est_time += B->est_redist_time(dA, nnz_frac_A);
+    }
+    /* the local sum reads A and reads and writes B */
+    est_time += COST_MEMBW*A->sr->el_size*(A->size*nnz_frac_A + 2.*B->size*nnz_frac_B);
+    double gest_time;
+    MPI_Allreduce(&est_time, &gest_time, 1, MPI_DOUBLE, MPI_MAX, A->wrld->cdt.cm);
+    return gest_time;
   }
 
   void summation::get_fold_indices(int *  num_fold,
@@ -871,8 +890,6 @@ namespace CTF_int {
 
     summation osum = summation(*this);
    
-    CTF_int::contract_mst();
-
     A->unfold();
     B->unfold();
     // FIXME: if custom function, we currently don't know whether its odd, even or neither, so unpack everything
@@ -1031,6 +1048,8 @@ namespace CTF_int {
         }
         B->nnz_loc = tnsr_B->nnz_loc;
         B->nnz_tot = tnsr_B->nnz_tot;
+        B->nnz_loc_max = tnsr_B->nnz_loc_max;
+        B->nnz_imb = tnsr_B->nnz_imb;
       } 
       B->data = tnsr_B->data;
     } else B->unfold();
@@ -2165,7 +2184,7 @@ namespace CTF_int {
           size += A->size*std::max(1.0,log2(wrld->cdt.np));
         } else {
           if (A->is_sparse){
-            double nnz_frac_A = std::min(2,(int)A->calc_npe())*((double)A->nnz_tot)/(A->size*A->calc_npe());
+            double nnz_frac_A = std::min(2,(int)A->calc_npe())*A->calc_nnz_frac();
             size += 25.*nnz_frac_A*A->size*std::max(1.0,log2(wrld->cdt.np));
           } else
             size += 5.*A->size*std::max(1.0,log2(wrld->cdt.np));
@@ -2186,8 +2205,8 @@ namespace CTF_int {
           if (B->is_home)
             pref = 2.0;
           if (B->is_sparse){
-            double nnz_frac_A = std::min(2,(int)A->calc_npe())*((double)A->nnz_tot)/(A->size*A->calc_npe());
-            double nnz_frac_B = std::min(2,(int)B->calc_npe())*((double)B->nnz_tot)/(B->size*B->calc_npe());
+            double nnz_frac_A = std::min(2,(int)A->calc_npe())*A->calc_nnz_frac();
+            double nnz_frac_B = std::min(2,(int)B->calc_npe())*B->calc_nnz_frac();
             nnz_frac_B = std::max(nnz_frac_B, nnz_frac_A);
             size += 25.*pref*nnz_frac_B*B->size*std::max(1.0,log2(wrld->cdt.np));
           } else
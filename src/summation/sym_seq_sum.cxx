@@ -145,12 +145,9 @@ namespace CTF_int {
       imin = std::max(imin,idx[idx_map_B[rB-1]]);
 
     if (func == NULL){
-      if (alpha == NULL){
-        for (int i=imin; i<imax; i++){
-          sr_B->add(A+offsets_A[0][i],
-                    B+offsets_B[0][i], 
-                    B+offsets_B[0][i]);
-        }
+      if (alpha == NULL || sr_A->isequal(alpha, sr_A->mulid())){
+        if (imax > imin)
+          sr_B->offsets_sum(imax-imin, A, offsets_A[0]+imin, B, offsets_B[0]+imin);
         CTF_FLOPS_ADD(imax-imin);
       } else {
         for (int i=imin; i<imax; i++){
@@ -4,6 +4,9 @@
 #include "untyped_tensor.h"
 #include "algstrct.h"
 #include "../sparse_formats/csr.h"
+#include "../sparse_formats/csf.h"
+#include "../sparse_formats/spgemm.h"
+#include "../summation/spr_seq_sum.h"
 
 namespace CTF_int {
   LinModel<3> csrred_mdl(csrred_mdl_init,"csrred_mdl");
@@ -677,7 +680,84 @@ namespace CTF_int {
     printf("CTF ERROR: csrmultcsr not present for this algebraic structure\n");
     ASSERT(0);
   }
-      
+
+  void algstrct::coomm(int m, int n, int k, char const * alpha, COO_Matrix const & A, char const * B, char const * beta, char * C) const {
+    COO_Matrix iA = A.to_idx_width(sizeof(int));
+    this->coomm(m, n, k, alpha, iA.vals(), iA.rows(), iA.cols(), iA.nnz(), B, beta, C, NULL);
+    if (iA.all_data != A.all_data) cdealloc(iA.all_data);
+  }
+
+  void algstrct::csrmm(int m, int n, int k, char const * alpha, CSR_Matrix const & A, char const * B, char const * beta, char * C) const {
+    CSR_Matrix iA = A.to_idx_width(sizeof(int));
+    this->csrmm(m, n, k, alpha, iA.vals(), iA.JA(), iA.IA(), iA.nnz(), B, beta, C, NULL);
+    if (iA.all_data != A.all_data) cdealloc(iA.all_data);
+  }
+
+  void algstrct::csrmultd(int m, int n, int k, char const * alpha, CSR_Matrix const & A, CSR_Matrix const & B, char const * beta, char * C) const {
+    CSR_Matrix iA = A.to_idx_width(sizeof(int));
+    CSR_Matrix iB = B.to_idx_width(sizeof(int));
+    this->csrmultd(m, n, k, alpha, iA.vals(), iA.JA(), iA.IA(), iA.nnz(), iB.vals(), iB.JA(), iB.IA(), iB.nnz(), beta, C);
+    if (iA.all_data != A.all_data) cdealloc(iA.all_data);
+    if (iB.all_data != B.all_data) cdealloc(iB.all_data);
+  }
+
+  void algstrct::csrmultcsr(int m, int n, int k, char const * alpha, CSR_Matrix const & A, CSR_Matrix const & B, char const * beta, char *& C_CSR) const {
+    CSR_Matrix iA = A.to_idx_width(sizeof(int));
+    CSR_Matrix iB = B.to_idx_width(sizeof(int));
+    this->csrmultcsr(m, n, k, alpha, iA.vals(), iA.JA(), iA.IA(), iA.nnz(), iB.vals(), iB.JA(), iB.IA(), iB.nnz(), beta, C_CSR);
+    if (iA.all_data != A.all_data) cdealloc(iA.all_data);
+    if (iB.all_data != B.all_data) cdealloc(iB.all_data);
+  }
+
+  void algstrct::masked_csrmultcsr(int m, int n, int k, char const * alpha, CSR_Matrix const & A, CSR_Matrix const & B, CSR_Matrix const & C) const {
+    char const * vA = A.vals();
+    char const * vB = B.vals();
+    char * vC = C.vals();
+    bool is_alpha = !this->isequal(alpha, this->mulid());
+    masked_spgemm(m, n, A, B, C, [&](int64_t ic, int64_t ia, int64_t ib){
+      char tmp[el_size];
+      this->mul(vA+ia*el_size, vB+ib*el_size, tmp);
+      if (is_alpha) this->mul(alpha, tmp, tmp);
+      this->add(vC+ic*el_size, tmp, vC+ic*el_size);
+    });
+  }
+
+  void algstrct::mttkrp(CSF_Tensor const & T, int R, char const * const * facs, char * out) const {
+    csf_mttkrp(T, R, facs, out, algstrct_mttkrp_ops(this));
+  }
+
+  void algstrct::offsets_ctr(int64_t n, char const * alpha, char const * A, uint64_t const * offsets_A, char const * B, uint64_t const * offsets_B, char * C, uint64_t const * offsets_C) const {
+    char tmp[el_size];
+    for (int64_t i=0; i<n; i++){
+      this->mul(A+offsets_A[i], B+offsets_B[i], tmp);
+      if (alpha != NULL) this->mul(tmp, alpha, tmp);
+      this->add(tmp, C+offsets_C[i], C+offsets_C[i]);
+    }
+  }
+
+  void algstrct::offsets_sum(int64_t n, char const * A, uint64_t const * offsets_A, char * B, uint64_t const * offsets_B) const {
+    for (int64_t i=0; i<n; i++){
+      this->add(A+offsets_A[i], B+offsets_B[i], B+offsets_B[i]);
+    }
+  }
+
+  int64_t algstrct::pairs_sum(int64_t nA, char const * A, int64_t idx_B, int64_t m, char * B) const {
+    ConstPairIterator pA(this, A);
+    int64_t j = 0;
+    for (int64_t i=0; i<m; i++){
+      while (j < nA && idx_B+i == pA[j].k()){
+        this->add(pA[j].d(), B+i*el_size, B+i*el_size);
+        j++;
+      }
+    }
+    return j;
+  }
+
+  void algstrct::pairs_merge_sum(int64_t nA, char const * A, char const * beta, int64_t nB, char const * B, int64_t & nnew, char *& new_B, int64_t map_pfx) const {
+    spspsum(this, nA, ConstPairIterator(this, A), beta, this, nB, ConstPairIterator(this, B), NULL, nnew, new_B, NULL, map_pfx);
+  }
+
+
   ConstPairIterator::ConstPairIterator(PairIterator const & pi){
     sr=pi.sr; ptr=pi.ptr; 
   }
@@ -803,74 +883,144 @@ namespace CTF_int {
     }
   };
 
-  void PairIterator::sort(int64_t n){
+  /** \brief number of key bits sorted by each pass of the radix sort */
+  #define RADIX_BITS 8
+  /** \brief sequences shorter than this are sorted by std::sort */
+  #define RADIX_SORT_MIN_N 512
+
+  /**
+   * \brief returns the largest key of n pairs
+   */
+  template <typename pair_t>
+  static int64_t get_max_key(pair_t const * pairs, int64_t n){
+    int64_t max_key = 0;
+#ifdef USE_OMP
+    #pragma omp parallel for reduction(max:max_key)
+#endif
+    for (int64_t i=0; i<n; i++){
+      max_key = std::max(max_key, pairs[i].key);
+    }
+    return max_key;
+  }
+
+  /**
+   * \brief stable least-significant-digit radix sort of n pairs by their (nonnegative) key,
+   *        only the digits needed to represent max_key are sorted and a pass is skipped
+   *        when all keys share the digit, threads histogram and scatter contiguous chunks
+   * \param[in,out] pairs pairs to sort
+   * \param[in] n number of pairs
+   * \param[in] max_key upper bound on the keys, if negative it is computed from the keys
+   */
+  template <typename pair_t>
+  static void radix_sort(pair_t * pairs, int64_t n, int64_t max_key){
+    if (n < RADIX_SORT_MIN_N){
+      std::sort(pairs, pairs+n);
+      return;
+    }
+    if (max_key < 0) max_key = get_max_key(pairs, n);
+    ASSERT(max_key >= 0);
+    int npass = 0;
+    while (npass*RADIX_BITS < 63 && (max_key >> (npass*RADIX_BITS)) > 0) npass++;
+
+    int const nbkt = 1<<RADIX_BITS;
+#ifdef USE_OMP
+    int nchk = omp_in_parallel() ? 1 : omp_get_max_threads();
+#else
+    int nchk = 1;
+#endif
+    int64_t chk_sz = (n+nchk-1)/nchk;
+    int64_t * counts = (int64_t*)alloc(sizeof(int64_t)*nbkt*nchk);
+    pair_t * buf = (pair_t*)alloc(sizeof(pair_t)*n);
+    pair_t * src = pairs;
+    pair_t * dst = buf;
+    for (int p=0; p<npass; p++){
+      int shift = p*RADIX_BITS;
+#ifdef USE_OMP
+      #pragma omp parallel for schedule(static,1)
+#endif
+      for (int c=0; c<nchk; c++){
+        int64_t * cnt = counts + c*nbkt;
+        std::fill(cnt, cnt+nbkt, 0);
+        int64_t end = std::min(n, (c+1)*chk_sz);
+        for (int64_t i=c*chk_sz; i<end; i++){
+          cnt[(src[i].key >> shift) & (nbkt-1)]++;
+        }
+      }
+      // offsets are ordered by digit, then by chunk, to keep the sort stable
+      bool is_sorted = false;
+      int64_t off = 0;
+      for (int b=0; b<nbkt; b++){
+        int64_t bkt_sz = 0;
+        for (int c=0; c<nchk; c++){
+          int64_t cnt = counts[c*nbkt+b];
+          counts[c*nbkt+b] = off;
+          off += cnt;
+          bkt_sz += cnt;
+        }
+        if (bkt_sz == n) is_sorted = true;
+      }
+      if (is_sorted) continue;
+#ifdef USE_OMP
+      #pragma omp parallel for schedule(static,1)
+#endif
+      for (int c=0; c<nchk; c++){
+        int64_t * cnt = counts + c*nbkt;
+        int64_t end = std::min(n, (c+1)*chk_sz);
+        for (int64_t i=c*chk_sz; i<end; i++){
+          dst[cnt[(src[i].key >> shift) & (nbkt-1)]++] = src[i];
+        }
+      }
+      std::swap(src, dst);
+    }
+    if (src != pairs){
+      memcpy(pairs, src, sizeof(pair_t)*n);
+    }
+    cdealloc(buf);
+    cdealloc(counts);
+  }
+
+  void PairIterator::sort(int64_t n, int64_t max_key){
     switch (sr->el_size){
       case 1:
         ASSERT(sizeof(BoolPair)==sr->pair_size());
-        std::sort((BoolPair*)ptr,((BoolPair*)ptr)+n);
+        radix_sort((BoolPair*)ptr, n, max_key);
         break;
       case 2:
         ASSERT(sizeof(ShortPair)==sr->pair_size());
-        std::sort((ShortPair*)ptr,((ShortPair*)ptr)+n);
+        radix_sort((ShortPair*)ptr, n, max_key);
         break;
       case 4:
         ASSERT(sizeof(IntPair)==sr->pair_size());
-        std::sort((IntPair*)ptr,((IntPair*)ptr)+n);
+        radix_sort((IntPair*)ptr, n, max_key);
         break;
       case 8:
         ASSERT(sizeof(CompPair<8>)==sr->pair_size());
-        std::sort((CompPair<8>*)ptr,((CompPair<8>*)ptr)+n);
+        radix_sort((CompPair<8>*)ptr, n, max_key);
         break;
-      case 12:
-        ASSERT(sizeof(CompPair<12>)==sr->pair_size());
-        std::sort((CompPair<12>*)ptr,((CompPair<12>*)ptr)+n);
-        break;
-      case 16:
-        ASSERT(sizeof(CompPair<16>)==sr->pair_size());
-        std::sort((CompPair<16>*)ptr,((CompPair<16>*)ptr)+n);
-        break;
-      case 20:
-        ASSERT(sizeof(CompPair<20>)==sr->pair_size());
-        std::sort((CompPair<20>*)ptr,((CompPair<20>*)ptr)+n);
-        break;
-      case 24:
-        ASSERT(sizeof(CompPair<24>)==sr->pair_size());
-        std::sort((CompPair<24>*)ptr,((CompPair<24>*)ptr)+n);
-        break;
-      case 28:
-        ASSERT(sizeof(CompPair<28>)==sr->pair_size());
-        std::sort((CompPair<28>*)ptr,((CompPair<28>*)ptr)+n);
-        break;
-      case 32:
-        ASSERT(sizeof(CompPair<32>)==sr->pair_size());
-        std::sort((CompPair<32>*)ptr,((CompPair<32>*)ptr)+n);
-        break;
-      default:
-        //Causes a bogus uninitialized variable warning with GNU
-        CompPtrPair ptr_pairs[n];
+      default: {
+        //keys are sorted along with their positions and each (wider) pair is moved once
+        if (n <= 1) break;
+        int64_t psz = sr->pair_size();
+        CompPtrPair * ptr_pairs = (CompPtrPair*)alloc(sizeof(CompPtrPair)*n);
 #ifdef USE_OMP
         #pragma omp parallel for
 #endif
         for (int64_t i=0; i<n; i++){
-          ptr_pairs[i].key = *(int64_t*)(ptr+i*(sizeof(int64_t)+sr->el_size));
+          ptr_pairs[i].key = (*this)[i].k();
           ptr_pairs[i].idx = i;
         }
-        //FIXME :(
-        char swap_buffer[(sizeof(int64_t)+sr->el_size)*n];
-    
-        memcpy(swap_buffer, ptr, (sizeof(int64_t)+sr->el_size)*n);
-
-        std::sort(ptr_pairs, ptr_pairs+n);
-        
+        radix_sort(ptr_pairs, n, max_key);
+        char * sorted = (char*)alloc(psz*n);
 #ifdef USE_OMP
         #pragma omp parallel for
 #endif
         for (int64_t i=0; i<n; i++){
-          memcpy(ptr+i*(sizeof(int64_t)+sr->el_size), 
-                 swap_buffer+ptr_pairs[i].idx*(sizeof(int64_t)+sr->el_size),
-                 sizeof(int64_t)+sr->el_size);
+          memcpy(sorted+i*psz, ptr+ptr_pairs[i].idx*psz, psz);
         }
-        break; //compiler warning here seems to be gcc bug
+        memcpy(ptr, sorted, psz*n);
+        cdealloc(sorted);
+        cdealloc(ptr_pairs);
+        } break;
     }
   }
 
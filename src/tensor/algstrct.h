@@ -5,6 +5,9 @@
 
 namespace CTF_int {
   class bivar_function;
+  class CSR_Matrix;
+  class COO_Matrix;
+  class CSF_Tensor;
 
   /**
    * \brief abstract class that knows how to add
@@ -239,6 +242,158 @@ namespace CTF_int {
                  char const * beta,
                  char *&      C_CSR) const;
 
+      /**
+       * \brief coomm with A given as a serialized COO matrix with indices of any width,
+       *        by default converts A to 32-bit indices and calls the above coomm
+       */
+      virtual void coomm(int                m,
+                         int                n,
+                         int                k,
+                         char const *       alpha,
+                         COO_Matrix const & A,
+                         char const *       B,
+                         char const *       beta,
+                         char *             C) const;
+
+      /**
+       * \brief csrmm with A given as a serialized CSR matrix with indices of any width,
+       *        by default converts A to 32-bit indices and calls the above csrmm
+       */
+      virtual void csrmm(int                m,
+                         int                n,
+                         int                k,
+                         char const *       alpha,
+                         CSR_Matrix const & A,
+                         char const *       B,
+                         char const *       beta,
+                         char *             C) const;
+
+      /**
+       * \brief csrmultd with A and B given as serialized CSR matrices with indices of the same (any) width,
+       *        by default converts them to 32-bit indices and calls the above csrmultd
+       */
+      virtual void csrmultd
+                (int                m,
+                 int                n,
+                 int                k,
+                 char const *       alpha,
+                 CSR_Matrix const & A,
+                 CSR_Matrix const & B,
+                 char const *       beta,
+                 char *             C) const;
+
+      /**
+       * \brief csrmultcsr with A and B given as serialized CSR matrices with indices of the same (any) width,
+       *        by default converts them to 32-bit indices and calls the above csrmultcsr
+       */
+      virtual void csrmultcsr
+                (int                m,
+                 int                n,
+                 int                k,
+                 char const *       alpha,
+                 CSR_Matrix const & A,
+                 CSR_Matrix const & B,
+                 char const *       beta,
+                 char *&            C_CSR) const;
+
+      /**
+       * \brief masked sparse matrix product, C[i,j] += alpha*sum_k A[i,k]*B[k,j] for each nonzero (i,j) of C only
+       *        (see masked_spgemm()), A and B have indices of the same (any) width, by default uses add() and mul()
+       * \param[in] m number of rows of A and C
+       * \param[in] n number of columns of B and C
+       * \param[in] k number of columns of A and rows of B
+       * \param[in] alpha scaling factor of the product
+       * \param[in] A m-by-k CSR matrix
+       * \param[in] B k-by-n CSR matrix
+       * \param[in] C m-by-n CSR matrix whose values are accumulated to, its pattern is the mask
+       */
+      virtual void masked_csrmultcsr
+                (int                m,
+                 int                n,
+                 int                k,
+                 char const *       alpha,
+                 CSR_Matrix const & A,
+                 CSR_Matrix const & B,
+                 CSR_Matrix const & C) const;
+
+      /**
+       * \brief matricized tensor times Khatri-Rao product (MTTKRP) of a CSF tensor (see csf_mttkrp()),
+       *        accumulates into the rows of out indexed by the root fibers of T, by default uses add() and mul()
+       * \param[in] T CSF tensor whose fiber indices at each level l>0 are rows of facs[l]
+       * \param[in] R number of columns of each factor matrix
+       * \param[in] facs row-major factor matrices for each level of T (facs[0] is unused)
+       * \param[in,out] out row-major output matrix
+       */
+      virtual void mttkrp(CSF_Tensor const & T,
+                          int                R,
+                          char const * const * facs,
+                          char *             out) const;
+
+      /**
+       * \brief innermost loop of sym_seq_ctr, C[offsets_C[i]] += alpha*A[offsets_A[i]]*B[offsets_B[i]] for i<n,
+       *        offsets are in bytes, by default uses add() and mul()
+       * \param[in] n number of elements
+       * \param[in] alpha scaling factor, NULL if none
+       * \param[in] A, B operands
+       * \param[in] offsets_A, offsets_B byte offsets of the elements of A and B
+       * \param[in,out] C output
+       * \param[in] offsets_C byte offsets of the elements of C
+       */
+      virtual void offsets_ctr(int64_t          n,
+                               char const *     alpha,
+                               char const *     A,
+                               uint64_t const * offsets_A,
+                               char const *     B,
+                               uint64_t const * offsets_B,
+                               char *           C,
+                               uint64_t const * offsets_C) const;
+
+      /**
+       * \brief innermost loop of sym_seq_sum, B[offsets_B[i]] += A[offsets_A[i]] for i<n,
+       *        offsets are in bytes, by default uses add()
+       */
+      virtual void offsets_sum(int64_t          n,
+                               char const *     A,
+                               uint64_t const * offsets_A,
+                               char *           B,
+                               uint64_t const * offsets_B) const;
+
+      /**
+       * \brief innermost loop of spA_dnB_seq_sum, B[i] += a for i<m and each leading pair (idx_B+i, a) of A,
+       *        by default uses add()
+       * \param[in] nA number of pairs in A
+       * \param[in] A pairs sorted by key
+       * \param[in] idx_B key of B[0]
+       * \param[in] m number of elements of B
+       * \param[in,out] B dense output
+       * \return number of pairs of A accumulated
+       */
+      virtual int64_t pairs_sum(int64_t      nA,
+                                char const * A,
+                                int64_t      idx_B,
+                                int64_t      m,
+                                char *       B) const;
+
+      /**
+       * \brief merges sorted pairs, new_B = A+beta*B (see spA_spB_seq_sum()), by default calls spspsum()
+       * \param[in] nA number of pairs in A
+       * \param[in] A pairs sorted by key
+       * \param[in] beta scaling factor of B, NULL if none
+       * \param[in] nB number of pairs in B
+       * \param[in] B pairs sorted by key
+       * \param[out] nnew number of pairs in new_B
+       * \param[out] new_B pairs of the result, allocated internally
+       * \param[in] map_pfx how many times each element of A should be replicated
+       */
+      virtual void pairs_merge_sum(int64_t      nA,
+                                   char const * A,
+                                   char const * beta,
+                                   int64_t      nB,
+                                   char const * B,
+                                   int64_t &    nnew,
+                                   char *&      new_B,
+                                   int64_t      map_pfx) const;
+
       /** \brief returns true if algstrct elements a and b are equal */
       virtual bool isequal(char const * a, char const * b) const;
 
@@ -319,6 +474,11 @@ namespace CTF_int {
 
   class PairIterator;
 
+  /**
+   * \brief iterator over pairs stored interleaved as [k1, d1, k2, d2, ...] with stride sr->pair_size(),
+   *        the layout of sparse tensor blocks and of the buffers bucketed, exchanged, and merged by
+   *        sparse_rw, spsum, spctr, and depin, routines that scan only keys copy them out first
+   */
   class ConstPairIterator {
     public:
       algstrct const * sr;
@@ -373,6 +533,9 @@ namespace CTF_int {
    */
   void depin(algstrct const * sr, int order, int const * lens, int const * divisor, int nvirt, int const * virt_dim, int const * phys_rank, char * X, int64_t & new_nnz_B, int64_t * nnz_blk, char *& new_B, bool check_padding);
 
+  /**
+   * \brief mutable iterator over interleaved pairs (see ConstPairIterator)
+   */
   class PairIterator {
     public:
       algstrct const * sr;
@@ -437,9 +600,12 @@ namespace CTF_int {
       void write_key(int64_t key);
 
       /**
-       * \brief sorts set of pairs using std::sort 
+       * \brief sorts set of pairs by key using a parallel radix sort
+       * \param[in] n number of pairs
+       * \param[in] max_key upper bound on the keys (e.g. the number of elements in the tensor minus one),
+       *            limits the number of radix passes, if negative it is computed from the keys
        */
-      void sort(int64_t n);
+      void sort(int64_t n, int64_t max_key=-1);
       
       /**
        * \brief searches for pair op via std::lower_bound
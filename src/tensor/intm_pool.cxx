@@ -0,0 +1,166 @@
+/*Copyright (c) 2011, Edgar Solomonik, all rights reserved.*/
+
+#include "intm_pool.h"
+#include "../shared/util.h"
+#include <typeinfo>
+
+namespace CTF {
+  int64_t INTM_POOL_SIZE = ((int64_t)1)<<30;
+
+  Plan_cache_stats get_intm_pool_stats(){
+    CTF_int::intm_pool & ip = CTF_int::get_intm_pool();
+    Plan_cache_stats st;
+    st.hits      = ip.nhits;
+    st.misses    = ip.nmisses;
+    st.evictions = ip.nevictions;
+    st.size      = ip.size();
+    return st;
+  }
+
+  void clear_intm_pool(){
+    CTF_int::get_intm_pool().clear();
+  }
+}
+
+namespace CTF_int {
+  using namespace CTF;
+
+  intm_pool & get_intm_pool(){
+    // not a static object, since a World destroyed at exit may still return its intermediates
+    static intm_pool * pool = new intm_pool();
+    return *pool;
+  }
+
+  /**
+   * \brief bytes held by a tensor, counting its home buffer if it is away from it
+   */
+  static int64_t pooled_bytes(tensor const * tsr){
+    int64_t sz = tsr->size*tsr->sr->el_size;
+    if (tsr->has_home && !tsr->is_home) sz *= 2;
+    return sz;
+  }
+
+  bool intm_pool::get_signature(algstrct const *       sr,
+                                int                    order,
+                                int const *            lens,
+                                int const *            sym,
+                                std::vector<int64_t> & sig){
+    if (CTF::INTM_POOL_SIZE <= 0) return false;
+    sig.clear();
+    // structures of different element types may have the same element size
+    sig.push_back((int64_t)typeid(*sr).hash_code());
+    sig.push_back(sr->el_size);
+    sig.push_back(order);
+    for (int i=0; i<order; i++){
+      sig.push_back(lens[i]);
+      sig.push_back(sym[i]);
+    }
+    return true;
+  }
+
+  intm_pool::intm_pool(){
+    nhits      = 0;
+    nmisses    = 0;
+    nevictions = 0;
+  }
+
+  intm_pool::~intm_pool(){
+    clear();
+  }
+
+  int64_t intm_pool::size() const {
+    int64_t n = 0;
+    std::map< World const *, world_pool >::const_iterator wit;
+    for (wit=worlds.begin(); wit!=worlds.end(); wit++){
+      std::map< std::vector<int64_t>, std::vector<pooled> >::const_iterator it;
+      for (it=wit->second.tensors.begin(); it!=wit->second.tensors.end(); it++){
+        n += it->second.size();
+      }
+    }
+    return n;
+  }
+
+  tensor * intm_pool::acquire(algstrct const * sr,
+                              int              order,
+                              int const *      lens,
+                              int const *      sym,
+                              CTF::World *     wrld){
+    std::vector<int64_t> sig;
+    if (!get_signature(sr, order, lens, sym, sig)) return NULL;
+    std::map< World const *, world_pool >::iterator wit = worlds.find(wrld);
+    std::map< std::vector<int64_t>, std::vector<pooled> >::iterator it;
+    if (wit == worlds.end() || (it = wit->second.tensors.find(sig)) == wit->second.tensors.end()){
+      nmisses++;
+      return NULL;
+    }
+    nhits++;
+    world_pool & wp = wit->second;
+    tensor * tsr = it->second.back().tsr;
+    it->second.pop_back();
+    if (it->second.size() == 0) wp.tensors.erase(it);
+    wp.nbytes -= pooled_bytes(tsr);
+    delete tsr->sr;
+    tsr->sr = sr->clone();
+    // the previous contents may not be discarded by scaling with the additive identity (e.g. if they are not finite)
+    tsr->set_zero();
+    return tsr;
+  }
+
+  void intm_pool::release(tensor * tsr){
+    std::vector<int64_t> sig;
+    if (tsr->is_sparse || tsr->is_data_aliased || !tsr->is_mapped ||
+        !get_signature(tsr->sr, tsr->order, tsr->lens, tsr->sym, sig)){
+      delete tsr;
+      return;
+    }
+    if (tsr->is_folded) tsr->unfold();
+    int64_t sz = pooled_bytes(tsr);
+    if (sz > CTF::INTM_POOL_SIZE){
+      delete tsr;
+      return;
+    }
+    world_pool & wp = worlds[tsr->wrld];
+    while (wp.nbytes + sz > CTF::INTM_POOL_SIZE && wp.nbytes > 0){
+      evict(wp);
+    }
+    pooled p;
+    p.tsr      = tsr;
+    p.last_use = ++wp.ncalls;
+    wp.tensors[sig].push_back(p);
+    wp.nbytes += sz;
+  }
+
+  void intm_pool::evict(world_pool & wp){
+    std::map< std::vector<int64_t>, std::vector<pooled> >::iterator it, lru;
+    lru = wp.tensors.end();
+    int64_t lru_use = INT64_MAX;
+    // tensors of each signature are pushed in order of release, so the first is the least recently used
+    for (it=wp.tensors.begin(); it!=wp.tensors.end(); it++){
+      if (it->second[0].last_use < lru_use){
+        lru = it;
+        lru_use = it->second[0].last_use;
+      }
+    }
+    tensor * tsr = lru->second[0].tsr;
+    lru->second.erase(lru->second.begin());
+    if (lru->second.size() == 0) wp.tensors.erase(lru);
+    wp.nbytes -= pooled_bytes(tsr);
+    delete tsr;
+    nevictions++;
+  }
+
+  void intm_pool::clear(CTF::World const * wrld){
+    std::map< World const *, world_pool >::iterator wit = worlds.begin();
+    while (wit != worlds.end()){
+      if (wrld == NULL || wit->first == wrld){
+        std::map< std::vector<int64_t>, std::vector<pooled> >::iterator it;
+        for (it=wit->second.tensors.begin(); it!=wit->second.tensors.end(); it++){
+          for (int i=0; i<(int)it->second.size(); i++){
+            delete it->second[i].tsr;
+          }
+        }
+        worlds.erase(wit++);
+      } else wit++;
+    }
+  }
+}
@@ -0,0 +1,95 @@
+/*Copyright (c) 2011, Edgar Solomonik, all rights reserved.*/
+
+#ifndef __INTM_POOL_H__
+#define __INTM_POOL_H__
+
+#include "untyped_tensor.h"
+#include <map>
+
+namespace CTF_int {
+
+  /**
+   * \brief pool of intermediate tensors of Term evaluation, recycled whole (with their mapping and buffer)
+   *        for later intermediates with the same World, algebraic structure type, lengths, and symmetry,
+   *        so that iterations evaluating the same expressions do not map and allocate new tensors,
+   *        intermediates and the CTF::INTM_POOL_SIZE budget are kept separately for each World,
+   *        so that all processes of a World recycle and evict the same intermediates
+   */
+  class intm_pool {
+    public:
+      /**
+       * \brief computes the signature under which an intermediate is pooled within its World
+       * \param[in] sr algebraic structure of the intermediate
+       * \param[in] order number of modes
+       * \param[in] lens edge lengths
+       * \param[in] sym symmetry relations
+       * \param[out] sig signature
+       * \return false if intermediates should not be pooled
+       */
+      static bool get_signature(algstrct const *       sr,
+                                int                    order,
+                                int const *            lens,
+                                int const *            sym,
+                                std::vector<int64_t> & sig);
+
+      /**
+       * \brief takes a pooled intermediate, updates hit/miss statistics,
+       *        its algebraic structure is replaced by sr and its data is set to zero
+       * \param[in] sr algebraic structure of the intermediate
+       * \param[in] order number of modes
+       * \param[in] lens edge lengths
+       * \param[in] sym symmetry relations
+       * \param[in] wrld World the intermediate is defined on
+       * \return mapped dense tensor or NULL if none is pooled
+       */
+      tensor * acquire(algstrct const * sr,
+                       int              order,
+                       int const *      lens,
+                       int const *      sym,
+                       CTF::World *     wrld);
+
+      /**
+       * \brief returns an intermediate to the pool (taking ownership), evicting least recently used ones
+       *        of its World to stay within the budget, or deletes it if it can not be pooled
+       * \param[in] tsr intermediate that is no longer referenced
+       */
+      void release(tensor * tsr);
+
+      /**
+       * \brief deletes pooled intermediates, statistics are kept
+       * \param[in] wrld if not NULL, only those defined on this World
+       */
+      void clear(CTF::World const * wrld=NULL);
+
+      /** \brief number of pooled intermediates */
+      int64_t size() const;
+
+      intm_pool();
+      ~intm_pool();
+
+      int64_t nhits;
+      int64_t nmisses;
+      int64_t nevictions;
+    private:
+      struct pooled {
+        tensor * tsr;
+        int64_t  last_use;
+      };
+      /** \brief intermediates of one World, their total size, and the count of releases to it */
+      struct world_pool {
+        int64_t ncalls;
+        int64_t nbytes;
+        std::map< std::vector<int64_t>, std::vector<pooled> > tensors;
+        world_pool() : ncalls(0), nbytes(0) {}
+      };
+      std::map< CTF::World const *, world_pool > worlds;
+
+      /** \brief deletes the least recently used intermediate of a World */
+      void evict(world_pool & wp);
+  };
+
+  /** \brief returns the intermediate tensor pool of this process */
+  intm_pool & get_intm_pool();
+}
+
+#endif
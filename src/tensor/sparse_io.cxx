@@ -0,0 +1,540 @@
+/*Copyright (c) 2011, Edgar Solomonik, all rights reserved.*/
+
+#include "untyped_tensor.h"
+#include "../shared/util.h"
+#include <ctype.h>
+#include <inttypes.h>
+#include <math.h>
+#include <string>
+#include <sstream>
+#include <vector>
+
+namespace CTF_int {
+  // symmetry of a MatrixMarket file
+  #define MTX_GENERAL 0
+  #define MTX_SYMMETRIC 1
+  #define MTX_SKEW 2
+  // a binary coordinate file starts with SPBIN_NFIXED words (magic, version, order, element size, number of nonzeros)
+  // followed by the lengths, then a record per nonzero of its 0-based indices and value
+  #define SPBIN_MAGIC 0x314f4f4346544342LL
+  #define SPBIN_VERSION 1
+  #define SPBIN_NFIXED 5
+
+  /**
+   * \brief opens fpath on all processes of cm, truncating it if opened for writing
+   * \return whether the file could be opened on all processes
+   */
+  static bool open_file(char const * fpath, bool is_write, MPI_Comm cm, MPI_File & file){
+    int amode = is_write ? (MPI_MODE_WRONLY | MPI_MODE_CREATE) : MPI_MODE_RDONLY;
+    int ret = MPI_File_open(cm, (char*)fpath, amode, MPI_INFO_NULL, &file);
+    int is_open = ret == MPI_SUCCESS;
+    MPI_Allreduce(MPI_IN_PLACE, &is_open, 1, MPI_INT, MPI_MIN, cm);
+    if (!is_open){
+      if (ret == MPI_SUCCESS) MPI_File_close(&file);
+      return false;
+    }
+    if (is_write) MPI_File_set_size(file, 0);
+    return true;
+  }
+
+  /**
+   * \brief finds the first position at or after pos at which a line starts within [st,en) of file
+   */
+  static int64_t line_start(MPI_File & file, int64_t pos, int64_t st, int64_t en){
+    if (pos <= st) return st;
+    char buf[4096];
+    int64_t p = pos-1;
+    while (p < en){
+      int cnt = (int)std::min((int64_t)sizeof(buf), en-p);
+      MPI_Status stat;
+      MPI_File_read_at(file, p, buf, cnt, MPI_CHAR, &stat);
+      char * nl = (char*)memchr(buf, '\n', cnt);
+      if (nl != NULL) return p+(nl-buf)+1;
+      p += cnt;
+    }
+    return en;
+  }
+
+  /**
+   * \brief reads a range of whole lines of [st,en) of file on each process, the ranges of all processes cover [st,en)
+   * \param[out] len number of bytes read by this process
+   * \return buffer of len+1 bytes, terminated by '\0'
+   */
+  static char * read_line_range(MPI_File & file, int64_t st, int64_t en, MPI_Comm cm, int64_t * len){
+    int rank, np;
+    MPI_Comm_rank(cm, &rank);
+    MPI_Comm_size(cm, &np);
+    int64_t my_st = line_start(file, st+((en-st)*rank)/np, st, en);
+    int64_t * starts = (int64_t*)alloc(sizeof(int64_t)*np);
+    MPI_Allgather(&my_st, 1, MPI_INT64_T, starts, 1, MPI_INT64_T, cm);
+    int64_t my_en = rank+1 < np ? starts[rank+1] : en;
+    cdealloc(starts);
+    *len = my_en-my_st;
+    char * buf = (char*)alloc(*len+1);
+    file_io_all(file, my_st, buf, *len, false, cm);
+    buf[*len] = '\0';
+    return buf;
+  }
+
+  /**
+   * \brief reads the MatrixMarket header of file, if it starts with one, and checks it against a tensor
+   * \param[out] hdr whether the header matches, whether there is one, whether entries have values,
+   *                 the symmetry, the offset of the first entry, and the number of entries
+   */
+  static void read_mtx_header(MPI_File & file, int64_t fsize, int order, int const * lens, char const * fpath, int64_t * hdr){
+    int64_t len = std::min(fsize, ((int64_t)1)<<16);
+    std::string banner, size_line;
+    for (;;){
+      std::string buf(len, '\0');
+      MPI_Status stat;
+      MPI_File_read_at(file, 0, &buf[0], (int)len, MPI_CHAR, &stat);
+      if (buf.compare(0, 14, "%%MatrixMarket") != 0) return;
+      hdr[1] = 1;
+      size_t pos = 0;
+      while (pos < buf.size()){
+        size_t eol = buf.find('\n', pos);
+        if (eol == std::string::npos){
+          // the header ends without a newline only at the end of the file
+          if (len == fsize) eol = buf.size();
+          else break;
+        }
+        std::string line = buf.substr(pos, eol-pos);
+        if (pos == 0) banner = line;
+        else if (line.size() > 0 && line[0] != '%' && line.find_first_not_of(" \t\r") != std::string::npos){
+          size_line = line;
+          hdr[4] = std::min((int64_t)eol+1, fsize);
+          break;
+        }
+        pos = eol+1;
+      }
+      if (size_line.size() > 0 || len == fsize) break;
+      len = std::min(fsize, 2*len);
+    }
+    std::istringstream bs(banner);
+    std::string tag, obj, fmt, field, symm;
+    bs >> tag >> obj >> fmt >> field >> symm;
+    for (size_t i=0; i<field.size(); i++) field[i] = tolower(field[i]);
+    for (size_t i=0; i<symm.size(); i++) symm[i] = tolower(symm[i]);
+    for (size_t i=0; i<fmt.size(); i++) fmt[i] = tolower(fmt[i]);
+    if (fmt != "coordinate" || (field != "real" && field != "double" && field != "integer" && field != "pattern")){
+      printf("CTF ERROR: %s is not a real, integer, or pattern MatrixMarket file in coordinate format\n", fpath);
+      hdr[0] = 0;
+      return;
+    }
+    hdr[2] = field != "pattern";
+    if (symm == "general") hdr[3] = MTX_GENERAL;
+    else if (symm == "symmetric" || symm == "hermitian") hdr[3] = MTX_SYMMETRIC;
+    else if (symm == "skew-symmetric") hdr[3] = MTX_SKEW;
+    else {
+      printf("CTF ERROR: %s has unknown MatrixMarket symmetry %s\n", fpath, symm.c_str());
+      hdr[0] = 0;
+      return;
+    }
+    int64_t m, n, nnz;
+    if (size_line.size() == 0 || sscanf(size_line.c_str(), "%" SCNd64 " %" SCNd64 " %" SCNd64, &m, &n, &nnz) != 3){
+      printf("CTF ERROR: %s has no MatrixMarket size line\n", fpath);
+      hdr[0] = 0;
+      return;
+    }
+    if (order != 2 || m != lens[0] || n != lens[1]){
+      printf("CTF ERROR: %s holds a %" PRId64 "-by-%" PRId64 " matrix, which does not match the tensor\n", fpath, m, n);
+      hdr[0] = 0;
+      return;
+    }
+    hdr[5] = nnz;
+  }
+
+  /**
+   * \brief parses a line of 1-based coordinates optionally followed by a value into pairs
+   * \param[in] mirror whether to also give the transposed entry of an off-diagonal matrix entry
+   * \return number of pairs given (0 for blank lines and comments), or -1 if the line could not be parsed
+   */
+  static int parse_line(char const *     line,
+                        int              order,
+                        int const *      lens,
+                        int64_t const *  lda,
+                        bool             has_val,
+                        bool             mirror,
+                        int              mtx_sym,
+                        algstrct const * sr,
+                        char *           pairs){
+    char const * p = line;
+    while (isspace(*p)) p++;
+    if (*p == '\0' || *p == '%' || *p == '#') return 0;
+    int64_t idx[order];
+    int64_t key = 0;
+    for (int d=0; d<order; d++){
+      char * e;
+      idx[d] = strtoll(p, &e, 10)-1;
+      if (e == p || idx[d] < 0 || idx[d] >= lens[d]) return -1;
+      key += idx[d]*lda[d];
+      p = e;
+    }
+    char val[std::max(1,sr->el_size)];
+    if (sr->el_size > 0){
+      if (has_val){
+        char * e;
+        int64_t iv = strtoll(p, &e, 10);
+        if (e != p && (*e == '\0' || isspace(*e)))
+          sr->cast_int(iv, val);
+        else {
+          double dv = strtod(p, &e);
+          if (e == p) return -1;
+          sr->cast_double(dv, val);
+        }
+      } else
+        memcpy(val, sr->mulid(), sr->el_size);
+    }
+    PairIterator pi(sr, pairs);
+    pi[0].write_key(key);
+    pi[0].write_val(val);
+    if (!mirror || idx[0] == idx[1]) return 1;
+    pi[1].write_key(idx[1]*lda[0]+idx[0]*lda[1]);
+    if (mtx_sym == MTX_SKEW && sr->el_size > 0){
+      char nval[sr->el_size];
+      sr->addinv(val, nval);
+      pi[1].write_val(nval);
+    } else
+      pi[1].write_val(val);
+    return 2;
+  }
+
+  /**
+   * \brief prints a value as an integer if it is one, otherwise with enough digits to be read back exactly
+   */
+  static int format_val(algstrct const * sr, char const * val, char * str, int maxlen){
+    double d = sr->cast_to_double(val);
+    if (d == floor(d) && fabs(d) < 9.e18)
+      return snprintf(str, maxlen, "%" PRId64, sr->cast_to_int(val));
+    return snprintf(str, maxlen, "%.17g", d);
+  }
+
+  int tensor::read_sparse_from_file(char const * fpath){
+    TAU_FSTART(read_sparse_from_file);
+    MPI_File file;
+    if (!open_file(fpath, false, wrld->comm, file)){
+      if (wrld->rank == 0) printf("CTF ERROR: could not open %s\n", fpath);
+      TAU_FSTOP(read_sparse_from_file);
+      return ERROR;
+    }
+    MPI_Offset fsize;
+    MPI_File_get_size(file, &fsize);
+    int64_t hdr[6] = {1, 0, 1, MTX_GENERAL, 0, 0};
+    if (wrld->rank == 0) read_mtx_header(file, fsize, order, lens, fpath, hdr);
+    MPI_Bcast(hdr, 6, MPI_INT64_T, 0, wrld->comm);
+    if (!hdr[0]){
+      MPI_File_close(&file);
+      TAU_FSTOP(read_sparse_from_file);
+      return ERROR;
+    }
+    int64_t len;
+    char * buf = read_line_range(file, hdr[4], fsize, wrld->comm, &len);
+    MPI_File_close(&file);
+
+    std::vector<int64_t> line_st;
+    for (char * p=buf; p<buf+len; ){
+      char * nl = (char*)memchr(p, '\n', buf+len-p);
+      line_st.push_back(p-buf);
+      if (nl == NULL) break;
+      *nl = '\0';
+      p = nl+1;
+    }
+    int64_t nline = line_st.size();
+    bool mirror = hdr[1] && hdr[3] != MTX_GENERAL && sym[0] == NS;
+    int npl = mirror ? 2 : 1;
+    int64_t lda[order];
+    for (int d=0; d<order; d++){
+      lda[d] = d == 0 ? 1 : lda[d-1]*lens[d-1];
+    }
+    // each line is parsed into its own slots, which are then compacted
+    char * line_pairs = (char*)alloc(sr->pair_size()*npl*nline);
+    int64_t * line_off = (int64_t*)alloc(sizeof(int64_t)*(nline+1));
+#ifdef USE_OMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int64_t l=0; l<nline; l++){
+      line_off[l+1] = parse_line(buf+line_st[l], order, lens, lda, hdr[2], mirror, hdr[3], sr,
+                                 line_pairs+l*npl*sr->pair_size());
+    }
+    int64_t sts[2] = {0, 0};
+    line_off[0] = 0;
+    for (int64_t l=0; l<nline; l++){
+      if (line_off[l+1] < 0){
+        if (sts[0] == 0) printf("CTF ERROR: could not parse line \"%s\" of %s\n", buf+line_st[l], fpath);
+        sts[0]++;
+        line_off[l+1] = 0;
+      }
+      if (line_off[l+1] > 0) sts[1]++;
+      line_off[l+1] += line_off[l];
+    }
+    int64_t npair = line_off[nline];
+    char * pairs = (char*)alloc(sr->pair_size()*npair);
+#ifdef USE_OMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int64_t l=0; l<nline; l++){
+      memcpy(pairs+line_off[l]*sr->pair_size(), line_pairs+l*npl*sr->pair_size(), (line_off[l+1]-line_off[l])*sr->pair_size());
+    }
+    cdealloc(line_pairs);
+    cdealloc(line_off);
+    cdealloc(buf);
+    MPI_Allreduce(MPI_IN_PLACE, sts, 2, MPI_INT64_T, MPI_SUM, wrld->comm);
+    int ret = SUCCESS;
+    if (sts[0] > 0){
+      ret = ERROR;
+    } else if (hdr[1] && sts[1] != hdr[5]){
+      if (wrld->rank == 0)
+        printf("CTF ERROR: %s has %" PRId64 " entries, its header gives %" PRId64 "\n", fpath, sts[1], hdr[5]);
+      ret = ERROR;
+    } else {
+      this->set_zero();
+      this->write(npair, sr->mulid(), sr->addid(), pairs);
+    }
+    cdealloc(pairs);
+    TAU_FSTOP(read_sparse_from_file);
+    return ret;
+  }
+
+  int tensor::write_sparse_to_file(char const * fpath, bool mtx){
+    TAU_FSTART(write_sparse_to_file);
+    if (mtx && order != 2){
+      if (wrld->rank == 0) printf("CTF ERROR: only matrices can be written in MatrixMarket format\n");
+      TAU_FSTOP(write_sparse_to_file);
+      return ERROR;
+    }
+    int64_t npair;
+    char * pairs;
+    this->read_local_nnz(&npair, &pairs);
+    ConstPairIterator pi(sr, pairs);
+
+    // each thread formats a contiguous range of the nonzeros into its own buffer
+#ifdef USE_OMP
+    int mntd = omp_get_max_threads();
+#else
+    int mntd = 1;
+#endif
+    std::vector<std::string> tbufs(mntd);
+#ifdef USE_OMP
+    #pragma omp parallel
+#endif
+    {
+#ifdef USE_OMP
+      int tid = omp_get_thread_num();
+      int ntd = omp_get_num_threads();
+#else
+      int tid = 0;
+      int ntd = 1;
+#endif
+      int64_t tst = (npair/ntd)*tid + std::min((int64_t)tid, npair%ntd);
+      int64_t tend = tst + npair/ntd + (tid < npair%ntd);
+      std::string & tbuf = tbufs[tid];
+      char line[32*order+64];
+      char val[std::max(1,sr->el_size)];
+      int64_t idx[order];
+      for (int64_t i=tst; i<tend; i++){
+        int64_t key = pi[i].k();
+        for (int d=0; d<order; d++){
+          idx[d] = key%lens[d];
+          key = key/lens[d];
+        }
+        if (sr->el_size > 0) pi[i].read_val(val);
+        // MatrixMarket files of symmetric matrices hold the lower triangle
+        if (mtx && sym[0] != NS && idx[0] < idx[1]){
+          std::swap(idx[0], idx[1]);
+          if (sym[0] == AS){
+            char nval[sr->el_size];
+            sr->addinv(val, nval);
+            memcpy(val, nval, sr->el_size);
+          }
+        }
+        int pos = 0;
+        for (int d=0; d<order; d++){
+          pos += snprintf(line+pos, sizeof(line)-pos, d == 0 ? "%" PRId64 : " %" PRId64, idx[d]+1);
+        }
+        if (sr->el_size > 0){
+          line[pos++] = ' ';
+          pos += format_val(sr, val, line+pos, sizeof(line)-pos-1);
+        }
+        line[pos++] = '\n';
+        tbuf.append(line, pos);
+      }
+    }
+    if (pairs != NULL) cdealloc(pairs);
+
+    int64_t nbytes = 0;
+    for (int t=0; t<mntd; t++){
+      nbytes += tbufs[t].size();
+    }
+    char * buf = (char*)alloc(nbytes+1);
+    nbytes = 0;
+    for (int t=0; t<mntd; t++){
+      memcpy(buf+nbytes, tbufs[t].data(), tbufs[t].size());
+      nbytes += tbufs[t].size();
+      std::string().swap(tbufs[t]);
+    }
+    int64_t my_off = 0;
+    MPI_Exscan(&nbytes, &my_off, 1, MPI_INT64_T, MPI_SUM, wrld->comm);
+    if (wrld->rank == 0) my_off = 0;
+    std::string hdr;
+    if (mtx){
+      int64_t nnz = npair;
+      MPI_Allreduce(MPI_IN_PLACE, &nnz, 1, MPI_INT64_T, MPI_SUM, wrld->comm);
+      char hline[256];
+      snprintf(hline, sizeof(hline), "%%%%MatrixMarket matrix coordinate %s %s\n%d %d %" PRId64 "\n",
+               sr->el_size > 0 ? "real" : "pattern",
+               sym[0] == NS ? "general" : (sym[0] == AS ? "skew-symmetric" : "symmetric"), lens[0], lens[1], nnz);
+      hdr = hline;
+    }
+
+    MPI_File file;
+    int ret = SUCCESS;
+    if (!open_file(fpath, true, wrld->comm, file)){
+      if (wrld->rank == 0) printf("CTF ERROR: could not open %s\n", fpath);
+      ret = ERROR;
+    } else {
+      if (wrld->rank == 0 && hdr.size() > 0){
+        MPI_Status stat;
+        MPI_File_write_at(file, 0, (void*)hdr.data(), (int)hdr.size(), MPI_CHAR, &stat);
+      }
+      file_io_all(file, hdr.size()+my_off, buf, nbytes, true, wrld->comm);
+      MPI_File_close(&file);
+    }
+    cdealloc(buf);
+    TAU_FSTOP(write_sparse_to_file);
+    return ret;
+  }
+
+  int tensor::read_sparse_from_binary_file(char const * fpath){
+    TAU_FSTART(read_sparse_from_binary_file);
+    MPI_File file;
+    if (!open_file(fpath, false, wrld->comm, file)){
+      if (wrld->rank == 0) printf("CTF ERROR: could not open %s\n", fpath);
+      TAU_FSTOP(read_sparse_from_binary_file);
+      return ERROR;
+    }
+    MPI_Offset fsize;
+    MPI_File_get_size(file, &fsize);
+    int nhdr = SPBIN_NFIXED+order;
+    int64_t hdr[nhdr];
+    std::fill(hdr, hdr+nhdr, 0);
+    if (wrld->rank == 0 && fsize >= (int64_t)sizeof(hdr)){
+      MPI_Status stat;
+      MPI_File_read_at(file, 0, hdr, sizeof(hdr), MPI_CHAR, &stat);
+    }
+    MPI_Bcast(hdr, nhdr, MPI_INT64_T, 0, wrld->comm);
+    bool is_cmpt = hdr[0] == SPBIN_MAGIC && hdr[1] == SPBIN_VERSION && hdr[2] == order && hdr[3] == sr->el_size;
+    for (int d=0; d<order; d++){
+      if (hdr[SPBIN_NFIXED+d] != lens[d]) is_cmpt = false;
+    }
+    if (!is_cmpt){
+      if (wrld->rank == 0) printf("CTF ERROR: %s holds no nonzeros of a tensor with the lengths and element size of %s\n", fpath, name);
+      MPI_File_close(&file);
+      TAU_FSTOP(read_sparse_from_binary_file);
+      return ERROR;
+    }
+    int64_t nnz = hdr[4];
+    int64_t rec_size = order*sizeof(int64_t)+sr->el_size;
+    if (nnz < 0 || fsize != (MPI_Offset)(sizeof(hdr)+nnz*rec_size)){
+      if (wrld->rank == 0) printf("CTF ERROR: %s has %lld bytes, but its header describes %" PRId64 " nonzeros\n", fpath, (long long)fsize, nnz);
+      MPI_File_close(&file);
+      TAU_FSTOP(read_sparse_from_binary_file);
+      return ERROR;
+    }
+    int64_t my_st = (nnz*wrld->rank)/wrld->np;
+    int64_t my_nnz = (nnz*(wrld->rank+1))/wrld->np-my_st;
+    char * recs = (char*)alloc(rec_size*my_nnz);
+    file_io_all(file, sizeof(hdr)+my_st*rec_size, recs, rec_size*my_nnz, false, wrld->comm);
+    MPI_File_close(&file);
+
+    int64_t lda[order];
+    for (int d=0; d<order; d++){
+      lda[d] = d == 0 ? 1 : lda[d-1]*lens[d-1];
+    }
+    char * pairs = (char*)alloc(sr->pair_size()*my_nnz);
+    PairIterator pi(sr, pairs);
+    int64_t nbad = 0;
+#ifdef USE_OMP
+    #pragma omp parallel for schedule(static) reduction(+:nbad)
+#endif
+    for (int64_t i=0; i<my_nnz; i++){
+      int64_t idx[order];
+      memcpy(idx, recs+i*rec_size, order*sizeof(int64_t));
+      int64_t key = 0;
+      for (int d=0; d<order; d++){
+        if (idx[d] < 0 || idx[d] >= lens[d]) nbad++;
+        key += idx[d]*lda[d];
+      }
+      pi[i].write_key(key);
+      pi[i].write_val(recs+i*rec_size+order*sizeof(int64_t));
+    }
+    cdealloc(recs);
+    MPI_Allreduce(MPI_IN_PLACE, &nbad, 1, MPI_INT64_T, MPI_SUM, wrld->comm);
+    int ret = SUCCESS;
+    if (nbad > 0){
+      if (wrld->rank == 0) printf("CTF ERROR: %s has %" PRId64 " nonzeros with indices out of range\n", fpath, nbad);
+      ret = ERROR;
+    } else {
+      this->set_zero();
+      this->write(my_nnz, sr->mulid(), sr->addid(), pairs);
+    }
+    cdealloc(pairs);
+    TAU_FSTOP(read_sparse_from_binary_file);
+    return ret;
+  }
+
+  int tensor::write_sparse_to_binary_file(char const * fpath){
+    TAU_FSTART(write_sparse_to_binary_file);
+    int64_t npair;
+    char * pairs;
+    this->read_local_nnz(&npair, &pairs);
+    ConstPairIterator pi(sr, pairs);
+    int64_t rec_size = order*sizeof(int64_t)+sr->el_size;
+    char * recs = (char*)alloc(rec_size*npair);
+#ifdef USE_OMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int64_t i=0; i<npair; i++){
+      int64_t idx[order];
+      int64_t key = pi[i].k();
+      for (int d=0; d<order; d++){
+        idx[d] = key%lens[d];
+        key = key/lens[d];
+      }
+      memcpy(recs+i*rec_size, idx, order*sizeof(int64_t));
+      pi[i].read_val(recs+i*rec_size+order*sizeof(int64_t));
+    }
+    if (pairs != NULL) cdealloc(pairs);
+
+    int nhdr = SPBIN_NFIXED+order;
+    int64_t hdr[nhdr];
+    int64_t my_st = 0;
+    MPI_Exscan(&npair, &my_st, 1, MPI_INT64_T, MPI_SUM, wrld->comm);
+    if (wrld->rank == 0) my_st = 0;
+    hdr[0] = SPBIN_MAGIC;
+    hdr[1] = SPBIN_VERSION;
+    hdr[2] = order;
+    hdr[3] = sr->el_size;
+    hdr[4] = npair;
+    MPI_Allreduce(MPI_IN_PLACE, hdr+4, 1, MPI_INT64_T, MPI_SUM, wrld->comm);
+    for (int d=0; d<order; d++){
+      hdr[SPBIN_NFIXED+d] = lens[d];
+    }
+
+    MPI_File file;
+    int ret = SUCCESS;
+    if (!open_file(fpath, true, wrld->comm, file)){
+      if (wrld->rank == 0) printf("CTF ERROR: could not open %s\n", fpath);
+      ret = ERROR;
+    } else {
+      if (wrld->rank == 0){
+        MPI_Status stat;
+        MPI_File_write_at(file, 0, hdr, sizeof(hdr), MPI_CHAR, &stat);
+      }
+      file_io_all(file, sizeof(hdr)+my_st*rec_size, recs, rec_size*npair, true, wrld->comm);
+      MPI_File_close(&file);
+    }
+    cdealloc(recs);
+    TAU_FSTOP(write_sparse_to_binary_file);
+    return ret;
+  }
+}
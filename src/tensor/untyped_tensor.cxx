@@ -14,6 +14,7 @@
 #include "../redistribution/cyclic_reshuffle.h"
 #include "../redistribution/glb_cyclic_reshuffle.h"
 #include "../redistribution/dgtog_redist.h"
+#include "../sparse_formats/dcsr.h"
 
 
 using namespace CTF;
@@ -194,6 +195,57 @@ namespace CTF_int {
     cdealloc(nname);
   }
 
+  tensor::tensor(tensor && other) noexcept {
+    order = -1;
+    *this = std::move(other);
+  }
+
+  tensor & tensor::operator=(tensor && other){
+    if (this == &other) return *this;
+    free_self();
+    if (other.order == -1) return *this;
+    wrld                  = other.wrld;
+    sr                    = other.sr;
+    sym                   = other.sym;
+    order                 = other.order;
+    lens                  = other.lens;
+    pad_edge_len          = other.pad_edge_len;
+    padding               = other.padding;
+    name                  = other.name;
+    is_scp_padded         = other.is_scp_padded;
+    scp_padding           = other.scp_padding;
+    sym_table             = other.sym_table;
+    is_mapped             = other.is_mapped;
+    topo                  = other.topo;
+    edge_map              = other.edge_map;
+    size                  = other.size;
+    registered_alloc_size = other.registered_alloc_size;
+    is_folded             = other.is_folded;
+    inner_ordering        = other.inner_ordering;
+    rec_tsr               = other.rec_tsr;
+    is_cyclic             = other.is_cyclic;
+    is_data_aliased       = other.is_data_aliased;
+    slay                  = other.slay;
+    has_zero_edge_len     = other.has_zero_edge_len;
+    data                  = other.data;
+    has_home              = other.has_home;
+    home_buffer           = other.home_buffer;
+    home_size             = other.home_size;
+    is_home               = other.is_home;
+    profile               = other.profile;
+    is_sparse             = other.is_sparse;
+    is_csr                = other.is_csr;
+    nrow_idx              = other.nrow_idx;
+    nnz_loc               = other.nnz_loc;
+    nnz_tot               = other.nnz_tot;
+    nnz_loc_max           = other.nnz_loc_max;
+    nnz_imb               = other.nnz_imb;
+    nnz_blk               = other.nnz_blk;
+    // other now owns nothing, so its destructor and free_self do nothing
+    other.order = -1;
+    return *this;
+  }
+
 
 
   void tensor::copy_tensor_data(tensor const * other){
@@ -276,7 +328,8 @@ namespace CTF_int {
     this->size = other->size;
     this->nnz_loc = other->nnz_loc;
     this->nnz_tot = other->nnz_tot;
-    //this->nnz_loc_max = other->nnz_loc_max;
+    this->nnz_loc_max = other->nnz_loc_max;
+    this->nnz_imb = other->nnz_imb;
 #if DEBUG>= 1
     if (wrld->rank == 0){
       if (is_sparse){
@@ -320,7 +373,8 @@ namespace CTF_int {
     this->nnz_blk           = NULL;
     this->is_csr            = false;
     this->nrow_idx          = -1;
-//    this->nnz_loc_max       = 0;
+    this->nnz_loc_max       = 0;
+    this->nnz_imb           = 1.;
     this->registered_alloc_size = 0;
     if (name_ != NULL){
       this->name = (char*)alloc(strlen(name_)+1);
@@ -436,6 +490,12 @@ namespace CTF_int {
     return npe;  
   }
 
+  double tensor::calc_nnz_frac() const {
+    if (!is_sparse) return 1.;
+    // sparse kernels finish only when the most loaded process does, so skewed nonzeros raise the effective density
+    return std::min(1.,nnz_imb*((double)nnz_tot)/(size*calc_npe()));
+  }
+
 
   void tensor::set_padding(){
     int j, pad, i;
@@ -749,6 +809,58 @@ namespace CTF_int {
     return ret;
   }
 
+  /**
+   * \brief pseudo-random permutation of 0,...,n-1 that depends only on n and seed, so all processes agree on it
+   * \param[in] n number of indices
+   * \param[in] seed selects the permutation
+   * \param[out] perm image of each index, preallocated to n
+   */
+  static void get_rand_perm(int n, int64_t seed, int * perm){
+    std::mt19937_64 gen(((uint64_t)seed)^(((uint64_t)n)*0x9E3779B97F4A7C15ULL));
+    for (int i=0; i<n; i++){
+      perm[i] = i;
+    }
+    // Fisher-Yates with the raw generator output rather than a std distribution, whose results are implementation defined
+    for (int i=n-1; i>0; i--){
+      std::swap(perm[i], perm[gen()%(uint64_t)(i+1)]);
+    }
+  }
+
+  int tensor::relabel(int64_t seed, bool inverse){
+    for (int i=0; i<order; i++){
+      if (sym[i] != NS){
+        if (wrld->rank == 0) printf("CTF ERROR: relabel requires a tensor without symmetry\n");
+        return ERROR;
+      }
+    }
+    TAU_FSTART(relabel);
+    int ** perms = (int**)alloc(sizeof(int*)*order);
+    int * perm = (int*)alloc(sizeof(int)*(order == 0 ? 1 : *std::max_element(lens, lens+order)));
+    for (int i=0; i<order; i++){
+      perms[i] = (int*)alloc(sizeof(int)*lens[i]);
+      get_rand_perm(lens[i], seed, perm);
+      // permute() moves the entry of A at index j of the mode to index perms[i][j] of this tensor
+      if (!inverse){
+        memcpy(perms[i], perm, sizeof(int)*lens[i]);
+      } else {
+        for (int j=0; j<lens[i]; j++){
+          perms[i][perm[j]] = j;
+        }
+      }
+    }
+    cdealloc(perm);
+    tensor * A = new tensor(this, 1, 1);
+    this->set_zero();
+    int ret = this->permute(A, perms, sr->mulid(), NULL, sr->addid());
+    delete A;
+    for (int i=0; i<order; i++){
+      cdealloc(perms[i]);
+    }
+    cdealloc(perms);
+    TAU_FSTOP(relabel);
+    return ret;
+  }
+
   void tensor::orient_subworld(CTF::World *    greater_world,
                                int &           bw_mirror_rank,
                                int &           fw_mirror_rank,
@@ -2541,11 +2653,14 @@ namespace CTF_int {
         nnz_loc += nnz_blk[i];
       }
       wrld->cdt.allred(&nnz_loc, &nnz_tot, 1, MPI_INT64_T, MPI_SUM);
+      wrld->cdt.allred(&nnz_loc, &nnz_loc_max, 1, MPI_INT64_T, MPI_MAX);
+      nnz_imb = 1.;
+      if (nnz_tot > 0) nnz_imb = std::max(1.,((double)nnz_loc_max*calc_npe())/nnz_tot);
   //    printf("New nnz loc = %ld tot = %ld\n", nnz_loc, nnz_tot);
     }
   }
 
-  void tensor::spmatricize(int m, int n, int nrow_idx, bool csr){
+  void tensor::spmatricize(int m, int n, int nrow_idx, bool csr, bool dcsr){
     ASSERT(is_sparse);
 
 #ifdef PROFILE
@@ -2557,34 +2672,58 @@ namespace CTF_int {
     this->rec_tsr->is_sparse = 1;
     int nvirt_A = calc_nvirt();
     this->rec_tsr->nnz_blk = (int64_t*)alloc(nvirt_A*sizeof(int64_t));
+    // row and column indices of each block are at most m and n
+    int coo_idx_width = get_sp_idx_width(std::max(m,n));
+    int phase[this->order];
+    for (int i=0; i<this->order; i++){
+      phase[i] = this->edge_map[i].calc_phase();
+    }
+    // the size of a DCSR block depends on its number of nonempty rows, so these blocks are built ahead of the buffer
+    char ** dcsr_blks = NULL;
+    if (csr && dcsr){
+      dcsr_blks = (char**)alloc(nvirt_A*sizeof(char*));
+      char const * data_ptr_in = this->data;
+      for (int i=0; i<nvirt_A; i++){
+        dcsr_blks[i] = NULL;
+        if (use_dcsr(this->nnz_blk[i], m)){
+          COO_Matrix cm(this->nnz_blk[i], this->sr, coo_idx_width);
+          cm.set_data(this->nnz_blk[i], this->order, this->lens, this->inner_ordering, nrow_idx, data_ptr_in, this->sr, phase, coo_idx_width);
+          dcsr_blks[i] = DCSR_Matrix(cm, m, n).all_data;
+          cdealloc(cm.all_data);
+        }
+        data_ptr_in += this->nnz_blk[i]*this->sr->pair_size();
+      }
+    }
     for (int i=0; i<nvirt_A; i++){
-      if (csr)
-        this->rec_tsr->nnz_blk[i] = get_csr_size(this->nnz_blk[i], m, this->sr->el_size); 
+      if (dcsr_blks != NULL && dcsr_blks[i] != NULL)
+        this->rec_tsr->nnz_blk[i] = DCSR_Matrix(dcsr_blks[i]).size();
+      else if (csr)
+        this->rec_tsr->nnz_blk[i] = get_csr_size(this->nnz_blk[i], m, this->sr->el_size, get_csr_idx_width(this->nnz_blk[i], n)); 
       else
-        this->rec_tsr->nnz_blk[i] = get_coo_size(this->nnz_blk[i], this->sr->el_size); 
+        this->rec_tsr->nnz_blk[i] = get_coo_size(this->nnz_blk[i], this->sr->el_size, coo_idx_width); 
       new_sz_A += this->rec_tsr->nnz_blk[i];
     }
     this->rec_tsr->data = (char*)alloc(new_sz_A);
     this->rec_tsr->is_data_aliased = false;
-    int phase[this->order];
-    for (int i=0; i<this->order; i++){
-      phase[i] = this->edge_map[i].calc_phase();
-    }
     char * data_ptr_out = this->rec_tsr->data;
     char const * data_ptr_in = this->data;
     for (int i=0; i<nvirt_A; i++){
-      if (csr){
-        COO_Matrix cm(this->nnz_blk[i], this->sr);
-        cm.set_data(this->nnz_blk[i], this->order, this->lens, this->inner_ordering, nrow_idx, data_ptr_in, this->sr, phase);
+      if (dcsr_blks != NULL && dcsr_blks[i] != NULL){
+        memcpy(data_ptr_out, dcsr_blks[i], this->rec_tsr->nnz_blk[i]);
+        cdealloc(dcsr_blks[i]);
+      } else if (csr){
+        COO_Matrix cm(this->nnz_blk[i], this->sr, coo_idx_width);
+        cm.set_data(this->nnz_blk[i], this->order, this->lens, this->inner_ordering, nrow_idx, data_ptr_in, this->sr, phase, coo_idx_width);
         CSR_Matrix cs(cm, m, n, this->sr, data_ptr_out);
         cdealloc(cm.all_data);
       } else {
         COO_Matrix cm(data_ptr_out);
-        cm.set_data(this->nnz_blk[i], this->order, this->lens, this->inner_ordering, nrow_idx, data_ptr_in, this->sr, phase);
+        cm.set_data(this->nnz_blk[i], this->order, this->lens, this->inner_ordering, nrow_idx, data_ptr_in, this->sr, phase, coo_idx_width);
       }
       data_ptr_in += this->nnz_blk[i]*this->sr->pair_size();
       data_ptr_out += this->rec_tsr->nnz_blk[i];
     }
+    if (dcsr_blks != NULL) cdealloc(dcsr_blks);
     this->is_csr = csr;
     this->nrow_idx = nrow_idx;
 #ifdef PROFILE
@@ -2786,5 +2925,204 @@ namespace CTF_int {
     }    
   }
 
+  // a checkpoint starts with CKPT_NFIXED words (magic, version, size of header, size of checkpoint, order,
+  // element size, sparsity, number of writing processes, cyclicity), followed by the lengths, symmetry, and the
+  // phase, virtual phase, physical phase, processor stride, padded length and padding of each mode,
+  // then the offset, size in bytes, and local size of the data of each writing process and its processor grid position
+  #define CKPT_MAGIC 0x3154504b43465443LL
+  #define CKPT_VERSION 1
+  #define CKPT_NFIXED 9
+  #define CKPT_NMODE_ARR 8
+
+  static int64_t ckpt_header_words(int order, int np){
+    return CKPT_NFIXED + CKPT_NMODE_ARR*order + ((int64_t)np)*(3+order);
+  }
+
+  int64_t tensor::write_checkpoint(MPI_File & file, int64_t offset){
+    TAU_FSTART(write_checkpoint);
+    ASSERT(is_mapped);
+    if (is_folded) unfold();
+    distribution dist(this);
+    int np = wrld->np;
+    int nent = 3+order;
+    int64_t blk_bytes = is_sparse ? calc_nvirt()*sizeof(int64_t) : 0;
+    int64_t loc_size = is_sparse ? nnz_loc : size;
+    int64_t loc_bytes = blk_bytes + loc_size*(is_sparse ? sr->pair_size() : sr->el_size);
+
+    int64_t nwords = ckpt_header_words(order, np);
+    int64_t * hdr = (int64_t*)alloc(sizeof(int64_t)*nwords);
+    int64_t * mode_arr = hdr + CKPT_NFIXED;
+    int64_t * rank_ent = mode_arr + CKPT_NMODE_ARR*order;
+    int64_t * my_ent = (int64_t*)alloc(sizeof(int64_t)*nent);
+    my_ent[0] = 0;
+    my_ent[1] = loc_bytes;
+    my_ent[2] = loc_size;
+    for (int i=0; i<order; i++){
+      my_ent[3+i] = dist.perank[i];
+    }
+    MPI_Allgather(my_ent, nent, MPI_INT64_T, rank_ent, nent, MPI_INT64_T, wrld->comm);
+    cdealloc(my_ent);
+    int64_t tot_bytes = nwords*sizeof(int64_t);
+    for (int r=0; r<np; r++){
+      rank_ent[r*nent] = tot_bytes;
+      tot_bytes += rank_ent[r*nent+1];
+    }
+    hdr[0] = CKPT_MAGIC;
+    hdr[1] = CKPT_VERSION;
+    hdr[2] = nwords*sizeof(int64_t);
+    hdr[3] = tot_bytes;
+    hdr[4] = order;
+    hdr[5] = sr->el_size;
+    hdr[6] = is_sparse;
+    hdr[7] = np;
+    hdr[8] = dist.is_cyclic;
+    for (int i=0; i<order; i++){
+      mode_arr[i]         = lens[i];
+      mode_arr[order+i]   = sym[i];
+      mode_arr[2*order+i] = dist.phase[i];
+      mode_arr[3*order+i] = dist.virt_phase[i];
+      mode_arr[4*order+i] = dist.phys_phase[i];
+      mode_arr[5*order+i] = dist.pe_lda[i];
+      mode_arr[6*order+i] = dist.pad_edge_len[i];
+      mode_arr[7*order+i] = dist.padding[i];
+    }
+    if (wrld->rank == 0){
+      MPI_Status stat;
+      MPI_File_write_at(file, offset, hdr, nwords*sizeof(int64_t), MPI_CHAR, &stat);
+    }
+    int64_t my_off = offset + rank_ent[wrld->rank*nent];
+    cdealloc(hdr);
+    // each process writes its blocks as stored, sparse blocks preceded by their numbers of nonzeros
+    if (is_sparse){
+      file_io_all(file, my_off, (char*)nnz_blk, blk_bytes, true, wrld->comm);
+      file_io_all(file, my_off+blk_bytes, data, loc_bytes-blk_bytes, true, wrld->comm);
+    } else
+      file_io_all(file, my_off, data, loc_bytes, true, wrld->comm);
+    TAU_FSTOP(write_checkpoint);
+    return tot_bytes;
+  }
+
+  int64_t tensor::read_checkpoint(MPI_File & file, int64_t offset){
+    TAU_FSTART(read_checkpoint);
+    MPI_Status stat;
+    int64_t fixed[CKPT_NFIXED];
+    if (wrld->rank == 0)
+      MPI_File_read_at(file, offset, fixed, sizeof(fixed), MPI_CHAR, &stat);
+    MPI_Bcast(fixed, CKPT_NFIXED, MPI_INT64_T, 0, wrld->comm);
+    bool is_cmpt = fixed[0] == CKPT_MAGIC && fixed[1] == CKPT_VERSION &&
+                   fixed[4] == order && fixed[5] == sr->el_size;
+    int64_t * hdr = NULL;
+    if (is_cmpt){
+      hdr = (int64_t*)alloc(fixed[2]);
+      if (wrld->rank == 0)
+        MPI_File_read_at(file, offset, hdr, fixed[2], MPI_CHAR, &stat);
+      MPI_Bcast(hdr, fixed[2]/sizeof(int64_t), MPI_INT64_T, 0, wrld->comm);
+      for (int i=0; i<order; i++){
+        if (hdr[CKPT_NFIXED+i] != lens[i] || hdr[CKPT_NFIXED+order+i] != sym[i]) is_cmpt = false;
+      }
+    }
+    if (!is_cmpt){
+      if (wrld->rank == 0)
+        printf("CTF ERROR: file holds no checkpoint of a tensor with the lengths, symmetry, and element size of %s at offset %ld\n", name, offset);
+      if (hdr != NULL) cdealloc(hdr);
+      TAU_FSTOP(read_checkpoint);
+      return -1;
+    }
+    if (is_folded) unfold();
+    int wnp = fixed[7];
+    int w_is_sparse = fixed[6];
+    int nent = 3+order;
+    int * mode_arr = (int*)alloc(sizeof(int)*(CKPT_NMODE_ARR-2)*order);
+    for (int i=0; i<(CKPT_NMODE_ARR-2)*order; i++){
+      mode_arr[i] = hdr[CKPT_NFIXED+2*order+i];
+    }
+    int * w_phase        = mode_arr;
+    int * w_virt_phase   = mode_arr+order;
+    int * w_phys_phase   = mode_arr+2*order;
+    int * w_pe_lda       = mode_arr+3*order;
+    int * w_pad_edge_len = mode_arr+4*order;
+    int * w_padding      = mode_arr+5*order;
+    int64_t * rank_ent = hdr+CKPT_NFIXED+CKPT_NMODE_ARR*order;
+
+    // local data can be read as stored if this process has the blocks the process of the same rank wrote
+    distribution dist(this);
+    int is_same_dist = wnp == wrld->np && w_is_sparse == is_sparse && fixed[8] == dist.is_cyclic;
+    if (is_same_dist){
+      int64_t * my_ent = rank_ent+wrld->rank*nent;
+      if (!is_sparse && my_ent[2] != size) is_same_dist = 0;
+      for (int i=0; i<order; i++){
+        if (w_phase[i] != dist.phase[i] || w_virt_phase[i] != dist.virt_phase[i] ||
+            w_phys_phase[i] != dist.phys_phase[i] || w_pe_lda[i] != dist.pe_lda[i] ||
+            w_pad_edge_len[i] != dist.pad_edge_len[i] || w_padding[i] != dist.padding[i] ||
+            my_ent[3+i] != dist.perank[i])
+          is_same_dist = 0;
+      }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &is_same_dist, 1, MPI_INT, MPI_MIN, wrld->comm);
+    if (is_same_dist){
+      int64_t * my_ent = rank_ent+wrld->rank*nent;
+      if (is_sparse){
+        int64_t nvirt = calc_nvirt();
+        int64_t * new_nnz_blk = (int64_t*)alloc(sizeof(int64_t)*nvirt);
+        char * new_pairs = NULL;
+        if (my_ent[2] > 0) new_pairs = (char*)alloc(my_ent[2]*sr->pair_size());
+        file_io_all(file, offset+my_ent[0], (char*)new_nnz_blk, sizeof(int64_t)*nvirt, false, wrld->comm);
+        file_io_all(file, offset+my_ent[0]+sizeof(int64_t)*nvirt, new_pairs, my_ent[2]*sr->pair_size(), false, wrld->comm);
+        if (data != NULL) cdealloc(data);
+        data = new_pairs;
+        set_new_nnz_glb(new_nnz_blk);
+        cdealloc(new_nnz_blk);
+      } else
+        file_io_all(file, offset+my_ent[0], data, my_ent[1], false, wrld->comm);
+    } else {
+      // otherwise each process reads the data written by one process at a time and writes it into the tensor as pairs,
+      // skipping writing processes that held replicated copies
+      set_zero();
+      int w_nvirt = 1;
+      for (int i=0; i<order; i++){
+        w_nvirt *= w_virt_phase[i];
+      }
+      int * w_perank = (int*)alloc(sizeof(int)*order);
+      int nrnd = (wnp+wrld->np-1)/wrld->np;
+      for (int rnd=0; rnd<nrnd; rnd++){
+        int w = rnd*wrld->np + wrld->rank;
+        int64_t nbytes = 0;
+        int64_t * ent = NULL;
+        if (w < wnp){
+          ent = rank_ent+w*nent;
+          int idx_lyr = w;
+          for (int i=0; i<order; i++){
+            w_perank[i] = ent[3+i];
+            idx_lyr -= w_perank[i]*w_pe_lda[i];
+          }
+          if (idx_lyr == 0) nbytes = ent[1];
+        }
+        char * buf = NULL;
+        if (nbytes > 0) buf = (char*)alloc(nbytes);
+        file_io_all(file, nbytes > 0 ? offset+ent[0] : offset, buf, nbytes, false, wrld->comm);
+        int64_t npair = 0;
+        char * pairs = NULL;
+        if (nbytes > 0){
+          if (w_is_sparse){
+            npair = ent[2];
+            pairs = buf+sizeof(int64_t)*w_nvirt;
+          } else
+            read_loc_pairs(order, ent[2], w_nvirt, sym, w_pad_edge_len, w_padding, w_phase, w_phys_phase,
+                           w_virt_phase, w_perank, &npair, buf, &pairs, sr);
+        }
+        this->write(npair, sr->mulid(), sr->addid(), pairs);
+        if (!w_is_sparse && pairs != NULL) cdealloc(pairs);
+        if (buf != NULL) cdealloc(buf);
+      }
+      cdealloc(w_perank);
+      if (is_sparse && !w_is_sparse) this->sparsify();
+    }
+    int64_t tot_bytes = fixed[3];
+    cdealloc(mode_arr);
+    cdealloc(hdr);
+    TAU_FSTOP(read_checkpoint);
+    return tot_bytes;
+  }
+
 }
 
@@ -133,8 +133,12 @@ namespace CTF_int {
       int nrow_idx;
       /** \brief number of local nonzero elements */
       int64_t nnz_loc;
-      /** \brief maximum number of local nonzero elements over all procs*/
+      /** \brief total number of nonzero elements over all procs */
       int64_t nnz_tot;
+      /** \brief maximum number of local nonzero elements over all procs */
+      int64_t nnz_loc_max;
+      /** \brief ratio of nnz_loc_max to the average number of nonzeros per proc owning blocks, measured on the current distribution */
+      double nnz_imb;
       /** \brief nonzero elements in each block owned locally */
       int64_t * nnz_blk;
       
@@ -217,6 +221,21 @@ namespace CTF_int {
        */
       tensor(tensor * other, int const * new_sym);
 
+      /**
+       * \brief takes the data, mapping, and home buffer of other in constant time,
+       *        leaving other empty (as if default-constructed), does not throw so that
+       *        std::vector moves rather than copies tensors when it grows
+       * \param[in,out] other tensor to move from
+       */
+      tensor(tensor && other) noexcept;
+
+      /**
+       * \brief frees this tensor and takes the data, mapping, and home buffer of other in constant time,
+       *        leaving other empty (as if default-constructed)
+       * \param[in,out] other tensor to move from
+       */
+      tensor & operator=(tensor && other);
+
       /**
        * \brief compute the cyclic phase of each tensor dimension
        * \return int * of cyclic phases
@@ -241,6 +260,12 @@ namespace CTF_int {
        */
       int64_t calc_npe() const;
 
+      /**
+       * \brief calculate the fraction of local entries stored by the most loaded process in the current mapping
+       * return average density of the tensor scaled by the measured nonzero imbalance nnz_imb (1 if dense)
+       */
+      double calc_nnz_frac() const;
+
 
       /**
        * \brief sets padding and local size of a tensor given a mapping
@@ -430,6 +455,14 @@ namespace CTF_int {
                   int * const * permutation_B,
                   char const *  beta);
 
+      /**
+       * \brief relabels the indices of each mode by a pseudo-random permutation that depends only on the
+       *        length of the mode and the seed, spreading nonzeros of skewed sparse tensors over processes
+       * \param[in] seed selects the permutations, must be the same on all processes
+       * \param[in] inverse whether to undo a relabeling done with the same seed
+       */
+      int relabel(int64_t seed, bool inverse);
+
       /**
        * \brief reduce tensor to sparse format, storing only nonzero data, or data above a specified threshold.
        *        makes dense tensors sparse.
@@ -683,8 +716,10 @@ namespace CTF_int {
        * \param[in] n number of columns in matrix
        * \param[in] nrow_idx number of indices to fold into column
        * \param[in] csr whether to do csr (1) or coo (0) layout
+       * \param[in] dcsr if csr, whether blocks with few nonzeros per row (see use_dcsr()) may be stored in DCSR layout,
+       *                 which the contraction kernels accept only for the input operands
        */
-      void spmatricize(int m, int n, int nrow_idx, bool csr);
+      void spmatricize(int m, int n, int nrow_idx, bool csr, bool dcsr=false);
 
       /**
        * \brief transposes back local data from sparse matrix format to key-value pair format
@@ -723,6 +758,70 @@ namespace CTF_int {
        */
       void read_dense_from_file(MPI_File & file, int64_t offset=0);
 
+      /**
+       * \brief writes a checkpoint of the tensor, consisting of a header with its lengths, symmetry, sparsity,
+       *        element size, and distribution, followed by the local data of each process as stored
+       *        (packed symmetric blocks and sparse pairs are not unpacked), written with collective I/O
+       * \param[in,out] file stream to write to, the user should open and close it, collective over the World of the tensor
+       * \param[in] offset displacement in bytes at which to start in the file (same on all processes)
+       * \return number of bytes taken by the checkpoint, the offset of a following one should be offset plus this
+       */
+      int64_t write_checkpoint(MPI_File & file, int64_t offset=0);
+
+      /**
+       * \brief reads a checkpoint written by write_checkpoint() into this tensor, which must have the same lengths,
+       *        symmetry, and element size, if it was written by as many processes with the same distribution as
+       *        this tensor has, each process reads its local data directly, otherwise the data of the writing
+       *        processes is read and redistributed a few processes at a time
+       * \param[in] file stream to read from, the user should open and close it, collective over the World of the tensor
+       * \param[in] offset displacement in bytes at which the checkpoint starts in the file (same on all processes)
+       * \return number of bytes taken by the checkpoint, or -1 if the file holds no checkpoint of a compatible tensor at offset
+       */
+      int64_t read_checkpoint(MPI_File & file, int64_t offset=0);
+
+      /**
+       * \brief reads nonzeros from a text file into this tensor (which is overwritten), each process reads a range of lines
+       *        with collective MPI I/O, parses them with threads, and writes them into the tensor in bulk,
+       *        the file may be in MatrixMarket coordinate format (if it starts with a %%MatrixMarket banner,
+       *        in which case the tensor must be a matrix of the given size, general, symmetric, and skew-symmetric
+       *        matrices are read, the latter two are mirrored if the matrix is nonsymmetric), or otherwise
+       *        in FROSTT format (a line per nonzero with order 1-based indices followed by the value),
+       *        lines starting with % or # are skipped, values of tensors with no elements (pattern tensors) are ignored,
+       *        a pattern MatrixMarket file gives values of one
+       * \param[in] fpath path to file, collective over the World of the tensor
+       * \return SUCCESS, or ERROR if the file could not be opened, its header does not match the tensor, or a line could not be parsed
+       */
+      int read_sparse_from_file(char const * fpath);
+
+      /**
+       * \brief writes the nonzeros of this tensor to a text file in FROSTT format or (for matrices) MatrixMarket coordinate
+       *        format, in the order of the data of each process, each process formats its nonzeros with threads
+       *        and writes them with collective MPI I/O
+       * \param[in] fpath path to file, collective over the World of the tensor, the file is replaced if it exists
+       * \param[in] mtx whether to write a MatrixMarket file (only for matrices), symmetric matrices are written
+       *                as symmetric or skew-symmetric ones, otherwise the FROSTT format is used
+       * \return SUCCESS, or ERROR if the file could not be opened
+       */
+      int write_sparse_to_file(char const * fpath, bool mtx=false);
+
+      /**
+       * \brief reads nonzeros from a binary coordinate file written by write_sparse_to_binary_file() into this tensor
+       *        (which is overwritten and must have the same lengths and element size), each process reads
+       *        a range of the nonzeros with collective MPI I/O
+       * \param[in] fpath path to file, collective over the World of the tensor
+       * \return SUCCESS, or ERROR if the file could not be opened or does not hold a tensor like this one
+       */
+      int read_sparse_from_binary_file(char const * fpath);
+
+      /**
+       * \brief writes the nonzeros of this tensor to a binary coordinate file, consisting of a header with
+       *        the order, element size, number of nonzeros, and lengths, followed by a record per nonzero
+       *        of order 0-based 64-bit indices and the value
+       * \param[in] fpath path to file, collective over the World of the tensor, the file is replaced if it exists
+       * \return SUCCESS, or ERROR if the file could not be opened
+       */
+      int write_sparse_to_binary_file(char const * fpath);
+
 
   };
 }
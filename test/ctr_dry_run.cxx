@@ -0,0 +1,110 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup ctr_dry_run ctr_dry_run
+  * @{
+  * \brief Checks that dry runs of contractions predict a cost without touching the tensors
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+int ctr_dry_run(int     n,
+                World & dw){
+  int pass = 1;
+  int lens[] = {n, n, n};
+  int shape_ns[] = {NS, NS, NS};
+  int shape_sy[] = {SY, NS, NS};
+
+  Tensor<> A(3, lens, shape_sy, dw);
+  Matrix<> B(n, n, NS, dw);
+  Tensor<> C(3, lens, shape_ns, dw);
+  Matrix<> S(n, n, SP, dw);
+  Matrix<> D(n, n, NS, dw);
+
+  A.fill_random(-1.,1.);
+  B.fill_random(-1.,1.);
+  S.fill_sp_random(-1.,1.,.2);
+
+  // the symmetry of A is broken by this contraction, so it is unfolded as part of the dry run
+  char * data_A = A.data;
+  char * data_B = B.data;
+  int64_t size_A = A.size;
+  int64_t size_B = B.size;
+  double norm_A = A.norm2();
+  Cost_estimate est = C.dry_run(A, "ijk", B, "kl", "ijl");
+  pass = pass && est.time > 0. && est.comp_time >= 0. && est.comm_time >= 0. && est.redist_time >= 0. && est.mem >= 0;
+  pass = pass && std::abs(est.time - (est.comp_time+est.comm_time+est.redist_time)) <= 1.E-12*est.time;
+  pass = pass && A.data == data_A && A.size == size_A && B.data == data_B && B.size == size_B;
+  pass = pass && std::abs(A.norm2() - norm_A) <= 1.E-12*norm_A;
+  pass = pass && C.estimate_time(A, "ijk", B, "kl", "ijl") == est.time;
+
+  // the contraction itself is unaffected by the dry run
+  Tensor<> C0(3, lens, shape_ns, dw);
+  Tensor<> A0(3, lens, shape_ns, dw);
+  A0["ijk"] = A["ijk"];
+  C0["ijl"] = A0["ijk"]*B["kl"];
+  C["ijl"] = A["ijk"]*B["kl"];
+  C["ijl"] -= C0["ijl"];
+  pass = pass && C.norm2() <= 1.E-10*n*n*n;
+
+  // sparse operand
+  int64_t nnz_S = S.nnz_tot;
+  est = D.dry_run(B, "ij", S, "jk", "ik");
+  pass = pass && est.time > 0. && S.nnz_tot == nnz_S;
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ C[\"ijl\"] = A[\"ijk\"]*B[\"kl\"] dry run } passed \n");
+    else
+      printf("{ C[\"ijl\"] = A[\"ijk\"]*B[\"kl\"] dry run } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 7;
+  } else n = 7;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking dry runs of contractions with n = %d\n", n);
+    }
+    pass = ctr_dry_run(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
@@ -0,0 +1,115 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup ctr_order ctr_order
+  * @{
+  * \brief Checks that contraction terms of many tensors are evaluated in a cheap order and give the right result
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+int ctr_order(int     n,
+              World & dw){
+  int pass = 1;
+
+  Matrix<> A(n, n, NS, dw);
+  Matrix<> B(n, n, NS, dw);
+  Matrix<> C(n, n, NS, dw);
+  Matrix<> E(n, n, NS, dw);
+  Vector<> v(n, dw);
+  Vector<> u(n, dw);
+  Vector<> w(n, dw);
+  Vector<> w0(n, dw);
+
+  A.fill_random(-1.,1.);
+  B.fill_random(-1.,1.);
+  C.fill_random(-1.,1.);
+  E.fill_random(-1.,1.);
+  v.fill_random(-1.,1.);
+
+  // as written, the rightmost pair B*C would be contracted first, costing n^3
+  std::vector< std::pair<int,int> > order = (v["i"]*A["ij"]*B["jk"]*C["kl"]).get_contraction_order(w["l"]);
+  pass = pass && order.size() == 3 && order[0] == std::pair<int,int>(0,1);
+  // pricing pairs by contraction::estimate_time() rather than by their flop count should agree
+  int est_max = CTR_ORDER_EST_MAX;
+  CTR_ORDER_EST_MAX = 4;
+  order = (v["i"]*A["ij"]*B["jk"]*C["kl"]).get_contraction_order(w["l"]);
+  pass = pass && order.size() == 3 && order[0] == std::pair<int,int>(0,1);
+  CTR_ORDER_EST_MAX = est_max;
+
+  u["j"] = v["i"]*A["ij"];
+  w0["k"] = u["j"]*B["jk"];
+  u["l"] = w0["k"]*C["kl"];
+  w0["l"] = 2.*u["l"];
+
+  w["l"] = 2.*v["i"]*A["ij"]*B["jk"]*C["kl"];
+  w["l"] -= w0["l"];
+  pass = pass && w.norm2() <= 1.E-10*n*n;
+
+  // also check the greedy ordering on a longer chain
+  int dp_max = CTR_ORDER_DP_MAX;
+  CTR_ORDER_DP_MAX = 2;
+  order = (v["i"]*A["ij"]*B["jk"]*C["kl"]*E["lm"]).get_contraction_order(w["m"]);
+  pass = pass && order.size() == 4 && order[0] == std::pair<int,int>(0,1);
+  w["m"] = v["i"]*A["ij"]*B["jk"]*C["kl"]*E["lm"];
+  w0["m"] = .5*w0["l"]*E["lm"];
+  w["m"] -= w0["m"];
+  pass = pass && w.norm2() <= 1.E-10*n*n;
+  CTR_ORDER_DP_MAX = dp_max;
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ w[\"l\"] = v[\"i\"]*A[\"ij\"]*B[\"jk\"]*C[\"kl\"] contracted left to right } passed \n");
+    else
+      printf("{ w[\"l\"] = v[\"i\"]*A[\"ij\"]*B[\"jk\"]*C[\"kl\"] contracted left to right } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 7;
+  } else n = 7;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking ordering of multi-tensor contractions with n = %d\n", n);
+    }
+    pass = ctr_order(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
@@ -0,0 +1,123 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup ctr_plan_cache ctr_plan_cache
+  * @{
+  * \brief Checks that repeated contractions reuse cached mappings and give the same result
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+int ctr_plan_cache(int     n,
+                   World & dw){
+  int lens[] = {n, n, n, n};
+  int shape[] = {NS, NS, NS, NS};
+
+  Tensor<> A(4, lens, shape, dw);
+  Tensor<> B(4, lens, shape, dw);
+  Tensor<> C(4, lens, shape, dw);
+  Tensor<> C0(4, lens, shape, dw);
+
+  A.fill_random(-1.,1.);
+  B.fill_random(-1.,1.);
+
+  C0["ijkl"] = A["ijmn"]*B["mnkl"];
+
+  Plan_cache_stats st0 = get_ctr_plan_cache_stats();
+  int niter = 4;
+  double max_err = 0.;
+  for (int it=0; it<niter; it++){
+    C["ijkl"] = A["ijmn"]*B["mnkl"];
+    C["ijkl"] += (-1.)*C0["ijkl"];
+    max_err = std::max(max_err, C.norm2());
+  }
+  Plan_cache_stats st1 = get_ctr_plan_cache_stats();
+
+  // every iteration repeats the contractions of the first, so later ones should hit
+  int pass = (st1.hits-st0.hits >= niter-1) && (max_err <= 1.E-10*n*n);
+
+  // contractions on a subworld that only some processes belong to must not evict plans of dw,
+  // otherwise the next contraction on dw would hit on some processes and miss on others
+  CTR_PLAN_CACHE_SIZE = 1;
+  C["ijkl"] = A["ijmn"]*B["mnkl"];
+  MPI_Comm sub_comm;
+  MPI_Comm_split(dw.comm, dw.rank%2, dw.rank, &sub_comm);
+  {
+    World sw(sub_comm);
+    if (dw.rank%2 == 0){
+      Matrix<> M(n, n, sw);
+      Matrix<> N(n, n, sw);
+      M.fill_random(-1.,1.);
+      N["ij"] = M["ik"]*M["kj"];
+    }
+  }
+  MPI_Comm_free(&sub_comm);
+  Plan_cache_stats st2 = get_ctr_plan_cache_stats();
+  C["ijkl"] = A["ijmn"]*B["mnkl"];
+  Plan_cache_stats st3 = get_ctr_plan_cache_stats();
+  pass = pass && (st3.hits == st2.hits+1);
+  C["ijkl"] += (-1.)*C0["ijkl"];
+  pass = pass && (C.norm2() <= 1.E-10*n*n);
+
+  CTR_PLAN_CACHE_SIZE = 0;
+  C["ijkl"] = A["ijmn"]*B["mnkl"];
+  C["ijkl"] += (-1.)*C0["ijkl"];
+  pass = pass && (C.norm2() <= 1.E-10*n*n);
+  CTR_PLAN_CACHE_SIZE = 1024;
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ repeated C[\"ijkl\"] = A[\"ijmn\"]*B[\"mnkl\"] reuses cached mapping } passed \n");
+    else
+      printf("{ repeated C[\"ijkl\"] = A[\"ijmn\"]*B[\"mnkl\"] reuses cached mapping } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 7;
+  } else n = 7;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking contraction mapping cache with n = %d\n", n);
+    }
+    pass = ctr_plan_cache(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
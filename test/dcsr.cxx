@@ -0,0 +1,129 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup dcsr dcsr
+  * @{
+  * \brief Checks contractions of hypersparse matrices, whose local blocks are stored in DCSR layout
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+int dcsr(int     n,
+         World & dw){
+  int pass = 1;
+  double max_nnz_per_row = CTF::SP_DCSR_MAX_NNZ_PER_ROW;
+
+  int m = 5*n+7, k = 3*n+2, nn = n+2;
+  Function<> fmul([](double a, double b){ return a*b; });
+
+  // CSR only, DCSR for hypersparse blocks, and DCSR for all blocks
+  double ratios[3] = {0., max_nnz_per_row, (double)INT_MAX};
+  for (int ir=0; ir<3; ir++){
+    CTF::SP_DCSR_MAX_NNZ_PER_ROW = ratios[ir];
+
+    Matrix<> SA(m, k, SP, dw);
+    Matrix<> SB(k, nn, SP, dw);
+    Matrix<> B(k, nn, dw);
+    srand48(dw.rank*11+ir);
+    SA.fill_sp_random(1., 2., .04);
+    SB.fill_sp_random(1., 2., .1);
+    B.fill_random(1., 2.);
+
+    std::vector<double> all_A(m*k), all_SB(k*nn), all_B(k*nn);
+    SA.read_all(all_A.data());
+    SB.read_all(all_SB.data());
+    B.read_all(all_B.data());
+
+    Matrix<> DC(m, nn, dw);
+    Matrix<> SC(m, nn, SP, dw);
+    Matrix<> FC(m, nn, dw);
+    Matrix<> TC(nn, m, dw);
+    Matrix<> SFC(m, nn, SP, dw);
+    DC["ij"] = SA["ik"]*SB["kj"];
+    SC["ij"] = SA["ik"]*SB["kj"];
+    SC["ij"] += SA["ik"]*SB["kj"];
+    FC["ij"] = fmul(SA["ik"],B["kj"]);
+    TC["ji"] = SB["kj"]*SA["ik"];
+    SFC["ij"] = fmul(SA["ik"],SB["kj"]);
+
+    std::vector<double> all_A2(m*k), all_DC(m*nn), all_SC(m*nn), all_FC(m*nn), all_TC(m*nn), all_SFC(m*nn);
+    SA.read_all(all_A2.data());
+    DC.read_all(all_DC.data());
+    SC.read_all(all_SC.data());
+    FC.read_all(all_FC.data());
+    TC.read_all(all_TC.data());
+    SFC.read_all(all_SFC.data());
+    for (int i=0; i<m*k; i++){
+      pass = pass && all_A[i] == all_A2[i];
+    }
+    for (int j=0; j<nn; j++){
+      for (int i=0; i<m; i++){
+        double dc = 0., fc = 0.;
+        for (int l=0; l<k; l++){
+          dc += all_A[l*m+i]*all_SB[j*k+l];
+          fc += all_A[l*m+i]*all_B[j*k+l];
+        }
+        int ij = j*m+i;
+        pass = pass && fabs(all_DC[ij]-dc) < 1.E-10 && fabs(all_SC[ij]-2.*dc) < 1.E-10 && fabs(all_SFC[ij]-dc) < 1.E-10;
+        pass = pass && fabs(all_FC[ij]-fc) < 1.E-10 && fabs(all_TC[i*nn+j]-dc) < 1.E-10;
+      }
+    }
+  }
+  CTF::SP_DCSR_MAX_NNZ_PER_ROW = max_nnz_per_row;
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ C[\"ij\"] = A[\"ik\"]*B[\"kj\"] with hypersparse A in DCSR layout } passed \n");
+    else
+      printf("{ C[\"ij\"] = A[\"ik\"]*B[\"kj\"] with hypersparse A in DCSR layout } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 9;
+  } else n = 9;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking contractions of hypersparse matrices with n = %d\n", n);
+    }
+    pass = dcsr(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
@@ -0,0 +1,139 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup intm_pool intm_pool
+  * @{
+  * \brief Checks that repeatedly evaluated expressions reuse pooled intermediates and give the same results as fresh ones
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+int intm_pool(int     n,
+              World & dw){
+  Matrix<> A(n, n+1, NS, dw);
+  Matrix<> B(n+1, n+2, NS, dw);
+  Matrix<> D(n+2, n, NS, dw);
+  Matrix<> E(n, n, NS, dw);
+  Matrix<> F(n, n, SY, dw);
+  Matrix<> C(n, n, NS, dw);
+  Matrix<> G(n, n, NS, dw);
+  Matrix<> C0(n, n, NS, dw);
+  Matrix<> G0(n, n, NS, dw);
+
+  A.fill_random(-1.,1.);
+  B.fill_random(-1.,1.);
+  D.fill_random(-1.,1.);
+  E.fill_random(-1.,1.);
+  F.fill_random(-1.,1.);
+
+  clear_intm_pool();
+  int64_t intm_pool_size = INTM_POOL_SIZE;
+  INTM_POOL_SIZE = 0;
+  C0["ij"] = A["ik"]*B["kl"]*D["lj"];
+  G0["ij"] = E["ij"]+F["ij"]+2.*(E["ik"]*F["kj"]);
+  Plan_cache_stats st0 = get_intm_pool_stats();
+  INTM_POOL_SIZE = intm_pool_size;
+  int pass = st0.size == 0;
+
+  int niter = 4;
+  double max_err = 0.;
+  Plan_cache_stats st1 = st0;
+  for (int it=0; it<niter; it++){
+    C["ij"] = A["ik"]*B["kl"]*D["lj"];
+    G["ij"] = E["ij"]+F["ij"]+2.*(E["ik"]*F["kj"]);
+    C["ij"] -= C0["ij"];
+    G["ij"] -= G0["ij"];
+    max_err = std::max(max_err, C.norm2());
+    max_err = std::max(max_err, G.norm2());
+    if (it == 0) st1 = get_intm_pool_stats();
+  }
+  Plan_cache_stats st2 = get_intm_pool_stats();
+
+  // intermediates of the first iteration are pooled, so later iterations should take them rather than create new ones
+  pass = pass && st1.size > 0;
+  pass = pass && (st2.misses == st1.misses) && (st2.hits-st1.hits >= (niter-1)*(st1.misses-st0.misses));
+  pass = pass && (max_err <= 1.E-10*n*n);
+
+  // an intermediate left holding non-finite values is zeroed before it is reused
+  Matrix<> Einf(n, n, NS, dw);
+  Einf["ij"] = std::numeric_limits<double>::infinity();
+  G["ij"] = E["ij"]+F["ij"]+2.*(Einf["ik"]*F["kj"]);
+  G["ij"] = E["ij"]+F["ij"]+2.*(E["ik"]*F["kj"]);
+  G["ij"] -= G0["ij"];
+  pass = pass && (G.norm2() <= 1.E-10*n*n);
+
+  // intermediates of other element types with the same size are not reused
+  Matrix<int64_t> I(n, n, NS, dw);
+  Matrix<int64_t> J(n, n, NS, dw);
+  I["ij"] = 1;
+  Plan_cache_stats st3 = get_intm_pool_stats();
+  J["ij"] = I["ik"]*I["kl"]*I["lj"];
+  Plan_cache_stats st4 = get_intm_pool_stats();
+  pass = pass && st4.hits == st3.hits && J.norm1() == (int64_t)n*n*n*n;
+
+  // a budget too small for any intermediate keeps nothing
+  clear_intm_pool();
+  INTM_POOL_SIZE = 1;
+  C["ij"] = A["ik"]*B["kl"]*D["lj"];
+  pass = pass && get_intm_pool_stats().size == 0;
+  INTM_POOL_SIZE = intm_pool_size;
+
+  clear_intm_pool();
+  pass = pass && get_intm_pool_stats().size == 0;
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ repeated evaluations of C[\"ij\"] = A[\"ik\"]*B[\"kl\"]*D[\"lj\"] reuse pooled intermediates } passed \n");
+    else
+      printf("{ repeated evaluations of C[\"ij\"] = A[\"ik\"]*B[\"kl\"]*D[\"lj\"] reuse pooled intermediates } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 7;
+  } else n = 7;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking pool of intermediate tensors with n = %d\n", n);
+    }
+    pass = intm_pool(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
@@ -0,0 +1,142 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup masked_spgemm masked_spgemm
+  * @{
+  * \brief Checks sparse matrix products computed only at the nonzeros of a mask
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+int masked_spgemm(int     n,
+                  World & dw){
+  int pass = 1;
+
+  int m = 5*n+7, k = 3*n+2, nn = 2*n+3;
+
+  Matrix<> SA(m, k, SP, dw);
+  Matrix<> A(m, k, dw);
+  Matrix<> SB(k, nn, SP, dw);
+  Matrix<> B(k, nn, dw);
+  Matrix<> M(m, nn, SP, dw);
+  Matrix<> MT(nn, m, SP, dw);
+  srand48(dw.rank*13);
+  SA.fill_sp_random(1., 2., .1);
+  SB.fill_sp_random(1., 2., .2);
+  B.fill_random(1., 2.);
+  M.fill_sp_random(1., 2., .2);
+  MT["ji"] = M["ij"];
+  A["ik"] = SA["ik"];
+
+  Matrix<> SC(m, nn, SP, dw);
+  Matrix<> DC(m, nn, dw);
+  Matrix<> FC(m, nn, dw);
+  Matrix<> TC(m, nn, SP, dw);
+  Matrix<> AC(m, nn, dw);
+  Matrix<> D(m, nn, dw);
+  Matrix<> OC(m, nn, dw);
+  Matrix<> QC(m, nn, dw);
+  DC.fill_random(1., 2.);
+  D.fill_random(1., 2.);
+  std::vector<double> all_DC0(m*nn);
+  DC.read_all(all_DC0.data());
+
+  SC["ij"] = (SA["ik"]*SB["kj"]).masked(M["ij"]);
+  DC["ij"] += (SA["ik"]*SB["kj"]).masked(M["ij"]);
+  FC["ij"] = (SA["ik"]*B["kj"]).masked(M["ij"]);
+  TC["ij"] = (SA["ik"]*SB["kj"]).masked(MT["ji"]);
+  AC.masked_contract(2., SA, "ik", SB, "kj", 0., "ij", M, "ij");
+  // a single operand left after folding the scalar, and a scalar last product, must both keep the mask
+  OC["ij"] = (2.*D["ij"]).masked(M["ij"]);
+  QC["ij"] = D["ij"] + (2.*(A["ik"]*B["kj"])).masked(M["ij"]);
+
+  std::vector<double> all_A(m*k), all_SB(k*nn), all_B(k*nn), all_M(m*nn), all_D(m*nn), all_OC(m*nn), all_QC(m*nn);
+  D.read_all(all_D.data());
+  OC.read_all(all_OC.data());
+  QC.read_all(all_QC.data());
+  SA.read_all(all_A.data());
+  SB.read_all(all_SB.data());
+  B.read_all(all_B.data());
+  M.read_all(all_M.data());
+  std::vector<double> all_SC(m*nn), all_DC(m*nn), all_FC(m*nn), all_TC(m*nn), all_AC(m*nn);
+  SC.read_all(all_SC.data());
+  DC.read_all(all_DC.data());
+  FC.read_all(all_FC.data());
+  TC.read_all(all_TC.data());
+  AC.read_all(all_AC.data());
+
+  // the sparse output stores no more than the entries of the mask
+  pass = pass && SC.nnz_tot <= M.nnz_tot && TC.nnz_tot <= M.nnz_tot;
+  for (int j=0; j<nn; j++){
+    for (int i=0; i<m; i++){
+      int ij = j*m+i;
+      double sc = 0., fc = 0.;
+      if (all_M[ij] != 0.){
+        for (int l=0; l<k; l++){
+          sc += all_A[l*m+i]*all_SB[j*k+l];
+          fc += all_A[l*m+i]*all_B[j*k+l];
+        }
+      }
+      pass = pass && fabs(all_SC[ij]-sc) < 1.E-10 && fabs(all_DC[ij]-all_DC0[ij]-sc) < 1.E-10;
+      pass = pass && fabs(all_FC[ij]-fc) < 1.E-10 && fabs(all_TC[ij]-sc) < 1.E-10 && fabs(all_AC[ij]-2.*sc) < 1.E-10;
+      double oc = all_M[ij] != 0. ? 2.*all_D[ij] : 0.;
+      pass = pass && fabs(all_OC[ij]-oc) < 1.E-10 && fabs(all_QC[ij]-all_D[ij]-2.*fc) < 1.E-10;
+    }
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ C[\"ij\"] = (A[\"ik\"]*B[\"kj\"]).masked(M[\"ij\"]) } passed \n");
+    else
+      printf("{ C[\"ij\"] = (A[\"ik\"]*B[\"kj\"]).masked(M[\"ij\"]) } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 9;
+  } else n = 9;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking masked sparse matrix products with n = %d\n", n);
+    }
+    pass = masked_spgemm(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
@@ -0,0 +1,182 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup mst_arena mst_arena
+  * @{
+  * \brief Checks that temporary buffers allocated from the arena are reused, may be freed in any order and by any thread
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+int mst_arena(int     n,
+              World & dw){
+  int pass = 1;
+
+  int64_t sizes[] = {0, 1, 63, 64, 65, 1000, 4096, 100000, 300000, 3000000};
+  int nsizes = sizeof(sizes)/sizeof(int64_t);
+  int nbuf = 4*nsizes;
+  std::vector<char*> bufs(nbuf);
+
+  Mst_stats st0 = get_mst_stats();
+  int64_t reserved = 0;
+  for (int r=0; r<3; r++){
+    for (int i=0; i<nbuf; i++){
+      bufs[i] = (char*)CTF_int::mst_alloc(sizes[i%nsizes]);
+      pass = pass && ((int64_t)bufs[i])%16 == 0;
+      memset(bufs[i], i, sizes[i%nsizes]);
+    }
+    // free in an order unrelated to allocation, checking no buffer overlapped another
+    for (int j=0; j<nbuf; j++){
+      int i = (j*7+r)%nbuf;
+      for (int64_t k=0; k<sizes[i%nsizes]; k++){
+        pass = pass && bufs[i][k] == (char)i;
+      }
+      CTF_int::cdealloc(bufs[i]);
+    }
+    // later rounds reuse the blocks of the first
+    if (r == 0) reserved = get_mst_stats().bytes_reserved;
+    if (r == 1) release_mst();
+  }
+  Mst_stats st1 = get_mst_stats();
+  pass = pass && st1.bytes_reserved == reserved;
+  pass = pass && st1.bytes_in_use == st0.bytes_in_use;
+  pass = pass && (st1.allocs-st0.allocs)+(st1.fallbacks-st0.fallbacks) == 3*nbuf;
+  pass = pass && st1.frees-st0.frees == st1.allocs-st0.allocs;
+  pass = pass && (st1.arena_size == 0 || st1.fallbacks == st0.fallbacks);
+
+  // buffers larger than MST_MAX_BLOCK_SIZE bypass the arena
+  int64_t max_block_size = MST_MAX_BLOCK_SIZE;
+  MST_MAX_BLOCK_SIZE = 1000;
+  char * big = (char*)CTF_int::mst_alloc(4096);
+  MST_MAX_BLOCK_SIZE = max_block_size;
+  memset(big, 1, 4096);
+  CTF_int::cdealloc(big);
+  Mst_stats st2 = get_mst_stats();
+  pass = pass && st2.fallbacks == st1.fallbacks+1 && st2.allocs == st1.allocs;
+
+  // past MST_CACHE_SIZE, pages of freed large buffers are returned to the operating system
+  if (st2.arena_size > 0){
+    int64_t cache_size = MST_CACHE_SIZE;
+    MST_CACHE_SIZE = 0;
+    char * lbuf = (char*)CTF_int::mst_alloc(3000000);
+    memset(lbuf, 1, 3000000);
+    int64_t committed = get_mst_stats().bytes_committed;
+    CTF_int::cdealloc(lbuf);
+    pass = pass && get_mst_stats().bytes_committed < committed;
+    // the buffer is reused whether or not its pages were returned
+    lbuf = (char*)CTF_int::mst_alloc(3000000);
+    pass = pass && get_mst_stats().bytes_committed <= committed && get_mst_stats().bytes_reserved == st2.bytes_reserved;
+    memset(lbuf, 2, 3000000);
+    CTF_int::cdealloc(lbuf);
+    MST_CACHE_SIZE = cache_size;
+    pass = pass && get_mst_stats().bytes_committed <= get_mst_stats().bytes_reserved;
+  }
+
+  // buffers allocated by one thread may be freed by another
+  int nthr_buf = 64*nsizes;
+  std::vector<char*> tbufs(nthr_buf);
+  int tpass = 1;
+  #pragma omp parallel for schedule(static,1)
+  for (int i=0; i<nthr_buf; i++){
+    tbufs[i] = (char*)CTF_int::mst_alloc(sizes[i%nsizes]);
+    memset(tbufs[i], i, sizes[i%nsizes]);
+  }
+  #pragma omp parallel for schedule(static) reduction(min:tpass)
+  for (int i=0; i<nthr_buf; i++){
+    for (int64_t k=0; k<sizes[i%nsizes]; k++){
+      if (tbufs[i][k] != (char)i) tpass = 0;
+    }
+    CTF_int::cdealloc(tbufs[i]);
+  }
+  pass = pass && tpass;
+  pass = pass && get_mst_stats().bytes_in_use == st0.bytes_in_use;
+
+  // with more than one process, SUMMA and redistribution buffers come from the arena
+  Matrix<> A(n, n+1, dw);
+  Matrix<> B(n+1, n+2, dw);
+  Matrix<> C(n, n+2, dw);
+  A.fill_random(-1.,1.);
+  B.fill_random(-1.,1.);
+  Mst_stats st3 = get_mst_stats();
+  C["ij"] = A["ik"]*B["kj"];
+  Mst_stats st4 = get_mst_stats();
+  if (dw.np > 1)
+    pass = pass && (st4.allocs-st3.allocs)+(st4.fallbacks-st3.fallbacks) > 0;
+
+  double * a = (double*)malloc(sizeof(double)*n*(n+1));
+  double * b = (double*)malloc(sizeof(double)*(n+1)*(n+2));
+  double * c = (double*)malloc(sizeof(double)*n*(n+2));
+  A.read_all(a);
+  B.read_all(b);
+  C.read_all(c);
+  double err = 0.;
+  for (int i=0; i<n; i++){
+    for (int j=0; j<n+2; j++){
+      double v = 0.;
+      for (int k=0; k<n+1; k++){
+        v += a[i+k*n]*b[k+j*(n+1)];
+      }
+      err = std::max(err, std::abs(v-c[i+j*n]));
+    }
+  }
+  pass = pass && err <= 1.E-10*n;
+  free(a);
+  free(b);
+  free(c);
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ temporary buffers are recycled by the arena } passed \n");
+    else
+      printf("{ temporary buffers are recycled by the arena } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 7;
+  } else n = 7;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking arena of temporary buffers with n = %d\n", n);
+    }
+    pass = mst_arena(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
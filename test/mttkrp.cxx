@@ -0,0 +1,142 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup mttkrp mttkrp
+  * @{
+  * \brief Checks products of sparse tensors of order at least three with a dense matrix along all but one of their modes (MTTKRP)
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+/** \brief checks that A and B have the same entries */
+template <typename dtype>
+int check_equal(Tensor<dtype> & A, Tensor<dtype> & B){
+  int64_t nA, nB;
+  dtype * all_A, * all_B;
+  A.read_all(&nA, &all_A);
+  B.read_all(&nB, &all_B);
+  int pass = nA == nB;
+  for (int64_t i=0; pass && i<nA; i++){
+    pass = all_A[i] == all_B[i] || fabs(all_A[i]-all_B[i]) <= 1.E-10*(1.+fabs(all_B[i]));
+  }
+  free(all_A);
+  free(all_B);
+  return pass;
+}
+
+template <typename dtype>
+int check_mttkrp(int n, World & dw, Set<dtype> const & sr){
+  int pass = 1;
+  int R = 4;
+  int lens3[] = {n+1, n+2, n+3};
+  int lens4[] = {n+1, 3, n+2, 2};
+  int nsym[] = {NS, NS, NS, NS};
+
+  Tensor<dtype> T(3, true, lens3, nsym, dw, sr);
+  Tensor<dtype> DT(3, lens3, nsym, dw, sr);
+  T.fill_sp_random(1., 2., .2);
+  DT["ijk"] = T["ijk"];
+  Matrix<dtype> A(n+1, R, dw, sr);
+  Matrix<dtype> Bt(R, n+2, dw, sr);
+  Matrix<dtype> C(n+3, R, dw, sr);
+  A.fill_random(1., 2.);
+  Bt.fill_random(1., 2.);
+  C.fill_random(1., 2.);
+
+  // output along each mode, with the rank index first or second in the output and in the other matrices
+  Matrix<dtype> M0(n+1, R, dw, sr), RM0(n+1, R, dw, sr);
+  M0["ir"] = T["ijk"]*Bt["rj"]*C["kr"];
+  RM0["ir"] = DT["ijk"]*Bt["rj"]*C["kr"];
+  pass = pass && check_equal(M0, RM0);
+
+  Matrix<dtype> M1(R, n+2, dw, sr), RM1(R, n+2, dw, sr);
+  M1.fill_random(1., 2.);
+  RM1["rj"] = M1["rj"];
+  M1["rj"] += C["kr"]*T["ijk"]*A["ir"];
+  RM1["rj"] += C["kr"]*DT["ijk"]*A["ir"];
+  pass = pass && check_equal(M1, RM1);
+
+  Matrix<dtype> M2(n+3, R, dw, sr), RM2(n+3, R, dw, sr);
+  M2.fill_random(1., 2.);
+  RM2["kr"] = M2["kr"];
+  M2["kr"] = 2.*T["ijk"]*A["ir"]*Bt["rj"];
+  RM2["kr"] = 2.*DT["ijk"]*A["ir"]*Bt["rj"];
+  pass = pass && check_equal(M2, RM2);
+
+  Tensor<dtype> T4(4, true, lens4, nsym, dw, sr);
+  Tensor<dtype> DT4(4, lens4, nsym, dw, sr);
+  T4.fill_sp_random(1., 2., .2);
+  DT4["ijkl"] = T4["ijkl"];
+  Matrix<dtype> D(3, R, dw, sr);
+  Matrix<dtype> E(R, 2, dw, sr);
+  D.fill_random(1., 2.);
+  E.fill_random(1., 2.);
+  Matrix<dtype> M3(n+2, R, dw, sr), RM3(n+2, R, dw, sr);
+  M3["kr"] = T4["ijkl"]*A["ir"]*D["jr"]*E["rl"];
+  RM3["kr"] = DT4["ijkl"]*A["ir"]*D["jr"]*E["rl"];
+  pass = pass && check_equal(M3, RM3);
+
+  return pass;
+}
+
+int mttkrp(int     n,
+           World & dw){
+  int pass = check_mttkrp<double>(n, dw, Ring<double>());
+  pass = pass && check_mttkrp<double>(n, dw, MinPlus<double>());
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ M[\"ir\"] = T[\"ijk\"]*A[\"jr\"]*B[\"kr\"] with sparse T } passed \n");
+    else
+      printf("{ M[\"ir\"] = T[\"ijk\"]*A[\"jr\"]*B[\"kr\"] with sparse T } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 9;
+  } else n = 9;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking MTTKRP of sparse tensors with n = %d\n", n);
+    }
+    pass = mttkrp(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
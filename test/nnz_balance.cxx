@@ -0,0 +1,129 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup nnz_balance nnz_balance
+  * @{
+  * \brief Checks that relabeling the modes of a skewed sparse matrix balances its nonzeros and preserves products
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+int nnz_balance(int     n,
+                World & dw){
+  int pass = 1;
+
+  int m = 12*(n+2), k = 12*(n+1), nn = n+3;
+
+  // all nonzeros of SA are in rows and columns that are multiples of 12, so they pile onto one process
+  Matrix<> SA(m, k, SP, dw);
+  std::vector<int64_t> keys;
+  std::vector<double> vals;
+  for (int l=0; l<k; l+=12){
+    for (int i=0; i<m; i+=12){
+      if ((i*7+l*3)%5 != 0){
+        keys.push_back(i+(int64_t)l*m);
+        vals.push_back(1.+(i+l)%7);
+      }
+    }
+  }
+  int64_t nnz_A = keys.size();
+  SA.write(dw.rank == 0 ? nnz_A : 0, keys.data(), vals.data());
+
+  Matrix<> SB(k, nn, SP, dw);
+  Matrix<> B(k, nn, dw);
+  srand48(dw.rank*13);
+  SB.fill_sp_random(1., 2., .2);
+  B.fill_random(1., 2.);
+
+  Matrix<> SA0(SA), SB0(SB), B0(B);
+  Matrix<> C0(m, nn, SP, dw);
+  Matrix<> DC0(m, nn, dw);
+  C0["ij"] = SA["ik"]*SB["kj"];
+  DC0["ij"] = SA["ik"]*B["kj"];
+
+  int64_t nnz_max = SA.nnz_loc_max;
+  pass = pass && SA.nnz_tot == nnz_A && nnz_max <= nnz_A && nnz_max*dw.np >= nnz_A;
+
+  SA.relabel(5);
+  SB.relabel(5);
+  B.relabel(5);
+  // the nonzeros are no longer all on one process, unless the matrix is mapped to one process
+  if (nnz_max == SA.nnz_tot && SA.calc_npe() > 1)
+    pass = pass && SA.nnz_loc_max < nnz_max;
+  pass = pass && SA.nnz_imb >= 1.;
+
+  Matrix<> C(m, nn, SP, dw);
+  Matrix<> DC(m, nn, dw);
+  C["ij"] = SA["ik"]*SB["kj"];
+  DC["ij"] = SA["ik"]*B["kj"];
+  C.relabel(5, true);
+  DC.relabel(5, true);
+  SA.relabel(5, true);
+  SB.relabel(5, true);
+  B.relabel(5, true);
+
+  C["ij"] -= C0["ij"];
+  DC["ij"] -= DC0["ij"];
+  SA["ij"] -= SA0["ij"];
+  SB["ij"] -= SB0["ij"];
+  B["ij"] -= B0["ij"];
+  pass = pass && C.norm2() < 1.E-10*std::max(1.,C0.norm2());
+  pass = pass && DC.norm2() < 1.E-10*std::max(1.,DC0.norm2());
+  pass = pass && SA.norm2() == 0. && SB.norm2() == 0. && B.norm2() == 0.;
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ C[\"ij\"] = A[\"ik\"]*B[\"kj\"] with skewed sparse A relabeled for balance } passed \n");
+    else
+      printf("{ C[\"ij\"] = A[\"ik\"]*B[\"kj\"] with skewed sparse A relabeled for balance } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 9;
+  } else n = 9;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking relabeling of skewed sparse matrices with n = %d\n", n);
+    }
+    pass = nnz_balance(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
@@ -0,0 +1,139 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup node_topo node_topo
+  * @{
+  * \brief Checks that topologies of a World with emulated nodes mark which dimensions span nodes and still contract correctly
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+int node_topo(int     n,
+              World & dw){
+  int pass = 1;
+
+  int ranks_per_node = RANKS_PER_NODE;
+  RANKS_PER_NODE = 2;
+  int node_size = dw.np % 2 == 0 ? 2 : 1;
+
+  // worlds on MPI_COMM_WORLD reuse the universe, so build one on a copy of it
+  MPI_Comm cm;
+  MPI_Comm_dup(dw.comm, &cm);
+  {
+    World nw(cm);
+    pass = pass && nw.cdt.node_size == node_size && nw.cdt.inter_node == (node_size < dw.np);
+
+    // a dimension spans nodes unless it and all faster varying dimensions fit within a node
+    std::vector<CTF_int::topology*> topos = nw.topovec;
+    topos.push_back(nw.phys_topology);
+    for (int t=0; t<(int)topos.size(); t++){
+      for (int i=0; i<topos[t]->order; i++){
+        bool inter = node_size < dw.np && node_size % (topos[t]->lda[i]*topos[t]->lens[i]) != 0;
+        pass = pass && topos[t]->dim_comm[i].inter_node == inter;
+      }
+    }
+
+    // the leading dimensions of the physical topology cover a node, and the same broadcast costs more across nodes
+    int intra_np = 1;
+    CTF_int::topology * phys = nw.phys_topology;
+    for (int i=0; i<phys->order; i++){
+      if (!phys->dim_comm[i].inter_node) intra_np *= phys->lens[i];
+      for (int j=0; j<phys->order; j++){
+        if (phys->lens[i] == phys->lens[j] && !phys->dim_comm[i].inter_node && phys->dim_comm[j].inter_node)
+          pass = pass && phys->dim_comm[i].estimate_bcast_time(1<<20) < phys->dim_comm[j].estimate_bcast_time(1<<20);
+      }
+    }
+    pass = pass && intra_np == node_size;
+
+    int lens[] = {n, n+1, n+2};
+    Tensor<> A(3, lens, dw);
+    Tensor<> B(3, lens, dw);
+    Matrix<> C(n, n, dw);
+    A.fill_random(-1.,1.);
+    B.fill_random(-1.,1.);
+    C["ij"] = A["ikl"]*B["jkl"];
+
+    Tensor<> NA(3, lens, nw);
+    Tensor<> NB(3, lens, nw);
+    Matrix<> NC(n, n, nw);
+    int64_t sz = (int64_t)n*(n+1)*(n+2);
+    double * data = (double*)malloc(sizeof(double)*sz);
+    int64_t * keys = (int64_t*)malloc(sizeof(int64_t)*sz);
+    for (int64_t i=0; i<sz; i++) keys[i] = i;
+    A.read_all(data);
+    NA.write(dw.rank == 0 ? sz : 0, keys, data);
+    B.read_all(data);
+    NB.write(dw.rank == 0 ? sz : 0, keys, data);
+    NC["ij"] = NA["ikl"]*NB["jkl"];
+
+    double * c = (double*)malloc(sizeof(double)*n*n);
+    C.read_all(c);
+    NC.read_all(data);
+    double err = 0.;
+    for (int64_t i=0; i<(int64_t)n*n; i++){
+      err = std::max(err, std::abs(c[i]-data[i]));
+    }
+    pass = pass && err <= 1.E-10*n*n;
+    free(c);
+    free(data);
+    free(keys);
+  }
+  MPI_Comm_free(&cm);
+  RANKS_PER_NODE = ranks_per_node;
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ C[\"ij\"] = A[\"ikl\"]*B[\"jkl\"] on a World with %d ranks per node } passed \n", node_size);
+    else
+      printf("{ C[\"ij\"] = A[\"ikl\"]*B[\"jkl\"] on a World with %d ranks per node } failed \n", node_size);
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 7;
+  } else n = 7;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking node-aware topologies with n = %d\n", n);
+    }
+    pass = node_topo(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
@@ -0,0 +1,127 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup pair_sort pair_sort
+  * @{
+  * \brief Checks sorting of key-value pairs of different value sizes and key ranges
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+/**
+ * \brief sorts n pairs of sr with keys in [0,max_key] and checks them against std::stable_sort
+ */
+template <typename dtype>
+int check_pair_sort(CTF_int::algstrct const * sr, int64_t n, int64_t max_key, bool pass_max_key){
+  std::vector< std::pair<int64_t,dtype> > ref(n);
+  char * buf = (char*)CTF_int::alloc(n*sr->pair_size());
+  CTF_int::PairIterator pi(sr, buf);
+  for (int64_t i=0; i<n; i++){
+    int64_t key = (int64_t)(drand48()*max_key);
+    if (i%7 == 0) key = max_key;
+    dtype val = (dtype)i;
+    ref[i] = std::pair<int64_t,dtype>(key, val);
+    pi[i].write_key(key);
+    pi[i].write_val((char const*)&val);
+  }
+  std::stable_sort(ref.begin(), ref.end(),
+                   [](std::pair<int64_t,dtype> const & a, std::pair<int64_t,dtype> const & b){ return a.first < b.first; });
+  pi.sort(n, pass_max_key ? max_key : -1);
+
+  int pass = 1;
+  std::vector<dtype> vals;
+  for (int64_t i=0; i<n; i++){
+    pass = pass && pi[i].k() == ref[i].first;
+    dtype val;
+    pi[i].read_val((char*)&val);
+    vals.push_back(val);
+  }
+  // values with equal keys may be permuted by the sort
+  std::vector<dtype> ref_vals;
+  for (int64_t i=0; i<n; i++) ref_vals.push_back(ref[i].second);
+  for (int64_t i=0, j=0; i<n; i=j){
+    for (j=i; j<n && ref[j].first == ref[i].first; j++){}
+    std::vector<dtype> a(vals.begin()+i, vals.begin()+j), b(ref_vals.begin()+i, ref_vals.begin()+j);
+    std::sort(a.begin(), a.end(), [](dtype x, dtype y){ return std::real(x) < std::real(y); });
+    std::sort(b.begin(), b.end(), [](dtype x, dtype y){ return std::real(x) < std::real(y); });
+    pass = pass && a == b;
+  }
+  CTF_int::cdealloc(buf);
+  return pass;
+}
+
+int pair_sort(int     n,
+              World & dw){
+  int pass = 1;
+  Ring<float> rf;
+  Ring<double> rd;
+  Ring< std::complex<double> > rz;
+  int64_t sizes[] = {0, 1, 100, 40*n*n+17};
+  int64_t max_keys[] = {0, 255, 256, 1<<20, ((int64_t)1)<<45};
+  srand48(dw.rank+3);
+  for (int is=0; is<4; is++){
+    for (int ik=0; ik<5; ik++){
+      for (int ip=0; ip<2; ip++){
+        pass = pass && check_pair_sort<float>(&rf, sizes[is], max_keys[ik], ip);
+        pass = pass && check_pair_sort<double>(&rd, sizes[is], max_keys[ik], ip);
+        pass = pass && check_pair_sort< std::complex<double> >(&rz, sizes[is], max_keys[ik], ip);
+      }
+    }
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ sort of key-value pairs } passed \n");
+    else
+      printf("{ sort of key-value pairs } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 7;
+  } else n = 7;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking sort of key-value pairs with n = %d\n", n);
+    }
+    pass = pair_sort(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
@@ -0,0 +1,194 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup pattern pattern
+  * @{
+  * \brief Checks sparse tensors over the Pattern semiring, which store only the keys of their nonzeros
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+/** \brief sorted keys of the nonzeros of A on all processes */
+template <typename dtype>
+static std::vector<int64_t> get_all_keys(Tensor<dtype> & A){
+  int64_t npair;
+  int64_t * keys;
+  dtype * vals;
+  A.read_local_nnz(&npair, &keys, &vals);
+  int np = A.wrld->np;
+  int cnt = npair;
+  std::vector<int> cnts(np), displs(np, 0);
+  MPI_Allgather(&cnt, 1, MPI_INT, cnts.data(), 1, MPI_INT, A.wrld->comm);
+  for (int i=1; i<np; i++) displs[i] = displs[i-1]+cnts[i-1];
+  std::vector<int64_t> all_keys(displs[np-1]+cnts[np-1]);
+  MPI_Allgatherv(keys, cnt, MPI_INT64_T, all_keys.data(), cnts.data(), displs.data(), MPI_INT64_T, A.wrld->comm);
+  std::sort(all_keys.begin(), all_keys.end());
+  free(keys);
+  free(vals);
+  return all_keys;
+}
+
+/** \brief writes the nonzero pattern of the local part of F into the pattern tensor P */
+template <typename dtype>
+static void write_pattern(Tensor<dtype> & F, Tensor<bool> & P){
+  int64_t npair;
+  int64_t * keys;
+  dtype * vals;
+  F.read_local_nnz(&npair, &keys, &vals);
+  bool * bvals = (bool*)malloc(sizeof(bool)*std::max(npair, (int64_t)1));
+  P.write(npair, keys, bvals);
+  free(bvals);
+  free(keys);
+  free(vals);
+}
+
+int pattern(int     n,
+            World & dw){
+  int pass = 1;
+
+  int m = 5*n+7, k = 3*n+2, nn = 2*n+3;
+  Pattern p;
+  pass = pass && p.pair_size() == (int64_t)sizeof(int64_t);
+
+  Matrix<> SA(m, k, SP, dw);
+  Matrix<> SB(k, nn, SP, dw);
+  Matrix<> SD(m, nn, SP, dw);
+  srand48(dw.rank*17);
+  SA.fill_sp_random(1., 2., .1);
+  SB.fill_sp_random(1., 2., .2);
+  SD.fill_sp_random(1., 2., .1);
+
+  Matrix<bool> A(m, k, SP, dw, p);
+  Matrix<bool> B(k, nn, SP, dw, p);
+  Matrix<bool> D(m, nn, SP, dw, p);
+  write_pattern(SA, A);
+  write_pattern(SB, B);
+  write_pattern(SD, D);
+  pass = pass && get_all_keys(A) == get_all_keys(SA) && get_all_keys(B) == get_all_keys(SB);
+
+  // product, transposed product, and union with an existing pattern
+  Matrix<> SC(m, nn, SP, dw);
+  Matrix<bool> C(m, nn, SP, dw, p);
+  Matrix<bool> TC(nn, m, SP, dw, p);
+  SC["ij"] = SA["ik"]*SB["kj"];
+  C["ij"] = A["ik"]*B["kj"];
+  TC["ji"] = B["kj"]*A["ik"];
+  pass = pass && get_all_keys(C) == get_all_keys(SC);
+  Matrix<> STC(nn, m, SP, dw);
+  STC["ji"] = SC["ij"];
+  pass = pass && get_all_keys(TC) == get_all_keys(STC);
+
+  SD["ij"] += SA["ik"]*SB["kj"];
+  D["ij"] += A["ik"]*B["kj"];
+  pass = pass && get_all_keys(D) == get_all_keys(SD);
+
+  // assignment replaces the pattern
+  D["ij"] = A["ik"]*B["kj"];
+  pass = pass && get_all_keys(D) == get_all_keys(SC);
+
+  // transposition and sums of patterns
+  Matrix<bool> AT(k, m, SP, dw, p);
+  Matrix<> SAT(k, m, SP, dw);
+  AT["ki"] = A["ik"];
+  SAT["ki"] = SA["ik"];
+  pass = pass && get_all_keys(AT) == get_all_keys(SAT);
+  D["ij"] += C["ij"];
+  D["ij"] += TC["ji"];
+  pass = pass && get_all_keys(D) == get_all_keys(SC);
+  Matrix<bool> E(m, nn, SP, dw, p);
+  write_pattern(SD, E);
+  E["ij"] += C["ij"];
+  SD["ij"] += SC["ij"];
+  pass = pass && get_all_keys(E) == get_all_keys(SD);
+  E["ij"] = TC["ji"];
+  pass = pass && get_all_keys(E) == get_all_keys(SC);
+
+  // writing and reading the pattern as an array of Pairs, which pack keys alone
+  {
+    int64_t npair;
+    int64_t * keys;
+    double * vals;
+    SA.read_local_nnz(&npair, &keys, &vals);
+    Pair<bool> * prs = (Pair<bool>*)malloc(sizeof(Pair<bool>)*std::max(npair, (int64_t)1));
+    for (int64_t i=0; i<npair; i++) prs[i] = Pair<bool>(keys[i], true);
+    Matrix<bool> PA(m, k, SP, dw, p);
+    PA.write(npair, prs);
+    pass = pass && get_all_keys(PA) == get_all_keys(SA);
+    PA.read(npair, prs);
+    for (int64_t i=0; i<npair; i++) pass = pass && prs[i].k == keys[i];
+    free(prs);
+    int64_t nlpair;
+    Pair<bool> * lprs;
+    PA.read_local_nnz(&nlpair, &lprs);
+    std::vector<int64_t> all_keys = get_all_keys(SA);
+    int64_t nall = nlpair;
+    MPI_Allreduce(MPI_IN_PLACE, &nall, 1, MPI_INT64_T, MPI_SUM, dw.comm);
+    pass = pass && nall == (int64_t)all_keys.size();
+    for (int64_t i=0; i<nlpair; i++)
+      pass = pass && std::binary_search(all_keys.begin(), all_keys.end(), lprs[i].k);
+    free(lprs);
+    free(keys);
+    free(vals);
+  }
+
+  // a pattern as the mask of a masked product
+  Matrix<> MC(m, nn, SP, dw);
+  MC["ij"] = (SA["ik"]*SB["kj"]).masked(TC["ji"]);
+  pass = pass && MC.norm2() > 0 && fabs(MC.norm2()-SC.norm2()) < 1.E-10*SC.norm2();
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ C[\"ij\"] = A[\"ik\"]*B[\"kj\"] with pattern-only sparse A, B, C } passed \n");
+    else
+      printf("{ C[\"ij\"] = A[\"ik\"]*B[\"kj\"] with pattern-only sparse A, B, C } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 9;
+  } else n = 9;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking pattern-only sparse tensors with n = %d\n", n);
+    }
+    pass = pattern(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
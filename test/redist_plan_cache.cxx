@@ -0,0 +1,133 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup redist_plan_cache redist_plan_cache
+  * @{
+  * \brief Checks that repeated redistributions between the same distributions reuse cached plans and give the same result
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+int redist_plan_cache(int     n,
+                      World & dw){
+  int lens[] = {n, n+1, n, n+1};
+  int shape[] = {NS, NS, NS, NS};
+  int tlens[] = {n+1, n, n+1, n};
+
+  Tensor<> A(4, lens, shape, dw);
+  Tensor<> B(4, lens, shape, dw);
+  Tensor<> C(4, lens, shape, dw);
+  Tensor<> T(4, tlens, shape, dw);
+  Tensor<> C0(4, lens, shape, dw);
+  Tensor<> T0(4, tlens, shape, dw);
+
+  A.fill_random(-1.,1.);
+  B.fill_random(-1.,1.);
+
+  clear_redist_plan_cache();
+  int redist_plan_cache_size = REDIST_PLAN_CACHE_SIZE;
+  REDIST_PLAN_CACHE_SIZE = 0;
+  C0["ijkl"] = A["ijmn"]*B["mnkl"];
+  T0["lkji"] = A["ijkl"];
+  Plan_cache_stats st0 = get_redist_plan_cache_stats();
+  REDIST_PLAN_CACHE_SIZE = redist_plan_cache_size;
+  int pass = st0.size == 0;
+
+  int niter = 4;
+  double max_err = 0.;
+  Plan_cache_stats st1 = st0;
+  for (int it=0; it<niter; it++){
+    C["ijkl"] = A["ijmn"]*B["mnkl"];
+    T["lkji"] = A["ijkl"];
+    C["ijkl"] += (-1.)*C0["ijkl"];
+    T["ijkl"] += (-1.)*T0["ijkl"];
+    max_err = std::max(max_err, C.norm2());
+    max_err = std::max(max_err, T.norm2());
+    if (it == 0) st1 = get_redist_plan_cache_stats();
+  }
+  Plan_cache_stats st2 = get_redist_plan_cache_stats();
+
+  // every iteration repeats the redistributions of the first, so later ones should all hit
+  pass = pass && (st2.misses == st1.misses) && (st2.hits-st1.hits >= (niter-1)*(st1.misses-st0.misses));
+  pass = pass && (max_err <= 1.E-10*n*n);
+
+  // reading M distributed over columns moves it from its default distribution every time
+  int m = 2*n+1, nn = 3*n+2;
+  Matrix<> M(m, nn, dw);
+  M.fill_random(-1.,1.);
+  Partition part(1, &dw.np);
+  int64_t sz = (int64_t)m*((nn+dw.np-1)/dw.np);
+  REDIST_PLAN_CACHE_SIZE = 0;
+  double * data0 = M.read("ij", part["j"]);
+  REDIST_PLAN_CACHE_SIZE = redist_plan_cache_size;
+  Plan_cache_stats st3 = get_redist_plan_cache_stats();
+  for (int it=0; it<niter; it++){
+    double * data = M.read("ij", part["j"]);
+    for (int64_t i=0; i<sz; i++){
+      pass = pass && data[i] == data0[i];
+    }
+    CTF_int::cdealloc(data);
+  }
+  CTF_int::cdealloc(data0);
+  Plan_cache_stats st4 = get_redist_plan_cache_stats();
+  pass = pass && (st4.misses-st3.misses <= 1) && (st4.hits-st3.hits >= (niter-1)*(st4.misses-st3.misses));
+
+  clear_redist_plan_cache();
+  pass = pass && get_redist_plan_cache_stats().size == 0;
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ repeated redistributions of A[\"ijkl\"] reuse cached plans } passed \n");
+    else
+      printf("{ repeated redistributions of A[\"ijkl\"] reuse cached plans } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 7;
+  } else n = 7;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking redistribution plan cache with n = %d\n", n);
+    }
+    pass = redist_plan_cache(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
@@ -0,0 +1,131 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup schedule_subworlds schedule_subworlds
+  * @{
+  * \brief Checks that a recorded schedule executed repeatedly reuses its subworlds and gives the same result as direct execution
+  */
+
+#include <ctf.hpp>
+#include "../src/interface/schedule.h"
+using namespace CTF;
+
+int schedule_subworlds(int     n,
+                       World & dw){
+  int pass = 1;
+
+  Matrix<> A(n, n, dw);
+  Matrix<> B(n, n, dw);
+  Matrix<> C(n, n, dw);
+  Matrix<> D(n, n, dw);
+  Matrix<> C0(n, n, dw);
+  Matrix<> D0(n, n, dw);
+  srand48(dw.rank*11+5);
+  A.fill_random(-1.,1.);
+  B.fill_random(-1.,1.);
+  C0["ij"] = A["ik"]*B["kj"];
+  D0["ij"] = B["ik"]*A["kj"];
+  D0["ij"] += A["ij"];
+
+  // C and D are independent, so they may be computed on different subworlds
+  C["ij"] = 7.;
+  D["ij"] = 7.;
+  Schedule sched(&dw);
+  sched.set_max_partitions(2);
+  sched.record();
+  C["ij"] = A["ik"]*B["kj"];
+  D["ij"] = B["ik"]*A["kj"];
+  D["ij"] += A["ij"];
+
+  clear_subworld_cache();
+  int niter = 3;
+  Plan_cache_stats st0 = get_subworld_cache_stats();
+  Plan_cache_stats st1 = st0;
+  for (int it=0; it<niter; it++){
+    sched.execute();
+    C["ij"] -= C0["ij"];
+    D["ij"] -= D0["ij"];
+    pass = pass && C.norm2() <= 1.E-10*n*n && D.norm2() <= 1.E-10*n*n;
+    C["ij"] = 7.;
+    D["ij"] = 7.;
+    if (it == 0) st1 = get_subworld_cache_stats();
+  }
+  Plan_cache_stats st2 = get_subworld_cache_stats();
+  // every execution partitions as the first, so later ones should not split communicators again
+  pass = pass && st1.misses > st0.misses && st2.misses == st1.misses;
+  pass = pass && st2.hits-st1.hits >= (niter-1)*(st1.misses-st0.misses);
+
+  // a schedule on other tensors with the same partition drops the copies of C and D, which are then made again
+  Matrix<> E(n, n, dw);
+  Matrix<> F(n, n, dw);
+  Schedule sched2(&dw);
+  sched2.set_max_partitions(2);
+  sched2.record();
+  E["ij"] = B["ik"]*B["kj"];
+  F["ij"] = A["ik"]*A["kj"];
+  sched2.execute();
+  E["ij"] -= B["ik"]*B["kj"];
+  F["ij"] -= A["ik"]*A["kj"];
+  sched.execute();
+  C["ij"] -= C0["ij"];
+  D["ij"] -= D0["ij"];
+  pass = pass && C.norm2() <= 1.E-10*n*n && D.norm2() <= 1.E-10*n*n && E.norm2() <= 1.E-10*n*n && F.norm2() <= 1.E-10*n*n;
+
+  clear_subworld_cache();
+  pass = pass && get_subworld_cache_stats().size == 0;
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ repeated executions of a schedule reuse its subworlds } passed \n");
+    else
+      printf("{ repeated executions of a schedule reuse its subworlds } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 7;
+  } else n = 7;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking reuse of schedule subworlds with n = %d\n", n);
+    }
+    pass = schedule_subworlds(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
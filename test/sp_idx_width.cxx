@@ -0,0 +1,161 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup sp_idx_width sp_idx_width
+  * @{
+  * \brief Checks sparse contractions with 16-, 32-, and 64-bit indices in the local CSR and COO blocks
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+double fadd_iw(double a, double b){ return a+b; }
+double fmul_iw(double a, double b){ return a*b; }
+
+void coomm_iw(int m, int n, int k, double alpha, double const * A, int const * rows_A, int const * cols_A, int nnz_A, double const * B, double beta, double * C){
+  for (int i=0; i<m*n; i++) C[i] *= beta;
+  for (int i=0; i<nnz_A; i++){
+    for (int j=0; j<n; j++){
+      C[j*m+rows_A[i]-1] += alpha*A[i]*B[j*k+cols_A[i]-1];
+    }
+  }
+}
+
+int sp_idx_width(int     n,
+                 World & dw){
+  int pass = 1;
+  int min_width = CTF::SP_MIN_IDX_WIDTH;
+
+  CTF::SP_MIN_IDX_WIDTH = 2;
+  pass = pass && CTF_int::get_sp_idx_width(100) == 2;
+  pass = pass && CTF_int::get_sp_idx_width(1<<20) == 4;
+  pass = pass && CTF_int::get_sp_idx_width(((int64_t)1)<<40) == 8;
+  CTF::SP_MIN_IDX_WIDTH = 4;
+  pass = pass && CTF_int::get_sp_idx_width(100) == 4;
+
+  int m = n+3, k = n+1, nn = 2*n+5;
+  Semiring<double> coo_sr(0., &fadd_iw, MPI_SUM, 1., &fmul_iw, NULL, NULL, NULL, &coomm_iw);
+  Function<> fmul([](double a, double b){ return a*b; });
+  double inf = std::numeric_limits<double>::infinity();
+
+  int widths[3] = {2, 4, 8};
+  for (int iw=0; iw<3; iw++){
+    CTF::SP_MIN_IDX_WIDTH = widths[iw];
+
+    Matrix<> SA(m, k, SP, dw);
+    Matrix<> SB(k, nn, SP, dw);
+    Matrix<> B(k, nn, dw);
+    srand48(dw.rank*7+iw);
+    SA.fill_sp_random(1., 2., .3);
+    SB.fill_sp_random(1., 2., .3);
+    B.fill_random(1., 2.);
+
+    Matrix<> C(m, nn, dw);
+    Matrix<> DC(m, nn, dw);
+    Matrix<> SC(m, nn, SP, dw);
+    Matrix<> FC(m, nn, dw);
+    C["ij"] = SA["ik"]*B["kj"];
+    DC["ij"] = SA["ik"]*SB["kj"];
+    SC["ij"] = SA["ik"]*SB["kj"];
+    FC["ij"] = fmul(SA["ik"],B["kj"]);
+
+    Matrix<> CA(m, k, SP, dw, coo_sr);
+    Matrix<> CB(k, nn, dw, coo_sr);
+    Matrix<> CC(m, nn, dw, coo_sr);
+    CA["ij"] = SA["ij"];
+    CB["ij"] = B["ij"];
+    CC["ij"] = CA["ik"]*CB["kj"];
+
+    MinPlus<> mp;
+    Matrix<> TA(m, k, SP, dw, mp);
+    Matrix<> TB(k, nn, dw, mp);
+    Matrix<> TC(m, nn, dw, mp);
+    TA["ij"] = SA["ij"];
+    TB["ij"] = B["ij"];
+    TC["ij"] = TA["ik"]*TB["kj"];
+
+    std::vector<double> all_A(m*k), all_SB(k*nn), all_B(k*nn), all_TA(m*k), all_TB(k*nn);
+    std::vector<double> all_C(m*nn), all_DC(m*nn), all_SC(m*nn), all_FC(m*nn), all_CC(m*nn), all_TC(m*nn);
+    SA.read_all(all_A.data());
+    SB.read_all(all_SB.data());
+    B.read_all(all_B.data());
+    TA.read_all(all_TA.data());
+    TB.read_all(all_TB.data());
+    C.read_all(all_C.data());
+    DC.read_all(all_DC.data());
+    SC.read_all(all_SC.data());
+    FC.read_all(all_FC.data());
+    CC.read_all(all_CC.data());
+    TC.read_all(all_TC.data());
+    for (int j=0; j<nn; j++){
+      for (int i=0; i<m; i++){
+        double c = 0., dc = 0., tc = inf;
+        for (int l=0; l<k; l++){
+          c += all_A[l*m+i]*all_B[j*k+l];
+          dc += all_A[l*m+i]*all_SB[j*k+l];
+          tc = std::min(tc, all_TA[l*m+i]+all_TB[j*k+l]);
+        }
+        int ij = j*m+i;
+        pass = pass && fabs(all_C[ij]-c) < 1.E-10 && fabs(all_FC[ij]-c) < 1.E-10 && fabs(all_CC[ij]-c) < 1.E-10;
+        pass = pass && fabs(all_DC[ij]-dc) < 1.E-10 && fabs(all_SC[ij]-dc) < 1.E-10;
+        pass = pass && all_TC[ij] == tc;
+      }
+    }
+  }
+  CTF::SP_MIN_IDX_WIDTH = min_width;
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ C[\"ij\"] = A[\"ik\"]*B[\"kj\"] with 16-, 32-, and 64-bit sparse indices } passed \n");
+    else
+      printf("{ C[\"ij\"] = A[\"ik\"]*B[\"kj\"] with 16-, 32-, and 64-bit sparse indices } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 9;
+  } else n = 9;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking sparse contractions with different index widths with n = %d\n", n);
+    }
+    pass = sp_idx_width(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
@@ -0,0 +1,112 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup sp_pairs sp_pairs
+  * @{
+  * \brief Writes and reads back unsorted and repeated keys of a sparse complex tensor
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+int sp_pairs(int     n,
+             World & dw){
+  int lens[] = {n, n+1, n+2};
+  int64_t size = (int64_t)lens[0]*lens[1]*lens[2];
+  Tensor< std::complex<double> > T(3, true, lens, dw);
+
+  /* every process writes keys in a scattered order, some several times */
+  int64_t nw = size/2+3;
+  std::vector< std::complex<double> > ref(size, std::complex<double>(0.,0.));
+  std::vector<int64_t> my_keys;
+  std::vector< std::complex<double> > my_vals;
+  for (int r=0; r<dw.np; r++){
+    for (int64_t j=0; j<nw; j++){
+      int64_t key = (j*7919 + r*13) % size;
+      std::complex<double> val((double)(j+1), (double)r);
+      ref[key] += val;
+      if (r == dw.rank){
+        my_keys.push_back(key);
+        my_vals.push_back(val);
+      }
+    }
+  }
+  T.write(nw, my_keys.data(), my_vals.data());
+
+  int pass = T.nnz_tot <= size;
+
+  /* read back every key in reverse order, each twice */
+  std::vector<int64_t> rd_keys;
+  for (int64_t k=size-1; k>=0; k--){
+    rd_keys.push_back(k);
+    rd_keys.push_back((k*31) % size);
+  }
+  std::vector< std::complex<double> > rd_vals(rd_keys.size());
+  T.read(rd_keys.size(), rd_keys.data(), rd_vals.data());
+  for (int64_t i=0; i<(int64_t)rd_keys.size(); i++){
+    pass = pass && std::abs(rd_vals[i]-ref[rd_keys[i]]) < 1.E-10;
+  }
+
+  Tensor< std::complex<double> > D(3, lens, dw);
+  D["ijk"] = T["ijk"];
+  std::vector< std::complex<double> > all_D(size);
+  D.read_all(all_D.data());
+  for (int64_t i=0; i<size; i++){
+    pass = pass && std::abs(all_D[i]-ref[i]) < 1.E-10;
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ sparse write and read of unsorted repeated keys } passed \n");
+    else
+      printf("{ sparse write and read of unsorted repeated keys } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 7;
+  } else n = 7;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking sparse writes and reads of unsorted repeated keys with n = %d\n", n);
+    }
+    pass = sp_pairs(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
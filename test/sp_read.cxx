@@ -0,0 +1,113 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup sp_read sp_read
+  * @{
+  * \brief Reads keys present in and absent from a sparse tensor and checks them against a dense copy
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+int sp_read(int     n,
+            World & dw){
+  int lens[] = {n+1, n, n+2};
+  int64_t size = (int64_t)lens[0]*lens[1]*lens[2];
+  Tensor<> T(3, true, lens, dw);
+  Tensor<> D(3, lens, dw);
+  srand48(dw.rank*29);
+  T.fill_sp_random(1., 2., .2);
+  D["ijk"] = T["ijk"];
+
+  int pass = 1;
+
+  /* every process reads all keys in a scattered order, most of them absent from T, some twice */
+  std::vector<int64_t> keys;
+  for (int64_t k=0; k<size; k++){
+    keys.push_back((k*7919+dw.rank) % size);
+    if (k % 3 == 0) keys.push_back((k*31) % size);
+  }
+  int64_t nread = keys.size();
+
+  /* without scaling factors the values read overwrite those passed in */
+  std::vector<double> sp_vals(nread, -7.), dn_vals(nread, 5.);
+  T.read(nread, keys.data(), sp_vals.data());
+  D.read(nread, keys.data(), dn_vals.data());
+  for (int64_t i=0; i<nread; i++){
+    pass = pass && std::abs(sp_vals[i]-dn_vals[i]) < 1.E-10;
+  }
+
+  /* with scaling factors, values read are alpha*T+beta*(values passed in) */
+  for (int64_t i=0; i<nread; i++){
+    sp_vals[i] = (double)(keys[i] % 5);
+    dn_vals[i] = sp_vals[i];
+  }
+  T.read(nread, 2., -3., keys.data(), sp_vals.data());
+  D.read(nread, 2., -3., keys.data(), dn_vals.data());
+  for (int64_t i=0; i<nread; i++){
+    pass = pass && std::abs(sp_vals[i]-dn_vals[i]) < 1.E-10;
+  }
+
+  /* a tensor with no nonzeros reads as zero */
+  Tensor<> Z(3, true, lens, dw);
+  std::vector<double> z_vals(nread, 1.);
+  Z.read(nread, keys.data(), z_vals.data());
+  for (int64_t i=0; i<nread; i++){
+    pass = pass && z_vals[i] == 0.;
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ sparse read of present and absent keys matches dense read } passed \n");
+    else
+      printf("{ sparse read of present and absent keys matches dense read } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 7;
+  } else n = 7;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking sparse reads of present and absent keys with n = %d\n", n);
+    }
+    pass = sp_read(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
@@ -0,0 +1,166 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup sparse_file_io sparse_file_io
+  * @{
+  * \brief Checks that sparse tensors are written to and read from MatrixMarket, coordinate text, and binary coordinate files
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+int sparse_file_io(int     n,
+                   World & dw){
+  int pass = 1;
+  int lens[] = {n, n+1, n+2};
+  int shape[] = {NS, NS, NS};
+  char const * mtx_name = "CTF_sparse_file_io_test_file.mtx";
+  char const * tns_name = "CTF_sparse_file_io_test_file.tns";
+  char const * bin_name = "CTF_sparse_file_io_test_file.bin";
+  char const * sym_name = "CTF_sparse_file_io_test_sym_file.mtx";
+
+  srand48(dw.rank*13+3);
+  Matrix<> M0(n, n+1, SP, dw);
+  M0.fill_sp_random(-1.,1.,.3);
+  Tensor<> T0(3, true, lens, shape, dw);
+  T0.fill_sp_random(-1.,1.,.2);
+
+  // MatrixMarket files may be read into sparse and dense matrices
+  pass = pass && M0.write_sparse_to_file(mtx_name, true) == CTF_int::SUCCESS;
+  {
+    Matrix<> M(n, n+1, SP, dw);
+    Matrix<> D(n, n+1, dw);
+    pass = pass && M.read_sparse_from_file(mtx_name) == CTF_int::SUCCESS;
+    pass = pass && D.read_sparse_from_file(mtx_name) == CTF_int::SUCCESS;
+    pass = pass && M.nnz_tot == M0.nnz_tot;
+    M["ij"] -= M0["ij"];
+    D["ij"] -= M0["ij"];
+    pass = pass && M.norm2() <= 1.E-12 && D.norm2() <= 1.E-12;
+  }
+
+  // coordinate text and binary files of an order three tensor
+  pass = pass && T0.write_sparse_to_file(tns_name) == CTF_int::SUCCESS;
+  pass = pass && T0.write_sparse_to_binary_file(bin_name) == CTF_int::SUCCESS;
+  {
+    Tensor<> T(3, true, lens, shape, dw);
+    Tensor<> B(3, true, lens, shape, dw);
+    pass = pass && T.read_sparse_from_file(tns_name) == CTF_int::SUCCESS;
+    pass = pass && B.read_sparse_from_binary_file(bin_name) == CTF_int::SUCCESS;
+    pass = pass && T.nnz_tot == T0.nnz_tot && B.nnz_tot == T0.nnz_tot;
+    T["ijk"] -= T0["ijk"];
+    B["ijk"] -= T0["ijk"];
+    pass = pass && T.norm2() <= 1.E-12 && B.norm2() <= 1.E-12;
+  }
+
+  // a truncated binary file is rejected
+  if (T0.nnz_tot > 0){
+    MPI_Barrier(dw.comm);
+    if (dw.rank == 0){
+      FILE * f = fopen(bin_name, "rb");
+      std::vector<char> bytes;
+      for (int c=fgetc(f); c!=EOF; c=fgetc(f)) bytes.push_back((char)c);
+      fclose(f);
+      f = fopen(bin_name, "wb");
+      fwrite(bytes.data(), 1, bytes.size()-1, f);
+      fclose(f);
+    }
+    MPI_Barrier(dw.comm);
+    Tensor<> B(3, true, lens, shape, dw);
+    pass = pass && B.read_sparse_from_binary_file(bin_name) == CTF_int::ERROR;
+  }
+
+  // a symmetric MatrixMarket file holds the lower triangle, which is mirrored into a nonsymmetric matrix
+  if (dw.rank == 0){
+    FILE * f = fopen(sym_name, "w");
+    fprintf(f, "%%%%MatrixMarket matrix coordinate real symmetric\n%% comment\n%d %d %d\n", n, n, 2*n-1);
+    for (int i=0; i<n; i++){
+      fprintf(f, "%d %d %d\n", i+1, i+1, i+1);
+      if (i+1 < n) fprintf(f, "%d %d %.17g\n", i+2, i+1, .5*(i+1));
+    }
+    fclose(f);
+  }
+  MPI_Barrier(dw.comm);
+  {
+    Matrix<> N(n, n, SP, dw);
+    Matrix<> S(n, n, SY, dw);
+    pass = pass && N.read_sparse_from_file(sym_name) == CTF_int::SUCCESS;
+    pass = pass && S.read_sparse_from_file(sym_name) == CTF_int::SUCCESS;
+    double sum = 0.;
+    for (int i=0; i<n; i++){
+      sum += (i+1) + (i+1 < n ? i+1 : 0);
+    }
+    pass = pass && N.nnz_tot == 3*n-2;
+    pass = pass && std::abs(N.reduce(OP_SUM) - sum) <= 1.E-12*sum;
+    Matrix<> F(n, n, dw);
+    F["ij"] = S["ij"];
+    F["ij"] -= N["ij"];
+    pass = pass && F.norm2() <= 1.E-12;
+
+    // matrices of other sizes are rejected
+    Matrix<> R(n+1, n, SP, dw);
+    pass = pass && R.read_sparse_from_file(sym_name) == CTF_int::ERROR;
+  }
+
+  MPI_Barrier(dw.comm);
+  if (dw.rank == 0){
+    remove(mtx_name);
+    remove(tns_name);
+    remove(bin_name);
+    remove(sym_name);
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ sparse tensors are written to and read from coordinate files } passed \n");
+    else
+      printf("{ sparse tensors are written to and read from coordinate files } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 7;
+  } else n = 7;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking sparse file I/O with n = %d\n", n);
+    }
+    pass = sparse_file_io(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
@@ -0,0 +1,151 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup spgemm_acc spgemm_acc
+  * @{
+  * \brief Sparse times sparse matrix products with rows that use each of the dense, hash, and heap accumulators
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+double fadd_sa(double a, double b){ return a+b; }
+double fmul_sa(double a, double b){ return a*b; }
+
+/**
+ * \brief fills A (m-by-k) with rows of 1, 3, 12, or k nonzeros and B (k-by-n) with rows of 1 to 17 nonzeros
+ */
+void fill_spgemm_acc(Matrix<> & A, Matrix<> & B, World & dw){
+  int m = A.nrow, k = A.ncol, n = B.ncol;
+  std::vector<int64_t> inds;
+  std::vector<double> vals;
+  if (dw.rank == 0){
+    for (int i=0; i<m; i++){
+      int nnz_row = (i%4 == 0) ? 1 : (i%4 == 1) ? 3 : (i%4 == 2) ? 12 : k;
+      for (int j=0; j<nnz_row; j++){
+        int col = (nnz_row == k) ? j : (i*7+j*5)%k;
+        inds.push_back((int64_t)col*m+i);
+        vals.push_back(1.+drand48());
+      }
+    }
+  }
+  A.write(inds.size(), inds.data(), vals.data());
+  inds.clear();
+  vals.clear();
+  if (dw.rank == 0){
+    for (int i=0; i<k; i++){
+      int nnz_row = (i%5)*4+1;
+      for (int j=0; j<nnz_row; j++){
+        inds.push_back((int64_t)((i*131+j*37)%n)*k+i);
+        vals.push_back(1.+drand48());
+      }
+    }
+  }
+  B.write(inds.size(), inds.data(), vals.data());
+}
+
+int spgemm_acc(int     n,
+               World & dw){
+  int pass = 1;
+  int m = 4*n, k = 4*n, nn = 128*n;
+  Semiring<double> fsr(0., &fadd_sa, MPI_SUM, 1., &fmul_sa);
+  MinPlus<double> mp;
+  double inf = std::numeric_limits<double>::infinity();
+
+  Matrix<> A(m, k, SP, dw);
+  Matrix<> B(k, nn, SP, dw);
+  srand48(17);
+  fill_spgemm_acc(A, B, dw);
+
+  Matrix<> C(m, nn, SP, dw);
+  C["ij"] = A["ik"]*B["kj"];
+
+  Matrix<> FA(m, k, SP, dw, fsr);
+  Matrix<> FB(k, nn, SP, dw, fsr);
+  Matrix<> FC(m, nn, SP, dw, fsr);
+  FA["ij"] = A["ij"];
+  FB["ij"] = B["ij"];
+  FC["ij"] = FA["ik"]*FB["kj"];
+
+  Matrix<> TA(m, k, SP, dw, mp);
+  Matrix<> TB(k, nn, SP, dw, mp);
+  Matrix<> TC(m, nn, SP, dw, mp);
+  TA["ij"] = A["ij"];
+  TB["ij"] = B["ij"];
+  TC["ij"] = TA["ik"]*TB["kj"];
+
+  std::vector<double> all_A(m*k), all_B(k*nn), all_C(m*nn), all_FC(m*nn), all_TC(m*nn);
+  A.read_all(all_A.data());
+  B.read_all(all_B.data());
+  C.read_all(all_C.data());
+  FC.read_all(all_FC.data());
+  TC.read_all(all_TC.data());
+  for (int j=0; j<nn; j++){
+    for (int i=0; i<m; i++){
+      double c = 0., tc = inf;
+      for (int l=0; l<k; l++){
+        double a = all_A[l*m+i], b = all_B[(int64_t)j*k+l];
+        c += a*b;
+        if (a != 0. && b != 0.) tc = std::min(tc, a+b);
+      }
+      int64_t ij = (int64_t)j*m+i;
+      pass = pass && fabs(all_C[ij]-c) < 1.E-10 && fabs(all_FC[ij]-c) < 1.E-10;
+      pass = pass && (tc == inf ? all_TC[ij] == inf : fabs(all_TC[ij]-tc) < 1.E-10);
+    }
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ C[\"ij\"] = A[\"ik\"]*B[\"kj\"] with sparse A, B, and C using dense, hash, and heap accumulators } passed \n");
+    else
+      printf("{ C[\"ij\"] = A[\"ik\"]*B[\"kj\"] with sparse A, B, and C using dense, hash, and heap accumulators } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 7;
+  } else n = 7;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking sparse times sparse matrix products with n = %d\n", n);
+    }
+    pass = spgemm_acc(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
@@ -0,0 +1,152 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup sr_gemm sr_gemm
+  * @{
+  * \brief Checks the blocked gemm used for semirings without a user-provided gemm
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+int sr_gemm(int     n,
+            World & dw){
+  int pass = 1;
+
+  // sizes not divisible by any of the block sizes
+  int m = 2*n+67;
+  int nn = n+13;
+  int k = 3*n+263;
+
+  Semiring<double> mp(std::numeric_limits<double>::infinity(),
+                      [](double a, double b){ return std::min(a,b); },
+                      MPI_MIN,
+                      0.,
+                      [](double a, double b){ return a+b; });
+  std::vector<double> A(m*k), B(k*nn), C(m*nn), C0(m*nn);
+  srand48(dw.rank+7);
+  for (int i=0; i<m*k; i++) A[i] = drand48();
+  for (int i=0; i<k*nn; i++) B[i] = drand48();
+  for (int i=0; i<m*nn; i++) C[i] = 1.+drand48();
+
+  // A is m-by-k, B is n-by-k, C = min(C, alpha + A*B^T)
+  double alpha = .5, beta = 0.;
+  for (int j=0; j<nn; j++){
+    for (int i=0; i<m; i++){
+      double c = C[j*m+i];
+      for (int l=0; l<k; l++) c = std::min(c, alpha+A[l*m+i]+B[l*nn+j]);
+      C0[j*m+i] = c;
+    }
+  }
+  mp.gemm('N', 'T', m, nn, k, (char const*)&alpha, (char const*)A.data(), (char const*)B.data(), (char const*)&beta, (char*)C.data());
+  for (int i=0; i<m*nn; i++) pass = pass && C[i] == C0[i];
+
+  // an associative but noncommutative addition, which keeps the last summand,
+  // so the result is correct only if every element of C is updated in order
+  Semiring<int> lst(0,
+                    [](int a, int b){ return a; },
+                    MPI_MAX,
+                    1,
+                    [](int a, int b){ return a*b; });
+  std::vector<int> iA(k*m), iB(k*nn), iC(m*nn, 0);
+  for (int i=0; i<k*m; i++) iA[i] = i%17-8;
+  for (int i=0; i<k*nn; i++) iB[i] = i%13-6;
+  int ialpha = 1, ibeta = 1;
+  lst.gemm('T', 'N', m, nn, k, (char const*)&ialpha, (char const*)iA.data(), (char const*)iB.data(), (char const*)&ibeta, (char*)iC.data());
+  for (int j=0; j<nn; j++){
+    for (int i=0; i<m; i++){
+      pass = pass && iC[j*m+i] == iA[i*k+k-1]*iB[j*k+k-1];
+    }
+  }
+
+  // default integer semiring, with scaling of A and C
+  Semiring<int64_t> is;
+  std::vector<int64_t> lA(m*k), lB(k*nn), lC(m*nn), lC0(m*nn);
+  for (int i=0; i<m*k; i++) lA[i] = i%7-3;
+  for (int i=0; i<k*nn; i++) lB[i] = i%5-2;
+  for (int i=0; i<m*nn; i++) lC[i] = i%3;
+  int64_t lalpha = 3, lbeta = -2;
+  for (int j=0; j<nn; j++){
+    for (int i=0; i<m; i++){
+      int64_t c = lbeta*lC[j*m+i];
+      for (int l=0; l<k; l++) c += lalpha*lA[l*m+i]*lB[j*k+l];
+      lC0[j*m+i] = c;
+    }
+  }
+  is.gemm('N', 'N', m, nn, k, (char const*)&lalpha, (char const*)lA.data(), (char const*)lB.data(), (char const*)&lbeta, (char*)lC.data());
+  for (int i=0; i<m*nn; i++) pass = pass && lC[i] == lC0[i];
+
+  // distributed min-plus matrix product
+  Matrix<double> dA(n+5, n+9, dw, mp);
+  Matrix<double> dB(n+9, n+3, dw, mp);
+  Matrix<double> dC(n+5, n+3, dw, mp);
+  dA.fill_random(0.,1.);
+  dB.fill_random(0.,1.);
+  dC["ij"] = dA["ik"]*dB["kj"];
+  std::vector<double> all_A((n+5)*(n+9)), all_B((n+9)*(n+3)), all_C((n+5)*(n+3));
+  dA.read_all(all_A.data());
+  dB.read_all(all_B.data());
+  dC.read_all(all_C.data());
+  for (int j=0; j<n+3; j++){
+    for (int i=0; i<n+5; i++){
+      double c = std::numeric_limits<double>::infinity();
+      for (int l=0; l<n+9; l++) c = std::min(c, all_A[l*(n+5)+i]+all_B[j*(n+9)+l]);
+      pass = pass && std::abs(c-all_C[j*(n+5)+i]) <= 1.E-14;
+    }
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ C[\"ij\"] = A[\"ik\"]*B[\"kj\"] with blocked semiring gemm } passed \n");
+    else
+      printf("{ C[\"ij\"] = A[\"ik\"]*B[\"kj\"] with blocked semiring gemm } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 7;
+  } else n = 7;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking blocked semiring gemm with n = %d\n", n);
+    }
+    pass = sr_gemm(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
@@ -0,0 +1,256 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup sr_op sr_op
+  * @{
+  * \brief Checks semirings and monoids with operators given by functors and lambdas against function pointers
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+struct min_op {
+  double operator()(double a, double b) const { return std::min(a,b); }
+};
+
+struct plus_op {
+  double operator()(double a, double b) const { return a+b; }
+};
+
+double fmin_ptr(double a, double b){ return std::min(a,b); }
+double fplus_ptr(double a, double b){ return a+b; }
+
+int sr_op(int     n,
+          World & dw){
+  int pass = 1;
+  double inf = std::numeric_limits<double>::infinity();
+
+  Semiring<double> ptr_sr(inf, &fmin_ptr, MPI_MIN, 0., &fplus_ptr);
+  Semiring_Op<double, min_op, plus_op> fct_sr(inf, min_op(), MPI_MIN, 0., plus_op());
+  auto lmb_sr = make_semiring<double>(inf,
+                                      [](double a, double b){ return std::min(a,b); },
+                                      MPI_MIN,
+                                      0.,
+                                      [](double a, double b){ return a+b; });
+
+  Matrix<double> A(n+3, n, dw, ptr_sr);
+  Matrix<double> B(n, n+5, dw, ptr_sr);
+  Matrix<double> SA(n+3, n, SP, dw, ptr_sr);
+  Matrix<double> SB(n, n+5, SP, dw, ptr_sr);
+  srand48(dw.rank+3);
+  A.fill_random(0.,1.);
+  B.fill_random(0.,1.);
+  SA.fill_sp_random(0.,1.,.3);
+  SB.fill_sp_random(0.,1.,.3);
+
+  Matrix<double> C_ptr(n+3, n+5, dw, ptr_sr);
+  Matrix<double> SC_ptr(n+3, n+5, dw, ptr_sr);
+  Matrix<double> SSC_ptr(n+3, n+5, SP, dw, ptr_sr);
+  C_ptr["ij"] = A["ik"]*B["kj"];
+  SC_ptr["ij"] = SA["ik"]*B["kj"];
+  SSC_ptr["ij"] = SA["ik"]*SB["kj"];
+
+  std::vector<double> ref((n+3)*(n+5)), sref((n+3)*(n+5)), ssref((n+3)*(n+5)), res((n+3)*(n+5));
+  C_ptr.read_all(ref.data());
+  SC_ptr.read_all(sref.data());
+  SSC_ptr.read_all(ssref.data());
+
+  // the function pointer semiring is checked against a reference loop
+  std::vector<double> all_A((n+3)*n), all_B(n*(n+5)), all_SA((n+3)*n);
+  A.read_all(all_A.data());
+  B.read_all(all_B.data());
+  SA.read_all(all_SA.data());
+  for (int j=0; j<n+5; j++){
+    for (int i=0; i<n+3; i++){
+      double c = inf, sc = inf;
+      for (int l=0; l<n; l++){
+        c = std::min(c, all_A[l*(n+3)+i]+all_B[j*n+l]);
+        sc = std::min(sc, all_SA[l*(n+3)+i]+all_B[j*n+l]);
+      }
+      pass = pass && c == ref[j*(n+3)+i] && sc == sref[j*(n+3)+i];
+    }
+  }
+
+  // elementwise products and sums with dense, sparse, and symmetric operands, which use the sequential kernels
+  Matrix<double> SA2(n+3, n, SP, dw, ptr_sr);
+  SA2.fill_sp_random(0.,1.,.3);
+  Matrix<double> H_ptr(n+3, n, dw, ptr_sr);
+  Matrix<double> D_ptr(n+3, n, dw, ptr_sr);
+  Matrix<double> SD_ptr(n+3, n, SP, dw, ptr_sr);
+  H_ptr["ij"] = A["ij"]*A["ij"];
+  D_ptr["ij"] = A["ij"];
+  D_ptr["ij"] += SA["ij"];
+  SD_ptr["ij"] = SA2["ij"];
+  SD_ptr["ij"] += SA["ij"];
+  Matrix<double> Q(n, n, dw, ptr_sr);
+  Q.fill_random(0.,1.);
+  Matrix<double> SQ_ptr(n, n, SY, dw, ptr_sr);
+  Matrix<double> NQ_ptr(n, n, dw, ptr_sr);
+  SQ_ptr["ij"] = Q["ij"];
+  NQ_ptr["ij"] = SQ_ptr["ij"];
+  std::vector<double> href((n+3)*n), dref((n+3)*n), sdref((n+3)*n), eres((n+3)*n), nqref(n*n);
+  H_ptr.read_all(href.data());
+  D_ptr.read_all(dref.data());
+  SD_ptr.read_all(sdref.data());
+  NQ_ptr.read_all(nqref.data());
+  for (int i=0; i<(n+3)*n; i++){
+    pass = pass && href[i] == all_A[i]+all_A[i] && dref[i] == std::min(all_A[i], all_SA[i]);
+  }
+  for (int i=0; i<n; i++){
+    for (int j=0; j<n; j++) pass = pass && nqref[i*n+j] == nqref[j*n+i];
+  }
+
+  for (int s=0; s<2; s++){
+    CTF_int::algstrct const & sr = s == 0 ? (CTF_int::algstrct const &)fct_sr : (CTF_int::algstrct const &)lmb_sr;
+    Matrix<double> oA(n+3, n, dw, sr);
+    Matrix<double> oB(n, n+5, dw, sr);
+    Matrix<double> oSA(n+3, n, SP, dw, sr);
+    Matrix<double> oSB(n, n+5, SP, dw, sr);
+    oA["ij"] = A["ij"];
+    oB["ij"] = B["ij"];
+    oSA["ij"] = SA["ij"];
+    oSB["ij"] = SB["ij"];
+
+    Matrix<double> C(n+3, n+5, dw, sr);
+    C["ij"] = oA["ik"]*oB["kj"];
+    C.read_all(res.data());
+    for (int i=0; i<(n+3)*(n+5); i++) pass = pass && res[i] == ref[i];
+
+    Matrix<double> SC(n+3, n+5, dw, sr);
+    SC["ij"] = oSA["ik"]*oB["kj"];
+    SC.read_all(res.data());
+    for (int i=0; i<(n+3)*(n+5); i++) pass = pass && res[i] == sref[i];
+
+    Matrix<double> SSC(n+3, n+5, SP, dw, sr);
+    SSC["ij"] = oSA["ik"]*oSB["kj"];
+    SSC.read_all(res.data());
+    for (int i=0; i<(n+3)*(n+5); i++) pass = pass && res[i] == ssref[i];
+
+    Matrix<double> H(n+3, n, dw, sr);
+    H["ij"] = oA["ij"]*oA["ij"];
+    H.read_all(eres.data());
+    for (int i=0; i<(n+3)*n; i++) pass = pass && eres[i] == href[i];
+
+    Matrix<double> D(n+3, n, dw, sr);
+    D["ij"] = oA["ij"];
+    D["ij"] += oSA["ij"];
+    D.read_all(eres.data());
+    for (int i=0; i<(n+3)*n; i++) pass = pass && eres[i] == dref[i];
+
+    Matrix<double> SD(n+3, n, SP, dw, sr);
+    SD["ij"] = SA2["ij"];
+    SD["ij"] += oSA["ij"];
+    SD.read_all(eres.data());
+    for (int i=0; i<(n+3)*n; i++) pass = pass && eres[i] == sdref[i];
+
+    Matrix<double> SQ(n, n, SY, dw, sr);
+    Matrix<double> NQ(n, n, dw, sr);
+    SQ["ij"] = SQ_ptr["ij"];
+    NQ["ij"] = SQ["ij"];
+    NQ.read_all(eres.data());
+    for (int i=0; i<n*n; i++) pass = pass && eres[i] == nqref[i];
+  }
+
+  // sparse times sparse into dense output
+  int m = n+3, nn = n+5, k = n;
+  std::vector<double> dA(m*k, inf), dB(k*nn, inf), dC(m*nn), dC0(m*nn);
+  for (int i=0; i<m*k; i++) if (i%3 == 0) dA[i] = (i%11)*.25;
+  for (int i=0; i<k*nn; i++) if (i%4 == 1) dB[i] = (i%7)*.5;
+  for (int i=0; i<m*nn; i++) dC[i] = 2.+(i%5);
+  double alpha = 1., beta = 0.;
+  // 1-based CSR representations of A and B
+  std::vector<double> vA, vB;
+  std::vector<int> JA, IA(1,1), JB, IB(1,1);
+  for (int i=0; i<m; i++){
+    for (int j=0; j<k; j++) if (dA[j*m+i] != inf){ vA.push_back(dA[j*m+i]); JA.push_back(j+1); }
+    IA.push_back(vA.size()+1);
+  }
+  for (int i=0; i<k; i++){
+    for (int j=0; j<nn; j++) if (dB[j*k+i] != inf){ vB.push_back(dB[j*k+i]); JB.push_back(j+1); }
+    IB.push_back(vB.size()+1);
+  }
+  for (int j=0; j<nn; j++){
+    for (int i=0; i<m; i++){
+      double c = dC[j*m+i];
+      for (int l=0; l<k; l++) c = std::min(c, alpha+dA[l*m+i]+dB[j*k+l]);
+      dC0[j*m+i] = c;
+    }
+  }
+  lmb_sr.csrmultd(m, nn, k, (char const*)&alpha, (char const*)vA.data(), JA.data(), IA.data(), vA.size(),
+                  (char const*)vB.data(), JB.data(), IB.data(), vB.size(), (char const*)&beta, (char*)dC.data());
+  for (int i=0; i<m*nn; i++) pass = pass && dC[i] == dC0[i];
+
+  // monoid with a functor summing into a vector
+  auto mx = make_monoid<int>(0, [](int a, int b){ return std::max(a,b); }, MPI_MAX);
+  Vector<int> v(n*n, dw, mx);
+  Vector<int> w(n*n, dw, mx);
+  int64_t * inds;
+  int * vals;
+  int64_t nloc;
+  v.read_local(&nloc, &inds, &vals);
+  for (int64_t i=0; i<nloc; i++) vals[i] = (int)(inds[i]%7);
+  v.write(nloc, inds, vals);
+  for (int64_t i=0; i<nloc; i++) vals[i] = 3;
+  w.write(nloc, inds, vals);
+  free(inds);
+  free(vals);
+  w["i"] += v["i"];
+  std::vector<int> all_w(n*n);
+  w.read_all(all_w.data());
+  for (int i=0; i<n*n; i++) pass = pass && all_w[i] == std::max(3, i%7);
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ C[\"ij\"] = A[\"ik\"]*B[\"kj\"] with functor and lambda semirings } passed \n");
+    else
+      printf("{ C[\"ij\"] = A[\"ik\"]*B[\"kj\"] with functor and lambda semirings } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 9;
+  } else n = 9;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking semirings with inlined operators with n = %d\n", n);
+    }
+    pass = sr_op(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
@@ -0,0 +1,176 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup tensor_checkpoint tensor_checkpoint
+  * @{
+  * \brief Checks that checkpoints of dense, symmetric, and sparse tensors are read back correctly with the same and a different number of processes
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+/**
+ * \brief writes checkpoints of A, S, and P to a file, returns the offset after the last
+ */
+static int64_t write_ckpt(Tensor<> & A, Tensor<> & S, Tensor<> & P, char const * fname, MPI_Comm cm){
+  MPI_File file;
+  MPI_File_open(cm, fname, MPI_MODE_WRONLY | MPI_MODE_CREATE, MPI_INFO_NULL, &file);
+  int64_t off = 0;
+  off += A.write_checkpoint(file, off);
+  off += S.write_checkpoint(file, off);
+  off += P.write_checkpoint(file, off);
+  MPI_File_close(&file);
+  return off;
+}
+
+/**
+ * \brief reads checkpoints written by write_ckpt into A, S, and P and compares them to A0, S0, and P0
+ */
+static int read_ckpt(Tensor<> & A, Tensor<> & S, Tensor<> & P, Tensor<> & A0, Tensor<> & S0, Tensor<> & P0,
+                     int64_t end_off, char const * fname, World & dw){
+  int pass = 1;
+  MPI_File file;
+  MPI_File_open(dw.comm, fname, MPI_MODE_RDONLY, MPI_INFO_NULL, &file);
+  int64_t off = 0;
+  int64_t sz = A.read_checkpoint(file, off);
+  pass = pass && sz > 0;
+  off += sz;
+  sz = S.read_checkpoint(file, off);
+  pass = pass && sz > 0;
+  off += sz;
+  sz = P.read_checkpoint(file, off);
+  pass = pass && sz > 0;
+  off += sz;
+  MPI_File_close(&file);
+  pass = pass && off == end_off;
+
+  A["ijk"] -= A0["ijk"];
+  S["ij"] -= S0["ij"];
+  pass = pass && A.norm2() <= 1.E-12 && S.norm2() <= 1.E-12;
+  pass = pass && P.nnz_tot == P0.nnz_tot;
+  P["ijk"] -= P0["ijk"];
+  pass = pass && P.norm2() <= 1.E-12;
+  return pass;
+}
+
+int tensor_checkpoint(int     n,
+                      World & dw){
+  int pass = 1;
+  int lens[] = {n, n+1, n+2};
+  int shape[] = {NS, NS, NS};
+  char const * fname = "CTF_tensor_checkpoint_test_file.bin";
+
+  Tensor<> A0(3, lens, shape, dw);
+  Matrix<> S0(n, n, SY, dw);
+  Tensor<> P0(3, true, lens, shape, dw);
+  srand48(dw.rank*7+1);
+  A0.fill_random(-1.,1.);
+  S0.fill_random(-1.,1.);
+  P0.fill_sp_random(-1.,1.,.2);
+
+  // written and read by the same processes, so local blocks are read as stored
+  int64_t end_off = write_ckpt(A0, S0, P0, fname, dw.comm);
+  {
+    Tensor<> A(3, lens, shape, dw);
+    Matrix<> S(n, n, SY, dw);
+    Tensor<> P(3, true, lens, shape, dw);
+    pass = pass && read_ckpt(A, S, P, A0, S0, P0, end_off, fname, dw);
+  }
+
+  // written by half of the processes, so the data is redistributed when read by all of them
+  int nsub = (dw.np+1)/2;
+  MPI_Comm sub_comm;
+  MPI_Comm_split(dw.comm, dw.rank < nsub, dw.rank, &sub_comm);
+  {
+    World sw(sub_comm);
+    // sparse tensors are moved to the subworld through a dense one
+    Tensor<> D0(3, lens, shape, dw);
+    D0["ijk"] = P0["ijk"];
+    if (dw.rank < nsub){
+      Tensor<> A(3, lens, shape, sw);
+      Matrix<> S(n, n, SY, sw);
+      Tensor<> D(3, lens, shape, sw);
+      Tensor<> P(3, true, lens, shape, sw);
+      A0.add_to_subworld(&A, 1., 0.);
+      S0.add_to_subworld(&S, 1., 0.);
+      D0.add_to_subworld(&D, 1., 0.);
+      P["ijk"] = D["ijk"];
+      P.sparsify();
+      end_off = write_ckpt(A, S, P, fname, sub_comm);
+    } else {
+      A0.add_to_subworld(NULL, 1., 0.);
+      S0.add_to_subworld(NULL, 1., 0.);
+      D0.add_to_subworld(NULL, 1., 0.);
+    }
+  }
+  MPI_Comm_free(&sub_comm);
+  MPI_Bcast(&end_off, 1, MPI_INT64_T, 0, dw.comm);
+  {
+    Tensor<> A(3, lens, shape, dw);
+    Matrix<> S(n, n, SY, dw);
+    Tensor<> P(3, true, lens, shape, dw);
+    pass = pass && read_ckpt(A, S, P, A0, S0, P0, end_off, fname, dw);
+
+    // a checkpoint of a tensor with other lengths is rejected
+    Matrix<> M(n+1, n, NS, dw);
+    MPI_File file;
+    MPI_File_open(dw.comm, fname, MPI_MODE_RDONLY | MPI_MODE_DELETE_ON_CLOSE, MPI_INFO_NULL, &file);
+    pass = pass && M.read_checkpoint(file, 0) == -1;
+    MPI_File_close(&file);
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ checkpoints of dense, symmetric, and sparse tensors are read back } passed \n");
+    else
+      printf("{ checkpoints of dense, symmetric, and sparse tensors are read back } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 7;
+  } else n = 7;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking tensor checkpoints with n = %d\n", n);
+    }
+    pass = tensor_checkpoint(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
@@ -0,0 +1,130 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup tensor_move tensor_move
+  * @{
+  * \brief Checks that moving tensors, matrices, and vectors takes their data without copying it, while copying still copies
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+int tensor_move(int     n,
+                World & dw){
+  int pass = 1;
+  int lens[] = {n, n+1, n+2};
+  int shape[] = {NS, NS, NS};
+
+  Tensor<> A(3, lens, shape, dw);
+  A.fill_random(-1.,1.);
+  Tensor<> A0(A);
+  pass = pass && A0.data != A.data;
+
+  // moving takes the buffer of A, leaving A empty
+  char * data = A.data;
+  Tensor<> B(std::move(A));
+  pass = pass && B.data == data && A.order == -1;
+  Tensor<> C;
+  C = std::move(B);
+  pass = pass && C.data == data && B.order == -1;
+  Tensor<> & C_alias = C;
+  C = std::move(C_alias);
+  pass = pass && C.data == data;
+  C["ijk"] -= A0["ijk"];
+  pass = pass && C.norm2() <= 1.E-12;
+
+  // copying still copies, including into a tensor that was moved from
+  A = A0;
+  pass = pass && A.data != A0.data;
+  A["ijk"] -= A0["ijk"];
+  pass = pass && A.norm2() <= 1.E-12;
+
+  // growing a vector of matrices moves them rather than copying them
+  int nmat = 5;
+  std::vector< Matrix<> > mats;
+  std::vector<char*> mat_data;
+  std::vector<double> mat_norms;
+  for (int i=0; i<nmat; i++){
+    Matrix<> M(n+i, n, NS, dw);
+    M.fill_random(-1.,1.);
+    mat_data.push_back(M.data);
+    mat_norms.push_back(M.norm2());
+    mats.push_back(std::move(M));
+  }
+  for (int i=0; i<nmat; i++){
+    pass = pass && mats[i].data == mat_data[i] && mats[i].nrow == n+i && mats[i].ncol == n;
+    pass = pass && std::abs(mats[i].norm2()-mat_norms[i]) <= 1.E-12;
+  }
+  Matrix<> M;
+  M = std::move(mats[0]);
+  pass = pass && M.data == mat_data[0] && M.nrow == n;
+  M = mats[1];
+  pass = pass && M.data != mat_data[1] && M.nrow == n+1 && std::abs(M.norm2()-mat_norms[1]) <= 1.E-12;
+
+  Vector<> v(n, dw);
+  v.fill_random(-1.,1.);
+  double v_norm = v.norm2();
+  data = v.data;
+  Vector<> w(std::move(v));
+  pass = pass && w.data == data && w.len == n;
+  Vector<> u;
+  u = w;
+  pass = pass && u.data != w.data && u.len == n && std::abs(u.norm2()-v_norm) <= 1.E-12;
+  u = std::move(w);
+  pass = pass && u.data == data && std::abs(u.norm2()-v_norm) <= 1.E-12;
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ moving tensors, matrices, and vectors keeps their data } passed \n");
+    else
+      printf("{ moving tensors, matrices, and vectors keeps their data } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 7;
+  } else n = 7;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking move semantics of tensors with n = %d\n", n);
+    }
+    pass = tensor_move(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif
@@ -25,6 +25,30 @@
 #include "univar_function.cxx"
 #include "bivar_function.cxx"
 #include "bivar_transform.cxx"
+#include "ctr_plan_cache.cxx"
+#include "redist_plan_cache.cxx"
+#include "node_topo.cxx"
+#include "mst_arena.cxx"
+#include "intm_pool.cxx"
+#include "tensor_move.cxx"
+#include "tensor_checkpoint.cxx"
+#include "sparse_file_io.cxx"
+#include "schedule_subworlds.cxx"
+#include "ctr_order.cxx"
+#include "ctr_dry_run.cxx"
+#include "sr_gemm.cxx"
+#include "sr_op.cxx"
+#include "tropical.cxx"
+#include "sp_idx_width.cxx"
+#include "sp_pairs.cxx"
+#include "sp_read.cxx"
+#include "pair_sort.cxx"
+#include "spgemm_acc.cxx"
+#include "dcsr.cxx"
+#include "mttkrp.cxx"
+#include "masked_spgemm.cxx"
+#include "pattern.cxx"
+#include "nnz_balance.cxx"
 
 #include "../examples/trace.cxx"
 #include "../examples/dft_3D.cxx"
@@ -193,6 +217,102 @@ int main(int argc, char ** argv){
       printf("Testing SY times NS with n = %d:\n",n);
     pass.push_back(sy_times_ns(n,dw));
 
+    if (rank == 0)
+      printf("Testing contraction mapping cache with n = %d:\n",n);
+    pass.push_back(ctr_plan_cache(n,dw));
+
+    if (rank == 0)
+      printf("Testing redistribution plan cache with n = %d:\n",n);
+    pass.push_back(redist_plan_cache(n,dw));
+
+    if (rank == 0)
+      printf("Testing node-aware topologies with n = %d:\n",n);
+    pass.push_back(node_topo(n,dw));
+
+    if (rank == 0)
+      printf("Testing arena of temporary buffers with n = %d:\n",n);
+    pass.push_back(mst_arena(n,dw));
+
+    if (rank == 0)
+      printf("Testing pool of intermediate tensors with n = %d:\n",n);
+    pass.push_back(intm_pool(n,dw));
+
+    if (rank == 0)
+      printf("Testing move semantics of tensors with n = %d:\n",n);
+    pass.push_back(tensor_move(n,dw));
+
+    if (rank == 0)
+      printf("Testing tensor checkpoints with n = %d:\n",n);
+    pass.push_back(tensor_checkpoint(n,dw));
+
+    if (rank == 0)
+      printf("Testing sparse file I/O with n = %d:\n",n);
+    pass.push_back(sparse_file_io(n,dw));
+
+    if (rank == 0)
+      printf("Testing reuse of schedule subworlds with n = %d:\n",n);
+    pass.push_back(schedule_subworlds(n,dw));
+
+    if (rank == 0)
+      printf("Testing ordering of multi-tensor contractions with n = %d:\n",n);
+    pass.push_back(ctr_order(n,dw));
+
+    if (rank == 0)
+      printf("Testing dry runs of contractions with n = %d:\n",n);
+    pass.push_back(ctr_dry_run(n,dw));
+
+    if (rank == 0)
+      printf("Testing blocked semiring gemm with n = %d:\n",n);
+    pass.push_back(sr_gemm(n,dw));
+
+    if (rank == 0)
+      printf("Testing semirings with inlined operators with n = %d:\n",n);
+    pass.push_back(sr_op(n,dw));
+
+    if (rank == 0)
+      printf("Testing min-plus and max-plus semirings with n = %d:\n",n);
+    pass.push_back(tropical(n,dw));
+
+    if (rank == 0)
+      printf("Testing sparse contractions with different index widths with n = %d:\n",n);
+    pass.push_back(sp_idx_width(n,dw));
+
+    if (rank == 0)
+      printf("Testing sparse writes and reads of unsorted repeated keys with n = %d:\n",n);
+    pass.push_back(sp_pairs(n,dw));
+
+    if (rank == 0)
+      printf("Testing sparse reads of present and absent keys with n = %d:\n",n);
+    pass.push_back(sp_read(n,dw));
+
+    if (rank == 0)
+      printf("Testing sort of key-value pairs with n = %d:\n",n);
+    pass.push_back(pair_sort(n,dw));
+
+    if (rank == 0)
+      printf("Testing sparse times sparse matrix products with n = %d:\n",n);
+    pass.push_back(spgemm_acc(n,dw));
+
+    if (rank == 0)
+      printf("Testing contractions of hypersparse matrices with n = %d:\n",n);
+    pass.push_back(dcsr(n,dw));
+
+    if (rank == 0)
+      printf("Testing MTTKRP of sparse tensors with n = %d:\n",n);
+    pass.push_back(mttkrp(n,dw));
+
+    if (rank == 0)
+      printf("Testing masked sparse matrix products with n = %d:\n",n);
+    pass.push_back(masked_spgemm(n,dw));
+
+    if (rank == 0)
+      printf("Testing pattern-only sparse tensors with n = %d:\n",n);
+    pass.push_back(pattern(n,dw));
+
+    if (rank == 0)
+      printf("Testing relabeling of skewed sparse matrices with n = %d:\n",n);
+    pass.push_back(nnz_balance(n,dw));
+
 #if 0
     if (rank == 0)
       printf("Testing skew-symmetric Strassen's algorithm with n = %d:\n",n*n);
@@ -0,0 +1,140 @@
+/** \addtogroup tests
+  * @{
+  * \defgroup tropical tropical
+  * @{
+  * \brief Checks the built-in min-plus and max-plus semirings against reference loops
+  */
+
+#include <ctf.hpp>
+using namespace CTF;
+
+template <typename dtype, bool is_max>
+int check_tropical(int                             n,
+                   World &                         dw,
+                   CTF_int::algstrct const &       sr){
+  int pass = 1;
+  dtype addid = ((dtype const*)sr.addid())[0];
+  auto fadd = [](dtype a, dtype b){ return is_max ? std::max(a,b) : std::min(a,b); };
+  auto fmul = [=](dtype a, dtype b){ return (a == addid || b == addid) ? addid : a+b; };
+
+  // direct call to the local gemm, with sizes that are not multiples of the register tile
+  int m = 2*n+5, nn = n+3, k = 3*n+1;
+  std::vector<dtype> A(m*k), B(nn*k), C(m*nn), C0(m*nn);
+  for (int i=0; i<m*k; i++) A[i] = (dtype)((i*7)%23);
+  for (int i=0; i<nn*k; i++) B[i] = (i%5 == 0) ? addid : (dtype)((i*3)%17);
+  for (int i=0; i<m*nn; i++) C[i] = (dtype)(i%31);
+  dtype alpha = 2, beta = 1;
+  for (int j=0; j<nn; j++){
+    for (int i=0; i<m; i++){
+      dtype c = fmul(beta, C[j*m+i]);
+      for (int l=0; l<k; l++) c = fadd(fmul(fmul(alpha, A[l*m+i]), B[l*nn+j]), c);
+      C0[j*m+i] = c;
+    }
+  }
+  sr.gemm('N', 'T', m, nn, k, (char const*)&alpha, (char const*)A.data(), (char const*)B.data(), (char const*)&beta, (char*)C.data());
+  for (int i=0; i<m*nn; i++) pass = pass && C[i] == C0[i];
+
+  // dense and sparse distributed products
+  Matrix<dtype> dA(n+3, n, dw, sr);
+  Matrix<dtype> dB(n, 2*n+7, dw, sr);
+  Matrix<dtype> sA(n+3, n, SP, dw, sr);
+  Matrix<dtype> dC(n+3, 2*n+7, dw, sr);
+  Matrix<dtype> sC(n+3, 2*n+7, dw, sr);
+  dA.fill_random((dtype)0, (dtype)20);
+  dB.fill_random((dtype)0, (dtype)20);
+  srand48(dw.rank*13+1);
+  sA.fill_sp_random((dtype)0, (dtype)20, .3);
+  dC["ij"] = dA["ik"]*dB["kj"];
+  sC["ij"] = sA["ik"]*dB["kj"];
+  std::vector<dtype> all_A((n+3)*n), all_sA((n+3)*n), all_B(n*(2*n+7)), all_C((n+3)*(2*n+7)), all_sC((n+3)*(2*n+7));
+  dA.read_all(all_A.data());
+  sA.read_all(all_sA.data());
+  dB.read_all(all_B.data());
+  dC.read_all(all_C.data());
+  sC.read_all(all_sC.data());
+  for (int j=0; j<2*n+7; j++){
+    for (int i=0; i<n+3; i++){
+      dtype c = addid, sc = addid;
+      for (int l=0; l<n; l++){
+        c = fadd(fmul(all_A[l*(n+3)+i], all_B[j*n+l]), c);
+        sc = fadd(fmul(all_sA[l*(n+3)+i], all_B[j*n+l]), sc);
+      }
+      pass = pass && c == all_C[j*(n+3)+i] && sc == all_sC[j*(n+3)+i];
+    }
+  }
+  return pass;
+}
+
+int tropical(int     n,
+             World & dw){
+  int pass = 1;
+
+  pass = pass && check_tropical<double, false>(n, dw, MinPlus<double>());
+  pass = pass && check_tropical<double, true>(n, dw, MaxPlus<double>());
+  pass = pass && check_tropical<float, false>(n, dw, MinPlus<float>());
+  pass = pass && check_tropical<float, true>(n, dw, MaxPlus<float>());
+  pass = pass && check_tropical<int, false>(n, dw, MinPlus<int>());
+  pass = pass && check_tropical<int64_t, true>(n, dw, MaxPlus<int64_t>());
+
+  // the additive identity is absorbing for integers rather than overflowing
+  MinPlus<int> mp;
+  int inf = ((int const*)mp.addid())[0], one = 1, r;
+  mp.mul((char const*)&inf, (char const*)&one, (char*)&r);
+  pass = pass && r == inf;
+
+  MPI_Allreduce(MPI_IN_PLACE, &pass, 1, MPI_INT, MPI_MIN, dw.comm);
+  if (dw.rank == 0){
+    if (pass)
+      printf("{ C[\"ij\"] = A[\"ik\"]*B[\"kj\"] with min-plus and max-plus semirings } passed \n");
+    else
+      printf("{ C[\"ij\"] = A[\"ik\"]*B[\"kj\"] with min-plus and max-plus semirings } failed \n");
+  }
+  return pass;
+}
+
+
+#ifndef TEST_SUITE
+char* getCmdOption(char ** begin,
+                   char ** end,
+                   const   std::string & option){
+  char ** itr = std::find(begin, end, option);
+  if (itr != end && ++itr != end){
+    return *itr;
+  }
+  return 0;
+}
+
+
+int main(int argc, char ** argv){
+  int rank, np, n, pass;
+  int const in_num = argc;
+  char ** input_str = argv;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &np);
+
+  if (getCmdOption(input_str, input_str+in_num, "-n")){
+    n = atoi(getCmdOption(input_str, input_str+in_num, "-n"));
+    if (n < 0) n = 9;
+  } else n = 9;
+
+  {
+    World dw(argc, argv);
+
+    if (rank == 0){
+      printf("Checking min-plus and max-plus semirings with n = %d\n", n);
+    }
+    pass = tropical(n, dw);
+    assert(pass);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
+/**
+ * @}
+ * @}
+ */
+
+#endif